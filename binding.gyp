@@ -8,6 +8,17 @@
       "sources": [
         "src/binding.cpp",
         "src/gpu_info.c",
+        "src/gpu_sampler.c",
+        "src/gpu_aggregate.c",
+        "src/gpu_history.c",
+        "src/gpu_store.c",
+        "src/gpu_process.c",
+        "src/gpu_snapshot.c",
+        "src/gpu_pool.c",
+        "src/gpu_prometheus.c",
+        "src/gpu_metrics_server.c",
+        "src/gpu_collector.c",
+        "src/gpu_shm.c",
         "src/vendor/nvidia.c",
         "src/vendor/amd.c",
         "src/vendor/intel.c"
@@ -65,6 +76,9 @@
             "src/linux/nvidia_linux.c",
             "src/linux/amd_linux.c",
             "src/linux/intel_linux.c"
+          ],
+          "libraries": [
+            "-lrt"
           ]
         }]
       ]
@@ -29,5 +29,23 @@ try {
     }
 }
 
+// SharedArrayBuffer snapshots: the reader half lives in shared.js so worker
+// threads can use it without loading the native addon
+const shared = require('./shared');
+
+/**
+ * Create a SharedArrayBuffer that the background sampler keeps updated with
+ * the latest sample of every GPU. Pass it to workers and read it with
+ * readSnapshot(). Requires startSampler().
+ */
+module.exports.createSharedSnapshot = function (capacity = module.exports.getGpuCount()) {
+    const buffer = new SharedArrayBuffer(shared.snapshotByteLength(Math.max(capacity, 1)));
+    module.exports.publishSnapshot(new Int32Array(buffer));
+    return buffer;
+};
+module.exports.readSnapshot = shared.readSnapshot;
+module.exports.snapshotCapacity = shared.snapshotCapacity;
+module.exports.snapshotLayout = shared.layout;
+
 // Add version information
 module.exports.version = require('./package.json').version;
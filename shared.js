@@ -0,0 +1,121 @@
+/**
+ * Lock-free reader for GPU telemetry snapshots published into a
+ * SharedArrayBuffer by the native sampler (see createSharedSnapshot()).
+ *
+ * This file does not load the native addon, so worker threads can read
+ * snapshots without initializing any GPU driver. The layout mirrors
+ * src/gpu_snapshot.h.
+ */
+
+'use strict';
+
+const HEADER_BYTES = 32;
+const MAGIC = 0x53555047; // "GPUS"
+const VERSION = 1;
+
+// Header words (Int32Array indices)
+const WORD = Object.freeze({
+    sequence: 0,
+    magic: 1,
+    version: 2,
+    headerBytes: 3,
+    capacity: 4,
+    deviceCount: 5,
+    columnCount: 6
+});
+
+// Data columns; column c of GPU i is at c * capacity + i
+const COLUMNS = Object.freeze({
+    timestamp: 0,
+    memoryUsed: 1,
+    memoryFree: 2,
+    gpuUtilization: 3,
+    memoryUtilization: 4,
+    temperature: 5,
+    powerUsage: 6,
+    coreClock: 7,
+    memoryClock: 8,
+    fanSpeed: 9
+});
+const COLUMN_COUNT = 10;
+
+const layout = Object.freeze({
+    version: VERSION,
+    headerBytes: HEADER_BYTES,
+    words: WORD,
+    columns: COLUMNS,
+    columnCount: COLUMN_COUNT
+});
+
+// Typed views are created once per buffer so reads allocate nothing
+const views = new WeakMap();
+
+function getViews(buffer) {
+    let view = views.get(buffer);
+    if (view) {
+        return view;
+    }
+    
+    const header = new Int32Array(buffer, 0, HEADER_BYTES / 4);
+    if (header[WORD.magic] !== MAGIC || header[WORD.version] !== VERSION) {
+        throw new Error('Not a GPU snapshot buffer (or unsupported layout version)');
+    }
+    
+    const capacity = header[WORD.capacity];
+    view = {
+        header,
+        capacity,
+        data: new Float64Array(buffer, header[WORD.headerBytes], capacity * header[WORD.columnCount])
+    };
+    views.set(buffer, view);
+    return view;
+}
+
+/**
+ * Bytes needed for a snapshot of `capacity` GPUs
+ */
+function snapshotByteLength(capacity) {
+    return HEADER_BYTES + capacity * COLUMN_COUNT * 8;
+}
+
+/**
+ * Number of GPU slots in a snapshot buffer
+ */
+function snapshotCapacity(buffer) {
+    return getViews(buffer).capacity;
+}
+
+/**
+ * Copy a consistent snapshot into `out` (a Float64Array of at least
+ * capacity * columnCount doubles, same layout as the shared data block).
+ * Retries while the native sampler is mid-write.
+ *
+ * @returns {number} GPUs in the snapshot, or -1 if no consistent copy was
+ *                   obtained within maxRetries attempts
+ */
+function readSnapshot(buffer, out, maxRetries = 100) {
+    const { header, data } = getViews(buffer);
+    
+    for (let attempt = 0; attempt < maxRetries; attempt++) {
+        const before = Atomics.load(header, WORD.sequence);
+        if (before & 1) {
+            continue;
+        }
+        
+        out.set(data);
+        const count = header[WORD.deviceCount];
+        
+        if (Atomics.load(header, WORD.sequence) === before) {
+            return count;
+        }
+    }
+    
+    return -1;
+}
+
+module.exports = {
+    layout,
+    snapshotByteLength,
+    snapshotCapacity,
+    readSnapshot
+};
@@ -1,68 +1,449 @@
 #include <napi.h>
 extern "C" {
+#include "gpu_aggregate.h"
+#include "gpu_collector.h"
+#include "gpu_history.h"
 #include "gpu_info.h"
+#include "gpu_metrics_server.h"
+#include "gpu_process.h"
+#include "gpu_prometheus.h"
+#include "gpu_sampler.h"
+#include "gpu_shm.h"
+#include "gpu_snapshot.h"
+#include "gpu_store.h"
 }
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace gpu {
 
+/**
+ * JS property names accepted in a fields list
+ */
+struct FieldName {
+    const char* name;
+    gpu_field_mask_t field;
+};
+
+static const FieldName kFieldNames[] = {
+    { "vendor", GPU_FIELD_VENDOR },
+    { "name", GPU_FIELD_NAME },
+    { "uuid", GPU_FIELD_UUID },
+    { "pciBusId", GPU_FIELD_PCI_BUS_ID },
+    { "memoryTotal", GPU_FIELD_MEMORY_TOTAL },
+    { "memoryUsed", GPU_FIELD_MEMORY_USED },
+    { "memoryFree", GPU_FIELD_MEMORY_FREE },
+    { "gpuUtilization", GPU_FIELD_GPU_UTILIZATION },
+    { "memoryUtilization", GPU_FIELD_MEMORY_UTILIZATION },
+    { "temperature", GPU_FIELD_TEMPERATURE },
+    { "powerUsage", GPU_FIELD_POWER_USAGE },
+    { "coreClock", GPU_FIELD_CORE_CLOCK },
+    { "memoryClock", GPU_FIELD_MEMORY_CLOCK },
+    { "fanSpeed", GPU_FIELD_FAN_SPEED },
+    { "memoryTemperature", GPU_FIELD_MEMORY_TEMPERATURE },
+    { "energyConsumption", GPU_FIELD_ENERGY },
+    { "pcieReplayCount", GPU_FIELD_PCIE_REPLAY_COUNT },
+};
+
+/**
+ * Convert an optional array of property names to a field mask
+ * undefined/null selects every field; throws a TypeError and returns false
+ * on anything else that is not a list of known names
+ */
+bool ParseFieldMask(Napi::Env env, const Napi::Value& value, gpu_field_mask_t* mask) {
+    if (value.IsUndefined() || value.IsNull()) {
+        *mask = GPU_FIELD_ALL;
+        return true;
+    }
+    
+    if (!value.IsArray()) {
+        Napi::TypeError::New(env, "fields must be an array of property names")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    Napi::Array fields = value.As<Napi::Array>();
+    *mask = 0;
+    for (uint32_t i = 0; i < fields.Length(); i++) {
+        Napi::Value field = fields.Get(i);
+        std::string name = field.IsString() ? field.As<Napi::String>().Utf8Value() : "";
+        
+        gpu_field_mask_t bit = 0;
+        for (const FieldName& entry : kFieldNames) {
+            if (name == entry.name) {
+                bit = entry.field;
+                break;
+            }
+        }
+        
+        if (bit == 0) {
+            Napi::TypeError::New(env, "Unknown GPU field: " + name)
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        *mask |= bit;
+    }
+    
+    return true;
+}
+
 /**
  * Convert gpu_info_t struct to JavaScript object
+ * Only the properties selected by fields are set; index is always present
  */
-Napi::Object GpuInfoToObject(Napi::Env env, const gpu_info_t& info) {
+Napi::Object GpuInfoToObject(Napi::Env env, const gpu_info_t& info,
+                             gpu_field_mask_t fields = GPU_FIELD_ALL) {
     Napi::Object obj = Napi::Object::New(env);
     
     obj.Set("index", Napi::Number::New(env, info.index));
     
     // Vendor
-    std::string vendor_str;
-    switch (info.vendor) {
-        case GPU_VENDOR_NVIDIA: vendor_str = "NVIDIA"; break;
-        case GPU_VENDOR_AMD: vendor_str = "AMD"; break;
-        case GPU_VENDOR_INTEL: vendor_str = "Intel"; break;
-        default: vendor_str = "Unknown"; break;
+    if (fields & GPU_FIELD_VENDOR) {
+        const char* vendor_str;
+        switch (info.vendor) {
+            case GPU_VENDOR_NVIDIA: vendor_str = "NVIDIA"; break;
+            case GPU_VENDOR_AMD: vendor_str = "AMD"; break;
+            case GPU_VENDOR_INTEL: vendor_str = "Intel"; break;
+            default: vendor_str = "Unknown"; break;
+        }
+        obj.Set("vendor", Napi::String::New(env, vendor_str));
     }
-    obj.Set("vendor", Napi::String::New(env, vendor_str));
     
-    obj.Set("name", Napi::String::New(env, info.name));
-    obj.Set("uuid", Napi::String::New(env, info.uuid));
-    obj.Set("pciBusId", Napi::String::New(env, info.pci_bus_id));
+    if (fields & GPU_FIELD_NAME) obj.Set("name", Napi::String::New(env, info.name));
+    if (fields & GPU_FIELD_UUID) obj.Set("uuid", Napi::String::New(env, info.uuid));
+    if (fields & GPU_FIELD_PCI_BUS_ID) obj.Set("pciBusId", Napi::String::New(env, info.pci_bus_id));
     
     // Memory (in MB)
-    obj.Set("memoryTotal", Napi::Number::New(env, info.memory_total));
-    obj.Set("memoryUsed", Napi::Number::New(env, info.memory_used));
-    obj.Set("memoryFree", Napi::Number::New(env, info.memory_free));
+    if (fields & GPU_FIELD_MEMORY_TOTAL) {
+        obj.Set("memoryTotal", Napi::Number::New(env, static_cast<double>(info.memory_total)));
+    }
+    if (fields & GPU_FIELD_MEMORY_USED) {
+        obj.Set("memoryUsed", Napi::Number::New(env, static_cast<double>(info.memory_used)));
+    }
+    if (fields & GPU_FIELD_MEMORY_FREE) {
+        obj.Set("memoryFree", Napi::Number::New(env, static_cast<double>(info.memory_free)));
+    }
     
     // Utilization (percentage)
-    obj.Set("gpuUtilization", Napi::Number::New(env, info.gpu_utilization));
-    obj.Set("memoryUtilization", Napi::Number::New(env, info.memory_utilization));
+    if (fields & GPU_FIELD_GPU_UTILIZATION) {
+        obj.Set("gpuUtilization", Napi::Number::New(env, info.gpu_utilization));
+    }
+    if (fields & GPU_FIELD_MEMORY_UTILIZATION) {
+        obj.Set("memoryUtilization", Napi::Number::New(env, info.memory_utilization));
+    }
     
     // Temperature (Celsius)
-    obj.Set("temperature", Napi::Number::New(env, info.temperature));
+    if (fields & GPU_FIELD_TEMPERATURE) obj.Set("temperature", Napi::Number::New(env, info.temperature));
     
     // Power (Watts)
-    obj.Set("powerUsage", Napi::Number::New(env, info.power_usage));
+    if (fields & GPU_FIELD_POWER_USAGE) obj.Set("powerUsage", Napi::Number::New(env, info.power_usage));
     
     // Clocks (MHz)
-    obj.Set("coreClock", Napi::Number::New(env, info.core_clock));
-    obj.Set("memoryClock", Napi::Number::New(env, info.memory_clock));
+    if (fields & GPU_FIELD_CORE_CLOCK) obj.Set("coreClock", Napi::Number::New(env, info.core_clock));
+    if (fields & GPU_FIELD_MEMORY_CLOCK) obj.Set("memoryClock", Napi::Number::New(env, info.memory_clock));
     
     // Fan speed (percentage)
-    obj.Set("fanSpeed", Napi::Number::New(env, info.fan_speed));
+    if (fields & GPU_FIELD_FAN_SPEED) obj.Set("fanSpeed", Napi::Number::New(env, info.fan_speed));
+    
+    // Memory temperature (Celsius), energy (millijoules), PCIe replays
+    if (fields & GPU_FIELD_MEMORY_TEMPERATURE) {
+        obj.Set("memoryTemperature", Napi::Number::New(env, info.memory_temperature));
+    }
+    if (fields & GPU_FIELD_ENERGY) {
+        obj.Set("energyConsumption", Napi::Number::New(env, static_cast<double>(info.energy_consumption)));
+    }
+    if (fields & GPU_FIELD_PCIE_REPLAY_COUNT) {
+        obj.Set("pcieReplayCount", Napi::Number::New(env, static_cast<double>(info.pcie_replay_count)));
+    }
+    
+    return obj;
+}
+
+/**
+ * Result of one parallel collection pass over every GPU
+ * results[i] != GPU_SUCCESS marks a device that failed to collect
+ */
+struct InfoBatch {
+    std::vector<gpu_info_t> infos;
+    std::vector<gpu_error_t> results;
+    std::vector<int64_t> timestamps_ms;
+};
+
+/**
+ * Collect every GPU on the native collection pool (see gpu_pool.h)
+ */
+static void CollectAll(gpu_field_mask_t fields, InfoBatch* batch) {
+    int32_t count = 0;
+    if (gpu_get_count(&count) != GPU_SUCCESS) {
+        count = 0;
+    }
+    
+    batch->infos.resize(count);
+    batch->results.resize(count);
+    batch->timestamps_ms.resize(count);
+    if (gpu_collect_info(fields, batch->infos.data(), batch->results.data(),
+                         batch->timestamps_ms.data(), count, &count) != GPU_SUCCESS) {
+        count = 0;
+    }
     
+    // The device list may have shrunk since it was counted
+    batch->infos.resize(count);
+    batch->results.resize(count);
+    batch->timestamps_ms.resize(count);
+}
+
+/**
+ * GPU info object plus the time its collection started
+ */
+static Napi::Object BatchEntryToObject(Napi::Env env, const InfoBatch& batch, size_t i,
+                                       gpu_field_mask_t fields) {
+    Napi::Object obj = GpuInfoToObject(env, batch.infos[i], fields);
+    obj.Set("timestamp", Napi::Number::New(env, static_cast<double>(batch.timestamps_ms[i])));
     return obj;
 }
 
+/**
+ * getAllGpuInfo() result: one object per GPU, null for devices that failed
+ */
+static Napi::Array BatchToArray(Napi::Env env, const InfoBatch& batch, gpu_field_mask_t fields) {
+    Napi::Array gpuArray = Napi::Array::New(env, batch.infos.size());
+    for (size_t i = 0; i < batch.infos.size(); i++) {
+        if (batch.results[i] == GPU_SUCCESS) {
+            gpuArray.Set(static_cast<uint32_t>(i), BatchEntryToObject(env, batch, i, fields));
+        } else {
+            gpuArray.Set(static_cast<uint32_t>(i), env.Null());
+        }
+    }
+    return gpuArray;
+}
+
+/**
+ * Snapshot buffer the sampler publishes into
+ * The typed array stays referenced so its backing store outlives the writes;
+ * the writer, which is the listener ctx, holds the capacity fixed at publish
+ * time so nothing JavaScript writes into the buffer can resize the writes
+ */
+struct SnapshotPublication {
+    Napi::ObjectReference array;
+    gpu_snapshot_writer_t writer;
+};
+
+/**
+ * One collection pass over every GPU, shared by all watchers due on a tick
+ * Collects the union of the due watchers' fields
+ */
+typedef InfoBatch WatchBatch;
+
+/**
+ * A watch() subscription
+ * Owned by its ThreadSafeFunction and freed in the finalizer, which only
+ * runs once every queued call has been delivered or dropped
+ */
+struct WatchHub;
+
+struct WatchSubscriber {
+    uint32_t id;
+    WatchHub* hub;
+    std::chrono::milliseconds interval;
+    std::chrono::steady_clock::time_point next_due;
+    gpu_field_mask_t fields;
+    Napi::ThreadSafeFunction tsfn;
+    
+    // Protected by WatchHub::mutex
+    std::shared_ptr<const WatchBatch> pending;
+    bool queued = false;
+    bool active = true;
+};
+
+/**
+ * Single native collection thread serving every watch() subscriber
+ * Ticks at each subscriber's own interval but collects at most once per tick,
+ * and runs only while there is at least one subscriber. A thread that went
+ * idle is joined by the next watch() call or by StopAllWatchers(), never
+ * detached, so none outlives the hub
+ */
+struct WatchHub {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+    bool running = false;
+    uint32_t next_id = 1;
+    std::vector<WatchSubscriber*> subscribers;
+};
+
+/**
+ * A watch() subscription on a collector client
+ * Owned by its ThreadSafeFunction and freed in the finalizer, like
+ * WatchSubscriber
+ */
+struct RemoteSubscriber {
+    uint32_t id;
+    gpu_field_mask_t fields;
+    Napi::ThreadSafeFunction tsfn;
+    
+    std::mutex mutex;
+    std::shared_ptr<const InfoBatch> pending;
+    bool queued = false;
+    bool active = true;
+};
+
+/**
+ * Connection to a collector daemon
+ * Shared by the CollectorClient object and any getAllGpuInfoAsync() worker in
+ * flight, so the socket is only closed once neither needs it
+ */
+struct RemoteConnection {
+    gpu_collector_client_t* client = nullptr;
+    
+    // Keeps the CollectorClient object alive while it has watchers; JS thread
+    // only
+    Napi::ObjectReference self;
+    
+    // Lock order: mutex, then a subscriber's mutex
+    std::mutex mutex;
+    std::map<uint32_t, RemoteSubscriber*> subscribers;
+    
+    ~RemoteConnection() { gpu_collector_destroy(client); }
+};
+
+/**
+ * A store opened with openStore()
+ * Shared by the TelemetryStore object and the environment's cleanup hook, so
+ * whichever comes first closes it
+ */
+struct StoreHandle {
+    gpu_store_t* store = nullptr;
+    
+    void Close() {
+        if (store) {
+            // Waits for an in-flight write, so the store can be closed afterwards
+            gpu_sampler_remove_listener(gpu_store_write, store);
+            gpu_store_close(store);
+            store = nullptr;
+        }
+    }
+    
+    ~StoreHandle() { Close(); }
+};
+
+/**
+ * Per-environment addon state
+ * The addon can be loaded by the main thread and any number of worker
+ * threads; each gets its own AddonData via SetInstanceData(). The C core and
+ * the sampler are process-wide and shared, so an environment only holds
+ * references on them and never tears them down under another environment.
+ */
+struct AddonData {
+    bool backend_ref = false;   // Holds a gpu_info_init() reference
+    bool sampler_ref = false;   // Holds a reference on the shared sampler
+    bool history_ref = false;   // Holds a reference on the shared history
+    SnapshotPublication* snapshot = nullptr;
+    WatchHub watch_hub;
+    
+    // Renderer for the most recent renderPrometheus() options
+    gpu_prometheus_t* prometheus = nullptr;
+    std::string prometheus_key;
+    
+    // Running serveMetrics() servers by id
+    std::map<uint32_t, gpu_metrics_server_t*> metrics_servers;
+    uint32_t next_metrics_server_id = 1;
+    
+    // Shared-memory segments this environment publishes, by name
+    std::map<std::string, gpu_shm_t*> shared_segments;
+    Napi::FunctionReference shared_segment_class;
+    
+    // Running startCollectorServer() servers by id
+    std::map<uint32_t, gpu_collector_server_t*> collector_servers;
+    uint32_t next_collector_server_id = 1;
+    
+    // connect() clients and their watch() subscriptions by id
+    Napi::FunctionReference collector_client_class;
+    std::vector<std::weak_ptr<RemoteConnection>> remote_connections;
+    std::map<uint32_t, std::weak_ptr<RemoteConnection>> remote_watches;
+    uint32_t next_remote_watch_id = 1;
+    
+    // openStore() stores
+    Napi::FunctionReference store_class;
+    std::vector<std::weak_ptr<StoreHandle>> stores;
+    
+    // getProcesses() scanner and the /proc it reads; keeps the counters of
+    // the previous call for the utilization deltas
+    gpu_process_scanner_t* process_scanner = nullptr;
+    std::string process_root;
+    
+    ~AddonData() {
+        gpu_prometheus_destroy(prometheus);
+        gpu_process_scanner_close(process_scanner);
+    }
+};
+
+static AddonData* GetAddonData(Napi::Env env) {
+    return env.GetInstanceData<AddonData>();
+}
+
+static void AcquireBackend(AddonData* data) {
+    if (!data->backend_ref && gpu_info_init() == GPU_SUCCESS) {
+        data->backend_ref = true;
+    }
+}
+
+static void ReleaseBackend(AddonData* data) {
+    if (data->backend_ref) {
+        data->backend_ref = false;
+        gpu_info_cleanup();
+    }
+}
+
+// Environments currently holding a reference on the sampler; the last one to
+// let go stops it
+static std::mutex g_sampler_users_mutex;
+static int32_t g_sampler_users = 0;
+
+static void ReleaseSampler(AddonData* data) {
+    std::lock_guard<std::mutex> lock(g_sampler_users_mutex);
+    if (data->sampler_ref) {
+        data->sampler_ref = false;
+        if (--g_sampler_users == 0) {
+            gpu_aggregate_reset();
+            gpu_sampler_stop();
+        }
+    }
+}
+
+// Environments currently using the compressed history, as for the sampler
+static std::mutex g_history_users_mutex;
+static int32_t g_history_users = 0;
+
+static void ReleaseHistory(AddonData* data) {
+    std::lock_guard<std::mutex> lock(g_history_users_mutex);
+    if (data->history_ref) {
+        data->history_ref = false;
+        if (--g_history_users == 0) {
+            gpu_history_stop();
+        }
+    }
+}
+
 /**
  * Node.js binding: initialize()
  * Initialize the GPU information library
  */
 Napi::Value Initialize(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
+    AddonData* data = GetAddonData(env);
     
-    gpu_error_t result = gpu_info_init();
+    AcquireBackend(data);
     
-    if (result != GPU_SUCCESS) {
+    if (!data->backend_ref) {
         Napi::Error::New(env, "Failed to initialize GPU library")
             .ThrowAsJavaScriptException();
         return env.Null();
@@ -73,15 +454,25 @@ Napi::Value Initialize(const Napi::CallbackInfo& info) {
 
 /**
  * Node.js binding: cleanup()
- * Cleanup the GPU information library
+ * Release this environment's reference on the GPU library; drivers are
+ * unloaded once no environment holds one
  */
 Napi::Value Cleanup(const Napi::CallbackInfo& info) {
+    ReleaseBackend(GetAddonData(info.Env()));
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+/**
+ * Node.js binding: refresh()
+ * Re-enumerate GPUs (e.g. after a hotplug or driver reload)
+ */
+Napi::Value Refresh(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    gpu_error_t result = gpu_info_cleanup();
+    gpu_error_t result = gpu_refresh();
     
     if (result != GPU_SUCCESS) {
-        Napi::Error::New(env, "Failed to cleanup GPU library")
+        Napi::Error::New(env, "Failed to refresh GPU list")
             .ThrowAsJavaScriptException();
         return env.Null();
     }
@@ -112,7 +503,7 @@ Napi::Value GetGpuCount(const Napi::CallbackInfo& info) {
 }
 
 /**
- * Node.js binding: getGpuInfo(index)
+ * Node.js binding: getGpuInfo(index, [fields])
  * Get information about a specific GPU by index
  */
 Napi::Value GetGpuInfo(const Napi::CallbackInfo& info) {
@@ -127,8 +518,13 @@ Napi::Value GetGpuInfo(const Napi::CallbackInfo& info) {
     
     int32_t index = info[0].As<Napi::Number>().Int32Value();
     
+    gpu_field_mask_t fields;
+    if (!ParseFieldMask(env, info[1], &fields)) {
+        return env.Null();
+    }
+    
     gpu_info_t gpu_info;
-    gpu_error_t result = gpu_get_info(index, &gpu_info);
+    gpu_error_t result = gpu_get_info_fields(index, fields, &gpu_info);
     
     if (result != GPU_SUCCESS) {
         std::string error_msg = "Failed to get GPU info for index " + std::to_string(index);
@@ -137,55 +533,2442 @@ Napi::Value GetGpuInfo(const Napi::CallbackInfo& info) {
         return env.Null();
     }
     
-    return GpuInfoToObject(env, gpu_info);
+    return GpuInfoToObject(env, gpu_info, fields);
 }
 
 /**
- * Node.js binding: getAllGpuInfo()
+ * Node.js binding: getAllGpuInfo([fields])
  * Get information about all GPUs in the system
  */
 Napi::Value GetAllGpuInfo(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    // Get GPU count
-    int32_t count = 0;
-    gpu_error_t result = gpu_get_count(&count);
+    gpu_field_mask_t fields;
+    if (!ParseFieldMask(env, info[0], &fields)) {
+        return env.Null();
+    }
+    
+    // Devices are collected in parallel, each with its own timestamp
+    InfoBatch batch;
+    CollectAll(fields, &batch);
+    
+    return BatchToArray(env, batch, fields);
+}
+
+/**
+ * Async worker for getGpuInfoAsync()/getAllGpuInfoAsync()
+ * Collects gpu_info_t on the libuv thread pool so slow or wedged drivers
+ * never block the event loop; JS objects are only built in OnOK()
+ */
+class GpuInfoWorker : public Napi::AsyncWorker {
+public:
+    // index < 0 collects every GPU
+    GpuInfoWorker(Napi::Env env, int32_t index, gpu_field_mask_t fields)
+        : Napi::AsyncWorker(env, "gpuInfoWorker"),
+          index_(index),
+          fields_(fields),
+          deferred_(Napi::Promise::Deferred::New(env)) {}
+    
+    Napi::Promise GetPromise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        if (index_ >= 0) {
+            gpu_info_t gpu_info;
+            if (gpu_get_info_fields(index_, fields_, &gpu_info) != GPU_SUCCESS) {
+                SetError("Failed to get GPU info for index " + std::to_string(index_));
+                return;
+            }
+            batch_.infos.push_back(gpu_info);
+            return;
+        }
+        
+        CollectAll(fields_, &batch_);
+    }
+    
+    void OnOK() override {
+        Napi::Env env = Env();
+        
+        if (index_ >= 0) {
+            deferred_.Resolve(GpuInfoToObject(env, batch_.infos[0], fields_));
+            return;
+        }
+        
+        deferred_.Resolve(BatchToArray(env, batch_, fields_));
+    }
+    
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    int32_t index_;
+    gpu_field_mask_t fields_;
+    InfoBatch batch_;
+    Napi::Promise::Deferred deferred_;
+};
+
+/**
+ * Node.js binding: getGpuInfoAsync(index, [fields])
+ * Promise-returning variant of getGpuInfo()
+ */
+Napi::Value GetGpuInfoAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected GPU index as number")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    int32_t index = info[0].As<Napi::Number>().Int32Value();
+    if (index < 0) {
+        Napi::RangeError::New(env, "GPU index must be non-negative")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    gpu_field_mask_t fields;
+    if (!ParseFieldMask(env, info[1], &fields)) {
+        return env.Null();
+    }
     
-    if (result != GPU_SUCCESS || count == 0) {
+    GpuInfoWorker* worker = new GpuInfoWorker(env, index, fields);
+    Napi::Promise promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+}
+
+/**
+ * Node.js binding: getAllGpuInfoAsync([fields])
+ * Promise-returning variant of getAllGpuInfo()
+ */
+Napi::Value GetAllGpuInfoAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    gpu_field_mask_t fields;
+    if (!ParseFieldMask(env, info[0], &fields)) {
+        return env.Null();
+    }
+    
+    GpuInfoWorker* worker = new GpuInfoWorker(env, -1, fields);
+    Napi::Promise promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+}
+
+/**
+ * Convert gpu_device_desc_t struct to JavaScript object
+ */
+Napi::Object DescToObject(Napi::Env env, const gpu_device_desc_t& desc) {
+    gpu_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.index = desc.index;
+    info.vendor = desc.vendor;
+    memcpy(info.name, desc.name, sizeof(info.name));
+    memcpy(info.uuid, desc.uuid, sizeof(info.uuid));
+    memcpy(info.pci_bus_id, desc.pci_bus_id, sizeof(info.pci_bus_id));
+    info.memory_total = desc.memory_total;
+    
+    return GpuInfoToObject(env, info, GPU_FIELD_STATIC);
+}
+
+/**
+ * Convert gpu_sample_t struct to JavaScript object (numbers only)
+ */
+Napi::Object SampleToObject(Napi::Env env, const gpu_sample_t& sample) {
+    Napi::Object obj = Napi::Object::New(env);
+    
+    obj.Set("index", Napi::Number::New(env, sample.index));
+    obj.Set("timestamp", Napi::Number::New(env, static_cast<double>(sample.timestamp_ms)));
+    obj.Set("memoryUsed", Napi::Number::New(env, static_cast<double>(sample.memory_used)));
+    obj.Set("memoryFree", Napi::Number::New(env, static_cast<double>(sample.memory_free)));
+    obj.Set("gpuUtilization", Napi::Number::New(env, sample.gpu_utilization));
+    obj.Set("memoryUtilization", Napi::Number::New(env, sample.memory_utilization));
+    obj.Set("temperature", Napi::Number::New(env, sample.temperature));
+    obj.Set("powerUsage", Napi::Number::New(env, sample.power_usage));
+    obj.Set("coreClock", Napi::Number::New(env, sample.core_clock));
+    obj.Set("memoryClock", Napi::Number::New(env, sample.memory_clock));
+    obj.Set("fanSpeed", Napi::Number::New(env, sample.fan_speed));
+    
+    return obj;
+}
+
+/**
+ * Node.js binding: getGpuDescriptors()
+ * Static description of every GPU (name, UUID, PCI bus ID, total memory)
+ */
+Napi::Value GetGpuDescriptors(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    int32_t count = 0;
+    if (gpu_get_count(&count) != GPU_SUCCESS || count == 0) {
         return Napi::Array::New(env, 0);
     }
     
-    // Create array to hold all GPU info
-    Napi::Array gpuArray = Napi::Array::New(env, count);
+    Napi::Array descArray = Napi::Array::New(env, count);
+    for (int32_t i = 0; i < count; i++) {
+        gpu_device_desc_t desc;
+        if (gpu_get_desc(i, &desc) == GPU_SUCCESS) {
+            descArray.Set(static_cast<uint32_t>(i), DescToObject(env, desc));
+        } else {
+            descArray.Set(static_cast<uint32_t>(i), env.Null());
+        }
+    }
+    
+    return descArray;
+}
+
+/**
+ * Convert one gpu_process_t to a JS object
+ */
+static Napi::Object ProcessToObject(Napi::Env env, const gpu_process_t& process) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("pid", Napi::Number::New(env, process.pid));
+    obj.Set("name", Napi::String::New(env, process.name));
+    obj.Set("device", process.device >= 0 ? Napi::Number::New(env, process.device) : env.Null());
+    obj.Set("driver", Napi::String::New(env, process.driver));
+    obj.Set("pciBusId", process.pdev[0] ? Napi::String::New(env, process.pdev) : env.Null());
+    obj.Set("clients", Napi::Number::New(env, process.clients));
+    
+    Napi::Object engines = Napi::Object::New(env);
+    for (uint32_t i = 0; i < process.engine_count; i++) {
+        const gpu_process_engine_t& engine = process.engines[i];
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set(engine.cycles ? "busyCycles" : "busyNs",
+                  Napi::Number::New(env, static_cast<double>(engine.busy)));
+        entry.Set("capacity", Napi::Number::New(env, engine.capacity));
+        entry.Set("utilization", engine.utilization >= 0
+                  ? Napi::Number::New(env, engine.utilization) : env.Null());
+        engines.Set(engine.name, entry);
+    }
+    obj.Set("engines", engines);
+    
+    Napi::Object memory = Napi::Object::New(env);
+    for (uint32_t i = 0; i < process.region_count; i++) {
+        const gpu_process_region_t& region = process.regions[i];
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("total", Napi::Number::New(env, static_cast<double>(region.total_bytes)));
+        entry.Set("resident", Napi::Number::New(env, static_cast<double>(region.resident_bytes)));
+        memory.Set(region.name, entry);
+    }
+    obj.Set("memory", memory);
+    
+    return obj;
+}
+
+/**
+ * Node.js binding: getProcesses([{ procRoot }])
+ * Processes using a GPU, from DRM fdinfo (Linux). Engine utilization is
+ * measured since the previous call with the same procRoot.
+ */
+Napi::Value GetProcesses(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    AddonData* data = GetAddonData(env);
+    
+    std::string root = "/proc";
+    if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNull()) {
+        if (!info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected options object")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Value value = info[0].As<Napi::Object>().Get("procRoot");
+        if (!value.IsUndefined()) {
+            if (!value.IsString()) {
+                Napi::TypeError::New(env, "procRoot must be a string")
+                    .ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            root = value.As<Napi::String>().Utf8Value();
+        }
+    }
+    
+    // Another root starts over without a baseline
+    if (!data->process_scanner || data->process_root != root) {
+        gpu_process_scanner_close(data->process_scanner);
+        data->process_scanner = nullptr;
+        gpu_error_t result = gpu_process_scanner_open(root.c_str(), &data->process_scanner);
+        if (result != GPU_SUCCESS) {
+            std::string error_msg = result == GPU_ERROR_NOT_SUPPORTED
+                ? "Process listing is only supported on Linux"
+                : "Failed to open " + root;
+            Napi::Error::New(env, error_msg)
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        data->process_root = root;
+    }
+    
+    const gpu_process_t* processes = nullptr;
+    int32_t count = 0;
+    if (gpu_process_scan(data->process_scanner, &processes, &count) != GPU_SUCCESS) {
+        Napi::Error::New(env, "Failed to scan " + root)
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
     
-    // Get info for each GPU
+    Napi::Array result = Napi::Array::New(env, count);
     for (int32_t i = 0; i < count; i++) {
-        gpu_info_t gpu_info;
-        result = gpu_get_info(i, &gpu_info);
+        result.Set(static_cast<uint32_t>(i), ProcessToObject(env, processes[i]));
+    }
+    return result;
+}
 
-        if (result == GPU_SUCCESS) {
-            gpuArray.Set(static_cast<uint32_t>(i), GpuInfoToObject(env, gpu_info));
+/**
+ * Node.js binding: sample([index])
+ * Dynamic telemetry only, for one GPU or all of them
+ */
+Napi::Value Sample(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() > 0 && info[0].IsNumber()) {
+        int32_t index = info[0].As<Napi::Number>().Int32Value();
+        
+        gpu_sample_t sample;
+        gpu_error_t result = gpu_sample(index, &sample);
+        if (result != GPU_SUCCESS) {
+            std::string error_msg = "Failed to sample GPU " + std::to_string(index);
+            Napi::Error::New(env, error_msg)
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        return SampleToObject(env, sample);
+    }
+    
+    gpu_sample_t samples[GPU_MAX_DEVICES];
+    bool valid[GPU_MAX_DEVICES];
+    int32_t count = 0;
+    if (gpu_collect_samples(samples, valid, GPU_MAX_DEVICES, &count) != GPU_SUCCESS) {
+        return Napi::Array::New(env, 0);
+    }
+    
+    Napi::Array sampleArray = Napi::Array::New(env, count);
+    for (int32_t i = 0; i < count; i++) {
+        if (valid[i]) {
+            sampleArray.Set(static_cast<uint32_t>(i), SampleToObject(env, samples[i]));
         } else {
-            gpuArray.Set(static_cast<uint32_t>(i), env.Null());
+            sampleArray.Set(static_cast<uint32_t>(i), env.Null());
         }
     }
     
-    return gpuArray;
+    return sampleArray;
 }
 
 /**
- * Initialize the Node.js addon
+ * JS names of the sample table columns, indexed by gpu_column_t
  */
-Napi::Object Init(Napi::Env env, Napi::Object exports) {
-    // Auto-initialize on module load
-    gpu_info_init();
+static const char* const kSampleColumns[GPU_COLUMN_COUNT] = {
+    "timestamp",
+    "memoryUsed",
+    "memoryFree",
+    "gpuUtilization",
+    "memoryUtilization",
+    "temperature",
+    "powerUsage",
+    "coreClock",
+    "memoryClock",
+    "fanSpeed",
+};
+
+/**
+ * Resolve a Float64Array or ArrayBuffer argument to a writable double span
+ */
+bool GetFloat64Span(const Napi::Value& value, double** data, size_t* length) {
+    if (value.IsTypedArray()) {
+        Napi::TypedArray array = value.As<Napi::TypedArray>();
+        if (array.TypedArrayType() != napi_float64_array) {
+            return false;
+        }
+        Napi::Float64Array doubles = value.As<Napi::Float64Array>();
+        *data = doubles.Data();
+        *length = doubles.ElementLength();
+        return true;
+    }
     
-    // Export functions
-    exports.Set("initialize", Napi::Function::New(env, Initialize));
-    exports.Set("cleanup", Napi::Function::New(env, Cleanup));
-    exports.Set("getGpuCount", Napi::Function::New(env, GetGpuCount));
-    exports.Set("getGpuInfo", Napi::Function::New(env, GetGpuInfo));
-    exports.Set("getAllGpuInfo", Napi::Function::New(env, GetAllGpuInfo));
+    if (value.IsArrayBuffer()) {
+        Napi::ArrayBuffer buffer = value.As<Napi::ArrayBuffer>();
+        *data = static_cast<double*>(buffer.Data());
+        *length = buffer.ByteLength() / sizeof(double);
+        return true;
+    }
+    
+    return false;
+}
+
+/**
+ * Node.js binding: sampleInto(buffer)
+ * Writes the dynamic metrics of every GPU into a caller-owned Float64Array
+ * (or ArrayBuffer) as a struct of arrays: column c of GPU i is at
+ * c * count + i, with columns numbered as in sampleColumns. Metrics of GPUs
+ * that failed to sample are NaN. Returns count; allocates no JS objects.
+ */
+Napi::Value SampleInto(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    double* data = nullptr;
+    size_t length = 0;
+    if (info.Length() < 1 || !GetFloat64Span(info[0], &data, &length)) {
+        Napi::TypeError::New(env, "Expected Float64Array or ArrayBuffer")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    int32_t count = 0;
+    if (gpu_get_count(&count) != GPU_SUCCESS) {
+        count = 0;
+    }
+    
+    if (length < static_cast<size_t>(count) * GPU_COLUMN_COUNT) {
+        std::string error_msg = "Buffer too small: need " +
+            std::to_string(static_cast<size_t>(count) * GPU_COLUMN_COUNT) + " doubles";
+        Napi::RangeError::New(env, error_msg)
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    gpu_sample_t samples[GPU_MAX_DEVICES];
+    bool valid[GPU_MAX_DEVICES];
+    int32_t collected = 0;
+    gpu_collect_samples(samples, valid, count, &collected);
+    
+    for (int32_t i = 0; i < count; i++) {
+        bool ok = i < collected && valid[i];
+        
+        for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+            data[static_cast<size_t>(c) * count + i] =
+                ok ? gpu_sample_column(&samples[i], static_cast<gpu_column_t>(c))
+                   : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    
+    return Napi::Number::New(env, count);
+}
+
+/**
+ * Node.js binding: startSampler({ intervalMs, historySize })
+ * Start the background sampler thread (restarts it if already running)
+ * The sampler is shared by every environment in the process
+ */
+Napi::Value StartSampler(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    uint32_t interval_ms = 1000;
+    uint32_t history_size = 60;
+    
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Get("intervalMs").IsNumber()) {
+            interval_ms = options.Get("intervalMs").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Get("historySize").IsNumber()) {
+            history_size = options.Get("historySize").As<Napi::Number>().Uint32Value();
+        }
+    }
+    
+    if (interval_ms == 0 || history_size == 0) {
+        Napi::RangeError::New(env, "intervalMs and historySize must be positive")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    AddonData* data = GetAddonData(env);
+    gpu_error_t result;
+    {
+        std::lock_guard<std::mutex> lock(g_sampler_users_mutex);
+        result = gpu_sampler_start(interval_ms, history_size);
+        if (result == GPU_SUCCESS && !data->sampler_ref) {
+            data->sampler_ref = true;
+            g_sampler_users++;
+        }
+    }
+    
+    if (result != GPU_SUCCESS) {
+        std::string error_msg = std::string("Failed to start sampler: ") + gpu_error_string(result);
+        Napi::Error::New(env, error_msg)
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return Napi::Boolean::New(env, true);
+}
+
+/**
+ * Node.js binding: stopSampler()
+ * Release this environment's use of the sampler; it stops (and drops its
+ * history) once no environment is using it
+ */
+Napi::Value StopSampler(const Napi::CallbackInfo& info) {
+    ReleaseSampler(GetAddonData(info.Env()));
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+static void WriteSnapshot(const gpu_sample_t* samples, const bool* valid, int32_t count, void* ctx) {
+    gpu_snapshot_write(static_cast<gpu_snapshot_writer_t*>(ctx), samples, valid, count);
+}
+
+static void StopPublishing(AddonData* data) {
+    if (!data->snapshot) {
+        return;
+    }
+    
+    // Waits for an in-flight write, so the buffer can be released afterwards
+    gpu_sampler_remove_listener(WriteSnapshot, &data->snapshot->writer);
+    delete data->snapshot;
+    data->snapshot = nullptr;
+}
+
+/**
+ * Node.js binding: publishSnapshot(typedArray)
+ * Have the sampler write every tick into the typed array's buffer (normally
+ * a SharedArrayBuffer) using the gpu_snapshot.h layout; replaces any previous
+ * target. Returns the number of GPU slots.
+ */
+Napi::Value PublishSnapshot(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected a typed array over a SharedArrayBuffer")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    // napi_get_typedarray_info also works for views over SharedArrayBuffers,
+    // which Napi::ArrayBuffer does not accept
+    napi_typedarray_type type;
+    size_t length = 0;
+    void* data = nullptr;
+    napi_value arraybuffer;
+    size_t byte_offset = 0;
+    if (napi_get_typedarray_info(env, info[0], &type, &length, &data, &arraybuffer, &byte_offset) != napi_ok) {
+        Napi::Error::New(env, "Failed to access typed array")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    // Detach the previous target first so there is never a second writer
+    AddonData* addon = GetAddonData(env);
+    StopPublishing(addon);
+    
+    size_t size = length * info[0].As<Napi::TypedArray>().ElementSize();
+    SnapshotPublication* publication = new SnapshotPublication();
+    if (gpu_snapshot_init(&publication->writer, data, size) != GPU_SUCCESS) {
+        delete publication;
+        Napi::RangeError::New(env, "Snapshot buffer is too small or not 8-byte aligned")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    publication->array = Napi::Persistent(info[0].As<Napi::Object>());
+    
+    if (gpu_sampler_add_listener(WriteSnapshot, &publication->writer) != GPU_SUCCESS) {
+        delete publication;
+        Napi::Error::New(env, "Too many sampler listeners")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    addon->snapshot = publication;
+    
+    return Napi::Number::New(env, publication->writer.capacity);
+}
+
+/**
+ * Node.js binding: unpublishSnapshot()
+ * Stop writing into the published snapshot buffer
+ */
+Napi::Value UnpublishSnapshot(const Napi::CallbackInfo& info) {
+    StopPublishing(GetAddonData(info.Env()));
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+static void StopSharingSegment(AddonData* data, const std::string& name) {
+    auto it = data->shared_segments.find(name);
+    if (it == data->shared_segments.end()) {
+        return;
+    }
+    
+    // Waits for an in-flight write, so the segment can be unmapped afterwards
+    gpu_sampler_remove_listener(gpu_shm_write, it->second);
+    gpu_shm_destroy(it->second);
+    data->shared_segments.erase(it);
+}
+
+static void StopSharingAll(AddonData* data) {
+    while (!data->shared_segments.empty()) {
+        StopSharingSegment(data, data->shared_segments.begin()->first);
+    }
+}
+
+/**
+ * Node.js binding: publishShared(name, [capacity])
+ * Have the sampler write every tick into the named POSIX shared-memory
+ * segment (gpu_shm.h layout) so other processes can attachShared() it;
+ * replaces a segment of the same name. Returns the number of GPU slots.
+ */
+Napi::Value PublishShared(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected segment name")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    std::string name = info[0].As<Napi::String>().Utf8Value();
+    
+    int32_t capacity = 0;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        capacity = info[1].As<Napi::Number>().Int32Value();
+    } else if (gpu_get_count(&capacity) != GPU_SUCCESS || capacity < 1) {
+        capacity = 1;
+    }
+    
+    AddonData* data = GetAddonData(env);
+    StopSharingSegment(data, name);
+    
+    gpu_shm_t* shm = nullptr;
+    gpu_error_t result = gpu_shm_create(name.c_str(), capacity, &shm);
+    if (result != GPU_SUCCESS) {
+        std::string error_msg = "Failed to create shared segment " + name + ": " + gpu_error_string(result);
+        Napi::Error::New(env, error_msg).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (gpu_sampler_add_listener(gpu_shm_write, shm) != GPU_SUCCESS) {
+        gpu_shm_destroy(shm);
+        Napi::Error::New(env, "Too many sampler listeners")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    data->shared_segments[name] = shm;
+    
+    return Napi::Number::New(env, gpu_shm_capacity(shm));
+}
+
+/**
+ * Node.js binding: unpublishShared(name)
+ * Stop publishing; the segment is marked closed and its name unlinked
+ */
+Napi::Value UnpublishShared(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected segment name")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    AddonData* data = GetAddonData(env);
+    std::string name = info[0].As<Napi::String>().Utf8Value();
+    bool found = data->shared_segments.count(name) > 0;
+    StopSharingSegment(data, name);
+    return Napi::Boolean::New(env, found);
+}
+
+/**
+ * Read-only view of a segment published by another process
+ * Reads never call into the C core's backends, so a process that only
+ * attaches never loads a GPU driver.
+ */
+class SharedSegment : public Napi::ObjectWrap<SharedSegment> {
+public:
+    static Napi::Function DefineClass(Napi::Env env) {
+        return Napi::ObjectWrap<SharedSegment>::DefineClass(env, "SharedSegment", {
+            InstanceMethod("read", &SharedSegment::Read),
+            InstanceMethod("readInto", &SharedSegment::ReadInto),
+            InstanceMethod("close", &SharedSegment::Close),
+            InstanceAccessor("capacity", &SharedSegment::Capacity, nullptr),
+            InstanceAccessor("publisherPid", &SharedSegment::PublisherPid, nullptr),
+            InstanceAccessor("closed", &SharedSegment::Closed, nullptr),
+        });
+    }
+    
+    SharedSegment(const Napi::CallbackInfo& info) : Napi::ObjectWrap<SharedSegment>(info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected segment name")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        
+        std::string name = info[0].As<Napi::String>().Utf8Value();
+        gpu_error_t result = gpu_shm_attach(name.c_str(), &reader_);
+        if (result != GPU_SUCCESS) {
+            std::string error_msg = result == GPU_ERROR_NO_GPU
+                ? "No shared GPU segment named " + name
+                : "Failed to attach shared segment " + name + ": " + gpu_error_string(result);
+            Napi::Error::New(env, error_msg).ThrowAsJavaScriptException();
+            return;
+        }
+        
+        data_.resize(static_cast<size_t>(gpu_shm_reader_capacity(reader_)) * GPU_COLUMN_COUNT);
+        descs_.resize(static_cast<size_t>(gpu_shm_reader_capacity(reader_)));
+    }
+    
+    ~SharedSegment() { gpu_shm_detach(reader_); }
+
+private:
+    static const uint32_t kMaxRetries = 100;
+    
+    bool CheckOpen(Napi::Env env) {
+        if (!reader_) {
+            Napi::Error::New(env, "Shared segment is closed")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+    
+    // read(): GPUs with descriptor and latest sample, or null if no
+    // consistent copy could be taken
+    Napi::Value Read(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckOpen(env)) {
+            return env.Null();
+        }
+        
+        int32_t count = 0;
+        if (gpu_shm_read(reader_, data_.data(), descs_.data(), &count, kMaxRetries) != GPU_SUCCESS) {
+            return env.Null();
+        }
+        
+        size_t capacity = descs_.size();
+        Napi::Array gpus = Napi::Array::New(env, count);
+        for (int32_t i = 0; i < count; i++) {
+            Napi::Object gpu = DescToObject(env, descs_[i]);
+            for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+                gpu.Set(kSampleColumns[c], Napi::Number::New(env, data_[c * capacity + i]));
+            }
+            gpus.Set(static_cast<uint32_t>(i), gpu);
+        }
+        return gpus;
+    }
+    
+    // readInto(out): copy the data block (createSharedSnapshot() layout) into
+    // a Float64Array; returns the GPU count, or -1 as readSnapshot() does
+    Napi::Value ReadInto(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckOpen(env)) {
+            return env.Null();
+        }
+        
+        double* out = nullptr;
+        size_t length = 0;
+        if (info.Length() < 1 || !GetFloat64Span(info[0], &out, &length)) {
+            Napi::TypeError::New(env, "Expected Float64Array or ArrayBuffer")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (length < data_.size()) {
+            Napi::RangeError::New(env, "Buffer must hold capacity * sampleColumnCount doubles")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        int32_t count = 0;
+        if (gpu_shm_read(reader_, out, nullptr, &count, kMaxRetries) != GPU_SUCCESS) {
+            return Napi::Number::New(env, -1);
+        }
+        return Napi::Number::New(env, count);
+    }
+    
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        gpu_shm_detach(reader_);
+        reader_ = nullptr;
+        return info.Env().Undefined();
+    }
+    
+    Napi::Value Capacity(const Napi::CallbackInfo& info) {
+        return Napi::Number::New(info.Env(), gpu_shm_reader_capacity(reader_));
+    }
+    
+    Napi::Value PublisherPid(const Napi::CallbackInfo& info) {
+        return Napi::Number::New(info.Env(), gpu_shm_reader_pid(reader_));
+    }
+    
+    // True once the publisher has stopped (or this view was closed)
+    Napi::Value Closed(const Napi::CallbackInfo& info) {
+        return Napi::Boolean::New(info.Env(), gpu_shm_reader_closed(reader_));
+    }
+    
+    gpu_shm_reader_t* reader_ = nullptr;
+    std::vector<double> data_;
+    std::vector<gpu_device_desc_t> descs_;
+};
+
+/**
+ * Node.js binding: attachShared(name)
+ * Map a segment published with publishShared() (in any process) read-only
+ */
+Napi::Value AttachShared(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected segment name")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Object segment = GetAddonData(env)->shared_segment_class.Value().New({ info[0] });
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+    return segment;
+}
+
+/**
+ * Latest sample of every GPU: from the background sampler when it is running,
+ * otherwise collected now
+ */
+static void CollectLatestSamples(gpu_sample_t* samples, bool* valid, int32_t* count) {
+    if (gpu_sampler_latest_all(samples, valid, GPU_MAX_DEVICES, count) == GPU_SUCCESS) {
+        return;
+    }
+    if (gpu_collect_samples(samples, valid, GPU_MAX_DEVICES, count) != GPU_SUCCESS) {
+        *count = 0;
+    }
+}
+
+/**
+ * Prometheus options shared by renderPrometheus() and serveMetrics()
+ */
+struct PrometheusOptions {
+    std::string prefix = "gpu";
+    bool openmetrics = false;
+    std::vector<std::string> label_names;
+    std::vector<std::string> label_values;
+    
+    // Views for gpu_prometheus_options_t; valid while this object is alive
+    std::vector<const char*> names;
+    std::vector<const char*> values;
+    
+    gpu_prometheus_options_t ToNative() {
+        names.clear();
+        values.clear();
+        for (size_t i = 0; i < label_names.size(); i++) {
+            names.push_back(label_names[i].c_str());
+            values.push_back(label_values[i].c_str());
+        }
+        
+        gpu_prometheus_options_t options;
+        options.prefix = prefix.c_str();
+        options.label_names = names.data();
+        options.label_values = values.data();
+        options.label_count = static_cast<int32_t>(names.size());
+        options.openmetrics = openmetrics;
+        return options;
+    }
+};
+
+/**
+ * Read prefix, labels and openMetrics from an options object
+ * Returns false (with a pending exception) if labels is not an object
+ */
+static bool ParsePrometheusOptions(Napi::Env env, Napi::Object options, PrometheusOptions* out) {
+    if (options.Get("prefix").IsString()) {
+        out->prefix = options.Get("prefix").As<Napi::String>().Utf8Value();
+    }
+    if (options.Get("openMetrics").IsBoolean()) {
+        out->openmetrics = options.Get("openMetrics").As<Napi::Boolean>().Value();
+    }
+    
+    Napi::Value labels = options.Get("labels");
+    if (labels.IsObject()) {
+        Napi::Array names = labels.As<Napi::Object>().GetPropertyNames();
+        for (uint32_t i = 0; i < names.Length(); i++) {
+            Napi::Value name = names.Get(i);
+            out->label_names.push_back(name.ToString().Utf8Value());
+            out->label_values.push_back(labels.As<Napi::Object>().Get(name).ToString().Utf8Value());
+        }
+    } else if (!labels.IsUndefined() && !labels.IsNull()) {
+        Napi::TypeError::New(env, "labels must be an object")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Node.js binding: renderPrometheus([{ prefix, labels, openMetrics }])
+ * Render every GPU's metrics as Prometheus text (or OpenMetrics) into a Buffer
+ * The renderer and its escaped per-device labels are kept for the next call
+ * with the same options
+ */
+Napi::Value RenderPrometheus(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    PrometheusOptions parsed;
+    if (info.Length() > 0 && info[0].IsObject() &&
+        !ParsePrometheusOptions(env, info[0].As<Napi::Object>(), &parsed)) {
+        return env.Null();
+    }
+    
+    // Options identify the cached renderer
+    std::string key = parsed.prefix + (parsed.openmetrics ? "\x01" : "\x02");
+    for (size_t i = 0; i < parsed.label_names.size(); i++) {
+        key += parsed.label_names[i] + '\0' + parsed.label_values[i] + '\0';
+    }
+    
+    AddonData* data = GetAddonData(env);
+    if (!data->prometheus || data->prometheus_key != key) {
+        gpu_prometheus_options_t options = parsed.ToNative();
+        gpu_prometheus_t* renderer = gpu_prometheus_create(&options);
+        if (!renderer) {
+            Napi::TypeError::New(env, "Invalid metric prefix or label names")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        gpu_prometheus_destroy(data->prometheus);
+        data->prometheus = renderer;
+        data->prometheus_key = key;
+    }
+    
+    gpu_sample_t samples[GPU_MAX_DEVICES];
+    bool valid[GPU_MAX_DEVICES];
+    int32_t count = 0;
+    CollectLatestSamples(samples, valid, &count);
+    
+    char* text = nullptr;
+    size_t length = 0;
+    if (gpu_prometheus_render(data->prometheus, samples, valid, count, &text, &length) != GPU_SUCCESS) {
+        Napi::Error::New(env, "Failed to render metrics")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    // Hands the rendered text to JS without copying where external buffers
+    // are allowed
+    return Napi::Buffer<char>::NewOrCopy(env, text, length,
+                                         [](Napi::Env, char* data) { free(data); });
+}
+
+static void StopMetricsServers(AddonData* data) {
+    for (auto& entry : data->metrics_servers) {
+        gpu_metrics_server_stop(entry.second);
+    }
+    data->metrics_servers.clear();
+}
+
+/**
+ * stop() handle on the object returned by serveMetrics()
+ */
+Napi::Value StopMetricsServer(const Napi::CallbackInfo& info) {
+    uint32_t id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(info.Data()));
+    AddonData* data = GetAddonData(info.Env());
+    
+    auto it = data->metrics_servers.find(id);
+    if (it == data->metrics_servers.end()) {
+        return Napi::Boolean::New(info.Env(), false);
+    }
+    
+    // Joins the server thread, so no scrape is in progress afterwards
+    gpu_metrics_server_stop(it->second);
+    data->metrics_servers.erase(it);
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+/**
+ * Node.js binding: serveMetrics([{ host, port, path, maxConnections, prefix, labels }])
+ * Serve Prometheus metrics over HTTP from a native thread, independent of the
+ * event loop; returns { host, port, path, stop() }
+ */
+Napi::Value ServeMetrics(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    std::string host = "127.0.0.1";
+    std::string path = "/metrics";
+    uint32_t port = 9400;
+    int32_t max_connections = GPU_METRICS_SERVER_DEFAULT_CONNECTIONS;
+    PrometheusOptions parsed;
+    
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Get("host").IsString()) {
+            host = options.Get("host").As<Napi::String>().Utf8Value();
+        }
+        if (options.Get("path").IsString()) {
+            path = options.Get("path").As<Napi::String>().Utf8Value();
+        }
+        if (options.Get("port").IsNumber()) {
+            port = options.Get("port").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Get("maxConnections").IsNumber()) {
+            max_connections = options.Get("maxConnections").As<Napi::Number>().Int32Value();
+        }
+        if (!ParsePrometheusOptions(env, options, &parsed)) {
+            return env.Null();
+        }
+    }
+    
+    if (port > 65535 || max_connections <= 0 || max_connections > GPU_METRICS_SERVER_MAX_CONNECTIONS) {
+        Napi::RangeError::New(env, "port or maxConnections out of range")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    // The server renders Prometheus text; OpenMetrics is not negotiated
+    parsed.openmetrics = false;
+    
+    gpu_metrics_server_options_t options;
+    options.host = host.c_str();
+    options.port = static_cast<uint16_t>(port);
+    options.path = path.c_str();
+    options.max_connections = max_connections;
+    options.prometheus = parsed.ToNative();
+    
+    gpu_metrics_server_t* server = nullptr;
+    gpu_error_t result = gpu_metrics_server_start(&options, &server);
+    if (result != GPU_SUCCESS) {
+        std::string error_msg = std::string("Failed to start metrics server on ") + host + ":" +
+                                std::to_string(port) + ": " + gpu_error_string(result);
+        Napi::Error::New(env, error_msg).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    AddonData* data = GetAddonData(env);
+    uint32_t id = data->next_metrics_server_id++;
+    data->metrics_servers[id] = server;
+    
+    Napi::Object handle = Napi::Object::New(env);
+    handle.Set("host", Napi::String::New(env, host));
+    handle.Set("port", Napi::Number::New(env, gpu_metrics_server_port(server)));
+    handle.Set("path", Napi::String::New(env, path));
+    handle.Set("stop", Napi::Function::New(env, StopMetricsServer, "stop",
+                                           reinterpret_cast<void*>(static_cast<uintptr_t>(id))));
+    return handle;
+}
+
+static void StopCollectorServers(AddonData* data) {
+    for (auto& entry : data->collector_servers) {
+        gpu_collector_server_stop(entry.second);
+    }
+    data->collector_servers.clear();
+}
+
+/**
+ * stop() handle on the object returned by startCollectorServer()
+ */
+Napi::Value StopCollectorServer(const Napi::CallbackInfo& info) {
+    uint32_t id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(info.Data()));
+    AddonData* data = GetAddonData(info.Env());
+    
+    auto it = data->collector_servers.find(id);
+    if (it == data->collector_servers.end()) {
+        return Napi::Boolean::New(info.Env(), false);
+    }
+    
+    gpu_collector_server_stop(it->second);
+    data->collector_servers.erase(it);
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+/**
+ * Node.js binding: startCollectorServer(socketPath)
+ * Collect for every process that connect()s to socketPath from a native
+ * server thread; returns { path, stop() }
+ */
+Napi::Value StartCollectorServer(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected socket path")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    gpu_collector_server_t* server = nullptr;
+    gpu_error_t result = gpu_collector_server_start(path.c_str(), &server);
+    if (result != GPU_SUCCESS) {
+        std::string error_msg = result == GPU_ERROR_ACCESS_DENIED
+            ? "A collector is already listening on " + path + " (or it is not writable)"
+            : "Failed to start collector on " + path + ": " + gpu_error_string(result);
+        Napi::Error::New(env, error_msg).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    AddonData* data = GetAddonData(env);
+    uint32_t id = data->next_collector_server_id++;
+    data->collector_servers[id] = server;
+    
+    Napi::Object handle = Napi::Object::New(env);
+    handle.Set("path", Napi::String::New(env, path));
+    handle.Set("stop", Napi::Function::New(env, StopCollectorServer, "stop",
+                                           reinterpret_cast<void*>(static_cast<uintptr_t>(id))));
+    return handle;
+}
+
+// Replies slower than this fail the request
+static const uint32_t kRemoteTimeoutMs = 5000;
+
+static gpu_error_t CollectRemote(gpu_collector_client_t* client, gpu_field_mask_t fields,
+                                 InfoBatch* batch) {
+    batch->infos.resize(GPU_MAX_DEVICES);
+    batch->results.resize(GPU_MAX_DEVICES);
+    batch->timestamps_ms.resize(GPU_MAX_DEVICES);
+    
+    int32_t count = 0;
+    gpu_error_t result = gpu_collector_get(client, fields, batch->infos.data(), batch->results.data(),
+                                           batch->timestamps_ms.data(), GPU_MAX_DEVICES, &count,
+                                           kRemoteTimeoutMs);
+    
+    batch->infos.resize(count);
+    batch->results.resize(count);
+    batch->timestamps_ms.resize(count);
+    return result;
+}
+
+/**
+ * Runs on the JS thread for each queued delivery, like DeliverWatchBatch()
+ */
+static void DeliverRemoteBatch(Napi::Env env, Napi::Function callback, RemoteSubscriber* sub) {
+    std::shared_ptr<const InfoBatch> batch;
+    {
+        std::lock_guard<std::mutex> lock(sub->mutex);
+        batch = std::move(sub->pending);
+        sub->queued = false;
+        if (!sub->active) {
+            return;
+        }
+    }
+    
+    if (!batch || env == nullptr || callback.IsEmpty()) {
+        return;
+    }
+    
+    Napi::Array gpuArray = Napi::Array::New(env);
+    uint32_t length = 0;
+    for (size_t i = 0; i < batch->infos.size(); i++) {
+        if (batch->results[i] == GPU_SUCCESS) {
+            gpuArray.Set(length++, BatchEntryToObject(env, *batch, i, sub->fields));
+        }
+    }
+    
+    callback.Call({gpuArray});
+}
+
+/**
+ * gpu_collector_event_t: runs on the client's reader thread
+ */
+static void OnRemoteEvent(uint32_t subscription, gpu_field_mask_t fields, const gpu_info_t* infos,
+                          const gpu_error_t* results, const int64_t* timestamps_ms, int32_t count,
+                          void* ctx) {
+    RemoteConnection* connection = static_cast<RemoteConnection*>(ctx);
+    (void)fields;
+    
+    auto batch = std::make_shared<InfoBatch>();
+    batch->infos.assign(infos, infos + count);
+    batch->results.assign(results, results + count);
+    batch->timestamps_ms.assign(timestamps_ms, timestamps_ms + count);
+    
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    auto it = connection->subscribers.find(subscription);
+    if (it == connection->subscribers.end()) {
+        return;
+    }
+    
+    // Coalesce like watch(): a slow JS thread only ever sees the newest batch
+    RemoteSubscriber* sub = it->second;
+    std::lock_guard<std::mutex> sub_lock(sub->mutex);
+    sub->pending = batch;
+    if (!sub->queued) {
+        sub->queued = sub->tsfn.NonBlockingCall(sub, DeliverRemoteBatch) == napi_ok;
+    }
+}
+
+/**
+ * Remove a watcher; returns false if it was already gone. JS thread only.
+ */
+static bool UnwatchRemote(RemoteConnection* connection, uint32_t id) {
+    RemoteSubscriber* sub = nullptr;
+    bool last = false;
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        auto it = connection->subscribers.find(id);
+        if (it == connection->subscribers.end()) {
+            return false;
+        }
+        sub = it->second;
+        connection->subscribers.erase(it);
+        last = connection->subscribers.empty();
+    }
+    
+    gpu_collector_unsubscribe(connection->client, id);
+    {
+        std::lock_guard<std::mutex> lock(sub->mutex);
+        sub->active = false;
+    }
+    
+    // The reader thread can no longer reach sub; the finalizer frees it
+    sub->tsfn.Release();
+    if (last) {
+        connection->self.Reset();
+    }
+    return true;
+}
+
+/**
+ * Close the socket and drop every watcher. JS thread only.
+ */
+static void CloseRemote(RemoteConnection* connection) {
+    // Joins the reader thread, so no event is delivered afterwards
+    gpu_collector_close(connection->client);
+    
+    std::map<uint32_t, RemoteSubscriber*> subs;
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        subs.swap(connection->subscribers);
+    }
+    for (auto& entry : subs) {
+        {
+            std::lock_guard<std::mutex> lock(entry.second->mutex);
+            entry.second->active = false;
+        }
+        entry.second->tsfn.Release();
+    }
+    connection->self.Reset();
+}
+
+static void CloseRemoteConnections(AddonData* data) {
+    for (auto& weak : data->remote_connections) {
+        if (std::shared_ptr<RemoteConnection> connection = weak.lock()) {
+            CloseRemote(connection.get());
+        }
+    }
+    data->remote_connections.clear();
+    data->remote_watches.clear();
+}
+
+/**
+ * unsubscribe() handle returned by CollectorClient.watch()
+ */
+Napi::Value UnsubscribeRemote(const Napi::CallbackInfo& info) {
+    uint32_t id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(info.Data()));
+    AddonData* data = GetAddonData(info.Env());
+    
+    auto it = data->remote_watches.find(id);
+    if (it == data->remote_watches.end()) {
+        return Napi::Boolean::New(info.Env(), false);
+    }
+    
+    std::shared_ptr<RemoteConnection> connection = it->second.lock();
+    data->remote_watches.erase(it);
+    return Napi::Boolean::New(info.Env(), connection && UnwatchRemote(connection.get(), id));
+}
+
+/**
+ * Async worker for CollectorClient.getAllGpuInfoAsync()
+ * Waits for the daemon's reply on the libuv thread pool
+ */
+class RemoteInfoWorker : public Napi::AsyncWorker {
+public:
+    RemoteInfoWorker(Napi::Env env, std::shared_ptr<RemoteConnection> connection,
+                     gpu_field_mask_t fields)
+        : Napi::AsyncWorker(env, "gpuRemoteInfoWorker"),
+          connection_(std::move(connection)),
+          fields_(fields),
+          deferred_(Napi::Promise::Deferred::New(env)) {}
+    
+    Napi::Promise GetPromise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        gpu_error_t result = CollectRemote(connection_->client, fields_, &batch_);
+        if (result != GPU_SUCCESS) {
+            SetError(std::string("Collector request failed: ") + gpu_error_string(result));
+        }
+    }
+    
+    void OnOK() override {
+        deferred_.Resolve(BatchToArray(Env(), batch_, fields_));
+    }
+    
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    std::shared_ptr<RemoteConnection> connection_;
+    gpu_field_mask_t fields_;
+    InfoBatch batch_;
+    Napi::Promise::Deferred deferred_;
+};
+
+/**
+ * Client of a collector daemon, returned by connect()
+ * Same getAllGpuInfo()/getAllGpuInfoAsync()/watch() API as the module, served
+ * by the daemon. The connection is re-established automatically if the
+ * daemon restarts; watchers resume and requests fail while it is down.
+ */
+class CollectorClient : public Napi::ObjectWrap<CollectorClient> {
+public:
+    static Napi::Function DefineClass(Napi::Env env) {
+        return Napi::ObjectWrap<CollectorClient>::DefineClass(env, "CollectorClient", {
+            InstanceMethod("getAllGpuInfo", &CollectorClient::GetAllGpuInfo),
+            InstanceMethod("getAllGpuInfoAsync", &CollectorClient::GetAllGpuInfoAsync),
+            InstanceMethod("watch", &CollectorClient::Watch),
+            InstanceMethod("close", &CollectorClient::Close),
+            InstanceAccessor("connected", &CollectorClient::Connected, nullptr),
+        });
+    }
+    
+    CollectorClient(const Napi::CallbackInfo& info) : Napi::ObjectWrap<CollectorClient>(info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected socket path")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        
+        std::string path = info[0].As<Napi::String>().Utf8Value();
+        auto connection = std::make_shared<RemoteConnection>();
+        gpu_error_t result = gpu_collector_connect(path.c_str(), OnRemoteEvent, connection.get(),
+                                                   &connection->client);
+        if (result != GPU_SUCCESS) {
+            std::string error_msg = result == GPU_ERROR_NO_GPU
+                ? "No collector listening on " + path
+                : "Failed to connect to collector on " + path + ": " + gpu_error_string(result);
+            Napi::Error::New(env, error_msg).ThrowAsJavaScriptException();
+            return;
+        }
+        
+        // Let go of connections already released before tracking this one
+        AddonData* data = GetAddonData(env);
+        auto& connections = data->remote_connections;
+        connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                         [](const std::weak_ptr<RemoteConnection>& weak) {
+                                             return weak.expired();
+                                         }),
+                          connections.end());
+        connections.push_back(connection);
+        connection_ = std::move(connection);
+    }
+    
+    ~CollectorClient() {
+        if (connection_) {
+            CloseRemote(connection_.get());
+        }
+    }
+
+private:
+    bool CheckOpen(Napi::Env env) {
+        if (!connection_) {
+            Napi::Error::New(env, "Collector client is closed")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+    
+    // getAllGpuInfo([fields]): blocks until the daemon replies
+    Napi::Value GetAllGpuInfo(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        gpu_field_mask_t fields;
+        if (!CheckOpen(env) || !ParseFieldMask(env, info[0], &fields)) {
+            return env.Null();
+        }
+        
+        InfoBatch batch;
+        gpu_error_t result = CollectRemote(connection_->client, fields, &batch);
+        if (result != GPU_SUCCESS) {
+            Napi::Error::New(env, std::string("Collector request failed: ") + gpu_error_string(result))
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return BatchToArray(env, batch, fields);
+    }
+    
+    Napi::Value GetAllGpuInfoAsync(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        gpu_field_mask_t fields;
+        if (!CheckOpen(env) || !ParseFieldMask(env, info[0], &fields)) {
+            return env.Null();
+        }
+        
+        RemoteInfoWorker* worker = new RemoteInfoWorker(env, connection_, fields);
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
+        return promise;
+    }
+    
+    // watch([{ intervalMs, fields }], callback): same contract as the
+    // module's watch(), with the daemon collecting
+    Napi::Value Watch(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckOpen(env)) {
+            return env.Null();
+        }
+        
+        size_t callback_arg = (info.Length() > 0 && info[0].IsFunction()) ? 0 : 1;
+        if (info.Length() <= callback_arg || !info[callback_arg].IsFunction()) {
+            Napi::TypeError::New(env, "Expected callback function")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        uint32_t interval_ms = 1000;
+        gpu_field_mask_t fields = GPU_FIELD_ALL;
+        
+        if (callback_arg == 1 && info[0].IsObject()) {
+            Napi::Object options = info[0].As<Napi::Object>();
+            if (options.Get("intervalMs").IsNumber()) {
+                interval_ms = options.Get("intervalMs").As<Napi::Number>().Uint32Value();
+            }
+            if (!ParseFieldMask(env, options.Get("fields"), &fields)) {
+                return env.Null();
+            }
+        }
+        
+        if (interval_ms == 0) {
+            Napi::RangeError::New(env, "intervalMs must be positive")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        AddonData* data = GetAddonData(env);
+        uint32_t id = data->next_remote_watch_id++;
+        
+        RemoteSubscriber* sub = new RemoteSubscriber();
+        sub->id = id;
+        sub->fields = fields;
+        sub->tsfn = Napi::ThreadSafeFunction::New(
+            env, info[callback_arg].As<Napi::Function>(), "gpuRemoteWatch", 0, 1, sub,
+            [](Napi::Env, RemoteSubscriber* s) { delete s; });
+        
+        {
+            std::lock_guard<std::mutex> lock(connection_->mutex);
+            connection_->subscribers[id] = sub;
+        }
+        
+        gpu_error_t result = gpu_collector_subscribe(connection_->client, id, fields, interval_ms);
+        if (result != GPU_SUCCESS) {
+            UnwatchRemote(connection_.get(), id);
+            std::string error_msg = result == GPU_ERROR_INVALID_PARAM
+                ? "Too many watchers on one collector client"
+                : std::string("Failed to watch collector: ") + gpu_error_string(result);
+            Napi::Error::New(env, error_msg).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        if (connection_->self.IsEmpty()) {
+            connection_->self = Napi::Persistent(info.This().As<Napi::Object>());
+        }
+        data->remote_watches[id] = connection_;
+        
+        return Napi::Function::New(env, UnsubscribeRemote, "unsubscribe",
+                                   reinterpret_cast<void*>(static_cast<uintptr_t>(id)));
+    }
+    
+    // close(): stop every watcher and disconnect; requests in flight fail
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        if (connection_) {
+            CloseRemote(connection_.get());
+            connection_.reset();
+        }
+        return info.Env().Undefined();
+    }
+    
+    Napi::Value Connected(const Napi::CallbackInfo& info) {
+        bool connected = connection_ && gpu_collector_connected(connection_->client);
+        return Napi::Boolean::New(info.Env(), connected);
+    }
+    
+    std::shared_ptr<RemoteConnection> connection_;
+};
+
+/**
+ * Node.js binding: connect(socketPath)
+ * Connect to a collector started with startCollectorServer() in any process
+ */
+Napi::Value Connect(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected socket path")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Object client = GetAddonData(env)->collector_client_class.Value().New({ info[0] });
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+    return client;
+}
+
+/**
+ * Node.js binding: getLatestSample(index)
+ * Most recent sample of a GPU, or null if none has been taken yet
+ */
+Napi::Value GetLatestSample(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected GPU index as number")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    int32_t index = info[0].As<Napi::Number>().Int32Value();
+    
+    gpu_sample_t record;
+    gpu_error_t result = gpu_sampler_latest(index, &record);
+    
+    if (result == GPU_ERROR_NO_GPU) {
+        return env.Null();
+    }
+    if (result != GPU_SUCCESS) {
+        Napi::Error::New(env, "Sampler is not running or index is out of range")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return SampleToObject(env, record);
+}
+
+/**
+ * Node.js binding: getSampleHistory(index, [count])
+ * Up to count most recent samples of a GPU, oldest first
+ */
+Napi::Value GetSampleHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected GPU index as number")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    int32_t index = info[0].As<Napi::Number>().Int32Value();
+    uint32_t max_records = UINT32_MAX;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        max_records = info[1].As<Napi::Number>().Uint32Value();
+    }
+    
+    // Never allocate more than the ring can hold
+    uint32_t history_size = 0;
+    if (gpu_sampler_get_history_size(&history_size) != GPU_SUCCESS) {
+        Napi::Error::New(env, "Sampler is not running")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    std::vector<gpu_sample_t> records(std::min(max_records, history_size));
+    uint32_t count = 0;
+    gpu_error_t result = gpu_sampler_history(index, records.data(),
+                                             static_cast<uint32_t>(records.size()), &count);
+    
+    if (result != GPU_SUCCESS) {
+        Napi::Error::New(env, "Sampler is not running or index is out of range")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Array history = Napi::Array::New(env, count);
+    for (uint32_t i = 0; i < count; i++) {
+        history.Set(i, SampleToObject(env, records[i]));
+    }
+    
+    return history;
+}
+
+/**
+ * Parse startHistory()'s tiers option: [{ bucketMs, retentionMs }, ...].
+ * Throws and returns false if it is not such an array.
+ */
+static bool ParseHistoryTiers(Napi::Env env, const Napi::Value& value,
+                              std::vector<gpu_history_tier_t>* tiers) {
+    if (!value.IsArray() || value.As<Napi::Array>().Length() > GPU_HISTORY_MAX_TIERS) {
+        Napi::TypeError::New(env, "tiers must be an array of at most 8 { bucketMs, retentionMs }")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    Napi::Array array = value.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+        Napi::Value item = array.Get(i);
+        if (!item.IsObject() || !item.As<Napi::Object>().Get("bucketMs").IsNumber() ||
+            !item.As<Napi::Object>().Get("retentionMs").IsNumber()) {
+            Napi::TypeError::New(env, "tiers must be an array of at most 8 { bucketMs, retentionMs }")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        
+        double bucket_ms = item.As<Napi::Object>().Get("bucketMs").As<Napi::Number>().DoubleValue();
+        double retention_ms = item.As<Napi::Object>().Get("retentionMs").As<Napi::Number>().DoubleValue();
+        gpu_history_tier_t tier;
+        tier.bucket_ms = bucket_ms >= 1 && bucket_ms <= UINT32_MAX ? static_cast<uint32_t>(bucket_ms) : 0;
+        tier.retention_ms = retention_ms >= 0 ? static_cast<uint64_t>(std::min(retention_ms, 1e18)) : 0;
+        tiers->push_back(tier);
+    }
+    return true;
+}
+
+/**
+ * Node.js binding: startHistory([{ retentionMs, maxBytes, tiers }])
+ * Record every sampler tick into the compressed long-retention history and
+ * its rollup tiers
+ */
+Napi::Value StartHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    double retention_ms = 24.0 * 60 * 60 * 1000;
+    double max_bytes = 0;
+    bool default_tiers = true;
+    std::vector<gpu_history_tier_t> tiers;
+    
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Get("retentionMs").IsNumber()) {
+            retention_ms = options.Get("retentionMs").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("maxBytes").IsNumber()) {
+            max_bytes = options.Get("maxBytes").As<Napi::Number>().DoubleValue();
+        }
+        Napi::Value tier_list = options.Get("tiers");
+        if (!tier_list.IsUndefined()) {
+            if (!ParseHistoryTiers(env, tier_list, &tiers)) {
+                return env.Null();
+            }
+            default_tiers = false;
+        }
+    }
+    
+    if (!(retention_ms >= 0) || !(max_bytes >= 0)) {
+        Napi::RangeError::New(env, "retentionMs and maxBytes must not be negative")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    AddonData* data = GetAddonData(env);
+    gpu_error_t result;
+    {
+        std::lock_guard<std::mutex> lock(g_history_users_mutex);
+        result = gpu_history_start(static_cast<uint64_t>(std::min(retention_ms, 1e18)),
+                                   static_cast<uint64_t>(std::min(max_bytes, 1e18)),
+                                   tiers.data(),
+                                   default_tiers ? GPU_HISTORY_DEFAULT_TIERS
+                                                 : static_cast<int32_t>(tiers.size()));
+        if (result == GPU_SUCCESS && !data->history_ref) {
+            data->history_ref = true;
+            g_history_users++;
+        }
+    }
+    
+    if (result == GPU_ERROR_INVALID_PARAM) {
+        Napi::RangeError::New(env, "Tier bucketMs must increase, and each retentionMs must cover "
+                                   "between 1 and 4194304 buckets")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (result != GPU_SUCCESS) {
+        std::string error_msg = std::string("Failed to start history: ") + gpu_error_string(result);
+        Napi::Error::New(env, error_msg)
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return Napi::Boolean::New(env, true);
+}
+
+/**
+ * Node.js binding: stopHistory()
+ * Release this environment's use of the history; it is dropped once no
+ * environment is using it
+ */
+Napi::Value StopHistory(const Napi::CallbackInfo& info) {
+    ReleaseHistory(GetAddonData(info.Env()));
+    return Napi::Boolean::New(info.Env(), true);
+}
+
+/**
+ * Node.js binding: getHistoryStats(index)
+ * Size and extent of the recorded history of a GPU
+ */
+Napi::Value GetHistoryStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected GPU index as number")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    gpu_history_stats_t stats;
+    if (gpu_history_get_stats(info[0].As<Napi::Number>().Int32Value(), &stats) != GPU_SUCCESS) {
+        return env.Null();
+    }
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("samples", Napi::Number::New(env, static_cast<double>(stats.samples)));
+    obj.Set("blocks", Napi::Number::New(env, static_cast<double>(stats.blocks)));
+    obj.Set("encodedBytes", Napi::Number::New(env, static_cast<double>(stats.encoded_bytes)));
+    obj.Set("allocatedBytes", Napi::Number::New(env, static_cast<double>(stats.allocated_bytes)));
+    obj.Set("firstTimestamp", Napi::Number::New(env, static_cast<double>(stats.first_ms)));
+    obj.Set("lastTimestamp", Napi::Number::New(env, static_cast<double>(stats.last_ms)));
+    obj.Set("rollupBytes", Napi::Number::New(env, static_cast<double>(stats.rollup_bytes)));
+    return obj;
+}
+
+/**
+ * JS timestamp (possibly +-Infinity) as int64 milliseconds
+ */
+static int64_t TimestampToInt64(double ms) {
+    // Clamp before converting; Infinity (and NaN) have no int64 value
+    const double int64_bound = 9.2e18;
+    if (ms >= int64_bound) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    return ms > -int64_bound ? static_cast<int64_t>(ms) : std::numeric_limits<int64_t>::min();
+}
+
+/**
+ * Node.js binding: readHistory(index, [{ from, to, limit }])
+ * Samples of a GPU recorded in [from, to], oldest first, decoded on the fly
+ * from the blocks overlapping the range. At most limit are returned; page by
+ * passing the last timestamp + 1 as the next from.
+ */
+Napi::Value ReadHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected GPU index as number")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    int32_t index = info[0].As<Napi::Number>().Int32Value();
+    double from = -std::numeric_limits<double>::infinity();
+    double to = std::numeric_limits<double>::infinity();
+    uint32_t limit = UINT32_MAX;
+    
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Get("from").IsNumber()) {
+            from = options.Get("from").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("to").IsNumber()) {
+            to = options.Get("to").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("limit").IsNumber()) {
+            limit = options.Get("limit").As<Napi::Number>().Uint32Value();
+        }
+    }
+    
+    gpu_history_iter_t* iter = nullptr;
+    if (gpu_history_iter_open(index, TimestampToInt64(from), TimestampToInt64(to), &iter) != GPU_SUCCESS) {
+        Napi::RangeError::New(env, "GPU index out of range")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Array samples = Napi::Array::New(env);
+    gpu_sample_t sample;
+    uint32_t count = 0;
+    while (count < limit && gpu_history_iter_next(iter, &sample)) {
+        samples.Set(count++, SampleToObject(env, sample));
+    }
+    gpu_history_iter_close(iter);
+    
+    return samples;
+}
+
+static void CloseStores(AddonData* data) {
+    for (auto& weak : data->stores) {
+        if (std::shared_ptr<StoreHandle> handle = weak.lock()) {
+            handle->Close();
+        }
+    }
+    data->stores.clear();
+}
+
+// Finalizer of a query() view: drop its reference on the segment
+static void ReleaseStoreRange(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)data;
+    gpu_store_segment_release(static_cast<gpu_store_segment_t*>(hint));
+}
+
+/**
+ * Persistent on-disk telemetry store, returned by openStore()
+ * Records every sampler tick into memory-mapped segment files (gpu_store.h);
+ * query() hands out views of those mappings without copying them.
+ */
+class TelemetryStore : public Napi::ObjectWrap<TelemetryStore> {
+public:
+    static Napi::Function DefineClass(Napi::Env env) {
+        return Napi::ObjectWrap<TelemetryStore>::DefineClass(env, "TelemetryStore", {
+            InstanceMethod("query", &TelemetryStore::Query),
+            InstanceMethod("stats", &TelemetryStore::Stats),
+            InstanceMethod("close", &TelemetryStore::Close),
+        });
+    }
+    
+    TelemetryStore(const Napi::CallbackInfo& info) : Napi::ObjectWrap<TelemetryStore>(info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Expected store directory")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        std::string dir = info[0].As<Napi::String>().Utf8Value();
+        
+        double segment_bytes = 0;
+        double max_bytes = 0;
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (options.Get("segmentBytes").IsNumber()) {
+                segment_bytes = options.Get("segmentBytes").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("maxBytes").IsNumber()) {
+                max_bytes = options.Get("maxBytes").As<Napi::Number>().DoubleValue();
+            }
+        }
+        if (!(segment_bytes >= 0) || !(max_bytes >= 0)) {
+            Napi::RangeError::New(env, "segmentBytes and maxBytes must not be negative")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        
+        auto handle = std::make_shared<StoreHandle>();
+        gpu_error_t result = gpu_store_open(dir.c_str(), static_cast<uint64_t>(std::min(segment_bytes, 1e18)),
+                                            static_cast<uint64_t>(std::min(max_bytes, 1e18)), &handle->store);
+        if (result != GPU_SUCCESS) {
+            if (result == GPU_ERROR_INVALID_PARAM) {
+                Napi::RangeError::New(env, "segmentBytes must be between 64 KiB and 1 GiB and no more than maxBytes")
+                    .ThrowAsJavaScriptException();
+                return;
+            }
+            std::string error_msg = result == GPU_ERROR_ACCESS_DENIED
+                ? "Store " + dir + " is open in another process or not writable"
+                : "Failed to open store " + dir + ": " + gpu_error_string(result);
+            Napi::Error::New(env, error_msg).ThrowAsJavaScriptException();
+            return;
+        }
+        
+        if (gpu_sampler_add_listener(gpu_store_write, handle->store) != GPU_SUCCESS) {
+            gpu_store_close(handle->store);
+            handle->store = nullptr;
+            Napi::Error::New(env, "Too many sampler listeners")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        
+        // Let go of stores already closed before tracking this one
+        auto& stores = GetAddonData(env)->stores;
+        stores.erase(std::remove_if(stores.begin(), stores.end(),
+                                    [](const std::weak_ptr<StoreHandle>& weak) {
+                                        return weak.expired();
+                                    }),
+                     stores.end());
+        stores.push_back(handle);
+        handle_ = std::move(handle);
+    }
+
+private:
+    bool CheckOpen(Napi::Env env) {
+        if (!handle_ || !handle_->store) {
+            Napi::Error::New(env, "Store is closed")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+    
+    // query([{ from, to }]): Float64Arrays of storeRecordDoubles-wide records
+    // of every GPU with a timestamp in [from, to], one per segment, oldest
+    // first. Each is a view of the segment's mapping, not a copy.
+    Napi::Value Query(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckOpen(env)) {
+            return env.Null();
+        }
+        
+        double from = -std::numeric_limits<double>::infinity();
+        double to = std::numeric_limits<double>::infinity();
+        if (info.Length() > 0 && info[0].IsObject()) {
+            Napi::Object options = info[0].As<Napi::Object>();
+            if (options.Get("from").IsNumber()) {
+                from = options.Get("from").As<Napi::Number>().DoubleValue();
+            }
+            if (options.Get("to").IsNumber()) {
+                to = options.Get("to").As<Napi::Number>().DoubleValue();
+            }
+        }
+        
+        std::vector<gpu_store_range_t> ranges(GPU_STORE_MAX_SEGMENTS);
+        int32_t count = 0;
+        gpu_store_query(handle_->store, TimestampToInt64(from), TimestampToInt64(to),
+                        ranges.data(), GPU_STORE_MAX_SEGMENTS, &count);
+        
+        Napi::Array views = Napi::Array::New(env, count);
+        for (int32_t i = 0; i < count; i++) {
+            const gpu_store_range_t& range = ranges[i];
+            size_t bytes = static_cast<size_t>(range.count) * GPU_STORE_RECORD_BYTES;
+            
+            // The view's finalizer releases the segment reference
+            napi_value buffer;
+            if (napi_create_external_arraybuffer(env, const_cast<double*>(range.records), bytes,
+                                                 ReleaseStoreRange, range.segment, &buffer) != napi_ok) {
+                // Runtimes that forbid external buffers (V8 sandbox) get a copy
+                Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, bytes);
+                memcpy(copy.Data(), range.records, bytes);
+                gpu_store_segment_release(range.segment);
+                buffer = copy;
+            }
+            
+            views.Set(static_cast<uint32_t>(i),
+                      Napi::Float64Array::New(env, bytes / sizeof(double),
+                                              Napi::ArrayBuffer(env, buffer), 0));
+        }
+        return views;
+    }
+    
+    Napi::Value Stats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        if (!CheckOpen(env)) {
+            return env.Null();
+        }
+        
+        gpu_store_stats_t stats;
+        gpu_store_get_stats(handle_->store, &stats);
+        
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("segments", Napi::Number::New(env, static_cast<double>(stats.segments)));
+        obj.Set("records", Napi::Number::New(env, static_cast<double>(stats.records)));
+        obj.Set("diskBytes", Napi::Number::New(env, static_cast<double>(stats.disk_bytes)));
+        obj.Set("firstTimestamp", Napi::Number::New(env, static_cast<double>(stats.first_ms)));
+        obj.Set("lastTimestamp", Napi::Number::New(env, static_cast<double>(stats.last_ms)));
+        obj.Set("recoveredRecords", Napi::Number::New(env, static_cast<double>(stats.recovered_records)));
+        obj.Set("truncatedRecords", Napi::Number::New(env, static_cast<double>(stats.truncated_records)));
+        obj.Set("droppedSamples", Napi::Number::New(env, static_cast<double>(stats.dropped_samples)));
+        return obj;
+    }
+    
+    // close(): stop recording and seal the segment being written; views
+    // already returned stay valid
+    Napi::Value Close(const Napi::CallbackInfo& info) {
+        if (handle_) {
+            handle_->Close();
+            handle_.reset();
+        }
+        return info.Env().Undefined();
+    }
+    
+    std::shared_ptr<StoreHandle> handle_;
+};
+
+/**
+ * Node.js binding: openStore(dir, [{ segmentBytes, maxBytes }])
+ * Open (or create) a persistent telemetry store and record the sampler into
+ * it
+ */
+Napi::Value OpenStore(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected store directory")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Value options = info.Length() > 1 ? info[1] : env.Undefined();
+    Napi::Object store = GetAddonData(env)->store_class.Value().New({ info[0], options });
+    if (env.IsExceptionPending()) {
+        return env.Null();
+    }
+    return store;
+}
+
+/**
+ * JS names of the aggregate() statistics, indexed by gpu_stat_t
+ */
+static const char* const kStatNames[GPU_STAT_COUNT] = {
+    "min", "max", "mean", "p50", "p95", "p99"
+};
+
+/**
+ * Resolve an array of names against a table; an absent value selects
+ * defaults. Throws and returns false on an unknown name.
+ */
+template <typename T>
+static bool ParseNameList(Napi::Env env, const Napi::Value& value, const char* const* names,
+                          int count, const char* what, std::vector<T>* out) {
+    if (value.IsUndefined() || value.IsNull()) {
+        return true;
+    }
+    if (!value.IsArray()) {
+        Napi::TypeError::New(env, std::string("Expected an array of ") + what + " names")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    Napi::Array array = value.As<Napi::Array>();
+    out->clear();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+        Napi::Value item = array.Get(i);
+        std::string name = item.IsString() ? item.As<Napi::String>().Utf8Value() : std::string();
+        const char* const* match = std::find_if(names, names + count,
+                                                [&name](const char* n) { return name == n; });
+        if (match == names + count) {
+            Napi::TypeError::New(env, std::string("Unknown ") + what + ": " + name)
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        out->push_back(static_cast<T>(match - names));
+    }
+    return true;
+}
+
+/**
+ * Node.js binding: aggregate([{ window, metrics, stats }])
+ * Rolling-window statistics over the sampler's history, computed natively.
+ * Returns a Float64Array laid out [gpu][metric][stat]
+ */
+Napi::Value Aggregate(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    uint32_t window_ms = 60000;
+    std::vector<gpu_column_t> columns;
+    std::vector<gpu_stat_t> stats;
+    
+    // Every metric but the timestamp, every statistic
+    for (int c = GPU_COLUMN_TIMESTAMP + 1; c < GPU_COLUMN_COUNT; c++) {
+        columns.push_back(static_cast<gpu_column_t>(c));
+    }
+    for (int s = 0; s < GPU_STAT_COUNT; s++) {
+        stats.push_back(static_cast<gpu_stat_t>(s));
+    }
+    
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Get("window").IsNumber()) {
+            window_ms = options.Get("window").As<Napi::Number>().Uint32Value();
+        }
+        if (!ParseNameList(env, options.Get("metrics"), kSampleColumns, GPU_COLUMN_COUNT, "metric", &columns) ||
+            !ParseNameList(env, options.Get("stats"), kStatNames, GPU_STAT_COUNT, "stat", &stats)) {
+            return env.Null();
+        }
+    }
+    
+    if (window_ms == 0 || columns.empty() || stats.empty()) {
+        Napi::RangeError::New(env, "window, metrics and stats must not be empty")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    size_t row = columns.size() * stats.size();
+    std::vector<double> out(row * GPU_MAX_DEVICES);
+    int32_t count = 0;
+    gpu_error_t result = gpu_aggregate(window_ms, columns.data(), static_cast<int32_t>(columns.size()),
+                                       stats.data(), static_cast<int32_t>(stats.size()),
+                                       out.data(), GPU_MAX_DEVICES, &count);
+    if (result != GPU_SUCCESS) {
+        Napi::Error::New(env, result == GPU_ERROR_API_FAILED
+                                  ? "Sampler is not running"
+                                  : std::string("Failed to aggregate: ") + gpu_error_string(result))
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Float64Array values = Napi::Float64Array::New(env, row * count);
+    std::copy(out.begin(), out.begin() + row * count, values.Data());
+    return values;
+}
+
+/**
+ * Node.js binding: rollupHistory(index, [{ from, to, resolution, metrics }])
+ * Recorded history of a GPU in buckets of resolution ms, read from the
+ * coarsest rollup tier that is fine enough (or the raw samples). Returns
+ * { bucketMs, sourceMs, timestamps, counts, min, max, sum }; min, max and sum
+ * are laid out [bucket][metric].
+ */
+Napi::Value RollupHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected GPU index as number")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    int32_t index = info[0].As<Napi::Number>().Int32Value();
+    double from = -std::numeric_limits<double>::infinity();
+    double to = std::numeric_limits<double>::infinity();
+    double resolution = 60000;
+    std::vector<int> metrics;
+    
+    // Every metric; the timestamp is the bucket's own
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        metrics.push_back(m);
+    }
+    
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Get("from").IsNumber()) {
+            from = options.Get("from").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("to").IsNumber()) {
+            to = options.Get("to").As<Napi::Number>().DoubleValue();
+        }
+        if (options.Get("resolution").IsNumber()) {
+            resolution = options.Get("resolution").As<Napi::Number>().DoubleValue();
+        }
+        if (!ParseNameList(env, options.Get("metrics"), kSampleColumns + 1, GPU_HISTORY_METRICS,
+                           "metric", &metrics)) {
+            return env.Null();
+        }
+    }
+    
+    if (!(resolution >= 1 && resolution <= UINT32_MAX) || metrics.empty()) {
+        Napi::RangeError::New(env, "resolution must be at least 1 ms and metrics must not be empty")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    gpu_history_rollup_t* rollup = nullptr;
+    if (gpu_history_rollup_open(index, TimestampToInt64(from), TimestampToInt64(to),
+                                static_cast<uint32_t>(resolution), &rollup) != GPU_SUCCESS) {
+        Napi::RangeError::New(env, "GPU index out of range")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    std::vector<double> timestamps;
+    std::vector<double> counts;
+    std::vector<double> min;
+    std::vector<double> max;
+    std::vector<double> sum;
+    gpu_history_bucket_t bucket;
+    while (gpu_history_rollup_next(rollup, &bucket)) {
+        timestamps.push_back(static_cast<double>(bucket.start_ms));
+        counts.push_back(static_cast<double>(bucket.count));
+        for (int m : metrics) {
+            min.push_back(bucket.min[m]);
+            max.push_back(bucket.max[m]);
+            sum.push_back(bucket.sum[m]);
+        }
+    }
+    uint32_t source_ms = gpu_history_rollup_source_ms(rollup);
+    gpu_history_rollup_close(rollup);
+    
+    auto to_array = [&env](const std::vector<double>& values) {
+        Napi::Float64Array array = Napi::Float64Array::New(env, values.size());
+        std::copy(values.begin(), values.end(), array.Data());
+        return array;
+    };
+    
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("bucketMs", Napi::Number::New(env, static_cast<uint32_t>(resolution)));
+    result.Set("sourceMs", Napi::Number::New(env, source_ms));
+    result.Set("timestamps", to_array(timestamps));
+    result.Set("counts", to_array(counts));
+    result.Set("min", to_array(min));
+    result.Set("max", to_array(max));
+    result.Set("sum", to_array(sum));
+    return result;
+}
+
+static std::shared_ptr<const WatchBatch> CollectWatchBatch(gpu_field_mask_t fields) {
+    auto batch = std::make_shared<WatchBatch>();
+    CollectAll(fields, batch.get());
+    return batch;
+}
+
+/**
+ * Runs on the JS thread for each queued delivery
+ */
+static void DeliverWatchBatch(Napi::Env env, Napi::Function callback, WatchSubscriber* sub) {
+    std::shared_ptr<const WatchBatch> batch;
+    {
+        std::lock_guard<std::mutex> lock(sub->hub->mutex);
+        batch = std::move(sub->pending);
+        sub->queued = false;
+        if (!sub->active) {
+            return;
+        }
+    }
+    
+    if (!batch || env == nullptr || callback.IsEmpty()) {
+        return;
+    }
+    
+    // Devices that failed to collect are left out
+    Napi::Array gpuArray = Napi::Array::New(env);
+    uint32_t length = 0;
+    for (size_t i = 0; i < batch->infos.size(); i++) {
+        if (batch->results[i] == GPU_SUCCESS) {
+            gpuArray.Set(length++, BatchEntryToObject(env, *batch, i, sub->fields));
+        }
+    }
+    
+    callback.Call({gpuArray});
+}
+
+static void WatchThread(WatchHub* hub) {
+    std::unique_lock<std::mutex> lock(hub->mutex);
+    
+    while (!hub->subscribers.empty()) {
+        auto now = std::chrono::steady_clock::now();
+        auto next = std::chrono::steady_clock::time_point::max();
+        for (WatchSubscriber* sub : hub->subscribers) {
+            next = std::min(next, sub->next_due);
+        }
+        
+        if (next > now) {
+            hub->wake.wait_until(lock, next);
+            continue;
+        }
+        
+        gpu_field_mask_t fields = 0;
+        for (WatchSubscriber* sub : hub->subscribers) {
+            if (sub->next_due <= now) {
+                fields |= sub->fields;
+            }
+        }
+        
+        // Collect without holding the lock so subscribe/unsubscribe never wait
+        // on a slow driver
+        lock.unlock();
+        std::shared_ptr<const WatchBatch> batch = CollectWatchBatch(fields);
+        lock.lock();
+        
+        now = std::chrono::steady_clock::now();
+        for (WatchSubscriber* sub : hub->subscribers) {
+            if (sub->next_due > now) {
+                continue;
+            }
+            
+            // Fixed-rate schedule that skips missed ticks instead of bursting
+            sub->next_due += sub->interval;
+            if (sub->next_due < now) {
+                sub->next_due = now + sub->interval;
+            }
+            
+            // Coalesce: if a delivery is still queued, just swap in the newer
+            // batch so a slow JS thread never builds up a backlog
+            sub->pending = batch;
+            if (!sub->queued) {
+                sub->queued = sub->tsfn.NonBlockingCall(sub, DeliverWatchBatch) == napi_ok;
+            }
+        }
+    }
+    
+    // Last write to the hub: whoever joins this thread only waits for the
+    // lock to be released
+    hub->running = false;
+}
+
+/**
+ * Remove a subscriber; returns false if it was already gone
+ */
+static bool Unwatch(WatchHub* hub, uint32_t id) {
+    WatchSubscriber* sub = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(hub->mutex);
+        auto& subs = hub->subscribers;
+        auto it = std::find_if(subs.begin(), subs.end(),
+                               [id](WatchSubscriber* s) { return s->id == id; });
+        if (it == subs.end()) {
+            return false;
+        }
+        sub = *it;
+        sub->active = false;
+        subs.erase(it);
+        hub->wake.notify_all();
+    }
+    
+    // The collection thread can no longer reach sub, so this is the last
+    // reference it holds; the finalizer frees it
+    sub->tsfn.Release();
+    return true;
+}
+
+/**
+ * Stop every watcher and wait for the collection thread to exit
+ */
+static void StopAllWatchers(WatchHub* hub) {
+    std::vector<WatchSubscriber*> subs;
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(hub->mutex);
+        subs.swap(hub->subscribers);
+        for (WatchSubscriber* sub : subs) {
+            sub->active = false;
+        }
+        thread = std::move(hub->thread);
+        hub->wake.notify_all();
+    }
+    
+    if (thread.joinable()) {
+        thread.join();
+    }
+    for (WatchSubscriber* sub : subs) {
+        sub->tsfn.Release();
+    }
+}
+
+/**
+ * unsubscribe() handle returned by watch()
+ */
+Napi::Value Unsubscribe(const Napi::CallbackInfo& info) {
+    uint32_t id = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(info.Data()));
+    return Napi::Boolean::New(info.Env(), Unwatch(&GetAddonData(info.Env())->watch_hub, id));
+}
+
+/**
+ * Node.js binding: watch([{ intervalMs, fields }], callback)
+ * Calls callback(gpus) every intervalMs from a shared native collection thread;
+ * returns an unsubscribe function
+ */
+Napi::Value Watch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    size_t callback_arg = (info.Length() > 0 && info[0].IsFunction()) ? 0 : 1;
+    if (info.Length() <= callback_arg || !info[callback_arg].IsFunction()) {
+        Napi::TypeError::New(env, "Expected callback function")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    uint32_t interval_ms = 1000;
+    gpu_field_mask_t fields = GPU_FIELD_ALL;
+    
+    if (callback_arg == 1 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Get("intervalMs").IsNumber()) {
+            interval_ms = options.Get("intervalMs").As<Napi::Number>().Uint32Value();
+        }
+        if (!ParseFieldMask(env, options.Get("fields"), &fields)) {
+            return env.Null();
+        }
+    }
+    
+    if (interval_ms == 0) {
+        Napi::RangeError::New(env, "intervalMs must be positive")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    WatchHub* hub = &GetAddonData(env)->watch_hub;
+    WatchSubscriber* sub = new WatchSubscriber();
+    sub->hub = hub;
+    sub->interval = std::chrono::milliseconds(interval_ms);
+    sub->next_due = std::chrono::steady_clock::now();
+    sub->fields = fields;
+    sub->tsfn = Napi::ThreadSafeFunction::New(
+        env, info[callback_arg].As<Napi::Function>(), "gpuWatch", 0, 1, sub,
+        [](Napi::Env, WatchSubscriber* s) { delete s; });
+    
+    uint32_t id;
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(hub->mutex);
+        id = hub->next_id++;
+        sub->id = id;
+        hub->subscribers.push_back(sub);
+        
+        if (!hub->running) {
+            // A previous thread may still be winding down after its last
+            // subscriber left; it cleared running under this lock, so all it
+            // has left to do is release the lock and return
+            finished = std::move(hub->thread);
+            hub->running = true;
+            hub->thread = std::thread(WatchThread, hub);
+        } else {
+            hub->wake.notify_all();
+        }
+    }
+    
+    if (finished.joinable()) {
+        finished.join();
+    }
+    
+    return Napi::Function::New(env, Unsubscribe, "unsubscribe",
+                               reinterpret_cast<void*>(static_cast<uintptr_t>(id)));
+}
+
+/**
+ * Initialize the Node.js addon
+ */
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    // Freed by the default finalizer once the environment is gone, which is
+    // after every watch() ThreadSafeFunction has been finalized
+    AddonData* data = new AddonData();
+    env.SetInstanceData(data);
+    
+    data->shared_segment_class = Napi::Persistent(SharedSegment::DefineClass(env));
+    data->collector_client_class = Napi::Persistent(CollectorClient::DefineClass(env));
+    data->store_class = Napi::Persistent(TelemetryStore::DefineClass(env));
+    
+    // Auto-initialize on module load
+    AcquireBackend(data);
+    
+    // Export functions
+    exports.Set("initialize", Napi::Function::New(env, Initialize));
+    exports.Set("cleanup", Napi::Function::New(env, Cleanup));
+    exports.Set("refresh", Napi::Function::New(env, Refresh));
+    exports.Set("getGpuCount", Napi::Function::New(env, GetGpuCount));
+    exports.Set("getGpuInfo", Napi::Function::New(env, GetGpuInfo));
+    exports.Set("getAllGpuInfo", Napi::Function::New(env, GetAllGpuInfo));
+    exports.Set("getGpuInfoAsync", Napi::Function::New(env, GetGpuInfoAsync));
+    exports.Set("getAllGpuInfoAsync", Napi::Function::New(env, GetAllGpuInfoAsync));
+    exports.Set("getGpuDescriptors", Napi::Function::New(env, GetGpuDescriptors));
+    exports.Set("getProcesses", Napi::Function::New(env, GetProcesses));
+    exports.Set("sample", Napi::Function::New(env, Sample));
+    exports.Set("sampleInto", Napi::Function::New(env, SampleInto));
+    
+    // Column table for sampleInto(): name -> column number
+    Napi::Object columns = Napi::Object::New(env);
+    for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+        columns.Set(kSampleColumns[c], Napi::Number::New(env, c));
+    }
+    columns.Freeze();
+    exports.Set("sampleColumns", columns);
+    exports.Set("sampleColumnCount", Napi::Number::New(env, GPU_COLUMN_COUNT));
+    
+    exports.Set("startSampler", Napi::Function::New(env, StartSampler));
+    exports.Set("stopSampler", Napi::Function::New(env, StopSampler));
+    exports.Set("publishSnapshot", Napi::Function::New(env, PublishSnapshot));
+    exports.Set("unpublishSnapshot", Napi::Function::New(env, UnpublishSnapshot));
+    exports.Set("publishShared", Napi::Function::New(env, PublishShared));
+    exports.Set("unpublishShared", Napi::Function::New(env, UnpublishShared));
+    exports.Set("attachShared", Napi::Function::New(env, AttachShared));
+    exports.Set("getLatestSample", Napi::Function::New(env, GetLatestSample));
+    exports.Set("getSampleHistory", Napi::Function::New(env, GetSampleHistory));
+    exports.Set("aggregate", Napi::Function::New(env, Aggregate));
+    exports.Set("startHistory", Napi::Function::New(env, StartHistory));
+    exports.Set("stopHistory", Napi::Function::New(env, StopHistory));
+    exports.Set("getHistoryStats", Napi::Function::New(env, GetHistoryStats));
+    exports.Set("readHistory", Napi::Function::New(env, ReadHistory));
+    exports.Set("rollupHistory", Napi::Function::New(env, RollupHistory));
+    exports.Set("openStore", Napi::Function::New(env, OpenStore));
+    exports.Set("storeRecordDoubles", Napi::Number::New(env, GPU_STORE_RECORD_DOUBLES));
+    exports.Set("watch", Napi::Function::New(env, Watch));
+    exports.Set("renderPrometheus", Napi::Function::New(env, RenderPrometheus));
+    exports.Set("serveMetrics", Napi::Function::New(env, ServeMetrics));
+    exports.Set("startCollectorServer", Napi::Function::New(env, StartCollectorServer));
+    exports.Set("connect", Napi::Function::New(env, Connect));
+    
+    // Don't leave native threads running into environment teardown, and drop
+    // this environment's references so the last one out unloads the drivers
+    env.AddCleanupHook([](AddonData* data) {
+        StopAllWatchers(&data->watch_hub);
+        StopMetricsServers(data);
+        CloseRemoteConnections(data);
+        StopCollectorServers(data);
+        StopPublishing(data);
+        StopSharingAll(data);
+        CloseStores(data);
+        ReleaseHistory(data);
+        ReleaseSampler(data);
+        ReleaseBackend(data);
+    }, data);
     
     return exports;
 }
@@ -0,0 +1,421 @@
+#include "gpu_aggregate.h"
+#include "gpu_sampler.h"
+#include "gpu_thread.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Quantile sketch: bucket 0 holds values <= SKETCH_MIN_VALUE, bucket k > 0
+// holds (gamma^(j-1), gamma^j] with j = k - SKETCH_OFFSET, which covers
+// values up to ~5e14 (timestamps included)
+#define SKETCH_BUCKETS 2048            // Power of two for the Fenwick descent
+#define SKETCH_MIN_VALUE 1e-3
+#define SKETCH_OFFSET 346
+
+typedef struct {
+    uint64_t* seqs;             // Ring of sample sequence numbers
+    uint64_t front;
+    uint64_t back;
+} seq_deque_t;
+
+typedef struct {
+    double* values;             // Ring, indexed by sequence % capacity
+    double sum;
+    uint32_t count;             // Non-NaN values in the window
+    seq_deque_t min;            // Increasing values, front is the minimum
+    seq_deque_t max;            // Decreasing values, front is the maximum
+    uint32_t* sketch;           // Fenwick tree over SKETCH_BUCKETS counts
+} column_window_t;
+
+typedef struct {
+    int64_t* timestamps;
+    uint64_t first;             // Samples [first, next) are in the window
+    uint64_t next;
+    int64_t last_timestamp;
+    column_window_t columns[GPU_COLUMN_COUNT];
+} device_window_t;
+
+typedef struct {
+    uint32_t window_ms;
+    uint32_t interval_ms;       // Sampler run the window was sized for
+    uint32_t capacity;
+    int32_t device_count;
+    uint64_t last_used;
+    device_window_t* devices;
+} aggregate_window_t;
+
+// g_attach_lock serializes attaching to the sampler, which must not happen
+// under g_aggregate_lock: the listener takes g_aggregate_lock while the
+// sampler holds its listener lock
+static gpu_mutex_t g_attach_lock = GPU_MUTEX_INITIALIZER;
+static bool g_listening = false;
+
+static gpu_mutex_t g_aggregate_lock = GPU_MUTEX_INITIALIZER;
+static aggregate_window_t* g_windows[GPU_AGGREGATE_MAX_WINDOWS];
+static int32_t g_window_count = 0;
+static uint64_t g_use_clock = 0;
+
+static double g_log_gamma = 0.0;
+static double g_gamma = 0.0;
+
+static void sketch_init_constants(void) {
+    if (g_log_gamma == 0.0) {
+        g_gamma = (1.0 + GPU_AGGREGATE_RELATIVE_ERROR) / (1.0 - GPU_AGGREGATE_RELATIVE_ERROR);
+        g_log_gamma = log(g_gamma);
+    }
+}
+
+static uint32_t sketch_bucket(double value) {
+    if (!(value > SKETCH_MIN_VALUE)) {
+        return 0;
+    }
+    double k = ceil(log(value) / g_log_gamma) + SKETCH_OFFSET;
+    if (k < 1) {
+        return 1;
+    }
+    return k > SKETCH_BUCKETS - 1 ? SKETCH_BUCKETS - 1 : (uint32_t)k;
+}
+
+// Midpoint (in relative terms) of a bucket
+static double sketch_value(uint32_t bucket) {
+    if (bucket == 0) {
+        return 0.0;
+    }
+    return 2.0 * pow(g_gamma, (double)bucket - SKETCH_OFFSET) / (g_gamma + 1.0);
+}
+
+static void sketch_add(uint32_t* tree, double value, int32_t delta) {
+    for (uint32_t i = sketch_bucket(value) + 1; i <= SKETCH_BUCKETS; i += i & (0u - i)) {
+        tree[i] += (uint32_t)delta;
+    }
+}
+
+// Bucket holding the rank-th smallest value (1-based)
+static uint32_t sketch_find(const uint32_t* tree, uint32_t rank) {
+    uint32_t position = 0;
+    for (uint32_t step = SKETCH_BUCKETS; step > 0; step >>= 1) {
+        if (position + step <= SKETCH_BUCKETS && tree[position + step] < rank) {
+            position += step;
+            rank -= tree[position];
+        }
+    }
+    return position;
+}
+
+static void window_free(aggregate_window_t* window) {
+    if (!window) {
+        return;
+    }
+    
+    for (int32_t d = 0; window->devices && d < window->device_count; d++) {
+        device_window_t* device = &window->devices[d];
+        free(device->timestamps);
+        for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+            free(device->columns[c].values);
+            free(device->columns[c].min.seqs);
+            free(device->columns[c].max.seqs);
+            free(device->columns[c].sketch);
+        }
+    }
+    free(window->devices);
+    free(window);
+}
+
+static aggregate_window_t* window_create(uint32_t window_ms, uint32_t interval_ms,
+                                         int32_t device_count) {
+    aggregate_window_t* window = (aggregate_window_t*)calloc(1, sizeof(aggregate_window_t));
+    if (!window) {
+        return NULL;
+    }
+    
+    // Room for every tick in the window plus the one straddling each end
+    uint64_t capacity = (uint64_t)window_ms / interval_ms + 2;
+    window->window_ms = window_ms;
+    window->interval_ms = interval_ms;
+    window->capacity = capacity > GPU_AGGREGATE_MAX_SAMPLES ? GPU_AGGREGATE_MAX_SAMPLES : (uint32_t)capacity;
+    window->device_count = device_count;
+    window->devices = (device_window_t*)calloc((size_t)(device_count > 0 ? device_count : 1),
+                                               sizeof(device_window_t));
+    if (!window->devices) {
+        window_free(window);
+        return NULL;
+    }
+    
+    for (int32_t d = 0; d < device_count; d++) {
+        device_window_t* device = &window->devices[d];
+        device->timestamps = (int64_t*)malloc(sizeof(int64_t) * window->capacity);
+        if (!device->timestamps) {
+            window_free(window);
+            return NULL;
+        }
+        device->last_timestamp = INT64_MIN;
+        
+        for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+            column_window_t* column = &device->columns[c];
+            column->values = (double*)malloc(sizeof(double) * window->capacity);
+            column->min.seqs = (uint64_t*)malloc(sizeof(uint64_t) * window->capacity);
+            column->max.seqs = (uint64_t*)malloc(sizeof(uint64_t) * window->capacity);
+            column->sketch = (uint32_t*)calloc(SKETCH_BUCKETS + 1, sizeof(uint32_t));
+            if (!column->values || !column->min.seqs || !column->max.seqs || !column->sketch) {
+                window_free(window);
+                return NULL;
+            }
+        }
+    }
+    return window;
+}
+
+static void device_evict_oldest(const aggregate_window_t* window, device_window_t* device) {
+    uint64_t seq = device->first++;
+    uint32_t slot = (uint32_t)(seq % window->capacity);
+    
+    for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+        column_window_t* column = &device->columns[c];
+        double value = column->values[slot];
+        if (isnan(value)) {
+            continue;
+        }
+        
+        // Recomputing from zero once empty keeps the running sum from drifting
+        column->sum = --column->count > 0 ? column->sum - value : 0.0;
+        sketch_add(column->sketch, value, -1);
+        if (column->min.back > column->min.front && column->min.seqs[column->min.front % window->capacity] == seq) {
+            column->min.front++;
+        }
+        if (column->max.back > column->max.front && column->max.seqs[column->max.front % window->capacity] == seq) {
+            column->max.front++;
+        }
+    }
+}
+
+static void device_evict_before(const aggregate_window_t* window, device_window_t* device,
+                                int64_t oldest_ms) {
+    while (device->first < device->next &&
+           device->timestamps[device->first % window->capacity] < oldest_ms) {
+        device_evict_oldest(window, device);
+    }
+}
+
+static void device_push(const aggregate_window_t* window, device_window_t* device,
+                        const gpu_sample_t* sample) {
+    // Seeding and the listener can both see the tick that raced the seed
+    if (sample->timestamp_ms <= device->last_timestamp) {
+        return;
+    }
+    device->last_timestamp = sample->timestamp_ms;
+    
+    if (device->next - device->first == window->capacity) {
+        device_evict_oldest(window, device);
+    }
+    
+    uint64_t seq = device->next++;
+    uint32_t slot = (uint32_t)(seq % window->capacity);
+    device->timestamps[slot] = sample->timestamp_ms;
+    
+    for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+        column_window_t* column = &device->columns[c];
+        double value = gpu_sample_column(sample, (gpu_column_t)c);
+        column->values[slot] = value;
+        if (isnan(value)) {
+            continue;
+        }
+        
+        column->sum += value;
+        column->count++;
+        sketch_add(column->sketch, value, 1);
+        
+        // Drop every queued value the new one dominates; what remains is
+        // monotonic, so the front is the extreme of the window
+        seq_deque_t* min = &column->min;
+        while (min->back > min->front && column->values[min->seqs[(min->back - 1) % window->capacity] % window->capacity] >= value) {
+            min->back--;
+        }
+        min->seqs[min->back++ % window->capacity] = seq;
+        
+        seq_deque_t* max = &column->max;
+        while (max->back > max->front && column->values[max->seqs[(max->back - 1) % window->capacity] % window->capacity] <= value) {
+            max->back--;
+        }
+        max->seqs[max->back++ % window->capacity] = seq;
+    }
+    
+    device_evict_before(window, device, sample->timestamp_ms - window->window_ms);
+}
+
+static double column_stat(const aggregate_window_t* window, const column_window_t* column,
+                          gpu_stat_t stat) {
+    if (column->count == 0) {
+        return NAN;
+    }
+    
+    double min = column->values[column->min.seqs[column->min.front % window->capacity] % window->capacity];
+    double max = column->values[column->max.seqs[column->max.front % window->capacity] % window->capacity];
+    double q;
+    switch (stat) {
+        case GPU_STAT_MIN: return min;
+        case GPU_STAT_MAX: return max;
+        case GPU_STAT_MEAN: return column->sum / column->count;
+        case GPU_STAT_P50: q = 0.50; break;
+        case GPU_STAT_P95: q = 0.95; break;
+        case GPU_STAT_P99: q = 0.99; break;
+        default: return NAN;
+    }
+    
+    // Nearest rank
+    uint32_t rank = (uint32_t)floor(q * (column->count - 1)) + 1;
+    double value = sketch_value(sketch_find(column->sketch, rank));
+    return value < min ? min : value > max ? max : value;
+}
+
+static void aggregate_listener(const gpu_sample_t* samples, const bool* valid, int32_t count,
+                               void* ctx) {
+    (void)ctx;
+    gpu_mutex_lock(&g_aggregate_lock);
+    
+    for (int32_t w = 0; w < g_window_count; w++) {
+        aggregate_window_t* window = g_windows[w];
+        int32_t n = count < window->device_count ? count : window->device_count;
+        for (int32_t i = 0; i < n; i++) {
+            if (valid[i]) {
+                device_push(window, &window->devices[i], &samples[i]);
+            }
+        }
+    }
+    
+    gpu_mutex_unlock(&g_aggregate_lock);
+}
+
+static bool ensure_listening(void) {
+    gpu_mutex_lock(&g_attach_lock);
+    if (!g_listening) {
+        g_listening = gpu_sampler_add_listener(aggregate_listener, NULL) == GPU_SUCCESS;
+    }
+    bool listening = g_listening;
+    gpu_mutex_unlock(&g_attach_lock);
+    return listening;
+}
+
+// Tracked window for window_ms, created and seeded from the sampler's rings
+// if needed; NULL on allocation failure. Called with g_aggregate_lock held.
+static aggregate_window_t* find_window(uint32_t window_ms, uint32_t interval_ms,
+                                       int32_t device_count) {
+    for (int32_t w = 0; w < g_window_count; w++) {
+        aggregate_window_t* window = g_windows[w];
+        if (window->window_ms != window_ms) {
+            continue;
+        }
+        
+        // Sized for another sampler run: rebuild it
+        if (window->interval_ms != interval_ms || window->device_count != device_count) {
+            window_free(window);
+            g_windows[w] = g_windows[--g_window_count];
+            break;
+        }
+        return window;
+    }
+    
+    aggregate_window_t* window = window_create(window_ms, interval_ms, device_count);
+    if (!window) {
+        return NULL;
+    }
+    
+    gpu_sample_t* history = (gpu_sample_t*)malloc(sizeof(gpu_sample_t) * window->capacity);
+    if (!history) {
+        window_free(window);
+        return NULL;
+    }
+    for (int32_t d = 0; d < device_count; d++) {
+        uint32_t count = 0;
+        if (gpu_sampler_history(d, history, window->capacity, &count) != GPU_SUCCESS) {
+            continue;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            device_push(window, &window->devices[d], &history[i]);
+        }
+    }
+    free(history);
+    
+    if (g_window_count == GPU_AGGREGATE_MAX_WINDOWS) {
+        int32_t oldest = 0;
+        for (int32_t w = 1; w < g_window_count; w++) {
+            if (g_windows[w]->last_used < g_windows[oldest]->last_used) {
+                oldest = w;
+            }
+        }
+        window_free(g_windows[oldest]);
+        g_windows[oldest] = g_windows[--g_window_count];
+    }
+    g_windows[g_window_count++] = window;
+    return window;
+}
+
+gpu_error_t gpu_aggregate(uint32_t window_ms, const gpu_column_t* columns, int32_t column_count,
+                          const gpu_stat_t* stats, int32_t stat_count,
+                          double* out, int32_t max_devices, int32_t* device_count) {
+    if (window_ms == 0 || !columns || column_count <= 0 || !stats || stat_count <= 0 ||
+        !out || max_devices < 0 || !device_count) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    for (int32_t c = 0; c < column_count; c++) {
+        if ((int)columns[c] < 0 || columns[c] >= GPU_COLUMN_COUNT) {
+            return GPU_ERROR_INVALID_PARAM;
+        }
+    }
+    for (int32_t s = 0; s < stat_count; s++) {
+        if ((int)stats[s] < 0 || stats[s] >= GPU_STAT_COUNT) {
+            return GPU_ERROR_INVALID_PARAM;
+        }
+    }
+    
+    uint32_t interval_ms = 0;
+    int32_t count = 0;
+    if (gpu_sampler_get_interval(&interval_ms) != GPU_SUCCESS ||
+        gpu_sampler_get_device_count(&count) != GPU_SUCCESS || !ensure_listening()) {
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    gpu_mutex_lock(&g_aggregate_lock);
+    sketch_init_constants();
+    
+    aggregate_window_t* window = find_window(window_ms, interval_ms, count);
+    if (!window) {
+        gpu_mutex_unlock(&g_aggregate_lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    window->last_used = ++g_use_clock;
+    
+    int64_t oldest_ms = gpu_time_ms() - window_ms;
+    int32_t n = count < max_devices ? count : max_devices;
+    for (int32_t d = 0; d < n; d++) {
+        device_window_t* device = &window->devices[d];
+        device_evict_before(window, device, oldest_ms);
+        
+        for (int32_t c = 0; c < column_count; c++) {
+            const column_window_t* column = &device->columns[columns[c]];
+            double* row = &out[((size_t)d * column_count + c) * stat_count];
+            for (int32_t s = 0; s < stat_count; s++) {
+                row[s] = column_stat(window, column, stats[s]);
+            }
+        }
+    }
+    *device_count = n;
+    
+    gpu_mutex_unlock(&g_aggregate_lock);
+    return GPU_SUCCESS;
+}
+
+void gpu_aggregate_reset(void) {
+    gpu_mutex_lock(&g_attach_lock);
+    if (g_listening) {
+        gpu_sampler_remove_listener(aggregate_listener, NULL);
+        g_listening = false;
+    }
+    gpu_mutex_unlock(&g_attach_lock);
+    
+    gpu_mutex_lock(&g_aggregate_lock);
+    for (int32_t w = 0; w < g_window_count; w++) {
+        window_free(g_windows[w]);
+    }
+    g_window_count = 0;
+    gpu_mutex_unlock(&g_aggregate_lock);
+}
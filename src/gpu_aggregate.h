@@ -0,0 +1,57 @@
+#ifndef GPU_AGGREGATE_H
+#define GPU_AGGREGATE_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rolling-window statistics over the sampler's history. The first query for a
+// window length seeds it from the sampler's rings; from then on a sampler
+// listener keeps it up to date incrementally, so a query costs O(1) for
+// min/max/mean and O(log buckets) per quantile instead of O(window):
+// - min and max: monotonic deques of the samples in the window
+// - mean: running sum and count
+// - quantiles: log-bucketed histogram (relative error
+//   GPU_AGGREGATE_RELATIVE_ERROR) stored as a Fenwick tree, so samples
+//   leaving the window can be removed exactly. Results are clamped to the
+//   exact min and max.
+//
+// Each tracked window keeps its own copy of the values in it, at most
+// GPU_AGGREGATE_MAX_SAMPLES per device; at most GPU_AGGREGATE_MAX_WINDOWS
+// window lengths are tracked and the least recently queried one is dropped
+// for a new one. Values that are NaN are skipped.
+#define GPU_AGGREGATE_MAX_WINDOWS 8
+#define GPU_AGGREGATE_MAX_SAMPLES 65536
+#define GPU_AGGREGATE_RELATIVE_ERROR 0.01
+
+typedef enum {
+    GPU_STAT_MIN = 0,
+    GPU_STAT_MAX,
+    GPU_STAT_MEAN,
+    GPU_STAT_P50,
+    GPU_STAT_P95,
+    GPU_STAT_P99,
+    GPU_STAT_COUNT
+} gpu_stat_t;
+
+// stats[s] of columns[c] over the samples of the last window_ms (by sample
+// timestamp) for every device sampled:
+//   out[(device * column_count + c) * stat_count + s]
+// NaN where a device has no sample in the window. out must hold
+// max_devices * column_count * stat_count doubles; *device_count is the
+// number of devices written. GPU_ERROR_API_FAILED if the sampler is not
+// running.
+gpu_error_t gpu_aggregate(uint32_t window_ms, const gpu_column_t* columns, int32_t column_count,
+                          const gpu_stat_t* stats, int32_t stat_count,
+                          double* out, int32_t max_devices, int32_t* device_count);
+
+// Drop every tracked window and stop listening to the sampler
+void gpu_aggregate_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_AGGREGATE_H
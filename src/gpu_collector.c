@@ -0,0 +1,1475 @@
+#include "gpu_collector.h"
+
+#ifndef _WIN32
+
+#include "gpu_thread.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// SIGPIPE must never reach the host process: Linux has a per-call flag,
+// macOS a per-socket option
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define FRAME_HEADER_BYTES 8
+#define MAX_REQUEST_PAYLOAD 64              // Largest client -> server frame
+#define MAX_RESPONSE_PAYLOAD (16 * 1024 * 1024)
+#define CLIENT_INPUT_BYTES 4096
+#define HANDSHAKE_TIMEOUT_MS 5000
+#define MAX_CACHED_ENCODINGS 32
+#define MAX_PENDING_GETS 64                 // Per client, answered each loop iteration
+
+typedef enum {
+    FRAME_HELLO = 1,
+    FRAME_GET = 2,
+    FRAME_SUBSCRIBE = 3,
+    FRAME_UNSUBSCRIBE = 4,
+    FRAME_WELCOME = 0x81,
+    FRAME_REPLY = 0x82,
+    FRAME_EVENT = 0x83,
+    FRAME_ERROR = 0x84
+} frame_type_t;
+
+// ---------------------------------------------------------------------------
+// Encoding
+
+typedef struct {
+    uint8_t* data;
+    size_t length;
+    size_t capacity;
+    bool failed;
+} byte_buffer_t;
+
+static bool buffer_reserve(byte_buffer_t* buffer, size_t extra) {
+    if (buffer->failed) {
+        return false;
+    }
+    if (buffer->length + extra <= buffer->capacity) {
+        return true;
+    }
+    
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (capacity < buffer->length + extra) {
+        capacity *= 2;
+    }
+    
+    uint8_t* data = (uint8_t*)realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static void buffer_append(byte_buffer_t* buffer, const void* data, size_t length) {
+    if (buffer_reserve(buffer, length)) {
+        memcpy(buffer->data + buffer->length, data, length);
+        buffer->length += length;
+    }
+}
+
+static void buffer_u32(byte_buffer_t* buffer, uint32_t value) { buffer_append(buffer, &value, 4); }
+static void buffer_i32(byte_buffer_t* buffer, int32_t value) { buffer_append(buffer, &value, 4); }
+static void buffer_i64(byte_buffer_t* buffer, int64_t value) { buffer_append(buffer, &value, 8); }
+static void buffer_u64(byte_buffer_t* buffer, uint64_t value) { buffer_append(buffer, &value, 8); }
+static void buffer_f32(byte_buffer_t* buffer, float value) { buffer_append(buffer, &value, 4); }
+
+static void buffer_str(byte_buffer_t* buffer, const char* text, size_t max_length) {
+    size_t length = strnlen(text, max_length);
+    uint16_t length16 = (uint16_t)length;
+    buffer_append(buffer, &length16, 2);
+    buffer_append(buffer, text, length);
+}
+
+static void buffer_frame_header(byte_buffer_t* buffer, frame_type_t type, uint32_t payload_length) {
+    uint16_t type16 = (uint16_t)type;
+    uint16_t reserved = 0;
+    buffer_u32(buffer, payload_length);
+    buffer_append(buffer, &type16, 2);
+    buffer_append(buffer, &reserved, 2);
+}
+
+static void buffer_free(byte_buffer_t* buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+static void encode_batch(byte_buffer_t* buffer, gpu_field_mask_t fields, const gpu_info_t* infos,
+                         const gpu_error_t* results, const int64_t* timestamps_ms, int32_t count) {
+    buffer_u32(buffer, fields);
+    buffer_u32(buffer, (uint32_t)count);
+    
+    for (int32_t i = 0; i < count; i++) {
+        const gpu_info_t* info = &infos[i];
+        buffer_i32(buffer, info->index);
+        buffer_i32(buffer, (int32_t)results[i]);
+        buffer_i64(buffer, timestamps_ms[i]);
+        if (results[i] != GPU_SUCCESS) {
+            continue;
+        }
+        
+        if (fields & GPU_FIELD_VENDOR) buffer_i32(buffer, (int32_t)info->vendor);
+        if (fields & GPU_FIELD_NAME) buffer_str(buffer, info->name, sizeof(info->name));
+        if (fields & GPU_FIELD_UUID) buffer_str(buffer, info->uuid, sizeof(info->uuid));
+        if (fields & GPU_FIELD_PCI_BUS_ID) buffer_str(buffer, info->pci_bus_id, sizeof(info->pci_bus_id));
+        if (fields & GPU_FIELD_MEMORY_TOTAL) buffer_u64(buffer, info->memory_total);
+        if (fields & GPU_FIELD_MEMORY_USED) buffer_u64(buffer, info->memory_used);
+        if (fields & GPU_FIELD_MEMORY_FREE) buffer_u64(buffer, info->memory_free);
+        if (fields & GPU_FIELD_GPU_UTILIZATION) buffer_f32(buffer, info->gpu_utilization);
+        if (fields & GPU_FIELD_MEMORY_UTILIZATION) buffer_f32(buffer, info->memory_utilization);
+        if (fields & GPU_FIELD_TEMPERATURE) buffer_f32(buffer, info->temperature);
+        if (fields & GPU_FIELD_POWER_USAGE) buffer_f32(buffer, info->power_usage);
+        if (fields & GPU_FIELD_CORE_CLOCK) buffer_u32(buffer, info->core_clock);
+        if (fields & GPU_FIELD_MEMORY_CLOCK) buffer_u32(buffer, info->memory_clock);
+        if (fields & GPU_FIELD_FAN_SPEED) buffer_f32(buffer, info->fan_speed);
+        if (fields & GPU_FIELD_MEMORY_TEMPERATURE) buffer_f32(buffer, info->memory_temperature);
+        if (fields & GPU_FIELD_ENERGY) buffer_u64(buffer, info->energy_consumption);
+        if (fields & GPU_FIELD_PCIE_REPLAY_COUNT) buffer_u64(buffer, info->pcie_replay_count);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Decoding
+
+typedef struct {
+    const uint8_t* data;
+    size_t left;
+    bool ok;
+} byte_reader_t;
+
+static void reader_take(byte_reader_t* reader, void* out, size_t length) {
+    if (!reader->ok || reader->left < length) {
+        reader->ok = false;
+        memset(out, 0, length);
+        return;
+    }
+    memcpy(out, reader->data, length);
+    reader->data += length;
+    reader->left -= length;
+}
+
+static uint32_t reader_u32(byte_reader_t* reader) { uint32_t v; reader_take(reader, &v, 4); return v; }
+static int32_t reader_i32(byte_reader_t* reader) { int32_t v; reader_take(reader, &v, 4); return v; }
+static int64_t reader_i64(byte_reader_t* reader) { int64_t v; reader_take(reader, &v, 8); return v; }
+static uint64_t reader_u64(byte_reader_t* reader) { uint64_t v; reader_take(reader, &v, 8); return v; }
+static float reader_f32(byte_reader_t* reader) { float v; reader_take(reader, &v, 4); return v; }
+
+// Strings longer than the destination are truncated
+static void reader_str(byte_reader_t* reader, char* out, size_t size) {
+    uint16_t length = 0;
+    reader_take(reader, &length, 2);
+    if (!reader->ok || reader->left < length) {
+        reader->ok = false;
+        out[0] = '\0';
+        return;
+    }
+    
+    size_t copied = length < size - 1 ? length : size - 1;
+    memcpy(out, reader->data, copied);
+    out[copied] = '\0';
+    reader->data += length;
+    reader->left -= length;
+}
+
+// Decode a batch into at most max_count entries (the rest is validated and
+// skipped)
+static bool decode_batch(byte_reader_t* reader, gpu_field_mask_t* fields_out, gpu_info_t* infos,
+                         gpu_error_t* results, int64_t* timestamps_ms, int32_t max_count,
+                         int32_t* count) {
+    gpu_field_mask_t fields = reader_u32(reader);
+    uint32_t entries = reader_u32(reader);
+    int32_t stored = 0;
+    
+    for (uint32_t i = 0; i < entries && reader->ok; i++) {
+        gpu_info_t scratch;
+        bool keep = stored < max_count;
+        gpu_info_t* info = keep ? &infos[stored] : &scratch;
+        
+        memset(info, 0, sizeof(*info));
+        info->index = reader_i32(reader);
+        gpu_error_t result = (gpu_error_t)reader_i32(reader);
+        int64_t timestamp = reader_i64(reader);
+        
+        if (result == GPU_SUCCESS) {
+            if (fields & GPU_FIELD_VENDOR) info->vendor = (gpu_vendor_t)reader_i32(reader);
+            if (fields & GPU_FIELD_NAME) reader_str(reader, info->name, sizeof(info->name));
+            if (fields & GPU_FIELD_UUID) reader_str(reader, info->uuid, sizeof(info->uuid));
+            if (fields & GPU_FIELD_PCI_BUS_ID) reader_str(reader, info->pci_bus_id, sizeof(info->pci_bus_id));
+            if (fields & GPU_FIELD_MEMORY_TOTAL) info->memory_total = reader_u64(reader);
+            if (fields & GPU_FIELD_MEMORY_USED) info->memory_used = reader_u64(reader);
+            if (fields & GPU_FIELD_MEMORY_FREE) info->memory_free = reader_u64(reader);
+            if (fields & GPU_FIELD_GPU_UTILIZATION) info->gpu_utilization = reader_f32(reader);
+            if (fields & GPU_FIELD_MEMORY_UTILIZATION) info->memory_utilization = reader_f32(reader);
+            if (fields & GPU_FIELD_TEMPERATURE) info->temperature = reader_f32(reader);
+            if (fields & GPU_FIELD_POWER_USAGE) info->power_usage = reader_f32(reader);
+            if (fields & GPU_FIELD_CORE_CLOCK) info->core_clock = reader_u32(reader);
+            if (fields & GPU_FIELD_MEMORY_CLOCK) info->memory_clock = reader_u32(reader);
+            if (fields & GPU_FIELD_FAN_SPEED) info->fan_speed = reader_f32(reader);
+            if (fields & GPU_FIELD_MEMORY_TEMPERATURE) info->memory_temperature = reader_f32(reader);
+            if (fields & GPU_FIELD_ENERGY) info->energy_consumption = reader_u64(reader);
+            if (fields & GPU_FIELD_PCIE_REPLAY_COUNT) info->pcie_replay_count = reader_u64(reader);
+        }
+        
+        if (keep) {
+            results[stored] = result;
+            timestamps_ms[stored] = timestamp;
+            stored++;
+        }
+    }
+    
+    *fields_out = fields;
+    *count = stored;
+    return reader->ok;
+}
+
+// ---------------------------------------------------------------------------
+// Socket helpers
+
+static bool fill_address(const char* path, struct sockaddr_un* address) {
+    if (!path || !*path || strlen(path) >= sizeof(address->sun_path)) {
+        return false;
+    }
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+static int open_socket(void) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    return fd;
+}
+
+static void set_timeout(int fd, int option, uint32_t timeout_ms) {
+    struct timeval timeout;
+    timeout.tv_sec = (time_t)(timeout_ms / 1000);
+    timeout.tv_usec = (suseconds_t)((timeout_ms % 1000) * 1000);
+    setsockopt(fd, SOL_SOCKET, option, &timeout, sizeof(timeout));
+}
+
+static bool send_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, SEND_FLAGS);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t received = recv(fd, data, length, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        length -= (size_t)received;
+    }
+    return true;
+}
+
+// Blocking read of one frame; the payload lands in frame->data
+static bool read_frame(int fd, byte_buffer_t* frame, frame_type_t* type) {
+    uint8_t header[FRAME_HEADER_BYTES];
+    if (!recv_all(fd, header, sizeof(header))) {
+        return false;
+    }
+    
+    uint32_t length;
+    uint16_t type16;
+    memcpy(&length, header, 4);
+    memcpy(&type16, header + 4, 2);
+    if (length > MAX_RESPONSE_PAYLOAD) {
+        return false;
+    }
+    
+    frame->length = 0;
+    if (!buffer_reserve(frame, length) || !recv_all(fd, frame->data, length)) {
+        return false;
+    }
+    frame->length = length;
+    *type = (frame_type_t)type16;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Server
+
+typedef struct {
+    uint32_t id;
+    gpu_field_mask_t fields;
+    uint32_t interval_ms;
+    int64_t next_due_ms;
+} subscription_t;
+
+typedef struct {
+    int fd;                     // -1 when the slot is free
+    bool greeted;
+    bool close_after;           // Close once the output is flushed
+    
+    uint8_t input[CLIENT_INPUT_BYTES];
+    size_t input_length;
+    
+    byte_buffer_t output;
+    size_t output_sent;
+    int32_t pending_gets;       // Read but not answered yet
+    
+    subscription_t subscriptions[GPU_COLLECTOR_MAX_SUBSCRIPTIONS];
+    int32_t subscription_count;
+} server_client_t;
+
+typedef struct {
+    int32_t client;
+    uint32_t request;
+    gpu_field_mask_t fields;
+} pending_get_t;
+
+typedef struct {
+    gpu_field_mask_t fields;
+    size_t offset;
+    size_t length;
+} cached_encoding_t;
+
+struct gpu_collector_server {
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    int listen_fd;
+    int wake_pipe[2];
+    bool backend_ref;
+    
+    server_client_t* clients;
+    struct pollfd* pollfds;
+    int32_t* poll_clients;      // pollfds[i] -> client slot
+    
+    pending_get_t* gets;
+    int32_t get_count;
+    int32_t get_capacity;
+    
+    // Latest collection pass and its encodings, one per distinct field mask
+    gpu_info_t infos[GPU_MAX_DEVICES];
+    gpu_error_t results[GPU_MAX_DEVICES];
+    int64_t timestamps_ms[GPU_MAX_DEVICES];
+    int32_t count;
+    byte_buffer_t encodings;
+    cached_encoding_t cached[MAX_CACHED_ENCODINGS];
+    int32_t cached_count;
+    
+    gpu_thread_t thread;
+    bool thread_started;
+};
+
+static void collect(gpu_collector_server_t* server, gpu_field_mask_t fields) {
+    if (gpu_collect_info(fields, server->infos, server->results, server->timestamps_ms,
+                         GPU_MAX_DEVICES, &server->count) != GPU_SUCCESS) {
+        server->count = 0;
+    }
+    server->encodings.length = 0;
+    server->cached_count = 0;
+}
+
+// Offset of the latest pass encoded for fields in server->encodings
+static cached_encoding_t encoding_for(gpu_collector_server_t* server, gpu_field_mask_t fields) {
+    for (int32_t i = 0; i < server->cached_count; i++) {
+        if (server->cached[i].fields == fields) {
+            return server->cached[i];
+        }
+    }
+    
+    cached_encoding_t encoding;
+    encoding.fields = fields;
+    encoding.offset = server->encodings.length;
+    encode_batch(&server->encodings, fields, server->infos, server->results,
+                 server->timestamps_ms, server->count);
+    encoding.length = server->encodings.length - encoding.offset;
+    
+    if (server->cached_count < MAX_CACHED_ENCODINGS) {
+        server->cached[server->cached_count++] = encoding;
+    }
+    return encoding;
+}
+
+static size_t client_backlog(const server_client_t* client) {
+    return client->output.length - client->output_sent;
+}
+
+// A client that does not read its replies, or pipelines more requests than
+// one pass answers, is not read from until it catches up; requests wait in
+// its socket instead of as queued replies here
+static bool client_throttled(const server_client_t* client) {
+    return client_backlog(client) >= GPU_COLLECTOR_MAX_BACKLOG || client->pending_gets >= MAX_PENDING_GETS;
+}
+
+static void queue_batch(gpu_collector_server_t* server, server_client_t* client, frame_type_t type,
+                        uint32_t id, gpu_field_mask_t fields) {
+    cached_encoding_t encoding = encoding_for(server, fields);
+    if (server->encodings.failed) {
+        return;
+    }
+    buffer_frame_header(&client->output, type, (uint32_t)(4 + encoding.length));
+    buffer_u32(&client->output, id);
+    buffer_append(&client->output, server->encodings.data + encoding.offset, encoding.length);
+}
+
+static void queue_error(server_client_t* client, uint32_t id, gpu_error_t error) {
+    buffer_frame_header(&client->output, FRAME_ERROR, 8);
+    buffer_u32(&client->output, id);
+    buffer_i32(&client->output, (int32_t)error);
+}
+
+static void close_client(server_client_t* client) {
+    if (client->fd < 0) {
+        return;
+    }
+    close(client->fd);
+    client->fd = -1;
+    buffer_free(&client->output);
+}
+
+// Send what the socket takes; returns false if the client has to go
+static bool flush_client(server_client_t* client) {
+    if (client->output.failed) {
+        return false;
+    }
+    
+    while (client->output_sent < client->output.length) {
+        ssize_t sent = send(client->fd, client->output.data + client->output_sent,
+                            client->output.length - client->output_sent, SEND_FLAGS);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client->output_sent += (size_t)sent;
+    }
+    
+    client->output.length = 0;
+    client->output_sent = 0;
+    return !client->close_after;
+}
+
+static subscription_t* find_subscription(server_client_t* client, uint32_t id) {
+    for (int32_t i = 0; i < client->subscription_count; i++) {
+        if (client->subscriptions[i].id == id) {
+            return &client->subscriptions[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns false on a protocol error
+static bool handle_frame(gpu_collector_server_t* server, int32_t slot, frame_type_t type,
+                         byte_reader_t* payload) {
+    server_client_t* client = &server->clients[slot];
+    
+    if (!client->greeted) {
+        uint32_t magic = reader_u32(payload);
+        uint32_t version = reader_u32(payload);
+        if (type != FRAME_HELLO || !payload->ok || magic != GPU_COLLECTOR_MAGIC) {
+            return false;
+        }
+        if (version != GPU_COLLECTOR_VERSION) {
+            queue_error(client, 0, GPU_ERROR_NOT_SUPPORTED);
+            client->close_after = true;
+            return true;
+        }
+        
+        client->greeted = true;
+        buffer_frame_header(&client->output, FRAME_WELCOME, 8);
+        buffer_u32(&client->output, GPU_COLLECTOR_MAGIC);
+        buffer_u32(&client->output, GPU_COLLECTOR_VERSION);
+        return true;
+    }
+    
+    switch (type) {
+        case FRAME_GET: {
+            uint32_t request = reader_u32(payload);
+            gpu_field_mask_t fields = reader_u32(payload) & GPU_FIELD_ALL;
+            if (!payload->ok) {
+                return false;
+            }
+            
+            // Served together with every other request read this iteration
+            if (server->get_count == server->get_capacity) {
+                int32_t capacity = server->get_capacity ? server->get_capacity * 2 : 16;
+                pending_get_t* gets = (pending_get_t*)realloc(server->gets, sizeof(pending_get_t) * (size_t)capacity);
+                if (!gets) {
+                    queue_error(client, request, GPU_ERROR_API_FAILED);
+                    return true;
+                }
+                server->gets = gets;
+                server->get_capacity = capacity;
+            }
+            server->gets[server->get_count].client = slot;
+            server->gets[server->get_count].request = request;
+            server->gets[server->get_count].fields = fields;
+            server->get_count++;
+            client->pending_gets++;
+            return true;
+        }
+        
+        case FRAME_SUBSCRIBE: {
+            uint32_t id = reader_u32(payload);
+            gpu_field_mask_t fields = reader_u32(payload) & GPU_FIELD_ALL;
+            uint32_t interval_ms = reader_u32(payload);
+            if (!payload->ok) {
+                return false;
+            }
+            
+            subscription_t* subscription = find_subscription(client, id);
+            if (!subscription && client->subscription_count < GPU_COLLECTOR_MAX_SUBSCRIPTIONS) {
+                subscription = &client->subscriptions[client->subscription_count++];
+            }
+            if (!subscription || interval_ms == 0) {
+                queue_error(client, id, GPU_ERROR_INVALID_PARAM);
+                return true;
+            }
+            
+            subscription->id = id;
+            subscription->fields = fields;
+            subscription->interval_ms = interval_ms;
+            subscription->next_due_ms = gpu_monotonic_ms();
+            return true;
+        }
+        
+        case FRAME_UNSUBSCRIBE: {
+            uint32_t id = reader_u32(payload);
+            if (!payload->ok) {
+                return false;
+            }
+            
+            subscription_t* subscription = find_subscription(client, id);
+            if (subscription) {
+                *subscription = client->subscriptions[--client->subscription_count];
+            }
+            return true;
+        }
+        
+        default:
+            return false;
+    }
+}
+
+// Read and handle whatever the client sent; returns false if it has to go
+static bool read_client(gpu_collector_server_t* server, int32_t slot) {
+    server_client_t* client = &server->clients[slot];
+    
+    // Frames already buffered are still handled, so a throttled client is
+    // over the limits by at most one input buffer of requests
+    while (!client_throttled(client)) {
+        size_t space = sizeof(client->input) - client->input_length;
+        ssize_t received = recv(client->fd, client->input + client->input_length, space, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        client->input_length += (size_t)received;
+        
+        size_t consumed = 0;
+        while (client->input_length - consumed >= FRAME_HEADER_BYTES && !client->close_after) {
+            const uint8_t* frame = client->input + consumed;
+            uint32_t length;
+            uint16_t type;
+            memcpy(&length, frame, 4);
+            memcpy(&type, frame + 4, 2);
+            if (length > MAX_REQUEST_PAYLOAD) {
+                return false;
+            }
+            if (client->input_length - consumed < FRAME_HEADER_BYTES + length) {
+                break;
+            }
+            
+            byte_reader_t payload = { frame + FRAME_HEADER_BYTES, length, true };
+            if (!handle_frame(server, slot, (frame_type_t)type, &payload)) {
+                return false;
+            }
+            consumed += FRAME_HEADER_BYTES + length;
+        }
+        
+        memmove(client->input, client->input + consumed, client->input_length - consumed);
+        client->input_length -= consumed;
+        if (client->close_after) {
+            client->input_length = 0;
+        }
+    }
+    return true;
+}
+
+static void accept_clients(gpu_collector_server_t* server) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+        
+        int32_t slot = -1;
+        for (int32_t i = 0; i < GPU_COLLECTOR_MAX_CLIENTS; i++) {
+            if (server->clients[i].fd < 0) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            close(fd);
+            continue;
+        }
+        
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        server_client_t* client = &server->clients[slot];
+        memset(client, 0, sizeof(*client));
+        client->fd = fd;
+    }
+}
+
+static void serve_gets(gpu_collector_server_t* server) {
+    if (server->get_count == 0) {
+        return;
+    }
+    
+    gpu_field_mask_t fields = 0;
+    for (int32_t i = 0; i < server->get_count; i++) {
+        fields |= server->gets[i].fields;
+    }
+    collect(server, fields);
+    
+    for (int32_t i = 0; i < server->get_count; i++) {
+        server_client_t* client = &server->clients[server->gets[i].client];
+        client->pending_gets = 0;
+        if (client->fd >= 0) {
+            queue_batch(server, client, FRAME_REPLY, server->gets[i].request, server->gets[i].fields);
+        }
+    }
+    server->get_count = 0;
+}
+
+// Serve every subscription that is due; returns ms until the next one is
+// (-1 if there are none)
+static int serve_subscriptions(gpu_collector_server_t* server) {
+    int64_t now = gpu_monotonic_ms();
+    gpu_field_mask_t fields = 0;
+    bool due = false;
+    
+    for (int32_t c = 0; c < GPU_COLLECTOR_MAX_CLIENTS; c++) {
+        server_client_t* client = &server->clients[c];
+        for (int32_t s = 0; client->fd >= 0 && s < client->subscription_count; s++) {
+            if (client->subscriptions[s].next_due_ms <= now) {
+                fields |= client->subscriptions[s].fields;
+                due = true;
+            }
+        }
+    }
+    
+    if (due) {
+        collect(server, fields);
+        now = gpu_monotonic_ms();
+    }
+    
+    int64_t next = -1;
+    for (int32_t c = 0; c < GPU_COLLECTOR_MAX_CLIENTS; c++) {
+        server_client_t* client = &server->clients[c];
+        for (int32_t s = 0; client->fd >= 0 && s < client->subscription_count; s++) {
+            subscription_t* subscription = &client->subscriptions[s];
+            
+            if (due && subscription->next_due_ms <= now) {
+                // Fixed-rate schedule that skips missed ticks instead of
+                // bursting
+                subscription->next_due_ms += subscription->interval_ms;
+                if (subscription->next_due_ms < now) {
+                    subscription->next_due_ms = now + subscription->interval_ms;
+                }
+                
+                // A client that stopped reading misses events rather than
+                // growing its backlog without bound
+                if (client_backlog(client) < GPU_COLLECTOR_MAX_BACKLOG) {
+                    queue_batch(server, client, FRAME_EVENT, subscription->id, subscription->fields);
+                }
+            }
+            
+            if (next < 0 || subscription->next_due_ms < next) {
+                next = subscription->next_due_ms;
+            }
+        }
+    }
+    
+    if (next < 0) {
+        return -1;
+    }
+    now = gpu_monotonic_ms();
+    return next <= now ? 0 : (int)(next - now);
+}
+
+static void server_thread(void* arg) {
+    gpu_collector_server_t* server = (gpu_collector_server_t*)arg;
+    int timeout = -1;
+    
+    for (;;) {
+        nfds_t count = 0;
+        server->pollfds[count].fd = server->wake_pipe[0];
+        server->pollfds[count++].events = POLLIN;
+        server->pollfds[count].fd = server->listen_fd;
+        server->pollfds[count++].events = POLLIN;
+        for (int32_t i = 0; i < GPU_COLLECTOR_MAX_CLIENTS; i++) {
+            server_client_t* client = &server->clients[i];
+            if (client->fd >= 0) {
+                server->pollfds[count].fd = client->fd;
+                server->pollfds[count].events = (short)((client_throttled(client) ? 0 : POLLIN) |
+                                                        (client_backlog(client) ? POLLOUT : 0));
+                server->poll_clients[count++] = i;
+            }
+        }
+        
+        int ready = poll(server->pollfds, count, timeout);
+        if (ready < 0 && errno != EINTR) {
+            return;
+        }
+        
+        if (ready > 0) {
+            if (server->pollfds[0].revents) {
+                return;
+            }
+            if (server->pollfds[1].revents & POLLIN) {
+                accept_clients(server);
+            }
+            
+            for (nfds_t i = 2; i < count; i++) {
+                short revents = server->pollfds[i].revents;
+                int32_t slot = server->poll_clients[i];
+                if (!revents || server->clients[slot].fd < 0) {
+                    continue;
+                }
+                
+                bool keep = true;
+                if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                    keep = read_client(server, slot);
+                }
+                if (keep && (revents & POLLOUT)) {
+                    keep = flush_client(&server->clients[slot]);
+                }
+                if (!keep) {
+                    close_client(&server->clients[slot]);
+                }
+            }
+        }
+        
+        serve_gets(server);
+        timeout = serve_subscriptions(server);
+        
+        // Everything queued for a client this iteration goes out in one send
+        for (int32_t i = 0; i < GPU_COLLECTOR_MAX_CLIENTS; i++) {
+            server_client_t* client = &server->clients[i];
+            if (client->fd >= 0 && (client->output.failed ||
+                                    (client_backlog(client) && !flush_client(client)))) {
+                close_client(client);
+            }
+        }
+    }
+}
+
+static void server_free(gpu_collector_server_t* server) {
+    if (server->clients) {
+        for (int32_t i = 0; i < GPU_COLLECTOR_MAX_CLIENTS; i++) {
+            close_client(&server->clients[i]);
+        }
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        unlink(server->path);
+    }
+    if (server->wake_pipe[0] >= 0) {
+        close(server->wake_pipe[0]);
+        close(server->wake_pipe[1]);
+    }
+    if (server->backend_ref) {
+        gpu_info_cleanup();
+    }
+    buffer_free(&server->encodings);
+    free(server->gets);
+    free(server->clients);
+    free(server->pollfds);
+    free(server->poll_clients);
+    free(server);
+}
+
+// Bind socket_path, replacing a socket file nobody listens on any more
+static gpu_error_t open_listener(gpu_collector_server_t* server) {
+    struct sockaddr_un address;
+    if (!fill_address(server->path, &address)) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    int fd = open_socket();
+    if (fd < 0) {
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        if (errno != EADDRINUSE) {
+            gpu_error_t result = errno == EACCES ? GPU_ERROR_ACCESS_DENIED : GPU_ERROR_API_FAILED;
+            close(fd);
+            return result;
+        }
+        
+        int probe = open_socket();
+        bool live = probe >= 0 && connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (live) {
+            close(fd);
+            return GPU_ERROR_ACCESS_DENIED;
+        }
+        
+        unlink(server->path);
+        if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+            close(fd);
+            return GPU_ERROR_API_FAILED;
+        }
+    }
+    
+    if (listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        unlink(server->path);
+        return GPU_ERROR_API_FAILED;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    server->listen_fd = fd;
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_collector_server_start(const char* socket_path, gpu_collector_server_t** server_out) {
+    struct sockaddr_un address;
+    if (!server_out || !fill_address(socket_path, &address)) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_collector_server_t* server = (gpu_collector_server_t*)calloc(1, sizeof(gpu_collector_server_t));
+    if (!server) {
+        return GPU_ERROR_API_FAILED;
+    }
+    strcpy(server->path, socket_path);
+    server->listen_fd = -1;
+    server->wake_pipe[0] = server->wake_pipe[1] = -1;
+    
+    server->clients = (server_client_t*)calloc(GPU_COLLECTOR_MAX_CLIENTS, sizeof(server_client_t));
+    server->pollfds = (struct pollfd*)calloc(GPU_COLLECTOR_MAX_CLIENTS + 2, sizeof(struct pollfd));
+    server->poll_clients = (int32_t*)calloc(GPU_COLLECTOR_MAX_CLIENTS + 2, sizeof(int32_t));
+    if (!server->clients || !server->pollfds || !server->poll_clients) {
+        server_free(server);
+        return GPU_ERROR_API_FAILED;
+    }
+    for (int32_t i = 0; i < GPU_COLLECTOR_MAX_CLIENTS; i++) {
+        server->clients[i].fd = -1;
+    }
+    
+    if (pipe(server->wake_pipe) != 0) {
+        server->wake_pipe[0] = server->wake_pipe[1] = -1;
+        server_free(server);
+        return GPU_ERROR_API_FAILED;
+    }
+    fcntl(server->wake_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(server->wake_pipe[1], F_SETFD, FD_CLOEXEC);
+    
+    gpu_error_t result = open_listener(server);
+    if (result != GPU_SUCCESS) {
+        server_free(server);
+        return result;
+    }
+    
+    server->backend_ref = gpu_info_init() == GPU_SUCCESS;
+    
+    if (gpu_thread_create(&server->thread, server_thread, server) != 0) {
+        server_free(server);
+        return GPU_ERROR_API_FAILED;
+    }
+    server->thread_started = true;
+    
+    *server_out = server;
+    return GPU_SUCCESS;
+}
+
+void gpu_collector_server_stop(gpu_collector_server_t* server) {
+    if (!server) {
+        return;
+    }
+    
+    if (server->thread_started) {
+        char byte = 0;
+        ssize_t ignored = write(server->wake_pipe[1], &byte, 1);
+        (void)ignored;
+        gpu_thread_join(server->thread);
+    }
+    server_free(server);
+}
+
+// ---------------------------------------------------------------------------
+// Client
+
+typedef struct pending_request {
+    uint32_t id;
+    gpu_info_t* infos;
+    gpu_error_t* results;
+    int64_t* timestamps_ms;
+    int32_t max_count;
+    int32_t count;
+    gpu_error_t result;
+    bool done;
+    struct pending_request* next;
+} pending_request_t;
+
+typedef struct {
+    uint32_t id;
+    gpu_field_mask_t fields;
+    uint32_t interval_ms;
+} client_subscription_t;
+
+struct gpu_collector_client {
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    gpu_collector_event_t on_event;
+    void* ctx;
+    
+    // Lock order: write_lock, then lock. fd only changes with both held.
+    gpu_mutex_t write_lock;     // Serializes outgoing frames
+    gpu_mutex_t lock;
+    gpu_cond_t cond;            // Replies, disconnects and shutdown
+    int fd;                     // -1 while disconnected
+    bool stopping;
+    int32_t users;              // Requests in flight
+    uint32_t next_request;
+    pending_request_t* pending;
+    client_subscription_t subscriptions[GPU_COLLECTOR_MAX_SUBSCRIPTIONS];
+    int32_t subscription_count;
+    
+    gpu_thread_t thread;
+    bool thread_started;
+    
+    // Reader thread only
+    byte_buffer_t frame;
+    gpu_info_t infos[GPU_MAX_DEVICES];
+    gpu_error_t results[GPU_MAX_DEVICES];
+    int64_t timestamps_ms[GPU_MAX_DEVICES];
+};
+
+static void frame_u32s(byte_buffer_t* buffer, frame_type_t type, const uint32_t* values, int32_t count) {
+    buffer_frame_header(buffer, type, (uint32_t)(count * 4));
+    for (int32_t i = 0; i < count; i++) {
+        buffer_u32(buffer, values[i]);
+    }
+}
+
+// Connect and handshake; *fd_out is a blocking socket ready for frames
+static gpu_error_t open_connection(const char* path, int* fd_out) {
+    struct sockaddr_un address;
+    if (!fill_address(path, &address)) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    int fd = open_socket();
+    if (fd < 0) {
+        return GPU_ERROR_API_FAILED;
+    }
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        gpu_error_t result = errno == EACCES ? GPU_ERROR_ACCESS_DENIED :
+                             (errno == ENOENT || errno == ECONNREFUSED) ? GPU_ERROR_NO_GPU :
+                             GPU_ERROR_API_FAILED;
+        close(fd);
+        return result;
+    }
+    
+    // A wedged server must not hang the caller
+    set_timeout(fd, SO_RCVTIMEO, HANDSHAKE_TIMEOUT_MS);
+    set_timeout(fd, SO_SNDTIMEO, HANDSHAKE_TIMEOUT_MS);
+    
+    byte_buffer_t buffer = { NULL, 0, 0, false };
+    uint32_t hello[2] = { GPU_COLLECTOR_MAGIC, GPU_COLLECTOR_VERSION };
+    frame_u32s(&buffer, FRAME_HELLO, hello, 2);
+    
+    frame_type_t type = FRAME_ERROR;
+    bool ok = !buffer.failed && send_all(fd, buffer.data, buffer.length) &&
+              read_frame(fd, &buffer, &type);
+    
+    gpu_error_t result = GPU_ERROR_API_FAILED;
+    if (ok && type == FRAME_WELCOME) {
+        byte_reader_t reader = { buffer.data, buffer.length, true };
+        uint32_t magic = reader_u32(&reader);
+        uint32_t version = reader_u32(&reader);
+        if (reader.ok && magic == GPU_COLLECTOR_MAGIC && version == GPU_COLLECTOR_VERSION) {
+            result = GPU_SUCCESS;
+        }
+    } else if (ok && type == FRAME_ERROR) {
+        result = GPU_ERROR_NOT_SUPPORTED;
+    }
+    buffer_free(&buffer);
+    
+    if (result != GPU_SUCCESS) {
+        close(fd);
+        return result;
+    }
+    
+    // The reader blocks until the server says something; sends stay bounded
+    set_timeout(fd, SO_RCVTIMEO, 0);
+    *fd_out = fd;
+    return GPU_SUCCESS;
+}
+
+// Send one frame; a failed send shuts the socket down so the reader thread
+// notices and reconnects
+static bool send_frame(gpu_collector_client_t* client, const byte_buffer_t* frame) {
+    if (frame->failed) {
+        return false;
+    }
+    
+    gpu_mutex_lock(&client->write_lock);
+    int fd = client->fd;
+    bool ok = fd >= 0 && send_all(fd, frame->data, frame->length);
+    if (!ok && fd >= 0) {
+        shutdown(fd, SHUT_RDWR);
+    }
+    gpu_mutex_unlock(&client->write_lock);
+    return ok;
+}
+
+static void send_u32s(gpu_collector_client_t* client, frame_type_t type, const uint32_t* values,
+                      int32_t count, bool* sent) {
+    byte_buffer_t frame = { NULL, 0, 0, false };
+    frame_u32s(&frame, type, values, count);
+    bool ok = send_frame(client, &frame);
+    buffer_free(&frame);
+    if (sent) {
+        *sent = ok;
+    }
+}
+
+static void drop_connection(gpu_collector_client_t* client) {
+    gpu_mutex_lock(&client->write_lock);
+    gpu_mutex_lock(&client->lock);
+    
+    if (client->fd >= 0) {
+        close(client->fd);
+        client->fd = -1;
+    }
+    for (pending_request_t* request = client->pending; request; request = request->next) {
+        if (!request->done) {
+            request->done = true;
+            request->result = GPU_ERROR_API_FAILED;
+        }
+    }
+    gpu_cond_broadcast(&client->cond);
+    
+    gpu_mutex_unlock(&client->lock);
+    gpu_mutex_unlock(&client->write_lock);
+}
+
+static void try_reconnect(gpu_collector_client_t* client) {
+    int fd = -1;
+    if (open_connection(client->path, &fd) != GPU_SUCCESS) {
+        gpu_mutex_lock(&client->lock);
+        if (!client->stopping) {
+            gpu_cond_timedwait(&client->cond, &client->lock, GPU_COLLECTOR_RECONNECT_MS);
+        }
+        gpu_mutex_unlock(&client->lock);
+        return;
+    }
+    
+    // Holding write_lock keeps new frames behind the replayed subscriptions
+    gpu_mutex_lock(&client->write_lock);
+    gpu_mutex_lock(&client->lock);
+    if (client->stopping) {
+        gpu_mutex_unlock(&client->lock);
+        gpu_mutex_unlock(&client->write_lock);
+        close(fd);
+        return;
+    }
+    client->fd = fd;
+    
+    byte_buffer_t frames = { NULL, 0, 0, false };
+    for (int32_t i = 0; i < client->subscription_count; i++) {
+        uint32_t values[3] = { client->subscriptions[i].id, client->subscriptions[i].fields,
+                               client->subscriptions[i].interval_ms };
+        frame_u32s(&frames, FRAME_SUBSCRIBE, values, 3);
+    }
+    gpu_mutex_unlock(&client->lock);
+    
+    if (frames.length > 0 && (frames.failed || !send_all(fd, frames.data, frames.length))) {
+        shutdown(fd, SHUT_RDWR);
+    }
+    gpu_mutex_unlock(&client->write_lock);
+    buffer_free(&frames);
+}
+
+static void dispatch_frame(gpu_collector_client_t* client, frame_type_t type) {
+    byte_reader_t reader = { client->frame.data, client->frame.length, true };
+    uint32_t id = reader_u32(&reader);
+    
+    if (type == FRAME_REPLY || type == FRAME_ERROR) {
+        gpu_mutex_lock(&client->lock);
+        pending_request_t* request = client->pending;
+        while (request && (request->id != id || request->done)) {
+            request = request->next;
+        }
+        if (request) {
+            if (type == FRAME_REPLY) {
+                gpu_field_mask_t fields;
+                bool ok = decode_batch(&reader, &fields, request->infos, request->results,
+                                       request->timestamps_ms, request->max_count, &request->count);
+                request->result = ok ? GPU_SUCCESS : GPU_ERROR_API_FAILED;
+            } else {
+                request->result = (gpu_error_t)reader_i32(&reader);
+            }
+            request->done = true;
+            gpu_cond_broadcast(&client->cond);
+        }
+        gpu_mutex_unlock(&client->lock);
+        return;
+    }
+    
+    if (type == FRAME_EVENT && client->on_event) {
+        gpu_field_mask_t fields;
+        int32_t count = 0;
+        if (decode_batch(&reader, &fields, client->infos, client->results, client->timestamps_ms,
+                         GPU_MAX_DEVICES, &count)) {
+            client->on_event(id, fields, client->infos, client->results, client->timestamps_ms,
+                             count, client->ctx);
+        }
+    }
+}
+
+static void client_thread(void* arg) {
+    gpu_collector_client_t* client = (gpu_collector_client_t*)arg;
+    
+    for (;;) {
+        gpu_mutex_lock(&client->lock);
+        bool stopping = client->stopping;
+        int fd = client->fd;
+        gpu_mutex_unlock(&client->lock);
+        
+        if (stopping) {
+            break;
+        }
+        if (fd < 0) {
+            try_reconnect(client);
+            continue;
+        }
+        
+        frame_type_t type;
+        if (!read_frame(fd, &client->frame, &type)) {
+            drop_connection(client);
+            continue;
+        }
+        dispatch_frame(client, type);
+    }
+    
+    drop_connection(client);
+}
+
+gpu_error_t gpu_collector_connect(const char* socket_path, gpu_collector_event_t on_event,
+                                  void* ctx, gpu_collector_client_t** client_out) {
+    struct sockaddr_un address;
+    if (!client_out || !fill_address(socket_path, &address)) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_collector_client_t* client = (gpu_collector_client_t*)calloc(1, sizeof(gpu_collector_client_t));
+    if (!client) {
+        return GPU_ERROR_API_FAILED;
+    }
+    strcpy(client->path, socket_path);
+    client->on_event = on_event;
+    client->ctx = ctx;
+    client->next_request = 1;
+    gpu_mutex_init(&client->write_lock);
+    gpu_mutex_init(&client->lock);
+    gpu_cond_init(&client->cond);
+    
+    gpu_error_t result = open_connection(client->path, &client->fd);
+    if (result == GPU_SUCCESS && gpu_thread_create(&client->thread, client_thread, client) != 0) {
+        close(client->fd);
+        result = GPU_ERROR_API_FAILED;
+    }
+    if (result != GPU_SUCCESS) {
+        gpu_cond_destroy(&client->cond);
+        gpu_mutex_destroy(&client->lock);
+        gpu_mutex_destroy(&client->write_lock);
+        free(client);
+        return result;
+    }
+    client->thread_started = true;
+    
+    *client_out = client;
+    return GPU_SUCCESS;
+}
+
+void gpu_collector_close(gpu_collector_client_t* client) {
+    if (!client) {
+        return;
+    }
+    
+    gpu_mutex_lock(&client->lock);
+    bool started = client->thread_started;
+    client->thread_started = false;
+    client->stopping = true;
+    gpu_cond_broadcast(&client->cond);
+    gpu_mutex_unlock(&client->lock);
+    
+    if (!started) {
+        return;
+    }
+    
+    // Unblocks the reader's recv(); the reader closes the socket itself
+    gpu_mutex_lock(&client->write_lock);
+    if (client->fd >= 0) {
+        shutdown(client->fd, SHUT_RDWR);
+    }
+    gpu_mutex_unlock(&client->write_lock);
+    gpu_thread_join(client->thread);
+    
+    gpu_mutex_lock(&client->lock);
+    while (client->users > 0) {
+        gpu_cond_wait(&client->cond, &client->lock);
+    }
+    gpu_mutex_unlock(&client->lock);
+}
+
+void gpu_collector_destroy(gpu_collector_client_t* client) {
+    if (!client) {
+        return;
+    }
+    
+    gpu_collector_close(client);
+    buffer_free(&client->frame);
+    gpu_cond_destroy(&client->cond);
+    gpu_mutex_destroy(&client->lock);
+    gpu_mutex_destroy(&client->write_lock);
+    free(client);
+}
+
+bool gpu_collector_connected(gpu_collector_client_t* client) {
+    if (!client) {
+        return false;
+    }
+    
+    gpu_mutex_lock(&client->lock);
+    bool connected = client->fd >= 0 && !client->stopping;
+    gpu_mutex_unlock(&client->lock);
+    return connected;
+}
+
+gpu_error_t gpu_collector_get(gpu_collector_client_t* client, gpu_field_mask_t fields,
+                              gpu_info_t* infos, gpu_error_t* results, int64_t* timestamps_ms,
+                              int32_t max_count, int32_t* count, uint32_t timeout_ms) {
+    if (!client || !infos || !results || !timestamps_ms || !count || max_count < 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    *count = 0;
+    
+    pending_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.infos = infos;
+    request.results = results;
+    request.timestamps_ms = timestamps_ms;
+    request.max_count = max_count;
+    request.result = GPU_ERROR_API_FAILED;
+    
+    gpu_mutex_lock(&client->lock);
+    if (client->stopping || client->fd < 0) {
+        gpu_mutex_unlock(&client->lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    request.id = client->next_request++;
+    request.next = client->pending;
+    client->pending = &request;
+    client->users++;
+    gpu_mutex_unlock(&client->lock);
+    
+    uint32_t values[2] = { request.id, fields };
+    bool sent = false;
+    send_u32s(client, FRAME_GET, values, 2, &sent);
+    
+    gpu_mutex_lock(&client->lock);
+    int64_t deadline = gpu_monotonic_ms() + timeout_ms;
+    while (sent && !request.done && !client->stopping) {
+        int64_t remaining = deadline - gpu_monotonic_ms();
+        if (remaining <= 0) {
+            break;
+        }
+        gpu_cond_timedwait(&client->cond, &client->lock, (uint32_t)remaining);
+    }
+    
+    gpu_error_t result = request.done ? request.result : GPU_ERROR_API_FAILED;
+    pending_request_t** link = &client->pending;
+    while (*link != &request) {
+        link = &(*link)->next;
+    }
+    *link = request.next;
+    if (--client->users == 0 && client->stopping) {
+        gpu_cond_broadcast(&client->cond);
+    }
+    gpu_mutex_unlock(&client->lock);
+    
+    if (result == GPU_SUCCESS) {
+        *count = request.count;
+    }
+    return result;
+}
+
+gpu_error_t gpu_collector_subscribe(gpu_collector_client_t* client, uint32_t subscription,
+                                    gpu_field_mask_t fields, uint32_t interval_ms) {
+    if (!client || interval_ms == 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    fields &= GPU_FIELD_ALL;
+    
+    gpu_mutex_lock(&client->lock);
+    if (client->stopping) {
+        gpu_mutex_unlock(&client->lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    client_subscription_t* entry = NULL;
+    for (int32_t i = 0; i < client->subscription_count; i++) {
+        if (client->subscriptions[i].id == subscription) {
+            entry = &client->subscriptions[i];
+        }
+    }
+    if (!entry && client->subscription_count < GPU_COLLECTOR_MAX_SUBSCRIPTIONS) {
+        entry = &client->subscriptions[client->subscription_count++];
+    }
+    if (!entry) {
+        gpu_mutex_unlock(&client->lock);
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    entry->id = subscription;
+    entry->fields = fields;
+    entry->interval_ms = interval_ms;
+    gpu_mutex_unlock(&client->lock);
+    
+    // While disconnected, the reader thread sends it on reconnect
+    uint32_t values[3] = { subscription, fields, interval_ms };
+    send_u32s(client, FRAME_SUBSCRIBE, values, 3, NULL);
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_collector_unsubscribe(gpu_collector_client_t* client, uint32_t subscription) {
+    if (!client) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&client->lock);
+    for (int32_t i = 0; i < client->subscription_count; i++) {
+        if (client->subscriptions[i].id == subscription) {
+            client->subscriptions[i] = client->subscriptions[--client->subscription_count];
+            break;
+        }
+    }
+    gpu_mutex_unlock(&client->lock);
+    
+    send_u32s(client, FRAME_UNSUBSCRIBE, &subscription, 1, NULL);
+    return GPU_SUCCESS;
+}
+
+#else
+
+gpu_error_t gpu_collector_server_start(const char* socket_path, gpu_collector_server_t** server) {
+    (void)socket_path;
+    (void)server;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+void gpu_collector_server_stop(gpu_collector_server_t* server) {
+    (void)server;
+}
+
+gpu_error_t gpu_collector_connect(const char* socket_path, gpu_collector_event_t on_event,
+                                  void* ctx, gpu_collector_client_t** client) {
+    (void)socket_path;
+    (void)on_event;
+    (void)ctx;
+    (void)client;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+void gpu_collector_close(gpu_collector_client_t* client) {
+    (void)client;
+}
+
+void gpu_collector_destroy(gpu_collector_client_t* client) {
+    (void)client;
+}
+
+bool gpu_collector_connected(gpu_collector_client_t* client) {
+    (void)client;
+    return false;
+}
+
+gpu_error_t gpu_collector_get(gpu_collector_client_t* client, gpu_field_mask_t fields,
+                              gpu_info_t* infos, gpu_error_t* results, int64_t* timestamps_ms,
+                              int32_t max_count, int32_t* count, uint32_t timeout_ms) {
+    (void)client;
+    (void)fields;
+    (void)infos;
+    (void)results;
+    (void)timestamps_ms;
+    (void)max_count;
+    (void)timeout_ms;
+    if (count) {
+        *count = 0;
+    }
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+gpu_error_t gpu_collector_subscribe(gpu_collector_client_t* client, uint32_t subscription,
+                                    gpu_field_mask_t fields, uint32_t interval_ms) {
+    (void)client;
+    (void)subscription;
+    (void)fields;
+    (void)interval_ms;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+gpu_error_t gpu_collector_unsubscribe(gpu_collector_client_t* client, uint32_t subscription) {
+    (void)client;
+    (void)subscription;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef GPU_COLLECTOR_H
+#define GPU_COLLECTOR_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Collector daemon over a Unix domain socket. One process runs the server and
+// is the only one that talks to the drivers; any number of clients connect
+// and request collections or subscribe to periodic ones. The server collects
+// once per tick for all subscriptions that are due (the union of their field
+// masks) and once per batch of concurrent requests, encodes each distinct
+// field mask once, and writes every client's frames for the tick in a single
+// send.
+//
+// Wire format, host byte order (both ends are on the same host). Every frame
+// starts with an 8-byte header:
+//   uint32 payload bytes, uint16 type, uint16 reserved (0)
+//
+// Client -> server:
+//   HELLO        uint32 magic GPU_COLLECTOR_MAGIC, uint32 version
+//   GET          uint32 request id, uint32 fields
+//   SUBSCRIBE    uint32 subscription id (client chosen), uint32 fields,
+//                uint32 interval ms (resubscribing an id replaces it)
+//   UNSUBSCRIBE  uint32 subscription id
+// Server -> client:
+//   WELCOME      uint32 magic, uint32 version
+//   REPLY        uint32 request id, batch
+//   EVENT        uint32 subscription id, batch
+//   ERROR        uint32 request or subscription id, int32 gpu_error_t
+//
+// A batch is uint32 fields, uint32 count and count entries of
+//   int32 index, int32 result, int64 timestamp ms
+// followed, when result is GPU_SUCCESS, by the requested fields in
+// gpu_field_t bit order: vendor int32, strings uint16 length + bytes,
+// memory uint64, utilization/temperature/power/fan float32, clocks uint32,
+// memory temperature float32, energy and PCIe replays uint64.
+//
+// The first frame on a connection must be HELLO; the server answers WELCOME
+// or ERROR and closes on a version mismatch or any malformed frame. Events
+// for a client whose unsent output exceeds GPU_COLLECTOR_MAX_BACKLOG bytes
+// are dropped until it catches up, and its requests are not read meanwhile.
+//
+// POSIX only; on Windows every function returns GPU_ERROR_NOT_SUPPORTED.
+#define GPU_COLLECTOR_MAGIC 0x43555047u     // "GPUC"
+#define GPU_COLLECTOR_VERSION 1
+#define GPU_COLLECTOR_MAX_CLIENTS 256
+#define GPU_COLLECTOR_MAX_SUBSCRIPTIONS 64  // Per client
+#define GPU_COLLECTOR_MAX_BACKLOG (4 * 1024 * 1024)
+
+typedef struct gpu_collector_server gpu_collector_server_t;
+typedef struct gpu_collector_client gpu_collector_client_t;
+
+// Server: listen on socket_path and serve from a native thread. A stale
+// socket file left by a dead server is replaced; a live one is not
+// (GPU_ERROR_ACCESS_DENIED). Holds a gpu_info_init() reference while running.
+gpu_error_t gpu_collector_server_start(const char* socket_path, gpu_collector_server_t** server);
+
+// Disconnect every client, join the server thread and remove the socket file
+void gpu_collector_server_stop(gpu_collector_server_t* server);
+
+// Called on the client's reader thread for every EVENT; the arrays are only
+// valid for the duration of the call. Events for a subscription may still
+// arrive shortly after gpu_collector_unsubscribe() returns.
+typedef void (*gpu_collector_event_t)(uint32_t subscription, gpu_field_mask_t fields,
+                                      const gpu_info_t* infos, const gpu_error_t* results,
+                                      const int64_t* timestamps_ms, int32_t count, void* ctx);
+
+// Client: connect and handshake, then start the reader thread. If the
+// connection drops, the reader thread reconnects every
+// GPU_COLLECTOR_RECONNECT_MS and re-sends every subscription; requests made
+// while disconnected fail with GPU_ERROR_API_FAILED.
+#define GPU_COLLECTOR_RECONNECT_MS 1000
+
+gpu_error_t gpu_collector_connect(const char* socket_path, gpu_collector_event_t on_event,
+                                  void* ctx, gpu_collector_client_t** client);
+
+// Stop the reader thread and close the socket; no event is delivered after
+// this returns. Requests in flight fail. The client stays valid (and every
+// call fails) until gpu_collector_destroy().
+void gpu_collector_close(gpu_collector_client_t* client);
+void gpu_collector_destroy(gpu_collector_client_t* client);
+
+bool gpu_collector_connected(gpu_collector_client_t* client);
+
+// Collect every GPU on the server, like gpu_collect_info(). Thread-safe;
+// concurrent requests are pipelined over the one connection.
+gpu_error_t gpu_collector_get(gpu_collector_client_t* client, gpu_field_mask_t fields,
+                              gpu_info_t* infos, gpu_error_t* results, int64_t* timestamps_ms,
+                              int32_t max_count, int32_t* count, uint32_t timeout_ms);
+
+gpu_error_t gpu_collector_subscribe(gpu_collector_client_t* client, uint32_t subscription,
+                                    gpu_field_mask_t fields, uint32_t interval_ms);
+gpu_error_t gpu_collector_unsubscribe(gpu_collector_client_t* client, uint32_t subscription);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_COLLECTOR_H
@@ -0,0 +1,959 @@
+#include "gpu_history.h"
+#include "gpu_sampler.h"
+#include "gpu_thread.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Worst case for one sample after the first in a block: a 4-bit prefix and
+// 64 raw timestamp bits, then per metric 2 + 5 + 6 control bits and 64 bits
+#define MAX_SAMPLE_BITS (4 + 64 + GPU_HISTORY_METRICS * (2 + 5 + 6 + 64))
+#define BLOCK_BITS (GPU_HISTORY_BLOCK_BYTES * 8)
+#define NO_WINDOW 0xff
+
+typedef struct {
+    uint64_t id;                // Consecutive per device
+    int64_t first_ms;
+    int64_t last_ms;
+    uint32_t count;
+    uint32_t bits;
+    uint8_t data[GPU_HISTORY_BLOCK_BYTES];
+} history_block_t;
+
+// Per-series state shared by the encoder and the decoder
+typedef struct {
+    int64_t timestamp;
+    int64_t delta;
+    uint64_t values[GPU_HISTORY_METRICS];
+    uint8_t leading[GPU_HISTORY_METRICS];
+    uint8_t trailing[GPU_HISTORY_METRICS];
+} codec_state_t;
+
+// Closed bucket of a rollup tier; its start time follows from its position
+typedef struct {
+    uint32_t count;
+    float min[GPU_HISTORY_METRICS];
+    float max[GPU_HISTORY_METRICS];
+    float sum[GPU_HISTORY_METRICS];
+} rollup_slot_t;
+
+typedef struct {
+    rollup_slot_t* slots;       // Ring, oldest first
+    uint32_t head;
+    uint32_t count;
+    uint32_t allocated;         // Grows up to the tier's bucket count
+    int64_t first_start;        // Start of the oldest slot
+    bool started;
+    gpu_history_bucket_t open;  // Being filled, in double; starts where the ring ends
+} rollup_tier_t;
+
+typedef struct {
+    history_block_t** blocks;   // Ring, oldest first
+    uint32_t head;              // Oldest
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t next_id;
+    uint64_t samples;
+    uint64_t encoded_bits;      // Sum over retained blocks
+    codec_state_t encoder;      // State after the newest block's last sample
+    rollup_tier_t tiers[GPU_HISTORY_MAX_TIERS];
+} device_history_t;
+
+struct gpu_history_iter {
+    int32_t index;
+    int64_t from_ms;
+    int64_t to_ms;
+    uint64_t next_id;           // Next block to load
+    bool started;
+    bool done;
+    history_block_t block;      // Copy being decoded
+    uint32_t decoded;
+    uint32_t position;
+    codec_state_t decoder;
+};
+
+#define ROLLUP_CHUNK 256
+
+struct gpu_history_rollup {
+    int32_t index;
+    int64_t from_ms;
+    int64_t to_ms;
+    int64_t bucket_ms;          // Output buckets
+    int32_t tier;               // Source tier, -1 for raw samples
+    uint32_t tier_ms;
+    gpu_history_iter_t* raw;
+    int64_t next_start;         // Next tier bucket to load
+    gpu_history_bucket_t chunk[ROLLUP_CHUNK];   // Copied tier buckets
+    uint32_t chunk_count;
+    uint32_t chunk_position;
+    gpu_history_bucket_t pending;   // Output bucket being merged
+    bool done;
+};
+
+// g_attach_lock serializes start/stop (which attach to the sampler and must
+// not hold g_history_lock, see gpu_aggregate.c); g_history_lock protects the
+// stores and is only held for an append or a block copy
+static gpu_mutex_t g_attach_lock = GPU_MUTEX_INITIALIZER;
+static gpu_mutex_t g_history_lock = GPU_MUTEX_INITIALIZER;
+static bool g_running = false;
+static uint64_t g_retention_ms = 0;
+static uint64_t g_max_bytes = 0;
+static gpu_history_tier_t g_tiers[GPU_HISTORY_MAX_TIERS];
+static int32_t g_tier_count = 0;
+static device_history_t g_devices[GPU_MAX_DEVICES];
+static int32_t g_device_count = 0;     // Highest index recorded + 1
+
+static const gpu_history_tier_t kDefaultTiers[] = {
+    { 10 * 1000, 24ull * 60 * 60 * 1000 },
+    { 60 * 1000, 7ull * 24 * 60 * 60 * 1000 },
+    { 60 * 60 * 1000, 90ull * 24 * 60 * 60 * 1000 },
+};
+
+// ---------------------------------------------------------------------------
+// Bit I/O, most significant bit first
+
+static void put_bits(history_block_t* block, uint64_t value, int n) {
+    while (n > 0) {
+        int used = (int)(block->bits & 7);
+        int take = n < 8 - used ? n : 8 - used;
+        uint8_t chunk = (uint8_t)((value >> (n - take)) & ((1u << take) - 1));
+        block->data[block->bits >> 3] |= (uint8_t)(chunk << (8 - used - take));
+        block->bits += (uint32_t)take;
+        n -= take;
+    }
+}
+
+static uint64_t get_bits(const history_block_t* block, uint32_t* position, int n) {
+    uint64_t value = 0;
+    while (n > 0) {
+        int used = (int)(*position & 7);
+        int take = n < 8 - used ? n : 8 - used;
+        uint8_t chunk = (uint8_t)((block->data[*position >> 3] >> (8 - used - take)) & ((1u << take) - 1));
+        value = (value << take) | chunk;
+        *position += (uint32_t)take;
+        n -= take;
+    }
+    return value;
+}
+
+static int leading_zeros(uint64_t value) {
+    int n = 0;
+    for (uint64_t bit = 1ull << 63; bit && !(value & bit); bit >>= 1) {
+        n++;
+    }
+    return n;
+}
+
+static int trailing_zeros(uint64_t value) {
+    int n = 0;
+    for (uint64_t bit = 1; bit && !(value & bit); bit <<= 1) {
+        n++;
+    }
+    return n;
+}
+
+static uint64_t double_bits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bits_double(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void set_column(gpu_sample_t* sample, gpu_column_t column, double value) {
+    switch (column) {
+        case GPU_COLUMN_MEMORY_USED: sample->memory_used = (uint64_t)value; break;
+        case GPU_COLUMN_MEMORY_FREE: sample->memory_free = (uint64_t)value; break;
+        case GPU_COLUMN_GPU_UTILIZATION: sample->gpu_utilization = (float)value; break;
+        case GPU_COLUMN_MEMORY_UTILIZATION: sample->memory_utilization = (float)value; break;
+        case GPU_COLUMN_TEMPERATURE: sample->temperature = (float)value; break;
+        case GPU_COLUMN_POWER_USAGE: sample->power_usage = (float)value; break;
+        case GPU_COLUMN_CORE_CLOCK: sample->core_clock = (uint32_t)value; break;
+        case GPU_COLUMN_MEMORY_CLOCK: sample->memory_clock = (uint32_t)value; break;
+        case GPU_COLUMN_FAN_SPEED: sample->fan_speed = (float)value; break;
+        default: break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Codec
+
+static void encode_first(history_block_t* block, codec_state_t* state, int64_t timestamp,
+                         const uint64_t* values) {
+    put_bits(block, (uint64_t)timestamp, 64);
+    state->timestamp = timestamp;
+    state->delta = 0;
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        put_bits(block, values[m], 64);
+        state->values[m] = values[m];
+        state->leading[m] = NO_WINDOW;
+        state->trailing[m] = 0;
+    }
+}
+
+static void encode_next(history_block_t* block, codec_state_t* state, int64_t timestamp,
+                        const uint64_t* values) {
+    int64_t delta = timestamp - state->timestamp;
+    int64_t dod = delta - state->delta;
+    state->timestamp = timestamp;
+    state->delta = delta;
+    
+    if (dod == 0) {
+        put_bits(block, 0x0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        put_bits(block, 0x2, 2);
+        put_bits(block, (uint64_t)(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        put_bits(block, 0x6, 3);
+        put_bits(block, (uint64_t)(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        put_bits(block, 0xe, 4);
+        put_bits(block, (uint64_t)(dod + 2047), 12);
+    } else {
+        put_bits(block, 0xf, 4);
+        put_bits(block, (uint64_t)dod, 64);
+    }
+    
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        uint64_t xor_bits = values[m] ^ state->values[m];
+        state->values[m] = values[m];
+        if (xor_bits == 0) {
+            put_bits(block, 0x0, 1);
+            continue;
+        }
+        
+        int leading = leading_zeros(xor_bits);
+        int trailing = trailing_zeros(xor_bits);
+        if (leading > 31) {
+            leading = 31;
+        }
+        
+        if (state->leading[m] != NO_WINDOW && leading >= state->leading[m] &&
+            trailing >= state->trailing[m]) {
+            put_bits(block, 0x2, 2);
+            put_bits(block, xor_bits >> state->trailing[m], 64 - state->leading[m] - state->trailing[m]);
+        } else {
+            int length = 64 - leading - trailing;
+            put_bits(block, 0x3, 2);
+            put_bits(block, (uint64_t)leading, 5);
+            put_bits(block, (uint64_t)(length - 1), 6);
+            put_bits(block, xor_bits >> trailing, length);
+            state->leading[m] = (uint8_t)leading;
+            state->trailing[m] = (uint8_t)trailing;
+        }
+    }
+}
+
+static void decode_first(const history_block_t* block, uint32_t* position, codec_state_t* state) {
+    state->timestamp = (int64_t)get_bits(block, position, 64);
+    state->delta = 0;
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        state->values[m] = get_bits(block, position, 64);
+        state->leading[m] = NO_WINDOW;
+        state->trailing[m] = 0;
+    }
+}
+
+static void decode_next(const history_block_t* block, uint32_t* position, codec_state_t* state) {
+    int64_t dod;
+    if (get_bits(block, position, 1) == 0) {
+        dod = 0;
+    } else if (get_bits(block, position, 1) == 0) {
+        dod = (int64_t)get_bits(block, position, 7) - 63;
+    } else if (get_bits(block, position, 1) == 0) {
+        dod = (int64_t)get_bits(block, position, 9) - 255;
+    } else if (get_bits(block, position, 1) == 0) {
+        dod = (int64_t)get_bits(block, position, 12) - 2047;
+    } else {
+        dod = (int64_t)get_bits(block, position, 64);
+    }
+    state->delta += dod;
+    state->timestamp += state->delta;
+    
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        if (get_bits(block, position, 1) == 0) {
+            continue;
+        }
+        
+        if (get_bits(block, position, 1) == 0) {
+            int length = 64 - state->leading[m] - state->trailing[m];
+            state->values[m] ^= get_bits(block, position, length) << state->trailing[m];
+        } else {
+            int leading = (int)get_bits(block, position, 5);
+            int length = (int)get_bits(block, position, 6) + 1;
+            int trailing = 64 - leading - length;
+            state->values[m] ^= get_bits(block, position, length) << trailing;
+            state->leading[m] = (uint8_t)leading;
+            state->trailing[m] = (uint8_t)trailing;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Rollup tiers
+
+// Largest multiple of step not above value
+static int64_t floor_to(int64_t value, int64_t step) {
+    int64_t quotient = value / step;
+    if (value % step != 0 && value < 0) {
+        quotient--;
+    }
+    return quotient * step;
+}
+
+static uint32_t tier_buckets(const gpu_history_tier_t* tier) {
+    return (uint32_t)(tier->retention_ms / tier->bucket_ms);
+}
+
+static void reset_bucket(gpu_history_bucket_t* bucket, int64_t start_ms) {
+    bucket->start_ms = start_ms;
+    bucket->count = 0;
+}
+
+static void merge_bucket(gpu_history_bucket_t* into, const gpu_history_bucket_t* from) {
+    if (from->count == 0) {
+        return;
+    }
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        if (into->count == 0) {
+            into->min[m] = from->min[m];
+            into->max[m] = from->max[m];
+            into->sum[m] = from->sum[m];
+        } else {
+            into->min[m] = from->min[m] < into->min[m] ? from->min[m] : into->min[m];
+            into->max[m] = from->max[m] > into->max[m] ? from->max[m] : into->max[m];
+            into->sum[m] += from->sum[m];
+        }
+    }
+    into->count += from->count;
+}
+
+static void slot_to_bucket(const rollup_slot_t* slot, int64_t start_ms, gpu_history_bucket_t* bucket) {
+    bucket->start_ms = start_ms;
+    bucket->count = slot->count;
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        bucket->min[m] = slot->min[m];
+        bucket->max[m] = slot->max[m];
+        bucket->sum[m] = slot->sum[m];
+    }
+}
+
+static void free_tiers(device_history_t* device) {
+    for (int t = 0; t < GPU_HISTORY_MAX_TIERS; t++) {
+        free(device->tiers[t].slots);
+        memset(&device->tiers[t], 0, sizeof(rollup_tier_t));
+    }
+}
+
+// Make room in the ring for `needed` slots (at most capacity). On failure the
+// ring is emptied and restarts at next_start.
+static bool grow_slots(rollup_tier_t* tier, uint32_t needed, uint32_t capacity,
+                       int64_t next_start) {
+    if (needed <= tier->allocated) {
+        return true;
+    }
+    
+    uint32_t allocated = tier->allocated ? tier->allocated * 2 : 64;
+    if (allocated < needed) {
+        allocated = needed;
+    }
+    if (allocated > capacity) {
+        allocated = capacity;
+    }
+    rollup_slot_t* slots = (rollup_slot_t*)malloc(sizeof(rollup_slot_t) * allocated);
+    if (!slots) {
+        tier->count = 0;
+        tier->first_start = next_start;
+        return false;
+    }
+    for (uint32_t i = 0; i < tier->count; i++) {
+        slots[i] = tier->slots[(tier->head + i) % tier->allocated];
+    }
+    free(tier->slots);
+    tier->slots = slots;
+    tier->head = 0;
+    tier->allocated = allocated;
+    return true;
+}
+
+// Drop the oldest slots so that `adding` more fit in the tier
+static void make_room(rollup_tier_t* tier, int64_t width, uint32_t capacity, uint32_t adding) {
+    if (tier->count + adding > capacity) {
+        uint32_t drop = tier->count + adding - capacity;
+        tier->head = (tier->head + drop) % tier->allocated;
+        tier->first_start += (int64_t)drop * width;
+        tier->count -= drop;
+    }
+}
+
+// Append the closed bucket to the ring, dropping the oldest one when the tier
+// is full. Keeps the ring ending where the next bucket starts, even if the
+// slot cannot be stored.
+static void push_slot(rollup_tier_t* tier, int64_t width, uint32_t capacity,
+                      const gpu_history_bucket_t* bucket) {
+    make_room(tier, width, capacity, 1);
+    if (!grow_slots(tier, tier->count + 1, capacity, bucket->start_ms + width)) {
+        return;
+    }
+    
+    rollup_slot_t* slot = &tier->slots[(tier->head + tier->count) % tier->allocated];
+    memset(slot, 0, sizeof(*slot));
+    slot->count = (uint32_t)bucket->count;
+    if (bucket->count > 0) {
+        for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+            slot->min[m] = (float)bucket->min[m];
+            slot->max[m] = (float)bucket->max[m];
+            slot->sum[m] = (float)bucket->sum[m];
+        }
+    }
+    tier->count++;
+}
+
+// Append `empty` buckets without samples, fewer than capacity, in one step:
+// one allocation and one drop of the oldest slots, and only the sample count
+// of each new slot written. Readers skip slots whose count is zero.
+static void push_empty(rollup_tier_t* tier, int64_t width, uint32_t capacity, uint32_t empty,
+                       int64_t next_start) {
+    if (empty == 0) {
+        return;
+    }
+    make_room(tier, width, capacity, empty);
+    if (!grow_slots(tier, tier->count + empty, capacity, next_start)) {
+        return;
+    }
+    for (uint32_t i = 0; i < empty; i++) {
+        tier->slots[(tier->head + tier->count + i) % tier->allocated].count = 0;
+    }
+    tier->count += empty;
+}
+
+// Timestamps only increase (record_sample() drops the others)
+static void tier_add(rollup_tier_t* tier, const gpu_history_tier_t* config, int64_t timestamp,
+                     const gpu_history_bucket_t* sample) {
+    int64_t width = config->bucket_ms;
+    uint32_t capacity = tier_buckets(config);
+    int64_t start = floor_to(timestamp, width);
+    int64_t gap = tier->started ? (start - tier->open.start_ms) / width : 0;
+    
+    // First sample, or after a gap longer than the tier keeps: start over
+    // without touching the slots, whatever the length of the gap
+    if (!tier->started || gap > (int64_t)capacity) {
+        tier->head = 0;
+        tier->count = 0;
+        tier->first_start = start;
+        reset_bucket(&tier->open, start);
+        tier->started = true;
+        gap = 0;
+    }
+    
+    // Close the open bucket, and an empty one for each bucket without samples
+    if (gap > 0) {
+        push_slot(tier, width, capacity, &tier->open);
+        push_empty(tier, width, capacity, (uint32_t)(gap - 1), start);
+        reset_bucket(&tier->open, start);
+    }
+    merge_bucket(&tier->open, sample);
+}
+
+// ---------------------------------------------------------------------------
+// Store
+
+static history_block_t* newest_block(const device_history_t* device) {
+    if (device->count == 0) {
+        return NULL;
+    }
+    return device->blocks[(device->head + device->count - 1) % device->capacity];
+}
+
+static void drop_oldest(device_history_t* device) {
+    history_block_t* block = device->blocks[device->head];
+    device->samples -= block->count;
+    device->encoded_bits -= block->bits;
+    free(block);
+    device->head = (device->head + 1) % device->capacity;
+    device->count--;
+}
+
+static history_block_t* append_block(device_history_t* device) {
+    if (device->count == device->capacity) {
+        uint32_t capacity = device->capacity ? device->capacity * 2 : 16;
+        history_block_t** blocks = (history_block_t**)malloc(sizeof(history_block_t*) * capacity);
+        if (!blocks) {
+            return NULL;
+        }
+        for (uint32_t i = 0; i < device->count; i++) {
+            blocks[i] = device->blocks[(device->head + i) % device->capacity];
+        }
+        free(device->blocks);
+        device->blocks = blocks;
+        device->head = 0;
+        device->capacity = capacity;
+    }
+    
+    history_block_t* block = (history_block_t*)calloc(1, sizeof(history_block_t));
+    if (!block) {
+        return NULL;
+    }
+    block->id = device->next_id++;
+    device->blocks[(device->head + device->count) % device->capacity] = block;
+    device->count++;
+    return block;
+}
+
+static void record_sample(device_history_t* device, const gpu_sample_t* sample) {
+    history_block_t* block = newest_block(device);
+    if (block && sample->timestamp_ms <= block->last_ms) {
+        return;
+    }
+    
+    uint64_t values[GPU_HISTORY_METRICS];
+    for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+        values[m] = double_bits(gpu_sample_column(sample, (gpu_column_t)(m + 1)));
+    }
+    
+    if (block && block->bits + MAX_SAMPLE_BITS <= BLOCK_BITS) {
+        uint32_t before = block->bits;
+        encode_next(block, &device->encoder, sample->timestamp_ms, values);
+        device->encoded_bits += block->bits - before;
+    } else {
+        block = append_block(device);
+        if (!block) {
+            return;
+        }
+        block->first_ms = sample->timestamp_ms;
+        encode_first(block, &device->encoder, sample->timestamp_ms, values);
+        device->encoded_bits += block->bits;
+    }
+    block->last_ms = sample->timestamp_ms;
+    block->count++;
+    device->samples++;
+    
+    if (g_tier_count > 0) {
+        gpu_history_bucket_t single;
+        single.start_ms = sample->timestamp_ms;
+        single.count = 1;
+        for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+            single.min[m] = single.max[m] = single.sum[m] = bits_double(values[m]);
+        }
+        for (int32_t t = 0; t < g_tier_count; t++) {
+            tier_add(&device->tiers[t], &g_tiers[t], sample->timestamp_ms, &single);
+        }
+    }
+    
+    // Never drop the block being written
+    while (device->count > 1) {
+        const history_block_t* oldest = device->blocks[device->head];
+        bool expired = g_retention_ms > 0 &&
+                       oldest->last_ms < sample->timestamp_ms - (int64_t)g_retention_ms;
+        bool over_budget = g_max_bytes > 0 &&
+                           (uint64_t)device->count * sizeof(history_block_t) > g_max_bytes;
+        if (!expired && !over_budget) {
+            break;
+        }
+        drop_oldest(device);
+    }
+}
+
+static void history_listener(const gpu_sample_t* samples, const bool* valid, int32_t count,
+                             void* ctx) {
+    (void)ctx;
+    gpu_mutex_lock(&g_history_lock);
+    
+    for (int32_t i = 0; i < count && i < GPU_MAX_DEVICES; i++) {
+        if (valid[i]) {
+            record_sample(&g_devices[i], &samples[i]);
+            if (i >= g_device_count) {
+                g_device_count = i + 1;
+            }
+        }
+    }
+    
+    gpu_mutex_unlock(&g_history_lock);
+}
+
+static bool valid_tiers(const gpu_history_tier_t* tiers, int32_t count) {
+    if (count < 0 || count > GPU_HISTORY_MAX_TIERS || (count > 0 && !tiers)) {
+        return false;
+    }
+    for (int32_t t = 0; t < count; t++) {
+        if (tiers[t].bucket_ms == 0 || tiers[t].retention_ms < tiers[t].bucket_ms ||
+            tiers[t].retention_ms / tiers[t].bucket_ms > GPU_HISTORY_MAX_TIER_BUCKETS ||
+            (t > 0 && tiers[t].bucket_ms <= tiers[t - 1].bucket_ms)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+gpu_error_t gpu_history_start(uint64_t retention_ms, uint64_t max_bytes,
+                              const gpu_history_tier_t* tiers, int32_t tier_count) {
+    if (tier_count == GPU_HISTORY_DEFAULT_TIERS) {
+        tiers = kDefaultTiers;
+        tier_count = (int32_t)(sizeof(kDefaultTiers) / sizeof(kDefaultTiers[0]));
+    }
+    if (!valid_tiers(tiers, tier_count)) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_attach_lock);
+    
+    gpu_mutex_lock(&g_history_lock);
+    g_retention_ms = retention_ms;
+    g_max_bytes = max_bytes;
+    if (tier_count != g_tier_count ||
+        (tier_count > 0 && memcmp(tiers, g_tiers, sizeof(gpu_history_tier_t) * (size_t)tier_count) != 0)) {
+        for (int32_t i = 0; i < g_device_count; i++) {
+            free_tiers(&g_devices[i]);
+        }
+        memset(g_tiers, 0, sizeof(g_tiers));
+        for (int32_t t = 0; t < tier_count; t++) {
+            g_tiers[t] = tiers[t];
+        }
+        g_tier_count = tier_count;
+    }
+    gpu_mutex_unlock(&g_history_lock);
+    
+    gpu_error_t result = GPU_SUCCESS;
+    if (!g_running) {
+        result = gpu_sampler_add_listener(history_listener, NULL);
+        g_running = result == GPU_SUCCESS;
+    }
+    
+    gpu_mutex_unlock(&g_attach_lock);
+    return result;
+}
+
+void gpu_history_stop(void) {
+    gpu_mutex_lock(&g_attach_lock);
+    
+    if (g_running) {
+        gpu_sampler_remove_listener(history_listener, NULL);
+        g_running = false;
+    }
+    
+    gpu_mutex_lock(&g_history_lock);
+    for (int32_t i = 0; i < g_device_count; i++) {
+        device_history_t* device = &g_devices[i];
+        while (device->count > 0) {
+            drop_oldest(device);
+        }
+        free(device->blocks);
+        free_tiers(device);
+        memset(device, 0, sizeof(*device));
+    }
+    g_device_count = 0;
+    gpu_mutex_unlock(&g_history_lock);
+    
+    gpu_mutex_unlock(&g_attach_lock);
+}
+
+bool gpu_history_running(void) {
+    gpu_mutex_lock(&g_attach_lock);
+    bool running = g_running;
+    gpu_mutex_unlock(&g_attach_lock);
+    return running;
+}
+
+gpu_error_t gpu_history_get_stats(int32_t index, gpu_history_stats_t* stats) {
+    if (!stats) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_history_lock);
+    
+    if (index < 0 || index >= g_device_count) {
+        gpu_mutex_unlock(&g_history_lock);
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    const device_history_t* device = &g_devices[index];
+    memset(stats, 0, sizeof(*stats));
+    stats->samples = device->samples;
+    stats->blocks = device->count;
+    stats->encoded_bytes = (device->encoded_bits + 7) / 8;
+    stats->allocated_bytes = (uint64_t)device->count * sizeof(history_block_t) +
+                             (uint64_t)device->capacity * sizeof(history_block_t*);
+    if (device->count > 0) {
+        stats->first_ms = device->blocks[device->head]->first_ms;
+        stats->last_ms = newest_block(device)->last_ms;
+    }
+    for (int32_t t = 0; t < g_tier_count; t++) {
+        stats->rollup_bytes += (uint64_t)device->tiers[t].allocated * sizeof(rollup_slot_t);
+    }
+    
+    gpu_mutex_unlock(&g_history_lock);
+    return GPU_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------
+// Streaming decoder
+
+gpu_error_t gpu_history_iter_open(int32_t index, int64_t from_ms, int64_t to_ms,
+                                  gpu_history_iter_t** iter) {
+    if (!iter || index < 0 || index >= GPU_MAX_DEVICES) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_history_iter_t* it = (gpu_history_iter_t*)calloc(1, sizeof(gpu_history_iter_t));
+    if (!it) {
+        return GPU_ERROR_API_FAILED;
+    }
+    it->index = index;
+    it->from_ms = from_ms;
+    it->to_ms = to_ms;
+    it->done = from_ms > to_ms;
+    
+    *iter = it;
+    return GPU_SUCCESS;
+}
+
+// Copy the next block overlapping the range; false when there is none
+static bool load_block(gpu_history_iter_t* it) {
+    gpu_mutex_lock(&g_history_lock);
+    
+    const device_history_t* device = &g_devices[it->index];
+    bool found = false;
+    if (device->count > 0) {
+        uint64_t oldest_id = device->blocks[device->head]->id;
+        uint32_t lo = 0;
+        uint32_t hi = device->count;
+        
+        if (it->started && it->next_id > oldest_id) {
+            lo = (uint32_t)(it->next_id - oldest_id < hi ? it->next_id - oldest_id : hi);
+        }
+        
+        // First block (from lo) that ends at or after from_ms; block end
+        // times are increasing
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (device->blocks[(device->head + mid) % device->capacity]->last_ms < it->from_ms) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        
+        if (lo < device->count) {
+            const history_block_t* block = device->blocks[(device->head + lo) % device->capacity];
+            if (block->first_ms <= it->to_ms) {
+                // Only the bytes written so far
+                size_t header = offsetof(history_block_t, data);
+                memcpy(&it->block, block, header + (block->bits + 7) / 8);
+                it->next_id = block->id + 1;
+                found = true;
+            }
+        }
+    }
+    
+    gpu_mutex_unlock(&g_history_lock);
+    
+    it->started = true;
+    it->decoded = 0;
+    it->position = 0;
+    return found;
+}
+
+bool gpu_history_iter_next(gpu_history_iter_t* iter, gpu_sample_t* sample) {
+    if (!iter || !sample) {
+        return false;
+    }
+    
+    while (!iter->done) {
+        if (iter->decoded == iter->block.count || !iter->started) {
+            if (!load_block(iter)) {
+                iter->done = true;
+                break;
+            }
+            continue;
+        }
+        
+        if (iter->decoded == 0) {
+            decode_first(&iter->block, &iter->position, &iter->decoder);
+        } else {
+            decode_next(&iter->block, &iter->position, &iter->decoder);
+        }
+        iter->decoded++;
+        
+        int64_t timestamp = iter->decoder.timestamp;
+        if (timestamp > iter->to_ms) {
+            iter->done = true;
+            break;
+        }
+        if (timestamp < iter->from_ms) {
+            continue;
+        }
+        
+        memset(sample, 0, sizeof(*sample));
+        sample->timestamp_ms = timestamp;
+        sample->index = iter->index;
+        for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+            set_column(sample, (gpu_column_t)(m + 1), bits_double(iter->decoder.values[m]));
+        }
+        return true;
+    }
+    return false;
+}
+
+void gpu_history_iter_close(gpu_history_iter_t* iter) {
+    free(iter);
+}
+
+// ---------------------------------------------------------------------------
+// Rollup queries
+
+gpu_error_t gpu_history_rollup_open(int32_t index, int64_t from_ms, int64_t to_ms,
+                                    uint32_t resolution_ms, gpu_history_rollup_t** rollup) {
+    if (!rollup || index < 0 || index >= GPU_MAX_DEVICES || resolution_ms == 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_history_rollup_t* it = (gpu_history_rollup_t*)calloc(1, sizeof(gpu_history_rollup_t));
+    if (!it) {
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    // Keep bucket arithmetic clear of int64 overflow
+    const int64_t bound = (int64_t)1 << 62;
+    it->index = index;
+    it->from_ms = from_ms < -bound ? -bound : from_ms;
+    it->to_ms = to_ms > bound ? bound : to_ms;
+    it->bucket_ms = resolution_ms;
+    it->done = it->from_ms > it->to_ms;
+    
+    // Coarsest tier whose buckets nest exactly in the requested ones (tiers
+    // are in increasing bucket order). A tier that only is finer, 10 s buckets
+    // for 15 s, would split its buckets across two output buckets.
+    it->tier = -1;
+    gpu_mutex_lock(&g_history_lock);
+    for (int32_t t = 0; t < g_tier_count; t++) {
+        if (g_tiers[t].bucket_ms <= resolution_ms && resolution_ms % g_tiers[t].bucket_ms == 0) {
+            it->tier = t;
+            it->tier_ms = g_tiers[t].bucket_ms;
+        }
+    }
+    gpu_mutex_unlock(&g_history_lock);
+    
+    if (it->tier < 0) {
+        gpu_error_t result = gpu_history_iter_open(index, it->from_ms, it->to_ms, &it->raw);
+        if (result != GPU_SUCCESS) {
+            free(it);
+            return result;
+        }
+    } else {
+        it->next_start = floor_to(it->from_ms, it->tier_ms);
+    }
+    
+    *rollup = it;
+    return GPU_SUCCESS;
+}
+
+uint32_t gpu_history_rollup_source_ms(const gpu_history_rollup_t* rollup) {
+    return rollup ? rollup->tier_ms : 0;
+}
+
+// Copy the next run of tier buckets, including the open one at the end;
+// false when there is none. Positions are found again from next_start every
+// time, so buckets dropped in between are simply skipped.
+static bool load_tier_chunk(gpu_history_rollup_t* it) {
+    uint32_t count = 0;
+    int64_t width = it->tier_ms;
+    
+    gpu_mutex_lock(&g_history_lock);
+    
+    const rollup_tier_t* tier = &g_devices[it->index].tiers[it->tier];
+    // A restart with other tiers empties them; stop rather than misread
+    bool same_tier = it->tier < g_tier_count && g_tiers[it->tier].bucket_ms == it->tier_ms;
+    if (same_tier && tier->started) {
+        int64_t start = it->next_start > tier->first_start ? it->next_start : tier->first_start;
+        uint64_t offset = (uint64_t)((start - tier->first_start) / width);
+        
+        while (count < ROLLUP_CHUNK && offset < tier->count && start <= it->to_ms) {
+            slot_to_bucket(&tier->slots[(tier->head + offset) % tier->allocated], start,
+                           &it->chunk[count++]);
+            offset++;
+            start += width;
+        }
+        if (count < ROLLUP_CHUNK && offset == tier->count && start <= it->to_ms &&
+            tier->open.start_ms == start) {
+            it->chunk[count++] = tier->open;
+            start += width;
+        }
+        it->next_start = start;
+    }
+    
+    gpu_mutex_unlock(&g_history_lock);
+    
+    it->chunk_count = count;
+    it->chunk_position = 0;
+    return count > 0;
+}
+
+// Next source bucket (a tier bucket, or a raw sample as a bucket of one)
+static bool next_source(gpu_history_rollup_t* it, gpu_history_bucket_t* bucket) {
+    if (it->raw) {
+        gpu_sample_t sample;
+        if (!gpu_history_iter_next(it->raw, &sample)) {
+            return false;
+        }
+        bucket->start_ms = sample.timestamp_ms;
+        bucket->count = 1;
+        for (int m = 0; m < GPU_HISTORY_METRICS; m++) {
+            double value = gpu_sample_column(&sample, (gpu_column_t)(m + 1));
+            bucket->min[m] = bucket->max[m] = bucket->sum[m] = value;
+        }
+        return true;
+    }
+    
+    if (it->chunk_position == it->chunk_count && !load_tier_chunk(it)) {
+        return false;
+    }
+    *bucket = it->chunk[it->chunk_position++];
+    return true;
+}
+
+bool gpu_history_rollup_next(gpu_history_rollup_t* rollup, gpu_history_bucket_t* bucket) {
+    if (!rollup || !bucket) {
+        return false;
+    }
+    
+    gpu_history_rollup_t* it = rollup;
+    gpu_history_bucket_t source;
+    while (!it->done) {
+        if (!next_source(it, &source)) {
+            it->done = true;
+            break;
+        }
+        if (source.count == 0) {
+            continue;
+        }
+        
+        int64_t start = floor_to(source.start_ms, it->bucket_ms);
+        if (it->pending.count > 0 && start != it->pending.start_ms) {
+            *bucket = it->pending;
+            reset_bucket(&it->pending, start);
+            merge_bucket(&it->pending, &source);
+            return true;
+        }
+        it->pending.start_ms = start;
+        merge_bucket(&it->pending, &source);
+    }
+    
+    if (it->pending.count > 0) {
+        *bucket = it->pending;
+        it->pending.count = 0;
+        return true;
+    }
+    return false;
+}
+
+void gpu_history_rollup_close(gpu_history_rollup_t* rollup) {
+    if (!rollup) {
+        return;
+    }
+    gpu_history_iter_close(rollup->raw);
+    free(rollup);
+}
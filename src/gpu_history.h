@@ -0,0 +1,116 @@
+#ifndef GPU_HISTORY_H
+#define GPU_HISTORY_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Long-retention compressed history behind the sampler. While started, every
+// sampler tick is appended to a per-device chain of fixed-size blocks using
+// Gorilla-style encoding:
+// - timestamps: delta-of-delta, '0' for a steady interval, otherwise a
+//   prefix-coded 7/9/12-bit value (or the raw 64 bits)
+// - metrics (every gpu_column_t but the timestamp, as IEEE doubles): XOR with
+//   the previous value, '0' if unchanged, otherwise the meaningful bits,
+//   reusing the previous leading/trailing zero window when it fits
+// Each block starts with one raw sample and decodes on its own. Steady
+// telemetry costs a bit or two per metric; a full day of 1 s samples of one
+// GPU typically fits in a few hundred KB.
+//
+// Blocks older than the retention period, or beyond the per-device byte
+// budget, are dropped oldest first. Readers iterate a time range with a
+// streaming decoder that only touches the blocks overlapping it.
+//
+// Rollup tiers: alongside the raw samples, each tier keeps per device the
+// sample count and the min, max and sum of every metric per bucket of
+// bucket_ms (aligned to the epoch), for retention_ms. Every recorded sample
+// updates the open bucket of each tier, so tiers are always current and cost
+// O(tiers) per sample. A tier is a ring of retention_ms / bucket_ms slots
+// stored as floats with implicit timestamps (buckets without samples keep an
+// empty slot), so its size is fixed by its configuration and does not count
+// against the raw byte budget.
+#define GPU_HISTORY_BLOCK_BYTES 4096
+#define GPU_HISTORY_METRICS (GPU_COLUMN_COUNT - 1)
+#define GPU_HISTORY_MAX_TIERS 8
+#define GPU_HISTORY_MAX_TIER_BUCKETS (1u << 22)
+#define GPU_HISTORY_DEFAULT_TIERS (-1)
+
+typedef struct {
+    uint32_t bucket_ms;
+    uint64_t retention_ms;      // At least bucket_ms
+} gpu_history_tier_t;
+
+typedef struct {
+    uint64_t samples;           // Samples retained
+    uint64_t blocks;
+    uint64_t encoded_bytes;     // Compressed payload
+    uint64_t allocated_bytes;   // Including block headers and unused tails
+    int64_t first_ms;           // Oldest and newest sample retained; 0 if none
+    int64_t last_ms;
+    uint64_t rollup_bytes;      // Allocated by the rollup tiers
+} gpu_history_stats_t;
+
+// Attach to the sampler and start recording. retention_ms 0 keeps samples
+// until the byte budget is reached; max_bytes (per device) 0 is unbounded.
+// tiers are in increasing bucket_ms order; tier_count 0 disables rollups and
+// GPU_HISTORY_DEFAULT_TIERS selects 10 s buckets for a day, 1 min for 7 days
+// and 1 h for 90 days. GPU_ERROR_INVALID_PARAM for an invalid tier list.
+// Restarting with other limits keeps what is recorded and applies the new
+// limits from the next tick; other tiers start out empty.
+gpu_error_t gpu_history_start(uint64_t retention_ms, uint64_t max_bytes,
+                              const gpu_history_tier_t* tiers, int32_t tier_count);
+
+// Detach from the sampler and free everything recorded
+void gpu_history_stop(void);
+
+bool gpu_history_running(void);
+
+// GPU_ERROR_INVALID_PARAM for an index that was never recorded
+gpu_error_t gpu_history_get_stats(int32_t index, gpu_history_stats_t* stats);
+
+// Streaming decoder over [from_ms, to_ms] of one device, oldest first. Holds
+// a copy of one block at a time, so recording carries on while it runs;
+// samples appended after the iterator reached the newest block are not
+// returned and blocks dropped meanwhile are skipped.
+typedef struct gpu_history_iter gpu_history_iter_t;
+
+gpu_error_t gpu_history_iter_open(int32_t index, int64_t from_ms, int64_t to_ms,
+                                  gpu_history_iter_t** iter);
+
+// Next sample in range; false once the range is exhausted
+bool gpu_history_iter_next(gpu_history_iter_t* iter, gpu_sample_t* sample);
+
+void gpu_history_iter_close(gpu_history_iter_t* iter);
+
+// Samples of one device merged into buckets of resolution_ms, from the
+// coarsest tier whose bucket width divides resolution_ms, or from the raw
+// samples when none does. Buckets are aligned to the epoch, so tier buckets
+// nest exactly in the requested ones; the first one may start before from_ms.
+typedef struct {
+    int64_t start_ms;
+    uint64_t count;             // Samples; buckets without any are skipped
+    double min[GPU_HISTORY_METRICS];
+    double max[GPU_HISTORY_METRICS];
+    double sum[GPU_HISTORY_METRICS];
+} gpu_history_bucket_t;
+
+typedef struct gpu_history_rollup gpu_history_rollup_t;
+
+gpu_error_t gpu_history_rollup_open(int32_t index, int64_t from_ms, int64_t to_ms,
+                                    uint32_t resolution_ms, gpu_history_rollup_t** rollup);
+
+// Bucket width of the tier read, 0 for raw samples
+uint32_t gpu_history_rollup_source_ms(const gpu_history_rollup_t* rollup);
+
+// Next bucket in range, oldest first; false once the range is exhausted
+bool gpu_history_rollup_next(gpu_history_rollup_t* rollup, gpu_history_bucket_t* bucket);
+
+void gpu_history_rollup_close(gpu_history_rollup_t* rollup);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_HISTORY_H
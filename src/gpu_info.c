@@ -1,4 +1,6 @@
 #include "gpu_info.h"
+#include "gpu_pool.h"
+#include "gpu_thread.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -10,100 +12,404 @@
 
 // Forward declarations for vendor functions
 gpu_error_t nvidia_get_gpu_count(int32_t* count);
-gpu_error_t nvidia_get_gpu_info(int32_t index, gpu_info_t* info);
+gpu_error_t nvidia_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info);
 gpu_error_t amd_get_gpu_count(int32_t* count);
-gpu_error_t amd_get_gpu_info(int32_t index, gpu_info_t* info);
+gpu_error_t amd_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info);
+gpu_error_t amd_get_gpu_path(int32_t index, char* path, size_t size);
+void amd_cleanup(void);
+void nvidia_cleanup(void);
 gpu_error_t intel_get_gpu_count(int32_t* count);
-gpu_error_t intel_get_gpu_info(int32_t index, gpu_info_t* info);
+gpu_error_t intel_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info);
 
-static bool g_initialized = false;
+// One reference per gpu_info_init() that hasn't been matched by a
+// gpu_info_cleanup(). Every Node.js environment (main thread and each worker)
+// holds one, so backends are torn down only when the last of them lets go.
+static int32_t g_init_refs = 0;
+
+// Locking: g_registry_lock is held shared by every device query and
+// exclusively while the registry is rebuilt or the backends are loaded or
+// unloaded, so enumeration never runs under a query. Within a query,
+// g_device_locks[i] serializes access to device i, whose backend state (NVML
+// handle cache, open sysfs files) is only ever touched by its own queries.
+// Queries on different devices therefore run in parallel.
+static gpu_rwlock_t g_registry_lock = GPU_RWLOCK_INITIALIZER;
+static gpu_mutex_t g_device_locks[GPU_MAX_DEVICES];
+static bool g_device_locks_ready = false;
+
+// Device registry: global index -> (backend, backend-local index, sysfs path).
+// Built lazily on first query so that each gpu_get_info() is an O(1) lookup
+// instead of re-enumerating every vendor. g_registry_valid is cleared by
+// queries (under the shared lock) when a device disappears.
+static gpu_device_entry_t g_devices[GPU_MAX_DEVICES];
+static int32_t g_device_count = 0;
+static volatile uint32_t g_registry_valid = 0;
+
+// Descriptor cache, filled on the first gpu_get_desc() of each device and
+// dropped whenever the registry is rebuilt; guarded by the device locks
+static gpu_device_desc_t g_descs[GPU_MAX_DEVICES];
+static bool g_desc_cached[GPU_MAX_DEVICES];
+
+static void registry_add_vendor(gpu_vendor_t vendor, int32_t vendor_count) {
+    for (int32_t i = 0; i < vendor_count && g_device_count < GPU_MAX_DEVICES; i++) {
+        gpu_device_entry_t* entry = &g_devices[g_device_count++];
+        memset(entry, 0, sizeof(gpu_device_entry_t));
+        entry->vendor = vendor;
+        entry->backend_index = i;
+        
+        if (vendor == GPU_VENDOR_AMD) {
+            amd_get_gpu_path(i, entry->sysfs_path, sizeof(entry->sysfs_path));
+        }
+    }
+}
+
+// Requires g_registry_lock held exclusively
+static void registry_build(void) {
+    int32_t nvidia_count = 0;
+    int32_t amd_count = 0;
+    int32_t intel_count = 0;
+    
+    // Enumerate every vendor once; ordering matches the historical
+    // NVIDIA, AMD, Intel index layout
+    if (nvidia_get_gpu_count(&nvidia_count) != GPU_SUCCESS) nvidia_count = 0;
+    if (amd_get_gpu_count(&amd_count) != GPU_SUCCESS) amd_count = 0;
+    if (intel_get_gpu_count(&intel_count) != GPU_SUCCESS) intel_count = 0;
+    
+    g_device_count = 0;
+    memset(g_desc_cached, 0, sizeof(g_desc_cached));
+    registry_add_vendor(GPU_VENDOR_NVIDIA, nvidia_count);
+    registry_add_vendor(GPU_VENDOR_AMD, amd_count);
+    registry_add_vendor(GPU_VENDOR_INTEL, intel_count);
+    
+    gpu_atomic_store_release(&g_registry_valid, 1);
+}
+
+// Take g_registry_lock shared with a valid registry, rebuilding it first if a
+// device went away. Returns false (lock not held) when not initialized.
+static bool registry_acquire(void) {
+    gpu_rwlock_lock_shared(&g_registry_lock);
+    
+    while (g_init_refs > 0 && !gpu_atomic_load_acquire(&g_registry_valid)) {
+        gpu_rwlock_unlock_shared(&g_registry_lock);
+        
+        gpu_rwlock_lock(&g_registry_lock);
+        if (g_init_refs > 0 && !g_registry_valid) {
+            registry_build();
+        }
+        gpu_rwlock_unlock(&g_registry_lock);
+        
+        gpu_rwlock_lock_shared(&g_registry_lock);
+    }
+    
+    if (g_init_refs == 0) {
+        gpu_rwlock_unlock_shared(&g_registry_lock);
+        return false;
+    }
+    return true;
+}
+
+static void registry_release(void) {
+    gpu_rwlock_unlock_shared(&g_registry_lock);
+}
 
 gpu_error_t gpu_info_init(void) {
-    if (g_initialized) {
-        return GPU_SUCCESS;
+    gpu_rwlock_lock(&g_registry_lock);
+    
+    if (!g_device_locks_ready) {
+        for (int32_t i = 0; i < GPU_MAX_DEVICES; i++) {
+            gpu_mutex_init(&g_device_locks[i]);
+        }
+        g_device_locks_ready = true;
     }
     
-    // Platform-specific initialization
-#ifdef _WIN32
-    // Windows-specific init
-#else
-    // Linux-specific init
-#endif
+    // Backends load their driver libraries lazily on first use
+    g_init_refs++;
     
-    g_initialized = true;
+    gpu_rwlock_unlock(&g_registry_lock);
     return GPU_SUCCESS;
 }
 
 gpu_error_t gpu_info_cleanup(void) {
-    if (!g_initialized) {
-        return GPU_SUCCESS;
+    bool last = false;
+    
+    // Waits for in-flight queries to drain
+    gpu_rwlock_lock(&g_registry_lock);
+    
+    if (g_init_refs > 0 && --g_init_refs == 0) {
+        last = true;
+        
+        // Last reference: unload driver libraries (NVML is shut down here)
+        nvidia_cleanup();
+        amd_cleanup();
+        
+        g_device_count = 0;
+        g_registry_valid = 0;
     }
     
-    // Platform-specific cleanup
+    gpu_rwlock_unlock(&g_registry_lock);
     
-    g_initialized = false;
+    // A batch in progress holds the registry lock shared, so the pool is
+    // stopped outside it
+    if (last) {
+        gpu_pool_stop();
+    }
     return GPU_SUCCESS;
 }
 
 gpu_error_t gpu_get_count(int32_t* count) {
-    if (!g_initialized) {
+    if (!count) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    if (!registry_acquire()) {
         return GPU_ERROR_API_FAILED;
     }
     
-    if (!count) {
+    *count = g_device_count;
+    
+    registry_release();
+    return *count > 0 ? GPU_SUCCESS : GPU_ERROR_NO_GPU;
+}
+
+// Requires g_registry_lock held shared and the device lock of index
+static gpu_error_t get_info_locked(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
+    const gpu_device_entry_t* entry = &g_devices[index];
+    gpu_error_t result;
+    
+    switch (entry->vendor) {
+        case GPU_VENDOR_NVIDIA:
+            result = nvidia_get_gpu_info(entry->backend_index, fields, info);
+            break;
+        case GPU_VENDOR_AMD:
+            result = amd_get_gpu_info(entry->backend_index, fields, info);
+            break;
+        case GPU_VENDOR_INTEL:
+            result = intel_get_gpu_info(entry->backend_index, fields, info);
+            break;
+        default:
+            return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    if (result == GPU_ERROR_NO_GPU) {
+        // Device vanished (hotplug/driver reset); rebuild on next query
+        gpu_atomic_store_release(&g_registry_valid, 0);
+    } else if (result == GPU_SUCCESS) {
+        // Backends fill in their local index; report the global one
+        info->index = index;
+    }
+    
+    return result;
+}
+
+gpu_error_t gpu_get_info(int32_t index, gpu_info_t* info) {
+    return gpu_get_info_fields(index, GPU_FIELD_ALL, info);
+}
+
+gpu_error_t gpu_get_info_fields(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
+    if (!info) {
         return GPU_ERROR_INVALID_PARAM;
     }
     
-    int32_t total_count = 0;
-    int32_t nvidia_count = 0;
-    int32_t amd_count = 0;
-    int32_t intel_count = 0;
+    if (!registry_acquire()) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
     
-    // Get counts from all vendors
-    if (nvidia_get_gpu_count(&nvidia_count) == GPU_SUCCESS) {
-        total_count += nvidia_count;
+    if (index < 0 || index >= g_device_count) {
+        registry_release();
+        return GPU_ERROR_INVALID_PARAM;
     }
     
-    if (amd_get_gpu_count(&amd_count) == GPU_SUCCESS) {
-        total_count += amd_count;
+    gpu_mutex_lock(&g_device_locks[index]);
+    gpu_error_t result = get_info_locked(index, fields, info);
+    gpu_mutex_unlock(&g_device_locks[index]);
+    
+    registry_release();
+    return result;
+}
+
+gpu_error_t gpu_get_desc(int32_t index, gpu_device_desc_t* desc) {
+    if (!desc) {
+        return GPU_ERROR_INVALID_PARAM;
     }
     
-    if (intel_get_gpu_count(&intel_count) == GPU_SUCCESS) {
-        total_count += intel_count;
+    if (!registry_acquire()) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    if (index < 0 || index >= g_device_count) {
+        registry_release();
+        return GPU_ERROR_INVALID_PARAM;
     }
     
-    *count = total_count;
-    return total_count > 0 ? GPU_SUCCESS : GPU_ERROR_NO_GPU;
+    gpu_error_t result = GPU_SUCCESS;
+    gpu_mutex_lock(&g_device_locks[index]);
+    
+    if (!g_desc_cached[index]) {
+        gpu_info_t info;
+        result = get_info_locked(index, GPU_FIELD_STATIC, &info);
+        if (result == GPU_SUCCESS) {
+            gpu_device_desc_t* cached = &g_descs[index];
+            cached->index = index;
+            cached->vendor = info.vendor;
+            memcpy(cached->name, info.name, sizeof(cached->name));
+            memcpy(cached->uuid, info.uuid, sizeof(cached->uuid));
+            memcpy(cached->pci_bus_id, info.pci_bus_id, sizeof(cached->pci_bus_id));
+            cached->memory_total = info.memory_total;
+            g_desc_cached[index] = true;
+        }
+    }
+    
+    if (result == GPU_SUCCESS) {
+        *desc = g_descs[index];
+    }
+    
+    gpu_mutex_unlock(&g_device_locks[index]);
+    registry_release();
+    return result;
 }
 
-gpu_error_t gpu_get_info(int32_t index, gpu_info_t* info) {
-    if (!g_initialized || !info) {
+static void info_to_sample(const gpu_info_t* info, int64_t timestamp_ms, gpu_sample_t* sample) {
+    sample->timestamp_ms = timestamp_ms;
+    sample->index = info->index;
+    sample->memory_used = info->memory_used;
+    sample->memory_free = info->memory_free;
+    sample->gpu_utilization = info->gpu_utilization;
+    sample->memory_utilization = info->memory_utilization;
+    sample->temperature = info->temperature;
+    sample->power_usage = info->power_usage;
+    sample->core_clock = info->core_clock;
+    sample->memory_clock = info->memory_clock;
+    sample->fan_speed = info->fan_speed;
+}
+
+gpu_error_t gpu_sample(int32_t index, gpu_sample_t* sample) {
+    if (!sample) {
         return GPU_ERROR_INVALID_PARAM;
     }
     
-    int32_t nvidia_count = 0;
-    int32_t amd_count = 0;
-    int32_t intel_count = 0;
+    gpu_info_t info;
+    int64_t timestamp_ms = gpu_time_ms();
+    gpu_error_t result = gpu_get_info_fields(index, GPU_FIELD_SAMPLE, &info);
+    if (result != GPU_SUCCESS) {
+        return result;
+    }
+    
+    info_to_sample(&info, timestamp_ms, sample);
+    return GPU_SUCCESS;
+}
+
+// Shared by the parallel collectors; the caller holds g_registry_lock shared
+// for the whole batch, so every device sees the same registry
+typedef struct {
+    gpu_field_mask_t fields;
+    gpu_info_t* infos;
+    gpu_error_t* results;
+    int64_t* timestamps_ms;
+} collect_ctx_t;
+
+static void collect_task(int32_t index, void* arg) {
+    collect_ctx_t* ctx = (collect_ctx_t*)arg;
+    
+    ctx->timestamps_ms[index] = gpu_time_ms();
+    gpu_mutex_lock(&g_device_locks[index]);
+    ctx->results[index] = get_info_locked(index, ctx->fields, &ctx->infos[index]);
+    gpu_mutex_unlock(&g_device_locks[index]);
+}
+
+static gpu_error_t collect_all(gpu_field_mask_t fields, gpu_info_t* infos, gpu_error_t* results,
+                               int64_t* timestamps_ms, int32_t max_count, int32_t* count) {
+    if (!registry_acquire()) {
+        *count = 0;
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    int32_t n = g_device_count < max_count ? g_device_count : max_count;
+    collect_ctx_t ctx = { fields, infos, results, timestamps_ms };
+    gpu_pool_run(collect_task, &ctx, n);
+    *count = n;
+    
+    registry_release();
+    return n > 0 ? GPU_SUCCESS : GPU_ERROR_NO_GPU;
+}
+
+gpu_error_t gpu_collect_info(gpu_field_mask_t fields, gpu_info_t* infos, gpu_error_t* results,
+                             int64_t* timestamps_ms, int32_t max_count, int32_t* count) {
+    if (!infos || !results || !timestamps_ms || !count || max_count < 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    return collect_all(fields, infos, results, timestamps_ms, max_count, count);
+}
+
+gpu_error_t gpu_collect_samples(gpu_sample_t* samples, bool* valid, int32_t max_count, int32_t* count) {
+    if (!samples || !valid || !count || max_count < 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    if (max_count > GPU_MAX_DEVICES) {
+        max_count = GPU_MAX_DEVICES;
+    }
+    
+    gpu_info_t infos[GPU_MAX_DEVICES];
+    gpu_error_t results[GPU_MAX_DEVICES];
+    int64_t timestamps_ms[GPU_MAX_DEVICES];
+    gpu_error_t result = collect_all(GPU_FIELD_SAMPLE, infos, results, timestamps_ms, max_count, count);
+    
+    for (int32_t i = 0; i < *count; i++) {
+        valid[i] = results[i] == GPU_SUCCESS;
+        if (valid[i]) {
+            info_to_sample(&infos[i], timestamps_ms[i], &samples[i]);
+        }
+    }
+    
+    return result;
+}
+
+double gpu_sample_column(const gpu_sample_t* sample, gpu_column_t column) {
+    switch (column) {
+        case GPU_COLUMN_TIMESTAMP: return (double)sample->timestamp_ms;
+        case GPU_COLUMN_MEMORY_USED: return (double)sample->memory_used;
+        case GPU_COLUMN_MEMORY_FREE: return (double)sample->memory_free;
+        case GPU_COLUMN_GPU_UTILIZATION: return sample->gpu_utilization;
+        case GPU_COLUMN_MEMORY_UTILIZATION: return sample->memory_utilization;
+        case GPU_COLUMN_TEMPERATURE: return sample->temperature;
+        case GPU_COLUMN_POWER_USAGE: return sample->power_usage;
+        case GPU_COLUMN_CORE_CLOCK: return sample->core_clock;
+        case GPU_COLUMN_MEMORY_CLOCK: return sample->memory_clock;
+        case GPU_COLUMN_FAN_SPEED: return sample->fan_speed;
+        default: return 0.0;
+    }
+}
+
+gpu_error_t gpu_get_device_entry(int32_t index, gpu_device_entry_t* entry) {
+    if (!entry) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    if (!registry_acquire()) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_error_t result = GPU_ERROR_INVALID_PARAM;
+    if (index >= 0 && index < g_device_count) {
+        *entry = g_devices[index];
+        result = GPU_SUCCESS;
+    }
+    
+    registry_release();
+    return result;
+}
+
+gpu_error_t gpu_refresh(void) {
+    gpu_error_t result = GPU_ERROR_API_FAILED;
+    gpu_rwlock_lock(&g_registry_lock);
+    
+    if (g_init_refs > 0) {
+        registry_build();
+        result = GPU_SUCCESS;
+    }
     
-    // Get vendor counts
-    nvidia_get_gpu_count(&nvidia_count);
-    amd_get_gpu_count(&amd_count);
-    intel_get_gpu_count(&intel_count);
-    
-    if (index < nvidia_count) {
-        // NVIDIA GPU
-        return nvidia_get_gpu_info(index, info);
-    } else if (index < nvidia_count + amd_count) {
-        // AMD GPU
-        int32_t amd_index = index - nvidia_count;
-        return amd_get_gpu_info(amd_index, info);
-    } else if (index < nvidia_count + amd_count + intel_count) {
-        // Intel GPU
-        int32_t intel_index = index - nvidia_count - amd_count;
-        return intel_get_gpu_info(intel_index, info);
-    }
-    
-    return GPU_ERROR_INVALID_PARAM;
+    gpu_rwlock_unlock(&g_registry_lock);
+    return result;
 }
 
 const char* gpu_error_string(gpu_error_t error) {
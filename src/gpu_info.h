@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +17,9 @@ typedef enum {
     GPU_VENDOR_INTEL
 } gpu_vendor_t;
 
+// Upper bound on the number of GPUs tracked by the device registry
+#define GPU_MAX_DEVICES 128
+
 // GPU information structure
 typedef struct {
     int32_t index;
@@ -45,8 +49,99 @@ typedef struct {
     
     // Fan speed in percentage (0-100)
     float fan_speed;
+    
+    // Memory (HBM/GDDR) temperature in Celsius
+    float memory_temperature;
+    
+    // Energy consumed since the driver was loaded, in millijoules
+    uint64_t energy_consumption;
+    
+    // PCIe replay (link retransmission) counter
+    uint64_t pcie_replay_count;
 } gpu_info_t;
 
+// Field selection bits for gpu_get_info_fields(). Backends skip the driver
+// calls and file reads behind fields that are not requested; those fields are
+// left zeroed unless they come for free with a requested one. index and vendor
+// are always filled.
+typedef enum {
+    GPU_FIELD_VENDOR             = 1u << 0,
+    GPU_FIELD_NAME               = 1u << 1,
+    GPU_FIELD_UUID               = 1u << 2,
+    GPU_FIELD_PCI_BUS_ID         = 1u << 3,
+    GPU_FIELD_MEMORY_TOTAL       = 1u << 4,
+    GPU_FIELD_MEMORY_USED        = 1u << 5,
+    GPU_FIELD_MEMORY_FREE        = 1u << 6,
+    GPU_FIELD_GPU_UTILIZATION    = 1u << 7,
+    GPU_FIELD_MEMORY_UTILIZATION = 1u << 8,
+    GPU_FIELD_TEMPERATURE        = 1u << 9,
+    GPU_FIELD_POWER_USAGE        = 1u << 10,
+    GPU_FIELD_CORE_CLOCK         = 1u << 11,
+    GPU_FIELD_MEMORY_CLOCK       = 1u << 12,
+    GPU_FIELD_FAN_SPEED          = 1u << 13,
+    GPU_FIELD_MEMORY_TEMPERATURE = 1u << 14,
+    GPU_FIELD_ENERGY             = 1u << 15,
+    GPU_FIELD_PCIE_REPLAY_COUNT  = 1u << 16,
+    GPU_FIELD_ALL                = (1u << 17) - 1
+} gpu_field_t;
+
+// Fields that never change for a device, and the per-sample telemetry
+#define GPU_FIELD_STATIC (GPU_FIELD_VENDOR | GPU_FIELD_NAME | GPU_FIELD_UUID | \
+                          GPU_FIELD_PCI_BUS_ID | GPU_FIELD_MEMORY_TOTAL)
+#define GPU_FIELD_DYNAMIC (GPU_FIELD_ALL & ~GPU_FIELD_STATIC)
+
+// Fields stored in a gpu_sample_t
+#define GPU_FIELD_SAMPLE (GPU_FIELD_MEMORY_USED | GPU_FIELD_MEMORY_FREE | \
+                          GPU_FIELD_GPU_UTILIZATION | GPU_FIELD_MEMORY_UTILIZATION | \
+                          GPU_FIELD_TEMPERATURE | GPU_FIELD_POWER_USAGE | GPU_FIELD_CORE_CLOCK | \
+                          GPU_FIELD_MEMORY_CLOCK | GPU_FIELD_FAN_SPEED)
+
+typedef uint32_t gpu_field_mask_t;
+
+// Immutable device description, fetched once per device
+typedef struct {
+    int32_t index;
+    gpu_vendor_t vendor;
+    char name[256];
+    char uuid[64];
+    char pci_bus_id[32];
+    uint64_t memory_total;      // MB
+} gpu_device_desc_t;
+
+// Dynamic telemetry of one device at one point in time
+typedef struct {
+    int64_t timestamp_ms;       // Unix epoch milliseconds
+    int32_t index;
+    
+    // Memory (MB)
+    uint64_t memory_used;
+    uint64_t memory_free;
+    
+    float gpu_utilization;
+    float memory_utilization;
+    float temperature;
+    float power_usage;
+    uint32_t core_clock;
+    uint32_t memory_clock;
+    float fan_speed;
+} gpu_sample_t;
+
+// Columns of the numeric sample tables written by the bindings. Values are
+// stable: new columns are only ever appended.
+typedef enum {
+    GPU_COLUMN_TIMESTAMP = 0,
+    GPU_COLUMN_MEMORY_USED,
+    GPU_COLUMN_MEMORY_FREE,
+    GPU_COLUMN_GPU_UTILIZATION,
+    GPU_COLUMN_MEMORY_UTILIZATION,
+    GPU_COLUMN_TEMPERATURE,
+    GPU_COLUMN_POWER_USAGE,
+    GPU_COLUMN_CORE_CLOCK,
+    GPU_COLUMN_MEMORY_CLOCK,
+    GPU_COLUMN_FAN_SPEED,
+    GPU_COLUMN_COUNT
+} gpu_column_t;
+
 // Error codes
 typedef enum {
     GPU_SUCCESS = 0,
@@ -57,23 +152,71 @@ typedef enum {
     GPU_ERROR_API_FAILED = -5
 } gpu_error_t;
 
-// Initialization and cleanup
+// Device registry entry: maps a global GPU index to the backend that owns it
+typedef struct {
+    gpu_vendor_t vendor;
+    int32_t backend_index;      // Index local to the vendor backend
+    char sysfs_path[256];       // e.g. /sys/class/drm/card0 (empty if not applicable)
+} gpu_device_entry_t;
+
+// Thread safety: every gpu_* function below may be called from any thread at
+// any time.
+// - gpu_get_count, gpu_get_info, gpu_get_info_fields, gpu_get_desc,
+//   gpu_sample, gpu_collect_info, gpu_collect_samples and
+//   gpu_get_device_entry run concurrently with each other.
+//   Queries on different devices proceed in parallel; queries on the same
+//   device are serialized by a per-device lock.
+// - gpu_info_init, gpu_info_cleanup and gpu_refresh wait for in-flight
+//   queries to finish and block new ones while they run.
+// - A query that sees a device disappear marks the registry stale; the next
+//   query rebuilds it under the exclusive lock.
+// - gpu_sample_column, gpu_error_string and gpu_vendor_supported are pure.
+// The vendor functions further down are internal: they rely on these locks
+// and must not be called directly while the library is in use.
+
+// Initialization and cleanup. Calls are reference counted: each
+// gpu_info_init() must be balanced by a gpu_info_cleanup(), and driver
+// libraries (NVML, ADLX) are unloaded only when the count drops to zero.
 gpu_error_t gpu_info_init(void);
 gpu_error_t gpu_info_cleanup(void);
 
 // GPU discovery
+// The device registry is built on first use and reused until gpu_refresh()
+// is called or a backend reports that a device has disappeared.
 gpu_error_t gpu_get_count(int32_t* count);
 gpu_error_t gpu_get_info(int32_t index, gpu_info_t* info);
+gpu_error_t gpu_get_info_fields(int32_t index, gpu_field_mask_t fields, gpu_info_t* info);
+
+// Split API for cheap polling: gpu_get_desc() is served from a per-device
+// cache after the first call, and gpu_sample() only collects dynamic fields
+gpu_error_t gpu_get_desc(int32_t index, gpu_device_desc_t* desc);
+gpu_error_t gpu_sample(int32_t index, gpu_sample_t* sample);
+double gpu_sample_column(const gpu_sample_t* sample, gpu_column_t column);
+
+// Collect every GPU at once, fanning devices out over the gpu_pool.h worker
+// pool. All devices are read against the same registry, and each gets its own
+// collection timestamp (wall clock, ms) so consumers can see the skew.
+// Fills entries [0, *count) with *count <= max_count; results[i] / valid[i]
+// report per-device failures.
+gpu_error_t gpu_collect_info(gpu_field_mask_t fields, gpu_info_t* infos, gpu_error_t* results,
+                             int64_t* timestamps_ms, int32_t max_count, int32_t* count);
+gpu_error_t gpu_collect_samples(gpu_sample_t* samples, bool* valid, int32_t max_count, int32_t* count);
+
+gpu_error_t gpu_get_device_entry(int32_t index, gpu_device_entry_t* entry);
+gpu_error_t gpu_refresh(void);
 
 // Platform-specific implementations
 gpu_error_t nvidia_get_gpu_count(int32_t* count);
-gpu_error_t nvidia_get_gpu_info(int32_t index, gpu_info_t* info);
+gpu_error_t nvidia_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info);
+void nvidia_cleanup(void);
 
 gpu_error_t amd_get_gpu_count(int32_t* count);
-gpu_error_t amd_get_gpu_info(int32_t index, gpu_info_t* info);
+gpu_error_t amd_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info);
+gpu_error_t amd_get_gpu_path(int32_t index, char* path, size_t size);
+void amd_cleanup(void);
 
 gpu_error_t intel_get_gpu_count(int32_t* count);
-gpu_error_t intel_get_gpu_info(int32_t index, gpu_info_t* info);
+gpu_error_t intel_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info);
 
 // Utility functions
 const char* gpu_error_string(gpu_error_t error);
@@ -0,0 +1,739 @@
+// accept4() and memmem()
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "gpu_metrics_server.h"
+
+#ifdef __linux__
+
+#include "gpu_sampler.h"
+#include "gpu_thread.h"
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define REQUEST_BUFFER_SIZE 8192    // Request line and headers must fit
+#define MAX_EVENTS 64
+#define SWEEP_INTERVAL_MS 1000      // How often idle connections are looked for
+
+// epoll tags for the two fds that are not connections
+#define TAG_LISTEN UINT32_MAX
+#define TAG_WAKE (UINT32_MAX - 1)
+
+#define CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+// A rendering shared by every connection still sending it
+typedef struct {
+    int32_t refs;
+    char* data;
+    size_t length;
+} body_t;
+
+typedef struct {
+    int fd;                     // -1 when the slot is free
+    int64_t last_active_ms;
+    
+    char request[REQUEST_BUFFER_SIZE];
+    size_t request_length;
+    
+    // Response in flight: status line, headers and (for errors) a short body
+    // in head, followed by the shared rendering if there is one
+    char head[512];
+    size_t head_length;
+    size_t head_sent;
+    body_t* body;
+    size_t body_sent;
+    bool writing;
+    bool close_after;           // Close once the response is out
+    bool peer_closed;           // Peer finished sending; answer what is buffered
+} connection_t;
+
+struct gpu_metrics_server {
+    int listen_fd;
+    int wake_fd;
+    int epoll_fd;
+    uint16_t port;
+    char path[256];
+    bool backend_ref;
+    
+    gpu_prometheus_t* renderer;
+    
+    // Last rendering; reused while the sampler has not ticked since
+    body_t* cached;
+    bool cached_sampled;
+    int32_t cached_count;
+    int64_t cached_timestamps[GPU_MAX_DEVICES];
+    
+    connection_t* connections;
+    int32_t* free_slots;
+    int32_t free_count;
+    int32_t max_connections;
+    
+    gpu_thread_t thread;
+    bool thread_started;
+};
+
+static void body_release(body_t* body) {
+    if (body && --body->refs == 0) {
+        free(body->data);
+        free(body);
+    }
+}
+
+static bool same_samples(const gpu_metrics_server_t* server, const gpu_sample_t* samples,
+                         const bool* valid, int32_t count) {
+    if (count != server->cached_count) {
+        return false;
+    }
+    for (int32_t i = 0; i < count; i++) {
+        int64_t timestamp = valid[i] ? samples[i].timestamp_ms : -1;
+        if (timestamp != server->cached_timestamps[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rendering of the latest samples with a reference for the caller, or NULL
+static body_t* acquire_body(gpu_metrics_server_t* server) {
+    gpu_sample_t samples[GPU_MAX_DEVICES];
+    bool valid[GPU_MAX_DEVICES];
+    int32_t count = 0;
+    
+    bool sampled = gpu_sampler_latest_all(samples, valid, GPU_MAX_DEVICES, &count) == GPU_SUCCESS;
+    if (!sampled && gpu_collect_samples(samples, valid, GPU_MAX_DEVICES, &count) != GPU_SUCCESS) {
+        count = 0;
+    }
+    
+    if (sampled && server->cached && server->cached_sampled &&
+        same_samples(server, samples, valid, count)) {
+        server->cached->refs++;
+        return server->cached;
+    }
+    
+    body_t* body = (body_t*)calloc(1, sizeof(body_t));
+    if (!body) {
+        return NULL;
+    }
+    if (gpu_prometheus_render(server->renderer, samples, valid, count,
+                              &body->data, &body->length) != GPU_SUCCESS) {
+        free(body);
+        return NULL;
+    }
+    
+    // One reference for the cache, one for the caller
+    body->refs = 2;
+    body_release(server->cached);
+    server->cached = body;
+    server->cached_sampled = sampled;
+    server->cached_count = count;
+    for (int32_t i = 0; i < count; i++) {
+        server->cached_timestamps[i] = valid[i] ? samples[i].timestamp_ms : -1;
+    }
+    return body;
+}
+
+static void close_connection(gpu_metrics_server_t* server, connection_t* conn) {
+    if (conn->fd < 0) {
+        return;
+    }
+    
+    // Closing the fd also removes it from the epoll set
+    close(conn->fd);
+    conn->fd = -1;
+    body_release(conn->body);
+    conn->body = NULL;
+    server->free_slots[server->free_count++] = (int32_t)(conn - server->connections);
+}
+
+static void set_interest(gpu_metrics_server_t* server, connection_t* conn, uint32_t events) {
+    struct epoll_event event;
+    event.events = events;
+    event.data.u32 = (uint32_t)(conn - server->connections);
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+// Queue a response; body is NULL for error responses or HEAD
+static void respond(connection_t* conn, const char* status, const char* extra_headers,
+                    const char* text, body_t* body, size_t content_length) {
+    if (text) {
+        content_length = strlen(text);
+    }
+    
+    int length = snprintf(conn->head, sizeof(conn->head),
+                          "HTTP/1.1 %s\r\n"
+                          "Content-Type: %s\r\n"
+                          "Content-Length: %zu\r\n"
+                          "%s%s\r\n%s",
+                          status, text ? "text/plain; charset=utf-8" : CONTENT_TYPE,
+                          content_length, extra_headers ? extra_headers : "",
+                          conn->close_after ? "Connection: close\r\n" : "",
+                          text ? text : "");
+    conn->head_length = (size_t)length < sizeof(conn->head) ? (size_t)length : sizeof(conn->head) - 1;
+    conn->head_sent = 0;
+    conn->body = body;
+    conn->body_sent = 0;
+    conn->writing = true;
+}
+
+// Returns false if the connection has to be closed
+static bool flush_response(connection_t* conn) {
+    while (conn->writing) {
+        struct iovec iov[2];
+        int iov_count = 0;
+        
+        if (conn->head_sent < conn->head_length) {
+            iov[iov_count].iov_base = conn->head + conn->head_sent;
+            iov[iov_count].iov_len = conn->head_length - conn->head_sent;
+            iov_count++;
+        }
+        if (conn->body && conn->body_sent < conn->body->length) {
+            iov[iov_count].iov_base = conn->body->data + conn->body_sent;
+            iov[iov_count].iov_len = conn->body->length - conn->body_sent;
+            iov_count++;
+        }
+        
+        if (iov_count == 0) {
+            conn->writing = false;
+            body_release(conn->body);
+            conn->body = NULL;
+            break;
+        }
+        
+        // sendmsg rather than writev: MSG_NOSIGNAL keeps a reset peer from
+        // raising SIGPIPE in the host process
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = iov;
+        message.msg_iovlen = (size_t)iov_count;
+        
+        ssize_t sent = sendmsg(conn->fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        
+        size_t head_left = conn->head_length - conn->head_sent;
+        if ((size_t)sent <= head_left) {
+            conn->head_sent += (size_t)sent;
+        } else {
+            conn->head_sent = conn->head_length;
+            conn->body_sent += (size_t)sent - head_left;
+        }
+    }
+    return true;
+}
+
+// Does the comma-separated header value contain token (case-insensitive)?
+static bool has_token(const char* value, const char* token) {
+    size_t token_length = strlen(token);
+    const char* p = value;
+    
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        const char* start = p;
+        while (*p && *p != ',') {
+            p++;
+        }
+        const char* end = p;
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t')) {
+            end--;
+        }
+        if ((size_t)(end - start) == token_length && strncasecmp(start, token, token_length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Answer the request in conn->request[0..length), which ends with the blank
+// line. The buffer is modified in place.
+static void handle_request(gpu_metrics_server_t* server, connection_t* conn, size_t length) {
+    char* request = conn->request;
+    request[length - 2] = '\0';
+    
+    char* line_end = strstr(request, "\r\n");
+    if (!line_end) {
+        conn->close_after = true;
+        respond(conn, "400 Bad Request", NULL, "Bad Request\n", NULL, 0);
+        return;
+    }
+    *line_end = '\0';
+    
+    // Request line: METHOD SP target SP version
+    char* method = request;
+    char* target = strchr(method, ' ');
+    char* version = target ? strchr(target + 1, ' ') : NULL;
+    if (!target || !version) {
+        conn->close_after = true;
+        respond(conn, "400 Bad Request", NULL, "Bad Request\n", NULL, 0);
+        return;
+    }
+    *target++ = '\0';
+    *version++ = '\0';
+    
+    bool http11;
+    if (strcmp(version, "HTTP/1.1") == 0) {
+        http11 = true;
+    } else if (strcmp(version, "HTTP/1.0") == 0) {
+        http11 = false;
+    } else {
+        conn->close_after = true;
+        respond(conn, "505 HTTP Version Not Supported", NULL, "HTTP Version Not Supported\n", NULL, 0);
+        return;
+    }
+    
+    // Headers that decide whether the connection stays open
+    bool keep_alive = http11;
+    bool has_body = false;
+    char* line = line_end + 2;
+    while (*line) {
+        char* next = strstr(line, "\r\n");
+        if (next) {
+            *next = '\0';
+            next += 2;
+        } else {
+            next = line + strlen(line);
+        }
+        
+        char* colon = strchr(line, ':');
+        if (colon) {
+            *colon = '\0';
+            char* value = colon + 1;
+            if (strcasecmp(line, "Connection") == 0) {
+                if (has_token(value, "close")) {
+                    keep_alive = false;
+                } else if (has_token(value, "keep-alive")) {
+                    keep_alive = true;
+                }
+            } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+                has_body = true;
+            } else if (strcasecmp(line, "Content-Length") == 0) {
+                has_body = has_body || strtoull(value, NULL, 10) > 0;
+            }
+        }
+        line = next;
+    }
+    
+    // Request bodies are never expected; rather than skip one, answer and
+    // close so it cannot be mistaken for the next request
+    conn->close_after = !keep_alive || has_body || conn->peer_closed;
+    
+    size_t path_length = strcspn(target, "?#");
+    if (path_length != strlen(server->path) || strncmp(target, server->path, path_length) != 0) {
+        respond(conn, "404 Not Found", NULL, "Not Found\n", NULL, 0);
+        return;
+    }
+    
+    bool head = strcmp(method, "HEAD") == 0;
+    if (!head && strcmp(method, "GET") != 0) {
+        respond(conn, "405 Method Not Allowed", "Allow: GET, HEAD\r\n", "Method Not Allowed\n", NULL, 0);
+        return;
+    }
+    
+    body_t* body = acquire_body(server);
+    if (!body) {
+        respond(conn, "500 Internal Server Error", NULL, "Failed to render metrics\n", NULL, 0);
+        return;
+    }
+    
+    size_t content_length = body->length;
+    if (head) {
+        body_release(body);
+        body = NULL;
+    }
+    respond(conn, "200 OK", NULL, NULL, body, content_length);
+}
+
+// Answer every complete request buffered on conn, one response at a time.
+// Returns false if the connection has to be closed.
+static bool process_requests(gpu_metrics_server_t* server, connection_t* conn) {
+    while (!conn->writing) {
+        char* end = (char*)memmem(conn->request, conn->request_length, "\r\n\r\n", 4);
+        if (!end) {
+            if (conn->request_length == sizeof(conn->request)) {
+                conn->close_after = true;
+                respond(conn, "431 Request Header Fields Too Large", NULL,
+                        "Request Header Fields Too Large\n", NULL, 0);
+                conn->request_length = 0;
+            } else {
+                return true;
+            }
+        } else {
+            size_t length = (size_t)(end - conn->request) + 4;
+            handle_request(server, conn, length);
+            
+            // Keep any pipelined bytes that follow
+            memmove(conn->request, conn->request + length, conn->request_length - length);
+            conn->request_length -= length;
+        }
+        
+        if (!flush_response(conn)) {
+            return false;
+        }
+        if (conn->writing) {
+            // Socket buffer is full; read nothing more until it drains
+            set_interest(server, conn, EPOLLOUT);
+            return true;
+        }
+        if (conn->close_after) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void handle_connection(gpu_metrics_server_t* server, connection_t* conn, uint32_t events) {
+    conn->last_active_ms = gpu_monotonic_ms();
+    
+    if (conn->writing) {
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            close_connection(server, conn);
+            return;
+        }
+        if (!flush_response(conn)) {
+            close_connection(server, conn);
+            return;
+        }
+        if (conn->writing) {
+            return;
+        }
+        if (conn->close_after) {
+            close_connection(server, conn);
+            return;
+        }
+        set_interest(server, conn, EPOLLIN);
+        
+        // Requests may have been pipelined behind the one just answered
+        if (!process_requests(server, conn)) {
+            close_connection(server, conn);
+        }
+        return;
+    }
+    
+    for (;;) {
+        size_t space = sizeof(conn->request) - conn->request_length;
+        if (space == 0) {
+            break;
+        }
+        
+        ssize_t received = recv(conn->fd, conn->request + conn->request_length, space, 0);
+        if (received > 0) {
+            conn->request_length += (size_t)received;
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (received == 0 && conn->request_length > 0) {
+            conn->peer_closed = true;
+            break;
+        }
+        
+        // Peer closed with nothing pending, or reset the connection
+        close_connection(server, conn);
+        return;
+    }
+    
+    if (!process_requests(server, conn) || (conn->peer_closed && !conn->writing)) {
+        close_connection(server, conn);
+    }
+}
+
+static void accept_connections(gpu_metrics_server_t* server) {
+    for (;;) {
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+        
+        if (server->free_count == 0) {
+            static const char kBusy[] =
+                "HTTP/1.1 503 Service Unavailable\r\n"
+                "Content-Length: 0\r\n"
+                "Connection: close\r\n\r\n";
+            ssize_t ignored = send(fd, kBusy, sizeof(kBusy) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            (void)ignored;
+            close(fd);
+            continue;
+        }
+        
+        int32_t slot = server->free_slots[--server->free_count];
+        connection_t* conn = &server->connections[slot];
+        
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        
+        conn->fd = fd;
+        conn->last_active_ms = gpu_monotonic_ms();
+        conn->request_length = 0;
+        conn->body = NULL;
+        conn->writing = false;
+        conn->close_after = false;
+        conn->peer_closed = false;
+        
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = (uint32_t)slot;
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close_connection(server, conn);
+        }
+    }
+}
+
+static void close_idle_connections(gpu_metrics_server_t* server, int64_t now) {
+    for (int32_t i = 0; i < server->max_connections; i++) {
+        connection_t* conn = &server->connections[i];
+        if (conn->fd >= 0 && now - conn->last_active_ms >= GPU_METRICS_SERVER_IDLE_TIMEOUT_MS) {
+            close_connection(server, conn);
+        }
+    }
+}
+
+static void server_thread(void* arg) {
+    gpu_metrics_server_t* server = (gpu_metrics_server_t*)arg;
+    struct epoll_event events[MAX_EVENTS];
+    int64_t last_sweep = gpu_monotonic_ms();
+    
+    for (;;) {
+        int ready = epoll_wait(server->epoll_fd, events, MAX_EVENTS, SWEEP_INTERVAL_MS);
+        if (ready < 0 && errno != EINTR) {
+            return;
+        }
+        
+        for (int i = 0; i < ready; i++) {
+            uint32_t tag = events[i].data.u32;
+            if (tag == TAG_WAKE) {
+                return;
+            }
+            if (tag == TAG_LISTEN) {
+                accept_connections(server);
+            } else if (server->connections[tag].fd >= 0) {
+                handle_connection(server, &server->connections[tag], events[i].events);
+            }
+        }
+        
+        int64_t now = gpu_monotonic_ms();
+        if (now - last_sweep >= SWEEP_INTERVAL_MS) {
+            close_idle_connections(server, now);
+            last_sweep = now;
+        }
+    }
+}
+
+static void server_free(gpu_metrics_server_t* server) {
+    if (server->connections) {
+        for (int32_t i = 0; i < server->max_connections; i++) {
+            close_connection(server, &server->connections[i]);
+        }
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+    }
+    if (server->wake_fd >= 0) {
+        close(server->wake_fd);
+    }
+    if (server->epoll_fd >= 0) {
+        close(server->epoll_fd);
+    }
+    body_release(server->cached);
+    gpu_prometheus_destroy(server->renderer);
+    if (server->backend_ref) {
+        gpu_info_cleanup();
+    }
+    free(server->connections);
+    free(server->free_slots);
+    free(server);
+}
+
+// Bind the first address host resolves to
+static gpu_error_t open_listener(gpu_metrics_server_t* server, const char* host, uint16_t port) {
+    char port_text[8];
+    snprintf(port_text, sizeof(port_text), "%u", (unsigned)port);
+    
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    
+    struct addrinfo* addresses = NULL;
+    if (getaddrinfo(host, port_text, &hints, &addresses) != 0) {
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    gpu_error_t result = GPU_ERROR_API_FAILED;
+    for (struct addrinfo* address = addresses; address; address = address->ai_next) {
+        int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        
+        if (bind(fd, address->ai_addr, address->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) {
+            struct sockaddr_storage bound;
+            socklen_t bound_length = sizeof(bound);
+            getsockname(fd, (struct sockaddr*)&bound, &bound_length);
+            server->port = ntohs(bound.ss_family == AF_INET6
+                ? ((struct sockaddr_in6*)&bound)->sin6_port
+                : ((struct sockaddr_in*)&bound)->sin_port);
+            server->listen_fd = fd;
+            result = GPU_SUCCESS;
+            break;
+        }
+        
+        if (errno == EACCES) {
+            result = GPU_ERROR_ACCESS_DENIED;
+        }
+        close(fd);
+    }
+    
+    freeaddrinfo(addresses);
+    return result;
+}
+
+gpu_error_t gpu_metrics_server_start(const gpu_metrics_server_options_t* options,
+                                     gpu_metrics_server_t** server_out) {
+    if (!options || !server_out) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    const char* host = options->host ? options->host : "127.0.0.1";
+    const char* path = options->path ? options->path : "/metrics";
+    int32_t max_connections = options->max_connections > 0
+        ? options->max_connections : GPU_METRICS_SERVER_DEFAULT_CONNECTIONS;
+    
+    if (path[0] != '/' || strlen(path) >= sizeof(((gpu_metrics_server_t*)0)->path) ||
+        max_connections > GPU_METRICS_SERVER_MAX_CONNECTIONS) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_metrics_server_t* server = (gpu_metrics_server_t*)calloc(1, sizeof(gpu_metrics_server_t));
+    if (!server) {
+        return GPU_ERROR_API_FAILED;
+    }
+    server->listen_fd = -1;
+    server->wake_fd = -1;
+    server->epoll_fd = -1;
+    strcpy(server->path, path);
+    
+    server->renderer = gpu_prometheus_create(&options->prometheus);
+    if (!server->renderer) {
+        server_free(server);
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    server->max_connections = max_connections;
+    server->connections = (connection_t*)calloc((size_t)max_connections, sizeof(connection_t));
+    server->free_slots = (int32_t*)calloc((size_t)max_connections, sizeof(int32_t));
+    if (!server->connections || !server->free_slots) {
+        server_free(server);
+        return GPU_ERROR_API_FAILED;
+    }
+    for (int32_t i = 0; i < max_connections; i++) {
+        server->connections[i].fd = -1;
+        
+        // Lowest slots are handed out first
+        server->free_slots[i] = max_connections - 1 - i;
+    }
+    server->free_count = max_connections;
+    
+    gpu_error_t result = open_listener(server, host, options->port);
+    if (result != GPU_SUCCESS) {
+        server_free(server);
+        return result;
+    }
+    
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (server->epoll_fd < 0 || server->wake_fd < 0) {
+        server_free(server);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u32 = TAG_LISTEN;
+    bool registered = epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &event) == 0;
+    event.data.u32 = TAG_WAKE;
+    registered = registered && epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->wake_fd, &event) == 0;
+    if (!registered) {
+        server_free(server);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    server->backend_ref = gpu_info_init() == GPU_SUCCESS;
+    
+    if (gpu_thread_create(&server->thread, server_thread, server) != 0) {
+        server_free(server);
+        return GPU_ERROR_API_FAILED;
+    }
+    server->thread_started = true;
+    
+    *server_out = server;
+    return GPU_SUCCESS;
+}
+
+uint16_t gpu_metrics_server_port(const gpu_metrics_server_t* server) {
+    return server ? server->port : 0;
+}
+
+void gpu_metrics_server_stop(gpu_metrics_server_t* server) {
+    if (!server) {
+        return;
+    }
+    
+    if (server->thread_started) {
+        uint64_t one = 1;
+        ssize_t ignored = write(server->wake_fd, &one, sizeof(one));
+        (void)ignored;
+        gpu_thread_join(server->thread);
+    }
+    server_free(server);
+}
+
+#else
+
+gpu_error_t gpu_metrics_server_start(const gpu_metrics_server_options_t* options,
+                                     gpu_metrics_server_t** server) {
+    (void)options;
+    if (server) {
+        *server = NULL;
+    }
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+uint16_t gpu_metrics_server_port(const gpu_metrics_server_t* server) {
+    (void)server;
+    return 0;
+}
+
+void gpu_metrics_server_stop(gpu_metrics_server_t* server) {
+    (void)server;
+}
+
+#endif
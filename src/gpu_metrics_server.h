@@ -0,0 +1,58 @@
+#ifndef GPU_METRICS_SERVER_H
+#define GPU_METRICS_SERVER_H
+
+#include "gpu_info.h"
+#include "gpu_prometheus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Embedded /metrics endpoint. A native thread runs a small epoll-based
+// HTTP/1.1 server that answers scrapes with the Prometheus text rendering of
+// the latest samples, so a busy event loop never delays a scrape. When the
+// background sampler is running its latest samples are served (and the
+// rendering is reused until the next tick); otherwise the GPUs are collected
+// on the server thread per scrape.
+//
+// GET and HEAD on the configured path are served; keep-alive follows
+// HTTP/1.1 rules (HTTP/1.0 clients have to ask for it) and pipelined
+// requests are answered in order. At most max_connections are open at once;
+// further clients get a 503 and are closed, and idle keep-alive connections
+// are closed after GPU_METRICS_SERVER_IDLE_TIMEOUT_MS.
+//
+// Linux only; elsewhere gpu_metrics_server_start() returns
+// GPU_ERROR_NOT_SUPPORTED. Each server holds a gpu_info_init() reference
+// while it runs.
+#define GPU_METRICS_SERVER_DEFAULT_CONNECTIONS 64
+#define GPU_METRICS_SERVER_MAX_CONNECTIONS 4096
+#define GPU_METRICS_SERVER_IDLE_TIMEOUT_MS 30000
+
+typedef struct gpu_metrics_server gpu_metrics_server_t;
+
+typedef struct {
+    const char* host;                   // Address or hostname; NULL = "127.0.0.1"
+    uint16_t port;                      // 0 picks a free port
+    const char* path;                   // NULL = "/metrics"
+    int32_t max_connections;            // <= 0 = GPU_METRICS_SERVER_DEFAULT_CONNECTIONS
+    gpu_prometheus_options_t prometheus;
+} gpu_metrics_server_options_t;
+
+// Bind, listen and start the server thread. GPU_ERROR_INVALID_PARAM for bad
+// options (path not starting with '/', invalid prefix or labels),
+// GPU_ERROR_ACCESS_DENIED if the port needs privileges and
+// GPU_ERROR_API_FAILED if the address cannot be resolved or bound.
+gpu_error_t gpu_metrics_server_start(const gpu_metrics_server_options_t* options,
+                                     gpu_metrics_server_t** server);
+
+// Port actually bound (useful with port 0)
+uint16_t gpu_metrics_server_port(const gpu_metrics_server_t* server);
+
+// Close every connection, join the server thread and free the server
+void gpu_metrics_server_stop(gpu_metrics_server_t* server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_METRICS_SERVER_H
@@ -0,0 +1,117 @@
+#include "gpu_pool.h"
+#include "gpu_thread.h"
+
+// g_batch_lock serializes batches and start/stop; g_pool_lock protects the
+// current batch and is released while a task runs
+static gpu_mutex_t g_batch_lock = GPU_MUTEX_INITIALIZER;
+static gpu_mutex_t g_pool_lock = GPU_MUTEX_INITIALIZER;
+static gpu_cond_t g_work_cond = GPU_COND_INITIALIZER;
+static gpu_cond_t g_done_cond = GPU_COND_INITIALIZER;
+
+static gpu_thread_t g_threads[GPU_POOL_THREADS];
+static int32_t g_thread_count = 0;
+static bool g_stopping = false;
+
+// Current batch: items [g_next, g_items) are still unclaimed
+static gpu_pool_task_t g_task = NULL;
+static void* g_ctx = NULL;
+static int32_t g_items = 0;
+static int32_t g_next = 0;
+static int32_t g_finished = 0;
+
+// Claim and run items until none are left; called with g_pool_lock held
+static void run_items_locked(void) {
+    while (g_next < g_items) {
+        int32_t item = g_next++;
+        gpu_pool_task_t task = g_task;
+        void* ctx = g_ctx;
+        
+        gpu_mutex_unlock(&g_pool_lock);
+        task(item, ctx);
+        gpu_mutex_lock(&g_pool_lock);
+        
+        if (++g_finished == g_items) {
+            gpu_cond_broadcast(&g_done_cond);
+        }
+    }
+}
+
+static void pool_worker(void* arg) {
+    (void)arg;
+    
+    gpu_mutex_lock(&g_pool_lock);
+    while (!g_stopping) {
+        if (g_next < g_items) {
+            run_items_locked();
+        } else {
+            gpu_cond_wait(&g_work_cond, &g_pool_lock);
+        }
+    }
+    gpu_mutex_unlock(&g_pool_lock);
+}
+
+// Requires g_batch_lock
+static void start_threads_locked(void) {
+    if (g_thread_count > 0) {
+        return;
+    }
+    
+    gpu_mutex_lock(&g_pool_lock);
+    g_stopping = false;
+    gpu_mutex_unlock(&g_pool_lock);
+    
+    while (g_thread_count < GPU_POOL_THREADS &&
+           gpu_thread_create(&g_threads[g_thread_count], pool_worker, NULL) == 0) {
+        g_thread_count++;
+    }
+}
+
+void gpu_pool_run(gpu_pool_task_t task, void* ctx, int32_t items) {
+    if (!task || items <= 0) {
+        return;
+    }
+    
+    gpu_mutex_lock(&g_batch_lock);
+    
+    if (items > 1) {
+        start_threads_locked();
+    }
+    
+    gpu_mutex_lock(&g_pool_lock);
+    g_task = task;
+    g_ctx = ctx;
+    g_items = items;
+    g_next = 0;
+    g_finished = 0;
+    gpu_cond_broadcast(&g_work_cond);
+    
+    // Work alongside the pool, then wait for items other threads claimed
+    run_items_locked();
+    while (g_finished < g_items) {
+        gpu_cond_wait(&g_done_cond, &g_pool_lock);
+    }
+    
+    g_task = NULL;
+    g_ctx = NULL;
+    g_items = 0;
+    g_next = 0;
+    gpu_mutex_unlock(&g_pool_lock);
+    
+    gpu_mutex_unlock(&g_batch_lock);
+}
+
+void gpu_pool_stop(void) {
+    gpu_mutex_lock(&g_batch_lock);
+    
+    gpu_mutex_lock(&g_pool_lock);
+    g_stopping = true;
+    gpu_cond_broadcast(&g_work_cond);
+    gpu_mutex_unlock(&g_pool_lock);
+    
+    for (int32_t i = 0; i < g_thread_count; i++) {
+        gpu_thread_join(g_threads[i]);
+    }
+    g_thread_count = 0;
+    
+    gpu_mutex_unlock(&g_batch_lock);
+}
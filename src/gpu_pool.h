@@ -0,0 +1,34 @@
+#ifndef GPU_POOL_H
+#define GPU_POOL_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-size native worker pool used to collect several GPUs at once. Driver
+// and sysfs reads block (amdgpu can take milliseconds per read while the SMU
+// answers), so fanning devices out keeps multi-GPU collection close to the
+// cost of the slowest device instead of the sum of all of them.
+//
+// Threads are started on first use and stopped by gpu_pool_stop(). The
+// calling thread works on the batch too. Batches from different callers run
+// one after another.
+#define GPU_POOL_THREADS 7
+
+typedef void (*gpu_pool_task_t)(int32_t item, void* ctx);
+
+// Run task(i, ctx) for every i in [0, items) and wait for all of them.
+// Falls back to running serially on the calling thread if the pool threads
+// cannot be started. Thread-safe; tasks must not call gpu_pool_run().
+void gpu_pool_run(gpu_pool_task_t task, void* ctx, int32_t items);
+
+// Stop and join the pool threads once the current batch (if any) is done
+void gpu_pool_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_POOL_H
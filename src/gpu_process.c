@@ -0,0 +1,754 @@
+// O_PATH
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "gpu_process.h"
+
+#ifdef __linux__
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DRI_PREFIX "/dev/dri/"
+#define FDINFO_BYTES 8192
+#define NO_CLIENT_ID (1ull << 63)   // Or'ed with the fd when drm-client-id is missing
+
+// Counters of one engine of one DRM client
+typedef struct {
+    char name[GPU_PROCESS_NAME_BYTES];
+    bool cycles;
+    uint32_t capacity;
+    uint64_t busy;
+    uint64_t total;             // drm-total-cycles-; 0 for ns counters
+} client_engine_t;
+
+typedef struct {
+    gpu_process_region_t region;
+    bool has_total;
+} client_region_t;
+
+// One fdinfo file as parsed
+typedef struct {
+    char driver[16];
+    char pdev[32];
+    bool has_id;
+    uint64_t id;
+    uint32_t engine_count;
+    client_engine_t engines[GPU_PROCESS_MAX_ENGINES];
+    uint32_t region_count;
+    client_region_t regions[GPU_PROCESS_MAX_REGIONS];
+} fdinfo_t;
+
+// A client seen by a scan, kept for the deltas of the next one
+typedef struct {
+    int32_t pid;
+    uint64_t device_key;        // Hash of driver and pdev
+    uint64_t id;                // drm-client-id, or the fd | NO_CLIENT_ID
+    uint64_t time_ns;           // CLOCK_MONOTONIC when its fdinfo was read
+    uint32_t engine_count;
+    client_engine_t engines[GPU_PROCESS_MAX_ENGINES];
+} client_state_t;
+
+typedef struct {
+    uint64_t pci;
+    int32_t index;
+} device_pci_t;
+
+struct gpu_process_scanner {
+    int proc_fd;
+    
+    // Clients of this scan, in the order found, and of the previous one,
+    // sorted for lookup
+    client_state_t* clients;
+    size_t client_count;
+    size_t client_capacity;
+    client_state_t* previous;
+    size_t previous_count;
+    size_t previous_capacity;
+    
+    gpu_process_t* processes;
+    size_t process_count;
+    size_t process_capacity;
+    
+    // GPU PCI addresses, read once per scan on the first DRM client
+    bool devices_loaded;
+    device_pci_t devices[GPU_MAX_DEVICES];
+    int32_t device_count;
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static bool reserve(void** array, size_t* capacity, size_t need, size_t size) {
+    if (need <= *capacity) {
+        return true;
+    }
+    size_t grown = *capacity ? *capacity * 2 : 16;
+    while (grown < need) {
+        grown *= 2;
+    }
+    void* resized = realloc(*array, grown * size);
+    if (!resized) {
+        return false;
+    }
+    *array = resized;
+    *capacity = grown;
+    return true;
+}
+
+static void copy_field(char* dst, size_t size, const char* src, size_t len) {
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+// "domain:bus:device.function" with a 4 or 8 digit domain, as published in
+// drm-pdev and reported by the backends
+static bool parse_pci(const char* text, uint64_t* pci) {
+    unsigned int domain, bus, device, function;
+    if (sscanf(text, "%x:%x:%x.%x", &domain, &bus, &device, &function) != 4) {
+        return false;
+    }
+    *pci = ((uint64_t)domain << 16) | ((bus & 0xff) << 8) | ((device & 0x1f) << 3) | (function & 0x7);
+    return true;
+}
+
+static uint64_t device_key(const fdinfo_t* info) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char* c = info->driver; *c; c++) {
+        hash = (hash ^ (uint8_t)*c) * 0x100000001b3ull;
+    }
+    hash = (hash ^ ':') * 0x100000001b3ull;
+    for (const char* c = info->pdev; *c; c++) {
+        hash = (hash ^ (uint8_t)*c) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// fdinfo parsing
+// ---------------------------------------------------------------------------
+
+// A "key:<blanks>value" line, pointing into the buffer being scanned
+typedef struct {
+    const char* key;
+    size_t key_len;
+    const char* value;
+    size_t value_len;
+} kv_t;
+
+// Next line with a colon in [*cursor, end); advances *cursor past it
+static bool next_kv(const char** cursor, const char* end, kv_t* kv) {
+    while (*cursor < end) {
+        const char* line = *cursor;
+        const char* eol = (const char*)memchr(line, '\n', (size_t)(end - line));
+        if (!eol) {
+            eol = end;
+        }
+        *cursor = eol < end ? eol + 1 : end;
+        
+        const char* colon = (const char*)memchr(line, ':', (size_t)(eol - line));
+        if (!colon) {
+            continue;
+        }
+        const char* value = colon + 1;
+        while (value < eol && (*value == ' ' || *value == '\t')) {
+            value++;
+        }
+        const char* value_end = eol;
+        while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t' ||
+                                     value_end[-1] == '\r')) {
+            value_end--;
+        }
+        kv->key = line;
+        kv->key_len = (size_t)(colon - line);
+        kv->value = value;
+        kv->value_len = (size_t)(value_end - value);
+        return true;
+    }
+    return false;
+}
+
+// Strips prefix from the key; false if the key does not start with it
+static bool key_suffix(const kv_t* kv, const char* prefix, const char** name, size_t* len) {
+    size_t prefix_len = strlen(prefix);
+    if (kv->key_len <= prefix_len || memcmp(kv->key, prefix, prefix_len) != 0) {
+        return false;
+    }
+    *name = kv->key + prefix_len;
+    *len = kv->key_len - prefix_len;
+    return true;
+}
+
+static bool key_is(const kv_t* kv, const char* key) {
+    return kv->key_len == strlen(key) && memcmp(kv->key, key, kv->key_len) == 0;
+}
+
+// Leading decimal number scaled by an optional KiB/MiB/GiB unit
+static bool parse_value(const kv_t* kv, uint64_t* value) {
+    const char* c = kv->value;
+    const char* end = kv->value + kv->value_len;
+    if (c == end || *c < '0' || *c > '9') {
+        return false;
+    }
+    uint64_t n = 0;
+    for (; c < end && *c >= '0' && *c <= '9'; c++) {
+        n = n * 10 + (uint64_t)(*c - '0');
+    }
+    while (c < end && *c == ' ') {
+        c++;
+    }
+    if (end - c == 3 && c[1] == 'i' && c[2] == 'B') {
+        switch (c[0]) {
+            case 'K': n <<= 10; break;
+            case 'M': n <<= 20; break;
+            case 'G': n <<= 30; break;
+            default: break;
+        }
+    }
+    *value = n;
+    return true;
+}
+
+static client_engine_t* fdinfo_engine(fdinfo_t* info, const char* name, size_t len) {
+    if (len >= GPU_PROCESS_NAME_BYTES) {
+        len = GPU_PROCESS_NAME_BYTES - 1;
+    }
+    for (uint32_t i = 0; i < info->engine_count; i++) {
+        client_engine_t* engine = &info->engines[i];
+        if (strncmp(engine->name, name, len) == 0 && engine->name[len] == '\0') {
+            return engine;
+        }
+    }
+    if (info->engine_count == GPU_PROCESS_MAX_ENGINES) {
+        return NULL;
+    }
+    client_engine_t* engine = &info->engines[info->engine_count++];
+    memset(engine, 0, sizeof(*engine));
+    copy_field(engine->name, sizeof(engine->name), name, len);
+    engine->capacity = 1;
+    return engine;
+}
+
+static client_region_t* fdinfo_region(fdinfo_t* info, const char* name, size_t len) {
+    if (len >= GPU_PROCESS_NAME_BYTES) {
+        len = GPU_PROCESS_NAME_BYTES - 1;
+    }
+    for (uint32_t i = 0; i < info->region_count; i++) {
+        client_region_t* region = &info->regions[i];
+        if (strncmp(region->region.name, name, len) == 0 && region->region.name[len] == '\0') {
+            return region;
+        }
+    }
+    if (info->region_count == GPU_PROCESS_MAX_REGIONS) {
+        return NULL;
+    }
+    client_region_t* region = &info->regions[info->region_count++];
+    memset(region, 0, sizeof(*region));
+    copy_field(region->region.name, sizeof(region->region.name), name, len);
+    return region;
+}
+
+static void parse_kv(fdinfo_t* info, const kv_t* kv) {
+    const char* name;
+    size_t len;
+    uint64_t value;
+    
+    if (key_is(kv, "drm-driver")) {
+        copy_field(info->driver, sizeof(info->driver), kv->value, kv->value_len);
+        return;
+    }
+    if (key_is(kv, "drm-pdev")) {
+        copy_field(info->pdev, sizeof(info->pdev), kv->value, kv->value_len);
+        return;
+    }
+    if (!parse_value(kv, &value)) {
+        return;
+    }
+    if (key_is(kv, "drm-client-id")) {
+        info->has_id = true;
+        info->id = value;
+        return;
+    }
+    
+    // Longer prefixes first: drm-engine-capacity- is also a drm-engine- key
+    // and drm-total-cycles- a drm-total- one
+    client_engine_t* engine = NULL;
+    client_region_t* region = NULL;
+    if (key_suffix(kv, "drm-engine-capacity-", &name, &len)) {
+        if ((engine = fdinfo_engine(info, name, len)) && value > 0) {
+            engine->capacity = (uint32_t)value;
+        }
+    } else if (key_suffix(kv, "drm-engine-", &name, &len)) {
+        if ((engine = fdinfo_engine(info, name, len))) {
+            engine->busy = value;
+        }
+    } else if (key_suffix(kv, "drm-total-cycles-", &name, &len)) {
+        if ((engine = fdinfo_engine(info, name, len))) {
+            engine->cycles = true;
+            engine->total = value;
+        }
+    } else if (key_suffix(kv, "drm-cycles-", &name, &len)) {
+        if ((engine = fdinfo_engine(info, name, len))) {
+            engine->cycles = true;
+            engine->busy = value;
+        }
+    } else if (key_suffix(kv, "drm-resident-", &name, &len) ||
+               key_suffix(kv, "drm-memory-", &name, &len)) {
+        if ((region = fdinfo_region(info, name, len))) {
+            region->region.resident_bytes = value;
+        }
+    } else if (key_suffix(kv, "drm-total-", &name, &len)) {
+        if ((region = fdinfo_region(info, name, len))) {
+            region->region.total_bytes = value;
+            region->has_total = true;
+        }
+    }
+}
+
+// Parse dir_fd/path; false if it cannot be read or is not a DRM client
+static bool read_fdinfo(int dir_fd, const char* path, fdinfo_t* info) {
+    char buf[FDINFO_BYTES];
+    int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    size_t len = 0;
+    while (len < sizeof(buf)) {
+        ssize_t n = read(fd, buf + len, sizeof(buf) - len);
+        if (n <= 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+    close(fd);
+    
+    // A full buffer may end in a cut line; drop it
+    if (len == sizeof(buf)) {
+        while (len > 0 && buf[len - 1] != '\n') {
+            len--;
+        }
+    }
+    
+    memset(info, 0, offsetof(fdinfo_t, engines));
+    info->region_count = 0;
+    const char* cursor = buf;
+    kv_t kv;
+    while (next_kv(&cursor, buf + len, &kv)) {
+        parse_kv(info, &kv);
+    }
+    
+    for (uint32_t i = 0; i < info->region_count; i++) {
+        if (!info->regions[i].has_total) {
+            info->regions[i].region.total_bytes = info->regions[i].region.resident_bytes;
+        }
+    }
+    return info->driver[0] != '\0';
+}
+
+// ---------------------------------------------------------------------------
+// Scanning
+// ---------------------------------------------------------------------------
+
+static int compare_clients(const void* a, const void* b) {
+    const client_state_t* x = (const client_state_t*)a;
+    const client_state_t* y = (const client_state_t*)b;
+    if (x->pid != y->pid) {
+        return x->pid < y->pid ? -1 : 1;
+    }
+    if (x->device_key != y->device_key) {
+        return x->device_key < y->device_key ? -1 : 1;
+    }
+    if (x->id != y->id) {
+        return x->id < y->id ? -1 : 1;
+    }
+    return 0;
+}
+
+static int compare_processes(const void* a, const void* b) {
+    const gpu_process_t* x = (const gpu_process_t*)a;
+    const gpu_process_t* y = (const gpu_process_t*)b;
+    if (x->pid != y->pid) {
+        return x->pid < y->pid ? -1 : 1;
+    }
+    if (x->device != y->device) {
+        return (uint32_t)x->device < (uint32_t)y->device ? -1 : 1;  // Unmatched (-1) last
+    }
+    int order = strcmp(x->pdev, y->pdev);
+    return order ? order : strcmp(x->driver, y->driver);
+}
+
+static void load_devices(gpu_process_scanner_t* scanner) {
+    scanner->devices_loaded = true;
+    scanner->device_count = 0;
+    
+    int32_t count = 0;
+    if (gpu_get_count(&count) != GPU_SUCCESS) {
+        return;
+    }
+    for (int32_t i = 0; i < count && i < GPU_MAX_DEVICES; i++) {
+        gpu_device_desc_t desc;
+        uint64_t pci;
+        if (gpu_get_desc(i, &desc) == GPU_SUCCESS && parse_pci(desc.pci_bus_id, &pci)) {
+            scanner->devices[scanner->device_count].pci = pci;
+            scanner->devices[scanner->device_count].index = i;
+            scanner->device_count++;
+        }
+    }
+}
+
+static int32_t device_index(gpu_process_scanner_t* scanner, const char* pdev) {
+    uint64_t pci;
+    if (!parse_pci(pdev, &pci)) {
+        return -1;
+    }
+    if (!scanner->devices_loaded) {
+        load_devices(scanner);
+    }
+    for (int32_t i = 0; i < scanner->device_count; i++) {
+        if (scanner->devices[i].pci == pci) {
+            return scanner->devices[i].index;
+        }
+    }
+    return -1;
+}
+
+// Percent of the engine's capacity busy since prev, -1 if there is nothing
+// to compare against or a counter went backwards
+static double engine_utilization(const client_state_t* prev, const client_state_t* client,
+                                 const client_engine_t* engine) {
+    if (!prev) {
+        return -1;
+    }
+    const client_engine_t* before = NULL;
+    for (uint32_t i = 0; i < prev->engine_count; i++) {
+        if (strcmp(prev->engines[i].name, engine->name) == 0) {
+            before = &prev->engines[i];
+            break;
+        }
+    }
+    if (!before || before->cycles != engine->cycles || engine->busy < before->busy) {
+        return -1;
+    }
+    
+    double elapsed;
+    if (engine->cycles) {
+        if (engine->total <= before->total) {
+            return -1;
+        }
+        elapsed = (double)(engine->total - before->total);
+    } else {
+        if (client->time_ns <= prev->time_ns) {
+            return -1;
+        }
+        elapsed = (double)(client->time_ns - prev->time_ns);
+    }
+    double utilization = (double)(engine->busy - before->busy) / elapsed / engine->capacity * 100.0;
+    return utilization < 100.0 ? utilization : 100.0;
+}
+
+static void read_comm(int pid_fd, char* name, size_t size) {
+    name[0] = '\0';
+    int fd = openat(pid_fd, "comm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    ssize_t n = read(fd, name, size - 1);
+    close(fd);
+    if (n <= 0) {
+        n = 0;
+    }
+    name[n] = '\0';
+    name[strcspn(name, "\n")] = '\0';
+}
+
+// Entry of pid for the client's device, added if this is its first client
+static gpu_process_t* process_entry(gpu_process_scanner_t* scanner, size_t first, int pid_fd,
+                                    int32_t pid, const fdinfo_t* info) {
+    for (size_t i = first; i < scanner->process_count; i++) {
+        gpu_process_t* process = &scanner->processes[i];
+        if (strcmp(process->driver, info->driver) == 0 && strcmp(process->pdev, info->pdev) == 0) {
+            return process;
+        }
+    }
+    if (!reserve((void**)&scanner->processes, &scanner->process_capacity,
+                 scanner->process_count + 1, sizeof(gpu_process_t))) {
+        return NULL;
+    }
+    gpu_process_t* process = &scanner->processes[scanner->process_count++];
+    memset(process, 0, offsetof(gpu_process_t, engines));
+    process->pid = pid;
+    process->device = device_index(scanner, info->pdev);
+    if (scanner->process_count - 1 > first) {
+        memcpy(process->name, scanner->processes[first].name, sizeof(process->name));
+    } else {
+        read_comm(pid_fd, process->name, sizeof(process->name));
+    }
+    memcpy(process->driver, info->driver, sizeof(process->driver));
+    memcpy(process->pdev, info->pdev, sizeof(process->pdev));
+    return process;
+}
+
+static void add_client(gpu_process_t* process, const fdinfo_t* info, const client_state_t* prev,
+                       const client_state_t* client) {
+    process->clients++;
+    
+    for (uint32_t i = 0; i < info->engine_count; i++) {
+        const client_engine_t* engine = &info->engines[i];
+        gpu_process_engine_t* total = NULL;
+        for (uint32_t j = 0; j < process->engine_count; j++) {
+            if (strcmp(process->engines[j].name, engine->name) == 0) {
+                total = &process->engines[j];
+                break;
+            }
+        }
+        if (!total) {
+            if (process->engine_count == GPU_PROCESS_MAX_ENGINES) {
+                continue;
+            }
+            total = &process->engines[process->engine_count++];
+            memcpy(total->name, engine->name, sizeof(total->name));
+            total->cycles = engine->cycles;
+            total->capacity = engine->capacity;
+            total->busy = 0;
+            total->utilization = -1;
+        }
+        total->busy += engine->busy;
+        
+        double utilization = engine_utilization(prev, client, engine);
+        if (utilization >= 0) {
+            total->utilization = total->utilization < 0 ? utilization : total->utilization + utilization;
+            if (total->utilization > 100.0) {
+                total->utilization = 100.0;
+            }
+        }
+    }
+    
+    for (uint32_t i = 0; i < info->region_count; i++) {
+        const gpu_process_region_t* region = &info->regions[i].region;
+        gpu_process_region_t* total = NULL;
+        for (uint32_t j = 0; j < process->region_count; j++) {
+            if (strcmp(process->regions[j].name, region->name) == 0) {
+                total = &process->regions[j];
+                break;
+            }
+        }
+        if (!total) {
+            if (process->region_count == GPU_PROCESS_MAX_REGIONS) {
+                continue;
+            }
+            total = &process->regions[process->region_count++];
+            memcpy(total->name, region->name, sizeof(total->name));
+            total->total_bytes = 0;
+            total->resident_bytes = 0;
+        }
+        total->total_bytes += region->total_bytes;
+        total->resident_bytes += region->resident_bytes;
+    }
+}
+
+static bool is_number(const char* name) {
+    if (!*name) {
+        return false;
+    }
+    for (; *name; name++) {
+        if (*name < '0' || *name > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void scan_process(gpu_process_scanner_t* scanner, int proc_fd, const char* pid_name) {
+    int pid_fd = openat(proc_fd, pid_name, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (pid_fd < 0) {
+        return;
+    }
+    // Fails for other users' processes without the privileges to inspect them
+    int fd_dir = openat(pid_fd, "fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* fds = fd_dir >= 0 ? fdopendir(fd_dir) : NULL;
+    if (!fds) {
+        if (fd_dir >= 0) {
+            close(fd_dir);
+        }
+        close(pid_fd);
+        return;
+    }
+    
+    int32_t pid = atoi(pid_name);
+    size_t first_client = scanner->client_count;
+    size_t first_process = scanner->process_count;
+    struct dirent* entry;
+    while ((entry = readdir(fds)) != NULL) {
+        if (!is_number(entry->d_name)) {
+            continue;
+        }
+        
+        // Only fds on a DRM device node are worth opening
+        char target[64];
+        ssize_t len = readlinkat(fd_dir, entry->d_name, target, sizeof(target));
+        if (len < (ssize_t)(sizeof(DRI_PREFIX) - 1) ||
+            memcmp(target, DRI_PREFIX, sizeof(DRI_PREFIX) - 1) != 0) {
+            continue;
+        }
+        int fd = atoi(entry->d_name);
+        char path[32];
+        snprintf(path, sizeof(path), "fdinfo/%d", fd);
+        fdinfo_t info;
+        if (!read_fdinfo(pid_fd, path, &info)) {
+            continue;
+        }
+        
+        // The same client behind several fds of this process counts once
+        uint64_t key = device_key(&info);
+        uint64_t id = info.has_id ? info.id : ((uint64_t)fd | NO_CLIENT_ID);
+        bool seen = false;
+        for (size_t i = first_client; i < scanner->client_count && !seen; i++) {
+            seen = scanner->clients[i].device_key == key && scanner->clients[i].id == id;
+        }
+        if (seen) {
+            continue;
+        }
+        
+        if (!reserve((void**)&scanner->clients, &scanner->client_capacity,
+                     scanner->client_count + 1, sizeof(client_state_t))) {
+            continue;
+        }
+        gpu_process_t* process = process_entry(scanner, first_process, pid_fd, pid, &info);
+        if (!process) {
+            continue;
+        }
+        client_state_t* client = &scanner->clients[scanner->client_count++];
+        client->pid = pid;
+        client->device_key = key;
+        client->id = id;
+        client->time_ns = now_ns();
+        client->engine_count = info.engine_count;
+        memcpy(client->engines, info.engines, info.engine_count * sizeof(client_engine_t));
+        
+        const client_state_t* prev = NULL;
+        if (scanner->previous_count > 0) {
+            prev = (const client_state_t*)bsearch(client, scanner->previous, scanner->previous_count,
+                                                  sizeof(client_state_t), compare_clients);
+        }
+        add_client(process, &info, prev, client);
+    }
+    
+    closedir(fds);
+    close(pid_fd);
+}
+
+gpu_error_t gpu_process_scanner_open(const char* proc_root, gpu_process_scanner_t** scanner) {
+    if (!scanner) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    *scanner = NULL;
+    
+    int proc_fd = open(proc_root ? proc_root : "/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (proc_fd < 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    gpu_process_scanner_t* created = (gpu_process_scanner_t*)calloc(1, sizeof(gpu_process_scanner_t));
+    if (!created) {
+        close(proc_fd);
+        return GPU_ERROR_API_FAILED;
+    }
+    created->proc_fd = proc_fd;
+    *scanner = created;
+    return GPU_SUCCESS;
+}
+
+void gpu_process_scanner_close(gpu_process_scanner_t* scanner) {
+    if (!scanner) {
+        return;
+    }
+    close(scanner->proc_fd);
+    free(scanner->clients);
+    free(scanner->previous);
+    free(scanner->processes);
+    free(scanner);
+}
+
+gpu_error_t gpu_process_scan(gpu_process_scanner_t* scanner, const gpu_process_t** processes,
+                             int32_t* count) {
+    if (!scanner || !processes || !count) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    // A fresh open file description, so the directory is read from the start
+    int proc_dir = openat(scanner->proc_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* proc = proc_dir >= 0 ? fdopendir(proc_dir) : NULL;
+    if (!proc) {
+        if (proc_dir >= 0) {
+            close(proc_dir);
+        }
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    scanner->client_count = 0;
+    scanner->process_count = 0;
+    scanner->devices_loaded = false;
+    
+    struct dirent* entry;
+    while ((entry = readdir(proc)) != NULL) {
+        if (is_number(entry->d_name)) {
+            scan_process(scanner, proc_dir, entry->d_name);
+        }
+    }
+    closedir(proc);
+    
+    // This scan's clients become the baseline of the next one
+    if (scanner->client_count > 1) {
+        qsort(scanner->clients, scanner->client_count, sizeof(client_state_t), compare_clients);
+    }
+    client_state_t* swap = scanner->previous;
+    size_t swap_capacity = scanner->previous_capacity;
+    scanner->previous = scanner->clients;
+    scanner->previous_count = scanner->client_count;
+    scanner->previous_capacity = scanner->client_capacity;
+    scanner->clients = swap;
+    scanner->client_capacity = swap_capacity;
+    scanner->client_count = 0;
+    
+    if (scanner->process_count > 1) {
+        qsort(scanner->processes, scanner->process_count, sizeof(gpu_process_t), compare_processes);
+    }
+    *processes = scanner->processes;
+    *count = (int32_t)scanner->process_count;
+    return GPU_SUCCESS;
+}
+
+#else
+
+gpu_error_t gpu_process_scanner_open(const char* proc_root, gpu_process_scanner_t** scanner) {
+    (void)proc_root;
+    if (scanner) {
+        *scanner = NULL;
+    }
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+void gpu_process_scanner_close(gpu_process_scanner_t* scanner) {
+    (void)scanner;
+}
+
+gpu_error_t gpu_process_scan(gpu_process_scanner_t* scanner, const gpu_process_t** processes,
+                             int32_t* count) {
+    (void)scanner;
+    (void)processes;
+    (void)count;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef GPU_PROCESS_H
+#define GPU_PROCESS_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-process GPU usage from DRM fdinfo (Linux). Drivers that implement the
+// DRM client usage stats (amdgpu, i915, xe, msm, panfrost, ...) publish for
+// every open DRM file, in /proc/<pid>/fdinfo/<fd>:
+//   drm-driver, drm-pdev          owning driver and device (PCI address)
+//   drm-client-id                 unique per open DRM file of a device
+//   drm-engine-<engine>           busy time in ns, or
+//   drm-cycles-<engine> with drm-total-cycles-<engine>   busy and elapsed
+//                                 GPU cycles (xe)
+//   drm-engine-capacity-<engine>  engines of that class, 1 if absent
+//   drm-memory-<region>, drm-resident-<region>, drm-total-<region>
+//                                 memory, with an optional KiB/MiB/GiB unit
+// A scan walks /proc, keeps the fds that link to /dev/dri/, and parses their
+// fdinfo in place from a stack buffer. An fd dup()ed or inherited within a
+// process shows up once per fd with the same drm-client-id and is counted
+// once; a client shared by several processes is reported under each.
+//
+// Engine utilization is the busy time accumulated since the previous scan
+// over the wall time between the two reads (for cycle counters, busy cycles
+// over elapsed GPU cycles), divided by the engine capacity. A client seen for
+// the first time has no utilization yet.
+//
+// NVIDIA's proprietary driver does not publish these keys. Processes owned by
+// other users are only visible with the matching privileges (root or
+// CAP_SYS_PTRACE); unreadable ones are skipped.
+#define GPU_PROCESS_MAX_ENGINES 16
+#define GPU_PROCESS_MAX_REGIONS 8
+#define GPU_PROCESS_NAME_BYTES 24
+
+typedef struct {
+    char name[GPU_PROCESS_NAME_BYTES];      // e.g. "gfx", "render", "video"
+    bool cycles;                // busy is in GPU cycles rather than ns
+    uint32_t capacity;
+    uint64_t busy;              // Summed over the process's clients
+    double utilization;         // Percent of capacity since the previous scan, -1 if unknown
+} gpu_process_engine_t;
+
+typedef struct {
+    char name[GPU_PROCESS_NAME_BYTES];      // e.g. "vram", "gtt", "system0"
+    uint64_t total_bytes;       // drm-total-; resident when not published
+    uint64_t resident_bytes;    // drm-resident- or the older drm-memory-
+} gpu_process_region_t;
+
+// Usage of one device by one process
+typedef struct {
+    int32_t pid;
+    int32_t device;             // Index of the GPU matching pdev, -1 if none does
+    char name[16];              // /proc/<pid>/comm
+    char driver[16];
+    char pdev[32];              // Empty if the driver does not publish it
+    uint32_t clients;           // Distinct DRM clients
+    uint32_t engine_count;
+    uint32_t region_count;
+    gpu_process_engine_t engines[GPU_PROCESS_MAX_ENGINES];
+    gpu_process_region_t regions[GPU_PROCESS_MAX_REGIONS];
+} gpu_process_t;
+
+// Holds the counters of the previous scan. Not thread safe: use a scanner
+// from one thread at a time.
+typedef struct gpu_process_scanner gpu_process_scanner_t;
+
+// proc_root NULL is "/proc". GPU_ERROR_INVALID_PARAM if it cannot be opened,
+// GPU_ERROR_NOT_SUPPORTED on anything but Linux.
+gpu_error_t gpu_process_scanner_open(const char* proc_root, gpu_process_scanner_t** scanner);
+
+void gpu_process_scanner_close(gpu_process_scanner_t* scanner);
+
+// Every process with a DRM client, sorted by pid then device. *processes is
+// owned by the scanner and valid until the next scan or close.
+gpu_error_t gpu_process_scan(gpu_process_scanner_t* scanner, const gpu_process_t** processes,
+                             int32_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_PROCESS_H
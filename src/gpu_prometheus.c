@@ -0,0 +1,313 @@
+#include "gpu_prometheus.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Pseudo-column for the one metric that comes from the descriptor
+#define COLUMN_MEMORY_TOTAL GPU_COLUMN_COUNT
+
+typedef struct {
+    const char* name;           // Appended to "<prefix>_"
+    const char* unit;           // OpenMetrics UNIT; also the name suffix
+    const char* help;
+    int column;                 // gpu_column_t or COLUMN_MEMORY_TOTAL
+    double scale;               // Native unit -> base unit
+} metric_t;
+
+static const metric_t kMetrics[] = {
+    { "memory_total_bytes", "bytes", "Total GPU memory in bytes.", COLUMN_MEMORY_TOTAL, 1048576.0 },
+    { "memory_used_bytes", "bytes", "Used GPU memory in bytes.", GPU_COLUMN_MEMORY_USED, 1048576.0 },
+    { "memory_free_bytes", "bytes", "Free GPU memory in bytes.", GPU_COLUMN_MEMORY_FREE, 1048576.0 },
+    { "utilization_ratio", "ratio", "GPU utilization (0-1).", GPU_COLUMN_GPU_UTILIZATION, 0.01 },
+    { "memory_utilization_ratio", "ratio", "GPU memory controller utilization (0-1).", GPU_COLUMN_MEMORY_UTILIZATION, 0.01 },
+    { "temperature_celsius", "celsius", "GPU temperature in degrees Celsius.", GPU_COLUMN_TEMPERATURE, 1.0 },
+    { "power_watts", "watts", "GPU power draw in watts.", GPU_COLUMN_POWER_USAGE, 1.0 },
+    { "core_clock_hertz", "hertz", "GPU core clock in hertz.", GPU_COLUMN_CORE_CLOCK, 1e6 },
+    { "memory_clock_hertz", "hertz", "GPU memory clock in hertz.", GPU_COLUMN_MEMORY_CLOCK, 1e6 },
+    { "fan_speed_ratio", "ratio", "GPU fan speed (0-1).", GPU_COLUMN_FAN_SPEED, 0.01 }
+};
+
+#define METRIC_COUNT (sizeof(kMetrics) / sizeof(kMetrics[0]))
+
+// Escaped label set of one device, valid while the device's UUID matches
+typedef struct {
+    char uuid[64];
+    uint64_t memory_total;
+    char* labels;               // Without the braces
+    size_t labels_length;
+} device_labels_t;
+
+struct gpu_prometheus {
+    char prefix[128];
+    char* const_labels;         // Escaped `name="value",` pairs, may be empty
+    bool openmetrics;
+    size_t size_hint;           // Length of the previous render
+    device_labels_t devices[GPU_MAX_DEVICES];
+};
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    bool failed;
+} text_buffer_t;
+
+static bool buffer_reserve(text_buffer_t* buffer, size_t extra) {
+    if (buffer->failed) {
+        return false;
+    }
+    if (buffer->length + extra <= buffer->capacity) {
+        return true;
+    }
+    
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (capacity < buffer->length + extra) {
+        capacity *= 2;
+    }
+    
+    char* data = (char*)realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static void buffer_append(text_buffer_t* buffer, const char* text, size_t length) {
+    if (buffer_reserve(buffer, length)) {
+        memcpy(buffer->data + buffer->length, text, length);
+        buffer->length += length;
+    }
+}
+
+static void buffer_append_str(text_buffer_t* buffer, const char* text) {
+    buffer_append(buffer, text, strlen(text));
+}
+
+// Label values escape backslash, double quote and newline
+static void buffer_append_escaped(text_buffer_t* buffer, const char* text) {
+    for (const char* p = text; *p; p++) {
+        switch (*p) {
+            case '\\': buffer_append(buffer, "\\\\", 2); break;
+            case '"': buffer_append(buffer, "\\\"", 2); break;
+            case '\n': buffer_append(buffer, "\\n", 2); break;
+            default: buffer_append(buffer, p, 1); break;
+        }
+    }
+}
+
+static void buffer_append_label(text_buffer_t* buffer, const char* name, const char* value) {
+    buffer_append_str(buffer, name);
+    buffer_append(buffer, "=\"", 2);
+    buffer_append_escaped(buffer, value);
+    buffer_append(buffer, "\",", 2);
+}
+
+static void buffer_append_value(text_buffer_t* buffer, double value) {
+    char number[32];
+    int length;
+    
+    if (isnan(value)) {
+        length = snprintf(number, sizeof(number), "NaN");
+    } else if (value == floor(value) && fabs(value) < 1e15) {
+        // Byte counts and clocks are integral; print them exactly
+        length = snprintf(number, sizeof(number), "%.0f", value);
+    } else {
+        // Samples are single precision, so 9 significant digits round-trip
+        length = snprintf(number, sizeof(number), "%.9g", value);
+    }
+    buffer_append(buffer, number, (size_t)length);
+}
+
+bool gpu_prometheus_valid_name(const char* name, bool allow_colon) {
+    if (!name || !*name) {
+        return false;
+    }
+    
+    for (const char* p = name; *p; p++) {
+        char c = *p;
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+                  (allow_colon && c == ':') || (p != name && c >= '0' && c <= '9');
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+gpu_prometheus_t* gpu_prometheus_create(const gpu_prometheus_options_t* options) {
+    if (!options || !options->prefix || options->label_count < 0 ||
+        options->label_count > GPU_PROMETHEUS_MAX_LABELS ||
+        strlen(options->prefix) >= sizeof(((gpu_prometheus_t*)0)->prefix) ||
+        !gpu_prometheus_valid_name(options->prefix, true)) {
+        return NULL;
+    }
+    
+    text_buffer_t labels = { NULL, 0, 0, false };
+    for (int32_t i = 0; i < options->label_count; i++) {
+        const char* name = options->label_names[i];
+        const char* value = options->label_values[i];
+        
+        // Names starting with "__" are reserved by Prometheus
+        if (!gpu_prometheus_valid_name(name, false) || strncmp(name, "__", 2) == 0 || !value) {
+            free(labels.data);
+            return NULL;
+        }
+        buffer_append_label(&labels, name, value);
+    }
+    buffer_append(&labels, "", 1);
+    
+    gpu_prometheus_t* renderer = (gpu_prometheus_t*)calloc(1, sizeof(gpu_prometheus_t));
+    if (!renderer || labels.failed) {
+        free(renderer);
+        free(labels.data);
+        return NULL;
+    }
+    
+    strcpy(renderer->prefix, options->prefix);
+    renderer->const_labels = labels.data;
+    renderer->openmetrics = options->openmetrics;
+    return renderer;
+}
+
+void gpu_prometheus_destroy(gpu_prometheus_t* renderer) {
+    if (!renderer) {
+        return;
+    }
+    
+    for (int32_t i = 0; i < GPU_MAX_DEVICES; i++) {
+        free(renderer->devices[i].labels);
+    }
+    free(renderer->const_labels);
+    free(renderer);
+}
+
+static const char* vendor_name(gpu_vendor_t vendor) {
+    switch (vendor) {
+        case GPU_VENDOR_NVIDIA: return "NVIDIA";
+        case GPU_VENDOR_AMD: return "AMD";
+        case GPU_VENDOR_INTEL: return "Intel";
+        default: return "Unknown";
+    }
+}
+
+// Make sure the cached labels describe the device now at index
+static bool update_device_labels(gpu_prometheus_t* renderer, int32_t index) {
+    device_labels_t* cached = &renderer->devices[index];
+    
+    gpu_device_desc_t desc;
+    if (gpu_get_desc(index, &desc) != GPU_SUCCESS) {
+        return false;
+    }
+    
+    if (cached->labels && strcmp(cached->uuid, desc.uuid) == 0) {
+        return true;
+    }
+    
+    char index_text[16];
+    snprintf(index_text, sizeof(index_text), "%d", index);
+    
+    text_buffer_t labels = { NULL, 0, 0, false };
+    buffer_append_str(&labels, renderer->const_labels);
+    buffer_append_label(&labels, "index", index_text);
+    buffer_append_label(&labels, "vendor", vendor_name(desc.vendor));
+    buffer_append_label(&labels, "name", desc.name);
+    buffer_append_label(&labels, "uuid", desc.uuid);
+    buffer_append_label(&labels, "pci_bus_id", desc.pci_bus_id);
+    if (labels.failed) {
+        free(labels.data);
+        return false;
+    }
+    
+    // Drop the trailing comma
+    free(cached->labels);
+    cached->labels = labels.data;
+    cached->labels_length = labels.length - 1;
+    cached->memory_total = desc.memory_total;
+    memcpy(cached->uuid, desc.uuid, sizeof(cached->uuid));
+    return true;
+}
+
+gpu_error_t gpu_prometheus_render(gpu_prometheus_t* renderer, const gpu_sample_t* samples,
+                                  const bool* valid, int32_t count, char** text, size_t* length) {
+    if (!renderer || (!samples && count > 0) || (!valid && count > 0) || !text || !length) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    bool included[GPU_MAX_DEVICES];
+    if (count > GPU_MAX_DEVICES) {
+        count = GPU_MAX_DEVICES;
+    }
+    for (int32_t i = 0; i < count; i++) {
+        int32_t index = samples[i].index;
+        included[i] = valid[i] && index >= 0 && index < GPU_MAX_DEVICES &&
+                      update_device_labels(renderer, index);
+    }
+    
+    text_buffer_t buffer = { NULL, 0, 0, false };
+    buffer_reserve(&buffer, renderer->size_hint ? renderer->size_hint + renderer->size_hint / 8 : 4096);
+    
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        const metric_t* metric = &kMetrics[m];
+        
+        buffer_append(&buffer, "# HELP ", 7);
+        buffer_append_str(&buffer, renderer->prefix);
+        buffer_append(&buffer, "_", 1);
+        buffer_append_str(&buffer, metric->name);
+        buffer_append(&buffer, " ", 1);
+        buffer_append_str(&buffer, metric->help);
+        
+        buffer_append(&buffer, "\n# TYPE ", 8);
+        buffer_append_str(&buffer, renderer->prefix);
+        buffer_append(&buffer, "_", 1);
+        buffer_append_str(&buffer, metric->name);
+        buffer_append(&buffer, " gauge\n", 7);
+        
+        if (renderer->openmetrics) {
+            buffer_append(&buffer, "# UNIT ", 7);
+            buffer_append_str(&buffer, renderer->prefix);
+            buffer_append(&buffer, "_", 1);
+            buffer_append_str(&buffer, metric->name);
+            buffer_append(&buffer, " ", 1);
+            buffer_append_str(&buffer, metric->unit);
+            buffer_append(&buffer, "\n", 1);
+        }
+        
+        for (int32_t i = 0; i < count; i++) {
+            if (!included[i]) {
+                continue;
+            }
+            
+            const device_labels_t* device = &renderer->devices[samples[i].index];
+            double value = metric->column == COLUMN_MEMORY_TOTAL
+                ? (double)device->memory_total
+                : gpu_sample_column(&samples[i], (gpu_column_t)metric->column);
+            
+            buffer_append_str(&buffer, renderer->prefix);
+            buffer_append(&buffer, "_", 1);
+            buffer_append_str(&buffer, metric->name);
+            buffer_append(&buffer, "{", 1);
+            buffer_append(&buffer, device->labels, device->labels_length);
+            buffer_append(&buffer, "} ", 2);
+            buffer_append_value(&buffer, value * metric->scale);
+            buffer_append(&buffer, "\n", 1);
+        }
+    }
+    
+    if (renderer->openmetrics) {
+        buffer_append(&buffer, "# EOF\n", 6);
+    }
+    
+    if (buffer.failed) {
+        free(buffer.data);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    renderer->size_hint = buffer.length;
+    *text = buffer.data;
+    *length = buffer.length;
+    return GPU_SUCCESS;
+}
@@ -0,0 +1,50 @@
+#ifndef GPU_PROMETHEUS_H
+#define GPU_PROMETHEUS_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Prometheus text exposition (0.0.4) / OpenMetrics 1.0 renderer.
+//
+// A renderer is created once per set of options. It keeps the escaped label
+// set of every device, built from the static descriptor and rebuilt only when
+// the device at an index changes, and remembers the size of the last render
+// so that the next one normally fits in a single allocation. Each metric
+// family's HELP/TYPE header is written once, followed by one sample line per
+// device. Metrics use base units (bytes, ratios, hertz, watts, celsius).
+//
+// A renderer is not thread-safe; use one per thread.
+#define GPU_PROMETHEUS_MAX_LABELS 16
+
+typedef struct gpu_prometheus gpu_prometheus_t;
+
+typedef struct {
+    const char* prefix;                 // Metric name prefix, e.g. "gpu"
+    const char* const* label_names;     // Constant labels added to every series
+    const char* const* label_values;
+    int32_t label_count;
+    bool openmetrics;                   // OpenMetrics instead of Prometheus text
+} gpu_prometheus_options_t;
+
+// Returns NULL on invalid options (prefix or label name not a valid
+// Prometheus identifier, too many labels) or allocation failure
+gpu_prometheus_t* gpu_prometheus_create(const gpu_prometheus_options_t* options);
+void gpu_prometheus_destroy(gpu_prometheus_t* renderer);
+
+// Render samples[0..count); devices with valid[i] false are left out. On
+// success *text is a malloc'd buffer of *length bytes (not NUL terminated)
+// that the caller owns and releases with free().
+gpu_error_t gpu_prometheus_render(gpu_prometheus_t* renderer, const gpu_sample_t* samples,
+                                  const bool* valid, int32_t count, char** text, size_t* length);
+
+// True if name is a valid metric (allow_colon) or label name
+bool gpu_prometheus_valid_name(const char* name, bool allow_colon);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_PROMETHEUS_H
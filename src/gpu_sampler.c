@@ -0,0 +1,329 @@
+#include "gpu_sampler.h"
+#include "gpu_thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Per-device ring buffer of the last history_size samples
+typedef struct {
+    gpu_sample_t* records;
+    uint32_t head;              // Next slot to write
+    uint32_t size;              // Number of valid records
+} sampler_ring_t;
+
+// g_control_lock serializes start/stop; g_sampler_lock protects the rings and
+// the stop flag and is only held for short copies, never across driver calls
+static gpu_mutex_t g_control_lock = GPU_MUTEX_INITIALIZER;
+static gpu_mutex_t g_sampler_lock = GPU_MUTEX_INITIALIZER;
+static gpu_cond_t g_sampler_wake = GPU_COND_INITIALIZER;
+
+static gpu_thread_t g_sampler_thread;
+static bool g_running = false;
+static bool g_stopping = false;
+static uint32_t g_interval_ms = 0;
+static uint32_t g_history_size = 0;
+static int32_t g_device_count = 0;
+static sampler_ring_t* g_rings = NULL;
+static gpu_sample_t* g_storage = NULL;
+
+// g_listener_lock is held while listeners run so removal can wait them out
+typedef struct {
+    gpu_sampler_listener_t fn;
+    void* ctx;
+} sampler_listener_t;
+
+static gpu_mutex_t g_listener_lock = GPU_MUTEX_INITIALIZER;
+static sampler_listener_t g_listeners[GPU_SAMPLER_MAX_LISTENERS];
+static int g_listener_count = 0;
+
+static void ring_push(sampler_ring_t* ring, const gpu_sample_t* record) {
+    ring->records[ring->head] = *record;
+    ring->head = (ring->head + 1) % g_history_size;
+    if (ring->size < g_history_size) {
+        ring->size++;
+    }
+}
+
+static void sampler_thread(void* arg) {
+    (void)arg;
+    int64_t next_tick = gpu_monotonic_ms();
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    while (!g_stopping) {
+        gpu_mutex_unlock(&g_sampler_lock);
+        
+        gpu_sample_t samples[GPU_MAX_DEVICES];
+        bool valid[GPU_MAX_DEVICES];
+        int32_t collected = 0;
+        gpu_collect_samples(samples, valid, g_device_count, &collected);
+        for (int32_t i = collected; i < g_device_count; i++) {
+            valid[i] = false;
+        }
+        
+        gpu_mutex_lock(&g_sampler_lock);
+        for (int32_t i = 0; i < g_device_count; i++) {
+            if (valid[i]) {
+                ring_push(&g_rings[i], &samples[i]);
+            }
+        }
+        gpu_mutex_unlock(&g_sampler_lock);
+        
+        gpu_mutex_lock(&g_listener_lock);
+        for (int l = 0; l < g_listener_count; l++) {
+            g_listeners[l].fn(samples, valid, g_device_count, g_listeners[l].ctx);
+        }
+        gpu_mutex_unlock(&g_listener_lock);
+        
+        // Fixed-rate schedule; if collection overran, skip the missed ticks
+        // rather than sampling back-to-back
+        int64_t now = gpu_monotonic_ms();
+        next_tick += g_interval_ms;
+        if (next_tick < now) {
+            next_tick = now;
+        }
+        
+        gpu_mutex_lock(&g_sampler_lock);
+        while (!g_stopping && (now = gpu_monotonic_ms()) < next_tick) {
+            gpu_cond_timedwait(&g_sampler_wake, &g_sampler_lock, (uint32_t)(next_tick - now));
+        }
+    }
+    gpu_mutex_unlock(&g_sampler_lock);
+}
+
+static void stop_locked(void) {
+    if (!g_running) {
+        return;
+    }
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    g_stopping = true;
+    gpu_cond_broadcast(&g_sampler_wake);
+    gpu_mutex_unlock(&g_sampler_lock);
+    
+    gpu_thread_join(g_sampler_thread);
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    free(g_storage);
+    free(g_rings);
+    g_storage = NULL;
+    g_rings = NULL;
+    g_device_count = 0;
+    g_running = false;
+    gpu_mutex_unlock(&g_sampler_lock);
+}
+
+gpu_error_t gpu_sampler_start(uint32_t interval_ms, uint32_t history_size) {
+    if (interval_ms == 0 || history_size == 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_control_lock);
+    stop_locked();
+    
+    int32_t count = 0;
+    gpu_error_t result = gpu_get_count(&count);
+    if (result != GPU_SUCCESS) {
+        gpu_mutex_unlock(&g_control_lock);
+        return result;
+    }
+    
+    sampler_ring_t* rings = (sampler_ring_t*)calloc(count, sizeof(sampler_ring_t));
+    gpu_sample_t* storage = (gpu_sample_t*)calloc((size_t)count * history_size,
+                                                  sizeof(gpu_sample_t));
+    if (!rings || !storage) {
+        free(rings);
+        free(storage);
+        gpu_mutex_unlock(&g_control_lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    for (int32_t i = 0; i < count; i++) {
+        rings[i].records = storage + (size_t)i * history_size;
+    }
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    g_rings = rings;
+    g_storage = storage;
+    g_device_count = count;
+    g_interval_ms = interval_ms;
+    g_history_size = history_size;
+    g_stopping = false;
+    gpu_mutex_unlock(&g_sampler_lock);
+    
+    if (gpu_thread_create(&g_sampler_thread, sampler_thread, NULL) != 0) {
+        gpu_mutex_lock(&g_sampler_lock);
+        free(g_storage);
+        free(g_rings);
+        g_storage = NULL;
+        g_rings = NULL;
+        g_device_count = 0;
+        gpu_mutex_unlock(&g_sampler_lock);
+        gpu_mutex_unlock(&g_control_lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    g_running = true;
+    gpu_mutex_unlock(&g_control_lock);
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_sampler_stop(void) {
+    gpu_mutex_lock(&g_control_lock);
+    stop_locked();
+    gpu_mutex_unlock(&g_control_lock);
+    return GPU_SUCCESS;
+}
+
+bool gpu_sampler_running(void) {
+    gpu_mutex_lock(&g_control_lock);
+    bool running = g_running;
+    gpu_mutex_unlock(&g_control_lock);
+    return running;
+}
+
+gpu_error_t gpu_sampler_get_device_count(int32_t* count) {
+    if (!count) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    *count = g_device_count;
+    bool running = g_rings != NULL;
+    gpu_mutex_unlock(&g_sampler_lock);
+    
+    return running ? GPU_SUCCESS : GPU_ERROR_API_FAILED;
+}
+
+gpu_error_t gpu_sampler_get_history_size(uint32_t* history_size) {
+    if (!history_size) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    *history_size = g_history_size;
+    bool running = g_rings != NULL;
+    gpu_mutex_unlock(&g_sampler_lock);
+    
+    return running ? GPU_SUCCESS : GPU_ERROR_API_FAILED;
+}
+
+gpu_error_t gpu_sampler_get_interval(uint32_t* interval_ms) {
+    if (!interval_ms) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    *interval_ms = g_interval_ms;
+    bool running = g_rings != NULL;
+    gpu_mutex_unlock(&g_sampler_lock);
+    
+    return running ? GPU_SUCCESS : GPU_ERROR_API_FAILED;
+}
+
+gpu_error_t gpu_sampler_latest(int32_t index, gpu_sample_t* record) {
+    if (!record) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t count = 0;
+    gpu_error_t result = gpu_sampler_history(index, record, 1, &count);
+    if (result == GPU_SUCCESS && count == 0) {
+        return GPU_ERROR_NO_GPU;
+    }
+    return result;
+}
+
+gpu_error_t gpu_sampler_latest_all(gpu_sample_t* samples, bool* valid, int32_t max_count,
+                                   int32_t* count) {
+    if (!samples || !valid || !count || max_count < 0) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    
+    if (!g_rings) {
+        gpu_mutex_unlock(&g_sampler_lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    int32_t n = g_device_count < max_count ? g_device_count : max_count;
+    for (int32_t i = 0; i < n; i++) {
+        const sampler_ring_t* ring = &g_rings[i];
+        valid[i] = ring->size > 0;
+        if (valid[i]) {
+            samples[i] = ring->records[(ring->head + g_history_size - 1) % g_history_size];
+        }
+    }
+    *count = n;
+    
+    gpu_mutex_unlock(&g_sampler_lock);
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_sampler_history(int32_t index, gpu_sample_t* records,
+                                uint32_t max_records, uint32_t* count) {
+    if (!records || !count) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_sampler_lock);
+    
+    if (!g_rings) {
+        gpu_mutex_unlock(&g_sampler_lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    if (index < 0 || index >= g_device_count) {
+        gpu_mutex_unlock(&g_sampler_lock);
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    const sampler_ring_t* ring = &g_rings[index];
+    uint32_t n = ring->size < max_records ? ring->size : max_records;
+    
+    // Oldest of the requested window first
+    uint32_t start = (ring->head + g_history_size - n) % g_history_size;
+    for (uint32_t i = 0; i < n; i++) {
+        records[i] = ring->records[(start + i) % g_history_size];
+    }
+    *count = n;
+    
+    gpu_mutex_unlock(&g_sampler_lock);
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_sampler_add_listener(gpu_sampler_listener_t listener, void* ctx) {
+    if (!listener) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_mutex_lock(&g_listener_lock);
+    
+    if (g_listener_count >= GPU_SAMPLER_MAX_LISTENERS) {
+        gpu_mutex_unlock(&g_listener_lock);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    g_listeners[g_listener_count].fn = listener;
+    g_listeners[g_listener_count].ctx = ctx;
+    g_listener_count++;
+    
+    gpu_mutex_unlock(&g_listener_lock);
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_sampler_remove_listener(gpu_sampler_listener_t listener, void* ctx) {
+    gpu_error_t result = GPU_ERROR_INVALID_PARAM;
+    gpu_mutex_lock(&g_listener_lock);
+    
+    for (int l = 0; l < g_listener_count; l++) {
+        if (g_listeners[l].fn == listener && g_listeners[l].ctx == ctx) {
+            g_listeners[l] = g_listeners[g_listener_count - 1];
+            g_listener_count--;
+            result = GPU_SUCCESS;
+            break;
+        }
+    }
+    
+    gpu_mutex_unlock(&g_listener_lock);
+    return result;
+}
@@ -0,0 +1,58 @@
+#ifndef GPU_SAMPLER_H
+#define GPU_SAMPLER_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Background sampler: a native thread polls every GPU at a fixed interval and
+// keeps the last history_size gpu_sample_t per device in a fixed-size ring
+// buffer. Memory use is bounded by device_count * history_size samples.
+// Starting a sampler that is already running restarts it with the new settings.
+// All functions are thread-safe; readers only contend with the sampler
+// thread for the duration of a copy.
+gpu_error_t gpu_sampler_start(uint32_t interval_ms, uint32_t history_size);
+gpu_error_t gpu_sampler_stop(void);
+bool gpu_sampler_running(void);
+
+// Number of devices being sampled (fixed for the lifetime of a run)
+gpu_error_t gpu_sampler_get_device_count(int32_t* count);
+
+// Per-device capacity of the history ring
+gpu_error_t gpu_sampler_get_history_size(uint32_t* history_size);
+
+// Sampling interval of the current run
+gpu_error_t gpu_sampler_get_interval(uint32_t* interval_ms);
+
+// Most recent sample of a device; GPU_ERROR_NO_GPU until the first one lands
+gpu_error_t gpu_sampler_latest(int32_t index, gpu_sample_t* record);
+
+// Most recent sample of every device; valid[i] is false until device i has
+// been sampled. *count is the number of devices written (<= max_count).
+gpu_error_t gpu_sampler_latest_all(gpu_sample_t* samples, bool* valid, int32_t max_count,
+                                   int32_t* count);
+
+// Up to max_records of the most recent samples, oldest first
+gpu_error_t gpu_sampler_history(int32_t index, gpu_sample_t* records,
+                                uint32_t max_records, uint32_t* count);
+
+// Listeners are called on the sampler thread after every tick with the
+// samples of all devices; valid[i] is false for devices that failed to sample.
+// They outlive sampler restarts. gpu_sampler_remove_listener() waits for an
+// in-flight call to finish, so ctx may be freed once it returns; it must not
+// be called from inside a listener.
+#define GPU_SAMPLER_MAX_LISTENERS 16
+
+typedef void (*gpu_sampler_listener_t)(const gpu_sample_t* samples, const bool* valid,
+                                       int32_t count, void* ctx);
+
+gpu_error_t gpu_sampler_add_listener(gpu_sampler_listener_t listener, void* ctx);
+gpu_error_t gpu_sampler_remove_listener(gpu_sampler_listener_t listener, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_SAMPLER_H
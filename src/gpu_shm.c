@@ -0,0 +1,489 @@
+#include "gpu_shm.h"
+
+#ifndef _WIN32
+
+#include "gpu_thread.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef NAME_MAX
+#define NAME_MAX 255
+#endif
+
+// Descriptor table entry as laid out in the segment (see gpu_shm.h)
+typedef struct {
+    int32_t index;
+    int32_t vendor;
+    uint64_t memory_total;
+    char name[256];
+    char uuid[64];
+    char pci_bus_id[32];
+    char reserved[GPU_SHM_DESCRIPTOR_BYTES - 368];
+} shm_descriptor_t;
+
+typedef char shm_descriptor_size_check[sizeof(shm_descriptor_t) == GPU_SHM_DESCRIPTOR_BYTES ? 1 : -1];
+
+struct gpu_shm {
+    char name[NAME_MAX + 2];
+    int fd;                     // Kept to tell whether the name is still ours
+    char* base;
+    size_t size;
+    int32_t capacity;
+    size_t snapshot_offset;
+    size_t descriptor_offset;
+    gpu_snapshot_writer_t snapshot;
+    
+    // Last descriptor table written, to skip unchanged updates
+    shm_descriptor_t descriptors[GPU_MAX_DEVICES];
+    int32_t descriptor_count;
+};
+
+struct gpu_shm_reader {
+    const char* base;
+    size_t size;
+    int32_t capacity;
+    size_t snapshot_offset;
+    size_t descriptor_offset;
+    size_t descriptor_bytes;
+};
+
+static volatile uint32_t* header_words(const char* base) {
+    return (volatile uint32_t*)base;
+}
+
+// "name" or "/name" -> "/name"; POSIX allows no other slash
+static bool normalize_name(const char* name, char* out) {
+    if (!name) {
+        return false;
+    }
+    if (name[0] == '/') {
+        name++;
+    }
+    
+    size_t length = strlen(name);
+    if (length == 0 || length > NAME_MAX - 1 || strchr(name, '/')) {
+        return false;
+    }
+    
+    out[0] = '/';
+    memcpy(out + 1, name, length + 1);
+    return true;
+}
+
+static size_t align8(size_t value) {
+    return (value + 7) & ~(size_t)7;
+}
+
+static gpu_error_t validate_layout(gpu_shm_reader_t* reader);
+
+// Close a segment left under this name by an earlier publisher, so its
+// readers stop treating it as live, then unlink it. Any other object under
+// the name, or one whose layout does not check out, belongs to someone else
+// and is left alone: GPU_ERROR_INVALID_PARAM.
+static gpu_error_t retire_existing(const char* name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return errno == ENOENT ? GPU_SUCCESS :
+               errno == EACCES ? GPU_ERROR_ACCESS_DENIED : GPU_ERROR_API_FAILED;
+    }
+    
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= GPU_SHM_HEADER_BYTES) {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_shm_reader_t existing;
+    memset(&existing, 0, sizeof(existing));
+    existing.base = (const char*)base;
+    existing.size = (size_t)st.st_size;
+    gpu_error_t result = validate_layout(&existing);
+    if (result == GPU_SUCCESS) {
+        gpu_atomic_store_release(&header_words(existing.base)[GPU_SHM_WORD_STATE], GPU_SHM_STATE_CLOSED);
+    }
+    munmap(base, (size_t)st.st_size);
+    
+    if (result != GPU_SUCCESS) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    shm_unlink(name);
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_shm_create(const char* name, int32_t capacity, gpu_shm_t** shm_out) {
+    if (!shm_out || capacity <= 0 || capacity > GPU_MAX_DEVICES) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_shm_t* shm = (gpu_shm_t*)calloc(1, sizeof(gpu_shm_t));
+    if (!shm) {
+        return GPU_ERROR_API_FAILED;
+    }
+    if (!normalize_name(name, shm->name)) {
+        free(shm);
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    shm->capacity = capacity;
+    shm->snapshot_offset = GPU_SHM_HEADER_BYTES;
+    shm->descriptor_offset = align8(shm->snapshot_offset + gpu_snapshot_size(capacity));
+    shm->size = shm->descriptor_offset + (size_t)capacity * GPU_SHM_DESCRIPTOR_BYTES;
+    
+    // Always a fresh object: readers of a replaced segment keep a mapping
+    // that can never shrink under them
+    gpu_error_t retired = retire_existing(shm->name);
+    if (retired != GPU_SUCCESS) {
+        free(shm);
+        return retired;
+    }
+    shm->fd = shm_open(shm->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (shm->fd < 0) {
+        gpu_error_t result = errno == EACCES ? GPU_ERROR_ACCESS_DENIED : GPU_ERROR_API_FAILED;
+        free(shm);
+        return result;
+    }
+    
+    void* base = MAP_FAILED;
+    if (ftruncate(shm->fd, (off_t)shm->size) == 0) {
+        base = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+    }
+    if (base == MAP_FAILED) {
+        close(shm->fd);
+        shm_unlink(shm->name);
+        free(shm);
+        return GPU_ERROR_API_FAILED;
+    }
+    shm->base = (char*)base;
+    
+    volatile uint32_t* header = header_words(shm->base);
+    header[GPU_SHM_WORD_VERSION] = GPU_SHM_VERSION;
+    header[GPU_SHM_WORD_HEADER_BYTES] = GPU_SHM_HEADER_BYTES;
+    header[GPU_SHM_WORD_SEGMENT_BYTES] = (uint32_t)shm->size;
+    header[GPU_SHM_WORD_PID] = (uint32_t)getpid();
+    header[GPU_SHM_WORD_STATE] = GPU_SHM_STATE_LIVE;
+    header[GPU_SHM_WORD_SNAPSHOT_OFFSET] = (uint32_t)shm->snapshot_offset;
+    header[GPU_SHM_WORD_DESCRIPTOR_OFFSET] = (uint32_t)shm->descriptor_offset;
+    header[GPU_SHM_WORD_DESCRIPTOR_SEQUENCE] = 0;
+    header[GPU_SHM_WORD_DESCRIPTOR_COUNT] = 0;
+    header[GPU_SHM_WORD_DESCRIPTOR_BYTES] = GPU_SHM_DESCRIPTOR_BYTES;
+    gpu_snapshot_init(&shm->snapshot, shm->base + shm->snapshot_offset, gpu_snapshot_size(capacity));
+    
+    // The magic goes in last: a reader that sees it sees a complete header
+    gpu_atomic_store_release(&header[GPU_SHM_WORD_MAGIC], GPU_SHM_MAGIC);
+    
+    *shm_out = shm;
+    return GPU_SUCCESS;
+}
+
+void gpu_shm_destroy(gpu_shm_t* shm) {
+    if (!shm) {
+        return;
+    }
+    
+    gpu_atomic_store_release(&header_words(shm->base)[GPU_SHM_WORD_STATE], GPU_SHM_STATE_CLOSED);
+    munmap(shm->base, shm->size);
+    
+    // Leave the name alone if another publisher has since taken it over
+    struct stat ours;
+    struct stat current;
+    int fd = shm_open(shm->name, O_RDONLY, 0);
+    if (fd >= 0) {
+        if (fstat(shm->fd, &ours) == 0 && fstat(fd, &current) == 0 &&
+            ours.st_dev == current.st_dev && ours.st_ino == current.st_ino) {
+            shm_unlink(shm->name);
+        }
+        close(fd);
+    }
+    
+    close(shm->fd);
+    free(shm);
+}
+
+int32_t gpu_shm_capacity(const gpu_shm_t* shm) {
+    return shm ? shm->capacity : 0;
+}
+
+static void update_descriptors(gpu_shm_t* shm, int32_t count) {
+    shm_descriptor_t current[GPU_MAX_DEVICES];
+    memset(current, 0, sizeof(shm_descriptor_t) * (size_t)count);
+    
+    for (int32_t i = 0; i < count; i++) {
+        gpu_device_desc_t desc;
+        current[i].index = i;
+        if (gpu_get_desc(i, &desc) == GPU_SUCCESS) {
+            current[i].vendor = (int32_t)desc.vendor;
+            current[i].memory_total = desc.memory_total;
+            snprintf(current[i].name, sizeof(current[i].name), "%s", desc.name);
+            snprintf(current[i].uuid, sizeof(current[i].uuid), "%s", desc.uuid);
+            snprintf(current[i].pci_bus_id, sizeof(current[i].pci_bus_id), "%s", desc.pci_bus_id);
+        }
+    }
+    
+    if (count == shm->descriptor_count &&
+        memcmp(current, shm->descriptors, sizeof(shm_descriptor_t) * (size_t)count) == 0) {
+        return;
+    }
+    
+    volatile uint32_t* header = header_words(shm->base);
+    uint32_t sequence = gpu_atomic_load_acquire(&header[GPU_SHM_WORD_DESCRIPTOR_SEQUENCE]);
+    gpu_atomic_store_release(&header[GPU_SHM_WORD_DESCRIPTOR_SEQUENCE], sequence + 1);
+    gpu_atomic_fence();
+    
+    memcpy(shm->base + shm->descriptor_offset, current, sizeof(shm_descriptor_t) * (size_t)count);
+    header[GPU_SHM_WORD_DESCRIPTOR_COUNT] = (uint32_t)count;
+    
+    gpu_atomic_store_release(&header[GPU_SHM_WORD_DESCRIPTOR_SEQUENCE], sequence + 2);
+    
+    memcpy(shm->descriptors, current, sizeof(shm_descriptor_t) * (size_t)count);
+    shm->descriptor_count = count;
+}
+
+void gpu_shm_write(const gpu_sample_t* samples, const bool* valid, int32_t count, void* ctx) {
+    gpu_shm_t* shm = (gpu_shm_t*)ctx;
+    if (count > shm->capacity) {
+        count = shm->capacity;
+    }
+    
+    // Descriptors are served from the registry's cache, so this is cheap
+    // next to collecting the samples
+    update_descriptors(shm, count);
+    gpu_snapshot_write(&shm->snapshot, samples, valid, count);
+}
+
+// Check that every offset and size in the header stays inside the mapping
+static gpu_error_t validate_layout(gpu_shm_reader_t* reader) {
+    volatile uint32_t* header = header_words(reader->base);
+    
+    uint32_t magic = gpu_atomic_load_acquire(&header[GPU_SHM_WORD_MAGIC]);
+    if (magic == 0) {
+        // Still being created
+        return GPU_ERROR_NO_GPU;
+    }
+    if (magic != GPU_SHM_MAGIC || header[GPU_SHM_WORD_VERSION] < 1) {
+        return GPU_ERROR_NOT_SUPPORTED;
+    }
+    
+    size_t header_bytes = header[GPU_SHM_WORD_HEADER_BYTES];
+    size_t segment_bytes = header[GPU_SHM_WORD_SEGMENT_BYTES];
+    reader->snapshot_offset = header[GPU_SHM_WORD_SNAPSHOT_OFFSET];
+    reader->descriptor_offset = header[GPU_SHM_WORD_DESCRIPTOR_OFFSET];
+    reader->descriptor_bytes = header[GPU_SHM_WORD_DESCRIPTOR_BYTES];
+    if (header_bytes < GPU_SHM_HEADER_BYTES || segment_bytes > reader->size ||
+        reader->descriptor_bytes < GPU_SHM_DESCRIPTOR_BYTES ||
+        (reader->snapshot_offset & 7) != 0 ||
+        reader->snapshot_offset + GPU_SNAPSHOT_HEADER_BYTES > segment_bytes) {
+        return GPU_ERROR_NOT_SUPPORTED;
+    }
+    
+    const volatile uint32_t* snapshot = header_words(reader->base + reader->snapshot_offset);
+    uint32_t capacity = snapshot[GPU_SNAPSHOT_WORD_CAPACITY];
+    uint32_t columns = snapshot[GPU_SNAPSHOT_WORD_COLUMN_COUNT];
+    if (snapshot[GPU_SNAPSHOT_WORD_MAGIC] != GPU_SNAPSHOT_MAGIC ||
+        snapshot[GPU_SNAPSHOT_WORD_VERSION] < 1 ||
+        snapshot[GPU_SNAPSHOT_WORD_HEADER_BYTES] != GPU_SNAPSHOT_HEADER_BYTES ||
+        capacity == 0 || capacity > GPU_MAX_DEVICES || columns < GPU_COLUMN_COUNT ||
+        reader->snapshot_offset + GPU_SNAPSHOT_HEADER_BYTES + (size_t)capacity * columns * sizeof(double) > segment_bytes ||
+        reader->descriptor_offset + (size_t)capacity * reader->descriptor_bytes > segment_bytes) {
+        return GPU_ERROR_NOT_SUPPORTED;
+    }
+    
+    reader->capacity = (int32_t)capacity;
+    return GPU_SUCCESS;
+}
+
+gpu_error_t gpu_shm_attach(const char* name, gpu_shm_reader_t** reader_out) {
+    char shm_name[NAME_MAX + 2];
+    if (!reader_out || !normalize_name(name, shm_name)) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    int fd = shm_open(shm_name, O_RDONLY, 0);
+    if (fd < 0) {
+        return errno == ENOENT ? GPU_ERROR_NO_GPU :
+               errno == EACCES ? GPU_ERROR_ACCESS_DENIED : GPU_ERROR_API_FAILED;
+    }
+    
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= GPU_SHM_HEADER_BYTES) {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        // An empty object is a segment still being created
+        return GPU_ERROR_NO_GPU;
+    }
+    
+    gpu_shm_reader_t* reader = (gpu_shm_reader_t*)calloc(1, sizeof(gpu_shm_reader_t));
+    if (!reader) {
+        munmap(base, (size_t)st.st_size);
+        return GPU_ERROR_API_FAILED;
+    }
+    reader->base = (const char*)base;
+    reader->size = (size_t)st.st_size;
+    
+    gpu_error_t result = validate_layout(reader);
+    if (result != GPU_SUCCESS) {
+        gpu_shm_detach(reader);
+        return result;
+    }
+    
+    *reader_out = reader;
+    return GPU_SUCCESS;
+}
+
+void gpu_shm_detach(gpu_shm_reader_t* reader) {
+    if (!reader) {
+        return;
+    }
+    munmap((void*)reader->base, reader->size);
+    free(reader);
+}
+
+int32_t gpu_shm_reader_capacity(const gpu_shm_reader_t* reader) {
+    return reader ? reader->capacity : 0;
+}
+
+int32_t gpu_shm_reader_pid(const gpu_shm_reader_t* reader) {
+    return reader ? (int32_t)header_words(reader->base)[GPU_SHM_WORD_PID] : 0;
+}
+
+bool gpu_shm_reader_closed(const gpu_shm_reader_t* reader) {
+    return !reader ||
+           gpu_atomic_load_acquire(&header_words(reader->base)[GPU_SHM_WORD_STATE]) != GPU_SHM_STATE_LIVE;
+}
+
+// Copy the descriptor table under its seqlock; returns false on too many
+// retries
+static bool read_descriptors(const gpu_shm_reader_t* reader, gpu_device_desc_t* descs,
+                             uint32_t max_retries) {
+    volatile uint32_t* header = header_words(reader->base);
+    
+    for (uint32_t attempt = 0; attempt < max_retries; attempt++) {
+        uint32_t before = gpu_atomic_load_acquire(&header[GPU_SHM_WORD_DESCRIPTOR_SEQUENCE]);
+        if (before & 1) {
+            continue;
+        }
+        
+        uint32_t count = header[GPU_SHM_WORD_DESCRIPTOR_COUNT];
+        if (count > (uint32_t)reader->capacity) {
+            count = (uint32_t)reader->capacity;
+        }
+        memset(descs, 0, sizeof(gpu_device_desc_t) * (size_t)reader->capacity);
+        for (uint32_t i = 0; i < count; i++) {
+            const volatile shm_descriptor_t* entry = (const volatile shm_descriptor_t*)
+                (reader->base + reader->descriptor_offset + i * reader->descriptor_bytes);
+            descs[i].index = entry->index;
+            descs[i].vendor = (gpu_vendor_t)entry->vendor;
+            descs[i].memory_total = entry->memory_total;
+            memcpy(descs[i].name, (const char*)entry->name, sizeof(descs[i].name));
+            memcpy(descs[i].uuid, (const char*)entry->uuid, sizeof(descs[i].uuid));
+            memcpy(descs[i].pci_bus_id, (const char*)entry->pci_bus_id, sizeof(descs[i].pci_bus_id));
+        }
+        
+        gpu_atomic_fence();
+        if (gpu_atomic_load_acquire(&header[GPU_SHM_WORD_DESCRIPTOR_SEQUENCE]) == before) {
+            // The publisher is trusted only so far: terminate every string
+            for (uint32_t i = 0; i < count; i++) {
+                descs[i].name[sizeof(descs[i].name) - 1] = '\0';
+                descs[i].uuid[sizeof(descs[i].uuid) - 1] = '\0';
+                descs[i].pci_bus_id[sizeof(descs[i].pci_bus_id) - 1] = '\0';
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+gpu_error_t gpu_shm_read(gpu_shm_reader_t* reader, double* data, gpu_device_desc_t* descs,
+                         int32_t* count, uint32_t max_retries) {
+    if (!reader || !data || !count) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    if (descs && !read_descriptors(reader, descs, max_retries)) {
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    int32_t devices = gpu_snapshot_read(reader->base + reader->snapshot_offset, reader->capacity,
+                                        data, max_retries);
+    if (devices < 0) {
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    *count = devices;
+    return GPU_SUCCESS;
+}
+
+#else
+
+gpu_error_t gpu_shm_create(const char* name, int32_t capacity, gpu_shm_t** shm) {
+    (void)name;
+    (void)capacity;
+    (void)shm;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+void gpu_shm_destroy(gpu_shm_t* shm) {
+    (void)shm;
+}
+
+int32_t gpu_shm_capacity(const gpu_shm_t* shm) {
+    (void)shm;
+    return 0;
+}
+
+void gpu_shm_write(const gpu_sample_t* samples, const bool* valid, int32_t count, void* shm) {
+    (void)samples;
+    (void)valid;
+    (void)count;
+    (void)shm;
+}
+
+gpu_error_t gpu_shm_attach(const char* name, gpu_shm_reader_t** reader) {
+    (void)name;
+    (void)reader;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+void gpu_shm_detach(gpu_shm_reader_t* reader) {
+    (void)reader;
+}
+
+int32_t gpu_shm_reader_capacity(const gpu_shm_reader_t* reader) {
+    (void)reader;
+    return 0;
+}
+
+int32_t gpu_shm_reader_pid(const gpu_shm_reader_t* reader) {
+    (void)reader;
+    return 0;
+}
+
+bool gpu_shm_reader_closed(const gpu_shm_reader_t* reader) {
+    (void)reader;
+    return true;
+}
+
+gpu_error_t gpu_shm_read(gpu_shm_reader_t* reader, double* data, gpu_device_desc_t* descs,
+                         int32_t* count, uint32_t max_retries) {
+    (void)reader;
+    (void)data;
+    (void)descs;
+    (void)count;
+    (void)max_retries;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+#endif
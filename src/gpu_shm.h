@@ -0,0 +1,115 @@
+#ifndef GPU_SHM_H
+#define GPU_SHM_H
+
+#include "gpu_info.h"
+#include "gpu_snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Named POSIX shared-memory segment (shm_open, /dev/shm on Linux) carrying
+// the latest sample and the descriptor of every GPU, so that one process can
+// poll the drivers and any number of others read the results without
+// initializing NVML or touching sysfs.
+//
+// Layout, version GPU_SHM_VERSION; fields are only ever appended and readers
+// must honour the offsets and sizes in the header rather than assume them.
+//
+// Segment header, GPU_SHM_HEADER_BYTES long, as 32-bit words:
+//   [0]  magic              GPU_SHM_MAGIC
+//   [1]  version            GPU_SHM_VERSION
+//   [2]  header bytes
+//   [3]  segment bytes
+//   [4]  publisher pid
+//   [5]  state              GPU_SHM_STATE_*
+//   [6]  snapshot offset    start of a gpu_snapshot.h block
+//   [7]  descriptor offset  start of the descriptor table
+//   [8]  descriptor seq     seqlock over the descriptor table
+//   [9]  descriptor count
+//   [10] descriptor bytes   size of one table entry
+//   [11..15] reserved
+//
+// The snapshot block is exactly the gpu_snapshot.h layout (own header and
+// seqlock) with room for the same number of GPUs as the descriptor table.
+//
+// Descriptor entry, GPU_SHM_DESCRIPTOR_BYTES long:
+//   +0   int32   index
+//   +4   int32   vendor (gpu_vendor_t)
+//   +8   uint64  total memory, MB
+//   +16  char[256] name, NUL terminated
+//   +272 char[64]  UUID
+//   +336 char[32]  PCI bus ID
+//   +368 reserved
+//
+// The descriptor table only changes when the set of devices does, so it has
+// its own seqlock and readers rarely retry on it.
+//
+// A publisher that stops marks the segment closed and unlinks the name.
+// Readers attached to it keep a valid (but final) mapping and should attach
+// again once a new publisher appears. If the publisher dies without closing,
+// the state stays live; the pid and the sample timestamps tell.
+//
+// Not available on Windows (GPU_ERROR_NOT_SUPPORTED).
+#define GPU_SHM_MAGIC 0x4d555047u       // "GPUM"
+#define GPU_SHM_VERSION 1
+#define GPU_SHM_HEADER_BYTES 64
+#define GPU_SHM_DESCRIPTOR_BYTES 384
+
+#define GPU_SHM_STATE_LIVE 1
+#define GPU_SHM_STATE_CLOSED 2
+
+typedef enum {
+    GPU_SHM_WORD_MAGIC = 0,
+    GPU_SHM_WORD_VERSION,
+    GPU_SHM_WORD_HEADER_BYTES,
+    GPU_SHM_WORD_SEGMENT_BYTES,
+    GPU_SHM_WORD_PID,
+    GPU_SHM_WORD_STATE,
+    GPU_SHM_WORD_SNAPSHOT_OFFSET,
+    GPU_SHM_WORD_DESCRIPTOR_OFFSET,
+    GPU_SHM_WORD_DESCRIPTOR_SEQUENCE,
+    GPU_SHM_WORD_DESCRIPTOR_COUNT,
+    GPU_SHM_WORD_DESCRIPTOR_BYTES
+} gpu_shm_word_t;
+
+typedef struct gpu_shm gpu_shm_t;
+typedef struct gpu_shm_reader gpu_shm_reader_t;
+
+// Publisher: create (or replace) the segment name ("name" or "/name") with
+// room for capacity GPUs. Readers attached to a segment it replaces see it
+// closed. Only a valid segment is replaced: GPU_ERROR_INVALID_PARAM if the
+// name holds any other shared-memory object.
+gpu_error_t gpu_shm_create(const char* name, int32_t capacity, gpu_shm_t** shm);
+
+// Mark the segment closed, unlink its name and unmap it
+void gpu_shm_destroy(gpu_shm_t* shm);
+
+int32_t gpu_shm_capacity(const gpu_shm_t* shm);
+
+// Publish samples[0..count) and refresh the descriptor table if the devices
+// changed. One writer per segment; matches gpu_sampler_listener_t with shm
+// as ctx.
+void gpu_shm_write(const gpu_sample_t* samples, const bool* valid, int32_t count, void* shm);
+
+// Reader: map an existing segment read-only. GPU_ERROR_NO_GPU if there is no
+// such segment, GPU_ERROR_NOT_SUPPORTED for an unknown layout version.
+gpu_error_t gpu_shm_attach(const char* name, gpu_shm_reader_t** reader);
+void gpu_shm_detach(gpu_shm_reader_t* reader);
+
+int32_t gpu_shm_reader_capacity(const gpu_shm_reader_t* reader);
+int32_t gpu_shm_reader_pid(const gpu_shm_reader_t* reader);
+bool gpu_shm_reader_closed(const gpu_shm_reader_t* reader);
+
+// Consistent copy of the snapshot data block (capacity * GPU_COLUMN_COUNT
+// doubles, gpu_snapshot.h layout) and of the descriptors (capacity entries;
+// descs may be NULL). *count is the number of GPUs. GPU_ERROR_API_FAILED if
+// the publisher kept the segment mid-write for max_retries attempts.
+gpu_error_t gpu_shm_read(gpu_shm_reader_t* reader, double* data, gpu_device_desc_t* descs,
+                         int32_t* count, uint32_t max_retries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_SHM_H
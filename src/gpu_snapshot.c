@@ -0,0 +1,104 @@
+#include "gpu_snapshot.h"
+#include "gpu_thread.h"
+#include <math.h>
+#include <string.h>
+
+size_t gpu_snapshot_size(int32_t capacity) {
+    if (capacity < 0) capacity = 0;
+    return GPU_SNAPSHOT_HEADER_BYTES + (size_t)capacity * GPU_COLUMN_COUNT * sizeof(double);
+}
+
+int32_t gpu_snapshot_capacity(size_t size) {
+    if (size < GPU_SNAPSHOT_HEADER_BYTES) return 0;
+    
+    size_t capacity = (size - GPU_SNAPSHOT_HEADER_BYTES) / (GPU_COLUMN_COUNT * sizeof(double));
+    return capacity > GPU_MAX_DEVICES ? GPU_MAX_DEVICES : (int32_t)capacity;
+}
+
+gpu_error_t gpu_snapshot_init(gpu_snapshot_writer_t* writer, void* buffer, size_t size) {
+    if (!writer || !buffer || ((uintptr_t)buffer & 7) != 0) return GPU_ERROR_INVALID_PARAM;
+    
+    int32_t capacity = gpu_snapshot_capacity(size);
+    if (capacity == 0) return GPU_ERROR_INVALID_PARAM;
+    
+    volatile uint32_t* header = (volatile uint32_t*)buffer;
+    double* data = (double*)((char*)buffer + GPU_SNAPSHOT_HEADER_BYTES);
+    
+    // Readers never see an even sequence with a half-written header: the
+    // sequence is bumped to odd first and only made even again at the end.
+    // It continues from whatever the buffer held so that readers of an
+    // earlier publication retry; the value only numbers the writes.
+    uint32_t sequence = gpu_atomic_load_acquire(&header[GPU_SNAPSHOT_WORD_SEQUENCE]);
+    gpu_atomic_store_release(&header[GPU_SNAPSHOT_WORD_SEQUENCE], sequence | 1);
+    gpu_atomic_fence();
+    
+    header[GPU_SNAPSHOT_WORD_MAGIC] = GPU_SNAPSHOT_MAGIC;
+    header[GPU_SNAPSHOT_WORD_VERSION] = GPU_SNAPSHOT_VERSION;
+    header[GPU_SNAPSHOT_WORD_HEADER_BYTES] = GPU_SNAPSHOT_HEADER_BYTES;
+    header[GPU_SNAPSHOT_WORD_CAPACITY] = (uint32_t)capacity;
+    header[GPU_SNAPSHOT_WORD_DEVICE_COUNT] = 0;
+    header[GPU_SNAPSHOT_WORD_COLUMN_COUNT] = GPU_COLUMN_COUNT;
+    header[7] = 0;
+    
+    for (size_t i = 0; i < (size_t)capacity * GPU_COLUMN_COUNT; i++) {
+        data[i] = NAN;
+    }
+    
+    gpu_atomic_store_release(&header[GPU_SNAPSHOT_WORD_SEQUENCE], (sequence | 1) + 1);
+    
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->capacity = capacity;
+    writer->sequence = (sequence | 1) + 1;
+    return GPU_SUCCESS;
+}
+
+void gpu_snapshot_write(gpu_snapshot_writer_t* writer, const gpu_sample_t* samples, const bool* valid,
+                        int32_t count) {
+    volatile uint32_t* header = (volatile uint32_t*)writer->buffer;
+    double* data = (double*)((char*)writer->buffer + GPU_SNAPSHOT_HEADER_BYTES);
+    int32_t capacity = writer->capacity;
+    
+    if (count < 0) count = 0;
+    if (count > capacity) count = capacity;
+    
+    uint32_t sequence = writer->sequence;
+    gpu_atomic_store_release(&header[GPU_SNAPSHOT_WORD_SEQUENCE], sequence + 1);
+    gpu_atomic_fence();
+    
+    header[GPU_SNAPSHOT_WORD_DEVICE_COUNT] = (uint32_t)count;
+    for (int32_t i = 0; i < capacity; i++) {
+        bool ok = i < count && valid[i];
+        for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+            data[(size_t)c * capacity + i] = ok ? gpu_sample_column(&samples[i], (gpu_column_t)c) : NAN;
+        }
+    }
+    
+    gpu_atomic_store_release(&header[GPU_SNAPSHOT_WORD_SEQUENCE], sequence + 2);
+    writer->sequence = sequence + 2;
+}
+
+int32_t gpu_snapshot_read(const void* buffer, int32_t capacity, double* data, uint32_t max_retries) {
+    volatile uint32_t* header = (volatile uint32_t*)buffer;
+    const volatile double* block = (const volatile double*)((const char*)buffer + GPU_SNAPSHOT_HEADER_BYTES);
+    size_t length = (size_t)capacity * GPU_COLUMN_COUNT;
+    
+    for (uint32_t attempt = 0; attempt < max_retries; attempt++) {
+        uint32_t before = gpu_atomic_load_acquire(&header[GPU_SNAPSHOT_WORD_SEQUENCE]);
+        if (before & 1) {
+            continue;
+        }
+        
+        for (size_t i = 0; i < length; i++) {
+            data[i] = block[i];
+        }
+        int32_t count = (int32_t)header[GPU_SNAPSHOT_WORD_DEVICE_COUNT];
+        
+        gpu_atomic_fence();
+        if (gpu_atomic_load_acquire(&header[GPU_SNAPSHOT_WORD_SEQUENCE]) == before) {
+            return count < 0 ? 0 : (count > capacity ? capacity : count);
+        }
+    }
+    
+    return -1;
+}
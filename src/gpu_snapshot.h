@@ -0,0 +1,82 @@
+#ifndef GPU_SNAPSHOT_H
+#define GPU_SNAPSHOT_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Seqlock-protected snapshot of the latest sample of every GPU, laid out for
+// lock-free readers in other threads or processes (SharedArrayBuffer, shared
+// memory). The layout is versioned; fields are only ever appended.
+//
+// Header, GPU_SNAPSHOT_HEADER_BYTES long, as 32-bit words:
+//   [0] sequence      odd while a write is in progress
+//   [1] magic         GPU_SNAPSHOT_MAGIC
+//   [2] version       GPU_SNAPSHOT_VERSION
+//   [3] header bytes  offset of the data block
+//   [4] capacity      GPUs the buffer has room for
+//   [5] device count  GPUs in the current snapshot (<= capacity)
+//   [6] column count  GPU_COLUMN_COUNT
+//   [7] reserved
+//
+// Data: doubles, struct of arrays; column c of GPU i is at c * capacity + i
+// (columns as in gpu_column_t). GPUs that failed to sample are NaN.
+//
+// Readers load the sequence, skip if odd, copy the data, then reload the
+// sequence and retry if it changed.
+
+#define GPU_SNAPSHOT_MAGIC 0x53555047u   // "GPUS"
+#define GPU_SNAPSHOT_VERSION 1
+#define GPU_SNAPSHOT_HEADER_BYTES 32
+
+typedef enum {
+    GPU_SNAPSHOT_WORD_SEQUENCE = 0,
+    GPU_SNAPSHOT_WORD_MAGIC,
+    GPU_SNAPSHOT_WORD_VERSION,
+    GPU_SNAPSHOT_WORD_HEADER_BYTES,
+    GPU_SNAPSHOT_WORD_CAPACITY,
+    GPU_SNAPSHOT_WORD_DEVICE_COUNT,
+    GPU_SNAPSHOT_WORD_COLUMN_COUNT
+} gpu_snapshot_word_t;
+
+// The writer's own record of a buffer. Capacity and size are fixed when the
+// buffer is initialized and the write sequence is tracked here: the buffer is
+// shared with readers (a SharedArrayBuffer is writable from JavaScript), so
+// the writer treats the header as output only and never sizes a write from it.
+typedef struct {
+    void* buffer;
+    size_t size;
+    int32_t capacity;
+    uint32_t sequence;
+} gpu_snapshot_writer_t;
+
+// Bytes needed for a snapshot of capacity GPUs
+size_t gpu_snapshot_size(int32_t capacity);
+
+// Largest capacity that fits in size bytes (0 if none)
+int32_t gpu_snapshot_capacity(size_t size);
+
+// Write the header into buffer, which must be 8-byte aligned, with room for
+// gpu_snapshot_capacity(size) GPUs, and set up writer for it
+gpu_error_t gpu_snapshot_init(gpu_snapshot_writer_t* writer, void* buffer, size_t size);
+
+// Publish samples[0..count) under the seqlock; valid[i] false writes NaNs.
+// Not thread-safe on the writer side: one writer per buffer (the sampler
+// thread). Any number of concurrent readers is fine.
+void gpu_snapshot_write(gpu_snapshot_writer_t* writer, const gpu_sample_t* samples, const bool* valid,
+                        int32_t count);
+
+// Reader side for buffers this process did not write (e.g. shared memory):
+// copy a consistent data block (capacity * GPU_COLUMN_COUNT doubles) into
+// data. capacity is the caller's own, validated, copy of the header value.
+// Returns the device count, or -1 if no consistent copy was obtained within
+// max_retries attempts.
+int32_t gpu_snapshot_read(const void* buffer, int32_t capacity, double* data, uint32_t max_retries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_SNAPSHOT_H
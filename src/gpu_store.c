@@ -0,0 +1,834 @@
+#include "gpu_store.h"
+
+#ifndef _WIN32
+
+#include "gpu_thread.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+#define SEGMENT_PREFIX "segment-"
+#define SEGMENT_SUFFIX ".gpus"
+#define MIN_SEGMENT_BYTES (64u * 1024)
+#define MAX_SEGMENT_BYTES (1024u * 1024 * 1024)
+
+typedef char store_header_size_check[sizeof(gpu_store_header_t) <= GPU_STORE_HEADER_BYTES ? 1 : -1];
+
+// Record as laid out in a segment (see gpu_store.h)
+typedef struct {
+    double values[GPU_STORE_CHECK];     // Sample columns, then the device index
+    uint64_t check;
+} store_record_t;
+
+typedef char store_record_size_check[sizeof(store_record_t) == GPU_STORE_RECORD_BYTES ? 1 : -1];
+
+struct gpu_store_segment {
+    char path[PATH_MAX];
+    size_t size;
+    gpu_store_header_t* header;     // Shared mapping of the whole file: writes and lookups
+    char* view;                     // Private mapping of the same pages, handed to readers
+    
+    gpu_mutex_t ref_lock;
+    int32_t refs;                   // The store's and one per range handed out
+    
+    struct gpu_store_segment* seal_next;    // Queued for the sealer thread
+};
+
+// Room for the longest file name after the directory
+#define DIR_MAX (PATH_MAX - 64)
+
+struct gpu_store {
+    char dir[DIR_MAX];
+    int lock_fd;
+    uint64_t segment_bytes;
+    uint64_t max_bytes;
+    
+    gpu_mutex_t lock;
+    gpu_store_segment_t* segments[GPU_STORE_MAX_SEGMENTS];   // Oldest first
+    int32_t segment_count;
+    bool active;                    // The newest segment is being appended to
+    uint64_t next_sequence;
+    uint64_t disk_bytes;
+    
+    uint64_t recovered_records;
+    uint64_t truncated_records;
+    uint64_t dropped_samples;
+    
+    // Full segments are flushed and sealed on this thread, so the writer (the
+    // sampler thread) never waits for the disk
+    gpu_thread_t sealer;
+    gpu_mutex_t seal_lock;
+    gpu_cond_t seal_cond;
+    gpu_store_segment_t* seal_head;     // FIFO, each holding a reference
+    gpu_store_segment_t* seal_tail;
+    bool sealer_stop;
+};
+
+static uint64_t record_check(const store_record_t* record) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (int i = 0; i < GPU_STORE_CHECK; i++) {
+        uint64_t word;
+        memcpy(&word, &record->values[i], sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+static store_record_t* record_at(const gpu_store_segment_t* segment, uint64_t i) {
+    return (store_record_t*)((char*)segment->header + GPU_STORE_HEADER_BYTES + i * GPU_STORE_RECORD_BYTES);
+}
+
+static int64_t record_time(const gpu_store_segment_t* segment, uint64_t i) {
+    return (int64_t)record_at(segment, i)->values[GPU_COLUMN_TIMESTAMP];
+}
+
+static uint64_t segment_capacity(size_t size) {
+    return (size - GPU_STORE_HEADER_BYTES) / GPU_STORE_RECORD_BYTES;
+}
+
+static uint32_t index_stride(uint64_t capacity) {
+    uint64_t stride = (capacity + GPU_STORE_INDEX_ENTRIES - 1) / GPU_STORE_INDEX_ENTRIES;
+    return stride > 0 ? (uint32_t)stride : 1;
+}
+
+static void segment_path(const char* dir, uint64_t sequence, char* path) {
+    snprintf(path, PATH_MAX, "%s/" SEGMENT_PREFIX "%016" PRIx64 SEGMENT_SUFFIX, dir, sequence);
+}
+
+// "segment-<16 hex digits>.gpus" -> sequence
+static bool parse_segment_name(const char* name, uint64_t* sequence) {
+    size_t prefix = sizeof(SEGMENT_PREFIX) - 1;
+    if (strncmp(name, SEGMENT_PREFIX, prefix) != 0 || strlen(name) != prefix + 16 + sizeof(SEGMENT_SUFFIX) - 1 ||
+        strcmp(name + prefix + 16, SEGMENT_SUFFIX) != 0) {
+        return false;
+    }
+    
+    uint64_t value = 0;
+    for (size_t i = prefix; i < prefix + 16; i++) {
+        char c = name[i];
+        int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (digit < 0) {
+            return false;
+        }
+        value = value << 4 | (uint64_t)digit;
+    }
+    *sequence = value;
+    return true;
+}
+
+static gpu_error_t errno_error(void) {
+    return errno == EACCES || errno == EPERM || errno == EROFS ? GPU_ERROR_ACCESS_DENIED : GPU_ERROR_API_FAILED;
+}
+
+// Both mappings of an open segment file; the caller closes fd
+static gpu_store_segment_t* map_segment(int fd, const char* path, size_t size) {
+    gpu_store_segment_t* segment = (gpu_store_segment_t*)calloc(1, sizeof(gpu_store_segment_t));
+    if (!segment) {
+        return NULL;
+    }
+    
+    void* shared = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void* view = MAP_FAILED;
+    if (shared != MAP_FAILED) {
+        view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            munmap(shared, size);
+        }
+    }
+    if (view == MAP_FAILED) {
+        free(segment);
+        return NULL;
+    }
+    
+    snprintf(segment->path, sizeof(segment->path), "%s", path);
+    segment->size = size;
+    segment->header = (gpu_store_header_t*)shared;
+    segment->view = (char*)view;
+    gpu_mutex_init(&segment->ref_lock);
+    segment->refs = 1;
+    return segment;
+}
+
+static void segment_retain(gpu_store_segment_t* segment) {
+    gpu_mutex_lock(&segment->ref_lock);
+    segment->refs++;
+    gpu_mutex_unlock(&segment->ref_lock);
+}
+
+void gpu_store_segment_release(gpu_store_segment_t* segment) {
+    if (!segment) {
+        return;
+    }
+    
+    gpu_mutex_lock(&segment->ref_lock);
+    bool last = --segment->refs == 0;
+    gpu_mutex_unlock(&segment->ref_lock);
+    if (!last) {
+        return;
+    }
+    
+    munmap(segment->header, segment->size);
+    munmap(segment->view, segment->size);
+    gpu_mutex_destroy(&segment->ref_lock);
+    free(segment);
+}
+
+// Allocate the file's blocks up front where possible: running out of disk
+// later would be a SIGBUS on a store through the mapping, not an error
+static int reserve_file(int fd, size_t size) {
+#ifdef __linux__
+    int result = posix_fallocate(fd, 0, (off_t)size);
+    if (result != EINVAL && result != EOPNOTSUPP) {
+        errno = result;
+        return result == 0 ? 0 : -1;
+    }
+#endif
+    return ftruncate(fd, (off_t)size);
+}
+
+static gpu_store_segment_t* create_segment(gpu_store_t* store) {
+    char path[PATH_MAX];
+    segment_path(store->dir, store->next_sequence, path);
+    
+    size_t size = (size_t)store->segment_bytes;
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    
+    gpu_store_segment_t* segment = NULL;
+    if (reserve_file(fd, size) == 0) {
+        segment = map_segment(fd, path, size);
+    }
+    close(fd);
+    if (!segment) {
+        unlink(path);
+        return NULL;
+    }
+    
+    gpu_store_header_t* header = segment->header;
+    header->version = GPU_STORE_VERSION;
+    header->header_bytes = GPU_STORE_HEADER_BYTES;
+    header->record_bytes = GPU_STORE_RECORD_BYTES;
+    header->segment_bytes = size;
+    header->sequence = store->next_sequence;
+    header->capacity = segment_capacity(size);
+    header->index_stride = index_stride(header->capacity);
+    
+    // The magic goes in last: a header without it is a torn creation
+    gpu_atomic_store_release((volatile uint32_t*)&header->magic, GPU_STORE_MAGIC);
+    
+    store->next_sequence++;
+    return segment;
+}
+
+// Flush the records before setting the flag, so a sealed segment never has
+// a torn tail and is not rescanned on open
+static void seal_segment(gpu_store_segment_t* segment) {
+    msync(segment->header, segment->size, MS_SYNC);
+    segment->header->sealed = 1;
+    msync(segment->header, GPU_STORE_HEADER_BYTES, MS_ASYNC);
+}
+
+// Hand a full segment to the sealer thread. Until it is sealed it is just an
+// unsealed segment, which open rescans like the active one.
+static void queue_seal(gpu_store_t* store, gpu_store_segment_t* segment) {
+    segment_retain(segment);
+    segment->seal_next = NULL;
+    
+    gpu_mutex_lock(&store->seal_lock);
+    if (store->seal_tail) {
+        store->seal_tail->seal_next = segment;
+    } else {
+        store->seal_head = segment;
+    }
+    store->seal_tail = segment;
+    gpu_cond_signal(&store->seal_cond);
+    gpu_mutex_unlock(&store->seal_lock);
+}
+
+// Drains the queue before it exits
+static void sealer_thread(void* arg) {
+    gpu_store_t* store = (gpu_store_t*)arg;
+    
+    gpu_mutex_lock(&store->seal_lock);
+    for (;;) {
+        gpu_store_segment_t* segment = store->seal_head;
+        if (!segment) {
+            if (store->sealer_stop) {
+                break;
+            }
+            gpu_cond_wait(&store->seal_cond, &store->seal_lock);
+            continue;
+        }
+        store->seal_head = segment->seal_next;
+        if (!store->seal_head) {
+            store->seal_tail = NULL;
+        }
+        gpu_mutex_unlock(&store->seal_lock);
+        
+        // Evicted meanwhile or not, the reference keeps the mapping valid
+        seal_segment(segment);
+        gpu_store_segment_release(segment);
+        
+        gpu_mutex_lock(&store->seal_lock);
+    }
+    gpu_mutex_unlock(&store->seal_lock);
+}
+
+static void evict_oldest(gpu_store_t* store) {
+    gpu_store_segment_t* segment = store->segments[0];
+    memmove(&store->segments[0], &store->segments[1],
+            sizeof(gpu_store_segment_t*) * (size_t)(store->segment_count - 1));
+    store->segment_count--;
+    
+    // Ranges still held keep their mappings; the blocks are freed once the
+    // last one is released
+    unlink(segment->path);
+    store->disk_bytes -= segment->size;
+    gpu_store_segment_release(segment);
+}
+
+// Delete the oldest segments until a new file of incoming bytes (none if 0)
+// fits the budget; never the one being appended to
+static void trim(gpu_store_t* store, uint64_t incoming) {
+    int32_t keep = store->active ? 1 : 0;
+    int32_t files = incoming > 0 ? 1 : 0;
+    while (store->segment_count > keep &&
+           (store->segment_count + files > GPU_STORE_MAX_SEGMENTS ||
+            store->disk_bytes + incoming > store->max_bytes)) {
+        evict_oldest(store);
+    }
+}
+
+static gpu_store_segment_t* start_segment(gpu_store_t* store) {
+    trim(store, store->segment_bytes);
+    
+    gpu_store_segment_t* segment = create_segment(store);
+    if (!segment) {
+        return NULL;
+    }
+    store->segments[store->segment_count++] = segment;
+    store->disk_bytes += segment->size;
+    store->active = true;
+    return segment;
+}
+
+static bool append_record(gpu_store_t* store, const gpu_sample_t* sample) {
+    gpu_store_segment_t* segment = store->active ? store->segments[store->segment_count - 1] : NULL;
+    if (segment) {
+        const gpu_store_header_t* header = segment->header;
+        if (header->count == header->capacity ||
+            (header->count > 0 && sample->timestamp_ms < header->last_ms)) {
+            queue_seal(store, segment);
+            store->active = false;
+            segment = NULL;
+        }
+    }
+    if (!segment) {
+        segment = start_segment(store);
+        if (!segment) {
+            return false;
+        }
+    }
+    
+    store_record_t record;
+    for (int c = 0; c < GPU_COLUMN_COUNT; c++) {
+        record.values[c] = gpu_sample_column(sample, (gpu_column_t)c);
+    }
+    record.values[GPU_STORE_DEVICE] = sample->index;
+    record.check = record_check(&record);
+    
+    gpu_store_header_t* header = segment->header;
+    uint64_t n = header->count;
+    memcpy(record_at(segment, n), &record, sizeof(record));
+    if (n % header->index_stride == 0) {
+        header->index[n / header->index_stride] = sample->timestamp_ms;
+    }
+    if (n == 0) {
+        header->first_ms = sample->timestamp_ms;
+    }
+    header->last_ms = sample->timestamp_ms;
+    header->count = n + 1;
+    return true;
+}
+
+void gpu_store_write(const gpu_sample_t* samples, const bool* valid, int32_t count, void* ctx) {
+    gpu_store_t* store = (gpu_store_t*)ctx;
+    
+    // Devices of one tick are stamped as each one is read, in whatever order
+    // the collection finished, so their timestamps can go backwards by a few
+    // ms in device order. Appending the tick in timestamp order keeps each
+    // segment sorted without treating that as a clock step.
+    const gpu_sample_t* order[GPU_MAX_DEVICES];
+    int32_t ordered = 0;
+    for (int32_t i = 0; i < count && ordered < GPU_MAX_DEVICES; i++) {
+        if (!valid[i]) {
+            continue;
+        }
+        int32_t j = ordered++;
+        while (j > 0 && order[j - 1]->timestamp_ms > samples[i].timestamp_ms) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = &samples[i];
+    }
+    
+    gpu_mutex_lock(&store->lock);
+    for (int32_t i = 0; i < ordered; i++) {
+        if (!append_record(store, order[i])) {
+            store->dropped_samples++;
+        }
+    }
+    gpu_mutex_unlock(&store->lock);
+}
+
+// Cut an unsealed segment at its first torn or out-of-order record and
+// rebuild the header from what is left. The writer appends every tick in
+// timestamp order and starts a new segment on a clock step, so a record
+// older than the one before it can only be torn. The count in the header is only a
+// hint: after a power loss it may be ahead of or behind the records.
+static void recover_segment(gpu_store_t* store, gpu_store_segment_t* segment) {
+    gpu_store_header_t* header = segment->header;
+    
+    uint64_t count = 0;
+    int64_t previous = INT64_MIN;
+    while (count < header->capacity) {
+        const store_record_t* record = record_at(segment, count);
+        if (record->check != record_check(record) || record_time(segment, count) < previous) {
+            break;
+        }
+        previous = record_time(segment, count);
+        count++;
+    }
+    
+    uint64_t claimed = header->count < header->capacity ? header->count : header->capacity;
+    if (claimed > count) {
+        store->truncated_records += claimed - count;
+    }
+    store->recovered_records += count;
+    
+    for (uint64_t i = 0; i < count; i += header->index_stride) {
+        header->index[i / header->index_stride] = record_time(segment, i);
+    }
+    header->first_ms = count > 0 ? record_time(segment, 0) : 0;
+    header->last_ms = count > 0 ? record_time(segment, count - 1) : 0;
+    header->count = count;
+}
+
+typedef enum {
+    LOAD_OK,
+    LOAD_INVALID,       // Torn creation or not ours: removed
+    LOAD_NEWER,         // Written by a newer layout version: left alone
+    LOAD_FAILED
+} load_result_t;
+
+static load_result_t load_segment(const char* path, uint64_t sequence, gpu_store_segment_t** out) {
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return LOAD_FAILED;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return LOAD_FAILED;
+    }
+    if ((uint64_t)st.st_size < GPU_STORE_HEADER_BYTES + GPU_STORE_RECORD_BYTES ||
+        (uint64_t)st.st_size > MAX_SEGMENT_BYTES) {
+        close(fd);
+        return LOAD_INVALID;
+    }
+    
+    size_t size = (size_t)st.st_size;
+    gpu_store_segment_t* segment = map_segment(fd, path, size);
+    close(fd);
+    if (!segment) {
+        return LOAD_FAILED;
+    }
+    
+    const gpu_store_header_t* header = segment->header;
+    uint64_t capacity = segment_capacity(size);
+    if (header->magic == GPU_STORE_MAGIC && header->version > GPU_STORE_VERSION) {
+        gpu_store_segment_release(segment);
+        return LOAD_NEWER;
+    }
+    if (header->magic != GPU_STORE_MAGIC || header->version != GPU_STORE_VERSION ||
+        header->header_bytes != GPU_STORE_HEADER_BYTES || header->record_bytes != GPU_STORE_RECORD_BYTES ||
+        header->segment_bytes != size || header->sequence != sequence ||
+        header->capacity != capacity || header->index_stride != index_stride(capacity) ||
+        (header->sealed && header->count > capacity)) {
+        gpu_store_segment_release(segment);
+        return LOAD_INVALID;
+    }
+    
+    *out = segment;
+    return LOAD_OK;
+}
+
+static int compare_sequences(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static gpu_error_t list_segments(const char* dir, uint64_t** sequences, size_t* count) {
+    DIR* handle = opendir(dir);
+    if (!handle) {
+        return errno_error();
+    }
+    
+    size_t capacity = 0;
+    *sequences = NULL;
+    *count = 0;
+    
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        uint64_t sequence;
+        if (!parse_segment_name(entry->d_name, &sequence)) {
+            continue;
+        }
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            uint64_t* grown = (uint64_t*)realloc(*sequences, capacity * sizeof(uint64_t));
+            if (!grown) {
+                free(*sequences);
+                *sequences = NULL;
+                closedir(handle);
+                return GPU_ERROR_API_FAILED;
+            }
+            *sequences = grown;
+        }
+        (*sequences)[(*count)++] = sequence;
+    }
+    closedir(handle);
+    
+    if (*count > 1) {
+        qsort(*sequences, *count, sizeof(uint64_t), compare_sequences);
+    }
+    return GPU_SUCCESS;
+}
+
+static gpu_error_t load_segments(gpu_store_t* store) {
+    uint64_t* sequences = NULL;
+    size_t count = 0;
+    gpu_error_t result = list_segments(store->dir, &sequences, &count);
+    if (result != GPU_SUCCESS) {
+        return result;
+    }
+    
+    char path[PATH_MAX];
+    for (size_t i = 0; i < count && result == GPU_SUCCESS; i++) {
+        segment_path(store->dir, sequences[i], path);
+        store->next_sequence = sequences[i] + 1;
+        
+        // Older than the file limit allows: would be trimmed right away
+        if (count - i > GPU_STORE_MAX_SEGMENTS) {
+            unlink(path);
+            continue;
+        }
+        
+        gpu_store_segment_t* segment = NULL;
+        switch (load_segment(path, sequences[i], &segment)) {
+            case LOAD_OK:
+                store->segments[store->segment_count++] = segment;
+                store->disk_bytes += segment->size;
+                break;
+            case LOAD_INVALID:
+                unlink(path);
+                break;
+            case LOAD_NEWER:
+                result = GPU_ERROR_NOT_SUPPORTED;
+                break;
+            case LOAD_FAILED:
+                result = errno_error();
+                break;
+        }
+    }
+    free(sequences);
+    if (result != GPU_SUCCESS) {
+        return result;
+    }
+    
+    // Normally only the newest segment is unsealed; it is appended to if it
+    // has room, any other is sealed as recovered
+    for (int32_t i = 0; i < store->segment_count; i++) {
+        gpu_store_segment_t* segment = store->segments[i];
+        if (segment->header->sealed) {
+            continue;
+        }
+        recover_segment(store, segment);
+        if (i == store->segment_count - 1 && segment->header->count < segment->header->capacity) {
+            store->active = true;
+        } else {
+            seal_segment(segment);
+        }
+    }
+    
+    trim(store, 0);
+    return GPU_SUCCESS;
+}
+
+static void release_segments(gpu_store_t* store) {
+    for (int32_t i = 0; i < store->segment_count; i++) {
+        gpu_store_segment_release(store->segments[i]);
+    }
+    store->segment_count = 0;
+}
+
+gpu_error_t gpu_store_open(const char* dir, uint64_t segment_bytes, uint64_t max_bytes,
+                           gpu_store_t** store_out) {
+    if (!dir || !dir[0] || !store_out || strlen(dir) >= DIR_MAX) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    if (segment_bytes == 0) {
+        segment_bytes = GPU_STORE_DEFAULT_SEGMENT_BYTES;
+    }
+    if (max_bytes == 0) {
+        max_bytes = GPU_STORE_DEFAULT_MAX_BYTES;
+    }
+    if (segment_bytes < MIN_SEGMENT_BYTES || segment_bytes > MAX_SEGMENT_BYTES || max_bytes < segment_bytes) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    gpu_store_t* store = (gpu_store_t*)calloc(1, sizeof(gpu_store_t));
+    if (!store) {
+        return GPU_ERROR_API_FAILED;
+    }
+    snprintf(store->dir, sizeof(store->dir), "%s", dir);
+    store->segment_bytes = GPU_STORE_HEADER_BYTES +
+        (segment_bytes - GPU_STORE_HEADER_BYTES) / GPU_STORE_RECORD_BYTES * GPU_STORE_RECORD_BYTES;
+    store->max_bytes = max_bytes;
+    
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        gpu_error_t result = errno_error();
+        free(store);
+        return result;
+    }
+    
+    // One writer per directory; the lock goes with the descriptor, so a
+    // crashed writer never leaves it held
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/lock", dir);
+    store->lock_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (store->lock_fd < 0) {
+        gpu_error_t result = errno_error();
+        free(store);
+        return result;
+    }
+    if (flock(store->lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        close(store->lock_fd);
+        free(store);
+        return GPU_ERROR_ACCESS_DENIED;
+    }
+    
+    gpu_error_t result = load_segments(store);
+    if (result != GPU_SUCCESS) {
+        release_segments(store);
+        close(store->lock_fd);
+        free(store);
+        return result;
+    }
+    
+    gpu_mutex_init(&store->lock);
+    gpu_mutex_init(&store->seal_lock);
+    gpu_cond_init(&store->seal_cond);
+    if (gpu_thread_create(&store->sealer, sealer_thread, store) != 0) {
+        gpu_cond_destroy(&store->seal_cond);
+        gpu_mutex_destroy(&store->seal_lock);
+        gpu_mutex_destroy(&store->lock);
+        release_segments(store);
+        close(store->lock_fd);
+        free(store);
+        return GPU_ERROR_API_FAILED;
+    }
+    
+    *store_out = store;
+    return GPU_SUCCESS;
+}
+
+void gpu_store_close(gpu_store_t* store) {
+    if (!store) {
+        return;
+    }
+    
+    // Finish sealing every full segment first, so they are all flushed by
+    // the time this returns
+    gpu_mutex_lock(&store->seal_lock);
+    store->sealer_stop = true;
+    gpu_cond_signal(&store->seal_cond);
+    gpu_mutex_unlock(&store->seal_lock);
+    gpu_thread_join(store->sealer);
+    
+    if (store->active) {
+        gpu_store_segment_t* segment = store->segments[store->segment_count - 1];
+        if (segment->header->count == 0) {
+            unlink(segment->path);
+        } else {
+            seal_segment(segment);
+        }
+    }
+    release_segments(store);
+    
+    close(store->lock_fd);
+    gpu_cond_destroy(&store->seal_cond);
+    gpu_mutex_destroy(&store->seal_lock);
+    gpu_mutex_destroy(&store->lock);
+    free(store);
+}
+
+gpu_error_t gpu_store_get_stats(gpu_store_t* store, gpu_store_stats_t* stats) {
+    if (!store || !stats) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    memset(stats, 0, sizeof(*stats));
+    
+    gpu_mutex_lock(&store->lock);
+    stats->segments = (uint64_t)store->segment_count;
+    stats->disk_bytes = store->disk_bytes;
+    for (int32_t i = 0; i < store->segment_count; i++) {
+        const gpu_store_header_t* header = store->segments[i]->header;
+        if (header->count == 0) {
+            continue;
+        }
+        if (stats->records == 0 || header->first_ms < stats->first_ms) {
+            stats->first_ms = header->first_ms;
+        }
+        if (stats->records == 0 || header->last_ms > stats->last_ms) {
+            stats->last_ms = header->last_ms;
+        }
+        stats->records += header->count;
+    }
+    stats->recovered_records = store->recovered_records;
+    stats->truncated_records = store->truncated_records;
+    stats->dropped_samples = store->dropped_samples;
+    gpu_mutex_unlock(&store->lock);
+    
+    return GPU_SUCCESS;
+}
+
+// First of the count records with a timestamp >= ms (count if none). The
+// header index narrows it down to one stride, so only that stride's records
+// are touched.
+static uint64_t first_at_or_after(const gpu_store_segment_t* segment, uint64_t count, int64_t ms) {
+    const gpu_store_header_t* header = segment->header;
+    uint64_t stride = header->index_stride;
+    
+    uint64_t lo = 0;
+    uint64_t hi = (count + stride - 1) / stride;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (header->index[mid] < ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    // Index entry lo is the first at or after ms, so the answer lies after
+    // entry lo - 1 and no later than entry lo
+    uint64_t high = lo * stride < count ? lo * stride : count;
+    lo = lo > 0 ? (lo - 1) * stride + 1 : 0;
+    hi = high;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (record_time(segment, mid) < ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+gpu_error_t gpu_store_query(gpu_store_t* store, int64_t from_ms, int64_t to_ms,
+                            gpu_store_range_t* ranges, int32_t max_ranges, int32_t* count) {
+    if (!store || !ranges || max_ranges < 0 || !count) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    *count = 0;
+    
+    gpu_mutex_lock(&store->lock);
+    for (int32_t i = 0; i < store->segment_count && *count < max_ranges; i++) {
+        gpu_store_segment_t* segment = store->segments[i];
+        const gpu_store_header_t* header = segment->header;
+        uint64_t records = header->count;
+        if (records == 0 || header->last_ms < from_ms || header->first_ms > to_ms) {
+            continue;
+        }
+        
+        uint64_t begin = first_at_or_after(segment, records, from_ms);
+        uint64_t end = to_ms == INT64_MAX ? records : first_at_or_after(segment, records, to_ms + 1);
+        if (end <= begin) {
+            continue;
+        }
+        
+        segment_retain(segment);
+        gpu_store_range_t* range = &ranges[(*count)++];
+        range->segment = segment;
+        range->records = (const double*)(segment->view + GPU_STORE_HEADER_BYTES + begin * GPU_STORE_RECORD_BYTES);
+        range->count = end - begin;
+    }
+    gpu_mutex_unlock(&store->lock);
+    
+    return GPU_SUCCESS;
+}
+
+#else
+
+gpu_error_t gpu_store_open(const char* dir, uint64_t segment_bytes, uint64_t max_bytes,
+                           gpu_store_t** store) {
+    (void)dir;
+    (void)segment_bytes;
+    (void)max_bytes;
+    (void)store;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+void gpu_store_close(gpu_store_t* store) {
+    (void)store;
+}
+
+void gpu_store_write(const gpu_sample_t* samples, const bool* valid, int32_t count, void* store) {
+    (void)samples;
+    (void)valid;
+    (void)count;
+    (void)store;
+}
+
+gpu_error_t gpu_store_get_stats(gpu_store_t* store, gpu_store_stats_t* stats) {
+    (void)store;
+    (void)stats;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+gpu_error_t gpu_store_query(gpu_store_t* store, int64_t from_ms, int64_t to_ms,
+                            gpu_store_range_t* ranges, int32_t max_ranges, int32_t* count) {
+    (void)store;
+    (void)from_ms;
+    (void)to_ms;
+    (void)ranges;
+    (void)max_ranges;
+    (void)count;
+    return GPU_ERROR_NOT_SUPPORTED;
+}
+
+void gpu_store_segment_release(gpu_store_segment_t* segment) {
+    (void)segment;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef GPU_STORE_H
+#define GPU_STORE_H
+
+#include "gpu_info.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Persistent telemetry store: sampler output appended to fixed-size,
+// memory-mapped segment files in one directory, so history survives a
+// restart of the process. One writer per directory (an flock()ed "lock"
+// file); a second gpu_store_open() of the same directory fails with
+// GPU_ERROR_ACCESS_DENIED.
+//
+// Segment file "segment-<sequence as 16 hex digits>.gpus":
+//   header, GPU_STORE_HEADER_BYTES long (gpu_store_header_t)
+//   capacity records of GPU_STORE_RECORD_DOUBLES doubles each:
+//     [0..GPU_COLUMN_COUNT)   the sample, in gpu_column_t order
+//     [GPU_STORE_DEVICE]      device index
+//     [GPU_STORE_CHECK]       check word over the rest of the record (not a
+//                             number)
+// Records are appended in timestamp order (each tick's devices sorted by
+// timestamp); a wall-clock step backwards starts a new segment so each one
+// stays sorted. The header keeps the timestamp of
+// every index_stride-th record, so a range lookup touches the header page and
+// one stride of records rather than binary-searching the whole file.
+//
+// Crash safety: a full segment is flushed (msync) and then marked sealed by
+// a background thread, while appends continue in the next one. On open,
+// every unsealed segment is rescanned from the start and cut at the first record whose check word does not match or whose
+// timestamp goes backwards, so a torn tail after a crash or power loss is
+// dropped rather than read back as data. Files whose header does not
+// validate (a crash while creating one) are removed.
+//
+// Disk use is bounded by max_bytes: the oldest segments are deleted before a
+// new one would exceed it (the active segment is never deleted).
+//
+// Reads are zero-copy: gpu_store_query() hands out pointers into a private
+// mapping of each segment, kept alive by a reference that outlives both
+// eviction and gpu_store_close(). Writing through such a pointer only changes
+// this process's copy of the page, never the file.
+//
+// POSIX only; on Windows every function returns GPU_ERROR_NOT_SUPPORTED.
+#define GPU_STORE_MAGIC 0x53555047u         // "GPUS"
+#define GPU_STORE_VERSION 1
+#define GPU_STORE_HEADER_BYTES 4096
+#define GPU_STORE_INDEX_ENTRIES 500
+#define GPU_STORE_RECORD_DOUBLES (GPU_COLUMN_COUNT + 2)
+#define GPU_STORE_RECORD_BYTES (GPU_STORE_RECORD_DOUBLES * 8)
+#define GPU_STORE_DEVICE GPU_COLUMN_COUNT
+#define GPU_STORE_CHECK (GPU_COLUMN_COUNT + 1)
+#define GPU_STORE_MAX_SEGMENTS 4096
+
+#define GPU_STORE_DEFAULT_SEGMENT_BYTES (16u * 1024 * 1024)
+#define GPU_STORE_DEFAULT_MAX_BYTES (1024ull * 1024 * 1024)
+
+typedef struct {
+    uint32_t magic;             // GPU_STORE_MAGIC, written last
+    uint32_t version;
+    uint32_t header_bytes;      // Offset of the first record
+    uint32_t record_bytes;
+    uint64_t segment_bytes;     // File size
+    uint64_t sequence;          // Matches the file name
+    uint64_t capacity;          // Records
+    uint64_t count;             // Committed records; rechecked on open
+    int64_t first_ms;           // Timestamps of the first and last record
+    int64_t last_ms;
+    uint32_t index_stride;      // Records between index entries
+    uint32_t sealed;            // Flushed and complete
+    uint64_t reserved[2];
+    int64_t index[GPU_STORE_INDEX_ENTRIES];   // Timestamp of record i * index_stride
+} gpu_store_header_t;
+
+typedef struct gpu_store gpu_store_t;
+typedef struct gpu_store_segment gpu_store_segment_t;
+
+typedef struct {
+    uint64_t segments;
+    uint64_t records;
+    uint64_t disk_bytes;        // Size of every segment file
+    int64_t first_ms;           // Oldest and newest record stored; 0 if none
+    int64_t last_ms;
+    uint64_t recovered_records; // Records found in the unsealed segment on open
+    uint64_t truncated_records; // Torn records cut from it
+    uint64_t dropped_samples;   // Not stored because a segment could not be created
+} gpu_store_stats_t;
+
+// A run of consecutive records of one segment. Holds a reference on the
+// segment; release it with gpu_store_segment_release().
+typedef struct {
+    gpu_store_segment_t* segment;
+    const double* records;      // count * GPU_STORE_RECORD_DOUBLES doubles
+    uint64_t count;
+} gpu_store_range_t;
+
+// Open (creating it if needed) the store in dir and recover what is there.
+// segment_bytes 0 and max_bytes 0 take the defaults; segment_bytes is
+// rounded down to whole records and applies to new segments only.
+gpu_error_t gpu_store_open(const char* dir, uint64_t segment_bytes, uint64_t max_bytes,
+                           gpu_store_t** store);
+
+// Seal the active segment and release the store's references; ranges still
+// held stay valid
+void gpu_store_close(gpu_store_t* store);
+
+// Append samples[0..count) with valid[i] set. Matches gpu_sampler_listener_t
+// with the store as ctx.
+void gpu_store_write(const gpu_sample_t* samples, const bool* valid, int32_t count, void* store);
+
+gpu_error_t gpu_store_get_stats(gpu_store_t* store, gpu_store_stats_t* stats);
+
+// Records of every device with a timestamp in [from_ms, to_ms], as one range
+// per overlapping segment, oldest segment first. *count is the number of
+// ranges written (<= max_ranges).
+gpu_error_t gpu_store_query(gpu_store_t* store, int64_t from_ms, int64_t to_ms,
+                            gpu_store_range_t* ranges, int32_t max_ranges, int32_t* count);
+
+void gpu_store_segment_release(gpu_store_segment_t* segment);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GPU_STORE_H
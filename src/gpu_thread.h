@@ -0,0 +1,241 @@
+#ifndef GPU_THREAD_H
+#define GPU_THREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Minimal portable threading primitives for the C core (Win32 / pthreads)
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef SRWLOCK gpu_mutex_t;
+typedef CONDITION_VARIABLE gpu_cond_t;
+typedef HANDLE gpu_thread_t;
+#define GPU_MUTEX_INITIALIZER SRWLOCK_INIT
+#define GPU_COND_INITIALIZER CONDITION_VARIABLE_INIT
+
+static __inline void gpu_mutex_init(gpu_mutex_t* mutex) { InitializeSRWLock(mutex); }
+static __inline void gpu_mutex_destroy(gpu_mutex_t* mutex) { (void)mutex; }
+static __inline void gpu_mutex_lock(gpu_mutex_t* mutex) { AcquireSRWLockExclusive(mutex); }
+static __inline void gpu_mutex_unlock(gpu_mutex_t* mutex) { ReleaseSRWLockExclusive(mutex); }
+
+// Reader-writer lock: many shared holders or one exclusive holder
+typedef SRWLOCK gpu_rwlock_t;
+#define GPU_RWLOCK_INITIALIZER SRWLOCK_INIT
+
+static __inline void gpu_rwlock_lock_shared(gpu_rwlock_t* lock) { AcquireSRWLockShared(lock); }
+static __inline void gpu_rwlock_unlock_shared(gpu_rwlock_t* lock) { ReleaseSRWLockShared(lock); }
+static __inline void gpu_rwlock_lock(gpu_rwlock_t* lock) { AcquireSRWLockExclusive(lock); }
+static __inline void gpu_rwlock_unlock(gpu_rwlock_t* lock) { ReleaseSRWLockExclusive(lock); }
+
+static __inline void gpu_cond_init(gpu_cond_t* cond) { InitializeConditionVariable(cond); }
+static __inline void gpu_cond_destroy(gpu_cond_t* cond) { (void)cond; }
+static __inline void gpu_cond_signal(gpu_cond_t* cond) { WakeConditionVariable(cond); }
+static __inline void gpu_cond_broadcast(gpu_cond_t* cond) { WakeAllConditionVariable(cond); }
+static __inline void gpu_cond_wait(gpu_cond_t* cond, gpu_mutex_t* mutex) {
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+// Returns once signalled or after timeout_ms, whichever comes first
+static __inline void gpu_cond_timedwait(gpu_cond_t* cond, gpu_mutex_t* mutex, uint32_t timeout_ms) {
+    SleepConditionVariableSRW(cond, mutex, timeout_ms, 0);
+}
+
+typedef struct {
+    void (*fn)(void*);
+    void* arg;
+} gpu_thread_start_t;
+
+static __inline DWORD WINAPI gpu_thread_trampoline(LPVOID param) {
+    gpu_thread_start_t start = *(gpu_thread_start_t*)param;
+    HeapFree(GetProcessHeap(), 0, param);
+    start.fn(start.arg);
+    return 0;
+}
+
+static __inline int gpu_thread_create(gpu_thread_t* thread, void (*fn)(void*), void* arg) {
+    gpu_thread_start_t* start = (gpu_thread_start_t*)HeapAlloc(GetProcessHeap(), 0, sizeof(gpu_thread_start_t));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+    *thread = CreateThread(NULL, 0, gpu_thread_trampoline, start, 0, NULL);
+    if (!*thread) {
+        HeapFree(GetProcessHeap(), 0, start);
+        return -1;
+    }
+    return 0;
+}
+
+static __inline void gpu_thread_join(gpu_thread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+// Wall clock, milliseconds since the Unix epoch
+static __inline int64_t gpu_time_ms(void) {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    int64_t ticks = ((int64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return ticks / 10000 - 11644473600000LL;
+}
+
+// Monotonic clock for scheduling, milliseconds
+static __inline int64_t gpu_monotonic_ms(void) {
+    return (int64_t)GetTickCount64();
+}
+
+// 32-bit atomics for lock-free publication (seqlocks); full barriers keep
+// them correct on both x86 and ARM64
+static __inline uint32_t gpu_atomic_load_acquire(volatile uint32_t* ptr) {
+    uint32_t value = *ptr;
+    MemoryBarrier();
+    return value;
+}
+static __inline void gpu_atomic_store_release(volatile uint32_t* ptr, uint32_t value) {
+    MemoryBarrier();
+    *ptr = value;
+}
+static __inline void gpu_atomic_fence(void) { MemoryBarrier(); }
+
+#else
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+typedef pthread_mutex_t gpu_mutex_t;
+typedef pthread_cond_t gpu_cond_t;
+typedef pthread_t gpu_thread_t;
+#define GPU_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define GPU_COND_INITIALIZER PTHREAD_COND_INITIALIZER
+
+static inline void gpu_mutex_init(gpu_mutex_t* mutex) { pthread_mutex_init(mutex, NULL); }
+static inline void gpu_mutex_destroy(gpu_mutex_t* mutex) { pthread_mutex_destroy(mutex); }
+static inline void gpu_mutex_lock(gpu_mutex_t* mutex) { pthread_mutex_lock(mutex); }
+static inline void gpu_mutex_unlock(gpu_mutex_t* mutex) { pthread_mutex_unlock(mutex); }
+
+// Reader-writer lock: many shared holders or one exclusive holder. Writers
+// take priority over new readers (pthread_rwlock_t on glibc prefers readers,
+// which lets a steady stream of queries starve a refresh).
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t readers_cond;
+    pthread_cond_t writers_cond;
+    int32_t readers;            // Active shared holders
+    int32_t writers_waiting;
+    bool writer;                // Exclusive holder present
+} gpu_rwlock_t;
+#define GPU_RWLOCK_INITIALIZER { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, \
+                                 PTHREAD_COND_INITIALIZER, 0, 0, false }
+
+static inline void gpu_rwlock_lock_shared(gpu_rwlock_t* lock) {
+    pthread_mutex_lock(&lock->mutex);
+    while (lock->writer || lock->writers_waiting > 0) {
+        pthread_cond_wait(&lock->readers_cond, &lock->mutex);
+    }
+    lock->readers++;
+    pthread_mutex_unlock(&lock->mutex);
+}
+static inline void gpu_rwlock_unlock_shared(gpu_rwlock_t* lock) {
+    pthread_mutex_lock(&lock->mutex);
+    if (--lock->readers == 0 && lock->writers_waiting > 0) {
+        pthread_cond_signal(&lock->writers_cond);
+    }
+    pthread_mutex_unlock(&lock->mutex);
+}
+static inline void gpu_rwlock_lock(gpu_rwlock_t* lock) {
+    pthread_mutex_lock(&lock->mutex);
+    lock->writers_waiting++;
+    while (lock->writer || lock->readers > 0) {
+        pthread_cond_wait(&lock->writers_cond, &lock->mutex);
+    }
+    lock->writers_waiting--;
+    lock->writer = true;
+    pthread_mutex_unlock(&lock->mutex);
+}
+static inline void gpu_rwlock_unlock(gpu_rwlock_t* lock) {
+    pthread_mutex_lock(&lock->mutex);
+    lock->writer = false;
+    if (lock->writers_waiting > 0) {
+        pthread_cond_signal(&lock->writers_cond);
+    } else {
+        pthread_cond_broadcast(&lock->readers_cond);
+    }
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+static inline void gpu_cond_init(gpu_cond_t* cond) { pthread_cond_init(cond, NULL); }
+static inline void gpu_cond_destroy(gpu_cond_t* cond) { pthread_cond_destroy(cond); }
+static inline void gpu_cond_signal(gpu_cond_t* cond) { pthread_cond_signal(cond); }
+static inline void gpu_cond_broadcast(gpu_cond_t* cond) { pthread_cond_broadcast(cond); }
+static inline void gpu_cond_wait(gpu_cond_t* cond, gpu_mutex_t* mutex) {
+    pthread_cond_wait(cond, mutex);
+}
+// Returns once signalled or after timeout_ms, whichever comes first
+static inline void gpu_cond_timedwait(gpu_cond_t* cond, gpu_mutex_t* mutex, uint32_t timeout_ms) {
+    // CLOCK_REALTIME: pthread_condattr_setclock() is unavailable on macOS
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    
+    struct timespec deadline;
+    int64_t nsec = (int64_t)now.tv_usec * 1000 + (int64_t)(timeout_ms % 1000) * 1000000;
+    deadline.tv_sec = now.tv_sec + timeout_ms / 1000 + (time_t)(nsec / 1000000000);
+    deadline.tv_nsec = (long)(nsec % 1000000000);
+    
+    pthread_cond_timedwait(cond, mutex, &deadline);
+}
+
+typedef struct {
+    void (*fn)(void*);
+    void* arg;
+} gpu_thread_start_t;
+
+static inline void* gpu_thread_trampoline(void* param) {
+    gpu_thread_start_t start = *(gpu_thread_start_t*)param;
+    free(param);
+    start.fn(start.arg);
+    return NULL;
+}
+
+static inline int gpu_thread_create(gpu_thread_t* thread, void (*fn)(void*), void* arg) {
+    gpu_thread_start_t* start = (gpu_thread_start_t*)malloc(sizeof(gpu_thread_start_t));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(thread, NULL, gpu_thread_trampoline, start) != 0) {
+        free(start);
+        return -1;
+    }
+    return 0;
+}
+
+static inline void gpu_thread_join(gpu_thread_t thread) {
+    pthread_join(thread, NULL);
+}
+
+// Wall clock, milliseconds since the Unix epoch
+static inline int64_t gpu_time_ms(void) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
+// Monotonic clock for scheduling, milliseconds
+static inline int64_t gpu_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 32-bit atomics for lock-free publication (seqlocks)
+static inline uint32_t gpu_atomic_load_acquire(volatile uint32_t* ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+static inline void gpu_atomic_store_release(volatile uint32_t* ptr, uint32_t value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+static inline void gpu_atomic_fence(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+#endif
+
+#endif // GPU_THREAD_H
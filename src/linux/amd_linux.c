@@ -1,9 +1,12 @@
 #include "../gpu_info.h"
+#include "../gpu_thread.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
 
 static int is_amd_device(const char* card_path) {
     char vendor_path[512];
@@ -20,102 +23,464 @@ static int is_amd_device(const char* card_path) {
     return (result == 1 && vendor == 0x1002);
 }
 
-gpu_error_t amd_linux_get_gpu_count(int32_t* count) {
-    if (!count) return GPU_ERROR_INVALID_PARAM;
+// Overridable so the native tests can point the backend at a fixture tree
+#ifndef DRM_CLASS_PATH
+#define DRM_CLASS_PATH "/sys/class/drm"
+#endif
+
+// sysfs attributes read per sample. Each one is opened once and re-read with
+// pread() at offset 0, which makes sysfs regenerate the value.
+typedef enum {
+    AMD_ATTR_PRODUCT_NAME = 0,
+    AMD_ATTR_MODEL,
+    AMD_ATTR_DEVICE_ID,
+    AMD_ATTR_UEVENT,
+    AMD_ATTR_VRAM_TOTAL,
+    AMD_ATTR_VRAM_USED,
+    AMD_ATTR_GPU_BUSY,
+    AMD_ATTR_SCLK,
+    AMD_ATTR_MCLK,
+    AMD_ATTR_GPU_METRICS,
+    AMD_ATTR_TEMP,
+    AMD_ATTR_POWER,
+    AMD_ATTR_PWM,
+    AMD_ATTR_COUNT
+} amd_attr_t;
+
+// Attribute paths relative to the card directory. hwmon attributes are
+// relative to the card's hwmon directory instead.
+static const char* amd_attr_names[AMD_ATTR_COUNT] = {
+    "device/product_name",
+    "device/model",
+    "device/device",
+    "device/uevent",
+    "device/mem_info_vram_total",
+    "device/mem_info_vram_used",
+    "device/gpu_busy_percent",
+    "device/pp_dpm_sclk",
+    "device/pp_dpm_mclk",
+    "device/gpu_metrics",
+    "temp1_input",
+    "power1_average",
+    "pwm1"
+};
+
+#define AMD_FD_UNOPENED (-1)
+#define AMD_FD_MISSING  (-2)
+
+// AMD card table, built by amd_linux_get_gpu_count() (i.e. when the device
+// registry is built or refreshed) so that info lookups don't rescan sysfs.
+typedef struct {
+    int card_number;
+    char path[512];
+    char hwmon_path[1024];      // Empty if the card has no hwmon device
+    const char* power_attr;     // power1_average or power1_input
+    int fds[AMD_ATTR_COUNT];
+    int gone;                   // Set once an attribute disappears under us
+} amd_card_t;
+
+// The card table is (re)built by scan_amd_cards() during enumeration, which
+// the core only runs while no query is in flight. Queries then touch only
+// their own amd_card_t. ensure_scanned() covers direct callers that query
+// before enumerating, under the same once-style guard as NVML loading.
+static gpu_mutex_t amd_scan_lock = GPU_MUTEX_INITIALIZER;
+static amd_card_t amd_cards[GPU_MAX_DEVICES];
+static int amd_card_count = 0;
+static volatile uint32_t amd_cards_scanned = 0;
+
+static void close_card_fds(amd_card_t* card) {
+    for (int i = 0; i < AMD_ATTR_COUNT; i++) {
+        if (card->fds[i] >= 0) {
+            close(card->fds[i]);
+        }
+        card->fds[i] = AMD_FD_UNOPENED;
+    }
+}
+
+static void close_all_cards(void) {
+    for (int i = 0; i < amd_card_count; i++) {
+        close_card_fds(&amd_cards[i]);
+    }
+    amd_card_count = 0;
+    gpu_atomic_store_release(&amd_cards_scanned, 0);
+}
+
+// Returns N for "cardN" entries, -1 for anything else (including connector
+// entries such as "card0-DP-1")
+static int parse_card_number(const char* name) {
+    if (strncmp(name, "card", 4) != 0 || name[4] == '\0') return -1;
+    
+    int number = 0;
+    for (const char* p = name + 4; *p; p++) {
+        if (*p < '0' || *p > '9') return -1;
+        number = number * 10 + (*p - '0');
+    }
+    return number;
+}
+
+static int compare_cards(const void* a, const void* b) {
+    const amd_card_t* ca = (const amd_card_t*)a;
+    const amd_card_t* cb = (const amd_card_t*)b;
+    return ca->card_number - cb->card_number;
+}
+
+// Resolve the card's hwmon directory once by enumerating device/hwmon/
+// (amdgpu registers a single hwmonN there, N being system-wide and often
+// well above 3 on multi-GPU hosts) and record which sensors it provides.
+// Sensors that are absent are marked missing so samples never probe them.
+static void resolve_hwmon(amd_card_t* card) {
+    char hwmon_dir[600];
+    snprintf(hwmon_dir, sizeof(hwmon_dir), "%s/device/hwmon", card->path);
+    
+    card->hwmon_path[0] = '\0';
+    card->power_attr = amd_attr_names[AMD_ATTR_POWER];
+    
+    DIR* dir = opendir(hwmon_dir);
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, "hwmon", 5) == 0) {
+                snprintf(card->hwmon_path, sizeof(card->hwmon_path), "%s/%s",
+                         hwmon_dir, entry->d_name);
+                break;
+            }
+        }
+        closedir(dir);
+    }
     
+    for (int attr = AMD_ATTR_TEMP; attr <= AMD_ATTR_PWM; attr++) {
+        if (card->hwmon_path[0] == '\0') {
+            card->fds[attr] = AMD_FD_MISSING;
+            continue;
+        }
+        
+        char path[1200];
+        snprintf(path, sizeof(path), "%s/%s", card->hwmon_path, amd_attr_names[attr]);
+        if (access(path, R_OK) == 0) continue;
+        
+        // Newer kernels (RDNA3+) expose instantaneous power only
+        if (attr == AMD_ATTR_POWER) {
+            snprintf(path, sizeof(path), "%s/power1_input", card->hwmon_path);
+            if (access(path, R_OK) == 0) {
+                card->power_attr = "power1_input";
+                continue;
+            }
+        }
+        
+        card->fds[attr] = AMD_FD_MISSING;
+    }
+}
+
+static gpu_error_t scan_amd_cards(void) {
     DIR* dir;
     struct dirent* entry;
-    int amd_count = 0;
     
-    dir = opendir("/sys/class/drm");
+    // Handles from a previous scan may point at cards that no longer exist
+    close_all_cards();
+    
+    dir = opendir(DRM_CLASS_PATH);
     if (!dir) {
-        *count = 0;
         return GPU_ERROR_API_FAILED;
     }
     
-    while ((entry = readdir(dir)) != NULL) {
-        // Look for card* directories
-        if (strncmp(entry->d_name, "card", 4) == 0 && 
-            strlen(entry->d_name) == 5 && 
-            entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
-            
-            char card_path[512];
-            snprintf(card_path, sizeof(card_path), "/sys/class/drm/%s", entry->d_name);
-            
-            if (is_amd_device(card_path)) {
-                amd_count++;
+    while ((entry = readdir(dir)) != NULL && amd_card_count < GPU_MAX_DEVICES) {
+        int card_number = parse_card_number(entry->d_name);
+        if (card_number < 0) continue;
+        
+        amd_card_t* card = &amd_cards[amd_card_count];
+        snprintf(card->path, sizeof(card->path), "%s/%s", DRM_CLASS_PATH, entry->d_name);
+        
+        if (is_amd_device(card->path)) {
+            card->card_number = card_number;
+            card->gone = 0;
+            for (int i = 0; i < AMD_ATTR_COUNT; i++) {
+                card->fds[i] = AMD_FD_UNOPENED;
             }
+            resolve_hwmon(card);
+            amd_card_count++;
         }
     }
     
     closedir(dir);
-    *count = amd_count;
+    
+    // readdir() order is arbitrary; keep indices stable across rescans
+    qsort(amd_cards, amd_card_count, sizeof(amd_card_t), compare_cards);
+    gpu_atomic_store_release(&amd_cards_scanned, 1);
     return GPU_SUCCESS;
 }
 
-static int read_sysfs_string(const char* path, char* buffer, size_t size) {
-    FILE* f = fopen(path, "r");
-    if (!f) return 0;
+static void ensure_scanned(void) {
+    if (gpu_atomic_load_acquire(&amd_cards_scanned)) return;
     
-    if (fgets(buffer, size, f)) {
-        // Remove trailing newline
-        size_t len = strlen(buffer);
-        if (len > 0 && buffer[len-1] == '\n') {
-            buffer[len-1] = '\0';
-        }
-        fclose(f);
-        return 1;
+    gpu_mutex_lock(&amd_scan_lock);
+    if (!amd_cards_scanned) scan_amd_cards();
+    gpu_mutex_unlock(&amd_scan_lock);
+}
+
+static int open_attr(amd_card_t* card, amd_attr_t attr) {
+    char path[1200];
+    
+    if (attr == AMD_ATTR_POWER) {
+        snprintf(path, sizeof(path), "%s/%s", card->hwmon_path, card->power_attr);
+    } else if (attr >= AMD_ATTR_TEMP) {
+        snprintf(path, sizeof(path), "%s/%s", card->hwmon_path, amd_attr_names[attr]);
+    } else {
+        snprintf(path, sizeof(path), "%s/%s", card->path, amd_attr_names[attr]);
     }
     
-    fclose(f);
-    return 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        // Optional attributes stay missing until the next rescan; there is no
+        // point retrying them every sample
+        return AMD_FD_MISSING;
+    }
+    return fd;
 }
 
-static long read_sysfs_long(const char* path) {
-    FILE* f = fopen(path, "r");
-    if (!f) return -1;
+// Read an attribute into buffer (NUL-terminated). Returns the number of bytes
+// read or -1 if the attribute is unavailable.
+static ssize_t read_attr(amd_card_t* card, amd_attr_t attr, char* buffer, size_t size) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (card->fds[attr] == AMD_FD_UNOPENED) {
+            card->fds[attr] = open_attr(card, attr);
+            if (card->fds[attr] == AMD_FD_MISSING && attempt > 0) {
+                // It was there a moment ago: the device went away
+                card->gone = 1;
+            }
+        }
+        
+        int fd = card->fds[attr];
+        if (fd < 0) return -1;
+        
+        ssize_t n = pread(fd, buffer, size - 1, 0);
+        if (n >= 0) {
+            buffer[n] = '\0';
+            return n;
+        }
+        
+        // Only a stale handle warrants a reopen; other errors (e.g. EINVAL
+        // from attributes the ASIC doesn't support) are reported as missing
+        if (errno != ENODEV && errno != EBADF) {
+            return -1;
+        }
+        
+        close(fd);
+        card->fds[attr] = AMD_FD_UNOPENED;
+    }
     
-    long value;
-    int result = fscanf(f, "%ld", &value);
-    fclose(f);
+    return -1;
+}
+
+static int read_attr_string(amd_card_t* card, amd_attr_t attr, char* buffer, size_t size) {
+    ssize_t n = read_attr(card, attr, buffer, size);
+    if (n <= 0) return 0;
     
-    return (result == 1) ? value : -1;
+    // Remove trailing newline
+    if (buffer[n-1] == '\n') {
+        buffer[n-1] = '\0';
+    }
+    return buffer[0] != '\0';
 }
 
-gpu_error_t amd_linux_get_gpu_info(int32_t index, gpu_info_t* info) {
-    if (!info) return GPU_ERROR_INVALID_PARAM;
+static long read_attr_long(amd_card_t* card, amd_attr_t attr) {
+    char buffer[64];
+    if (read_attr(card, attr, buffer, sizeof(buffer)) <= 0) return -1;
     
-    // Find the correct card device
-    DIR* dir = opendir("/sys/class/drm");
-    if (!dir) return GPU_ERROR_API_FAILED;
+    char* end;
+    long value = strtol(buffer, &end, 0);
+    return (end != buffer) ? value : -1;
+}
+
+// pp_dpm_* files list one DPM level per line; the active one ends with '*'
+static uint32_t read_attr_dpm_clock(amd_card_t* card, amd_attr_t attr) {
+    char buffer[1024];
+    if (read_attr(card, attr, buffer, sizeof(buffer)) <= 0) return 0;
     
-    struct dirent* entry;
-    int current_index = 0;
-    char card_path[512] = {0};
-    int found = 0;
-    
-    while ((entry = readdir(dir)) != NULL) {
-        if (strncmp(entry->d_name, "card", 4) == 0 && 
-            strlen(entry->d_name) == 5 && 
-            entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
-            
-            char temp_path[512];
-            snprintf(temp_path, sizeof(temp_path), "/sys/class/drm/%s", entry->d_name);
-            
-            if (is_amd_device(temp_path)) {
-                if (current_index == index) {
-                    strncpy(card_path, temp_path, sizeof(card_path) - 1);
-                    found = 1;
-                    break;
-                }
-                current_index++;
+    char* line = buffer;
+    while (line && *line) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        
+        if (strchr(line, '*')) {
+            unsigned int clock_mhz;
+            if (sscanf(line, "%*d: %uMhz", &clock_mhz) == 1) {
+                return clock_mhz;
             }
         }
+        line = next;
+    }
+    return 0;
+}
+
+// gpu_metrics: a versioned binary table exposing most telemetry in a single
+// read. Offsets below follow the kernel's struct gpu_metrics_vX_Y layouts
+// (drivers/gpu/drm/amd/include/kgd_pp_interface.h). Every table starts with
+// a 4-byte header: u16 structure_size, u8 format_revision, u8 content_revision.
+#define AMD_METRICS_TEMPERATURE  (1u << 0)
+#define AMD_METRICS_POWER        (1u << 1)
+#define AMD_METRICS_GFX_ACTIVITY (1u << 2)
+#define AMD_METRICS_CORE_CLOCK   (1u << 3)
+#define AMD_METRICS_MEMORY_CLOCK (1u << 4)
+
+typedef struct {
+    unsigned int valid;         // AMD_METRICS_* bits that were decoded
+    float temperature;          // Celsius
+    float power_usage;          // Watts
+    float gpu_utilization;      // Percent
+    uint32_t core_clock;        // MHz
+    uint32_t memory_clock;      // MHz
+} amd_gpu_metrics_t;
+
+// Field offsets for one table revision; -1 when the revision lacks the field
+typedef struct {
+    int temperature;            // u16
+    int gfx_activity;           // u16
+    int socket_power;           // u16, or u32 when power_is_u32
+    int gfxclk;                 // u16
+    int uclk;                   // u16
+    int power_is_u32;
+    float temperature_scale;    // Raw unit -> Celsius
+    float activity_scale;       // Raw unit -> percent
+    float power_scale;          // Raw unit -> Watts
+} amd_metrics_layout_t;
+
+// dGPU tables report whole degrees/percent/Watts
+static const amd_metrics_layout_t amd_metrics_v1_0 = { 16, 28, 34, 54, 58, 0, 1.0f, 1.0f, 1.0f };
+static const amd_metrics_layout_t amd_metrics_v1_1 = { 4, 16, 22, 54, 58, 0, 1.0f, 1.0f, 1.0f };
+// v1.4+ (MI300 class) leads with hotspot temperature and current socket power;
+// per-instance clock arrays are not decoded
+static const amd_metrics_layout_t amd_metrics_v1_4 = { 4, 12, 10, -1, -1, 0, 1.0f, 1.0f, 1.0f };
+// APU tables report centi-degrees, centi-percent and milliwatts
+static const amd_metrics_layout_t amd_metrics_v2_0 = { 16, 40, 44, 80, 84, 0, 0.01f, 0.01f, 0.001f };
+static const amd_metrics_layout_t amd_metrics_v2_1 = { 4, 28, 40, 76, 80, 0, 0.01f, 0.01f, 0.001f };
+// v3.x only carries time-filtered clocks. Socket power is a u32, and the u16
+// average_ipu_power at 116 leaves the clocks 2-byte aligned at 174 and 186.
+static const amd_metrics_layout_t amd_metrics_v3_0 = { 4, 42, 112, 174, 186, 1, 0.01f, 0.01f, 0.001f };
+
+static const amd_metrics_layout_t* select_metrics_layout(uint8_t format, uint8_t content) {
+    switch (format) {
+        case 1:
+            if (content == 0) return &amd_metrics_v1_0;
+            if (content <= 3) return &amd_metrics_v1_1;
+            return &amd_metrics_v1_4;
+        case 2:
+            return content == 0 ? &amd_metrics_v2_0 : &amd_metrics_v2_1;
+        case 3:
+            return &amd_metrics_v3_0;
+        default:
+            return NULL;
     }
+}
+
+// Read a u16 field; 0xFFFF marks a field the firmware doesn't populate
+static int metrics_u16(const unsigned char* blob, size_t size, int offset, uint32_t* value) {
+    if (offset < 0 || (size_t)offset + 2 > size) return 0;
     
-    closedir(dir);
+    uint16_t raw;
+    memcpy(&raw, blob + offset, sizeof(raw));
+    if (raw == 0xFFFF) return 0;
+    
+    *value = raw;
+    return 1;
+}
+
+static int metrics_u32(const unsigned char* blob, size_t size, int offset, uint32_t* value) {
+    if (offset < 0 || (size_t)offset + 4 > size) return 0;
+    
+    uint32_t raw;
+    memcpy(&raw, blob + offset, sizeof(raw));
+    if (raw == 0xFFFFFFFF) return 0;
+    
+    *value = raw;
+    return 1;
+}
+
+static void parse_gpu_metrics(const unsigned char* blob, size_t size, amd_gpu_metrics_t* metrics) {
+    memset(metrics, 0, sizeof(amd_gpu_metrics_t));
+    if (size < 4) return;
+    
+    uint16_t structure_size;
+    memcpy(&structure_size, blob, sizeof(structure_size));
+    if (structure_size < size) size = structure_size;
+    
+    const amd_metrics_layout_t* layout = select_metrics_layout(blob[2], blob[3]);
+    if (!layout) return;
+    
+    uint32_t value;
+    if (metrics_u16(blob, size, layout->temperature, &value) && value > 0) {
+        metrics->temperature = value * layout->temperature_scale;
+        metrics->valid |= AMD_METRICS_TEMPERATURE;
+    }
+    
+    int has_power = layout->power_is_u32
+        ? metrics_u32(blob, size, layout->socket_power, &value)
+        : metrics_u16(blob, size, layout->socket_power, &value);
+    if (has_power) {
+        metrics->power_usage = value * layout->power_scale;
+        metrics->valid |= AMD_METRICS_POWER;
+    }
+    
+    if (metrics_u16(blob, size, layout->gfx_activity, &value)) {
+        metrics->gpu_utilization = value * layout->activity_scale;
+        metrics->valid |= AMD_METRICS_GFX_ACTIVITY;
+    }
+    
+    if (metrics_u16(blob, size, layout->gfxclk, &value)) {
+        metrics->core_clock = value;
+        metrics->valid |= AMD_METRICS_CORE_CLOCK;
+    }
+    
+    if (metrics_u16(blob, size, layout->uclk, &value)) {
+        metrics->memory_clock = value;
+        metrics->valid |= AMD_METRICS_MEMORY_CLOCK;
+    }
+}
+
+static void read_gpu_metrics(amd_card_t* card, amd_gpu_metrics_t* metrics) {
+    unsigned char blob[4096];
+    
+    memset(metrics, 0, sizeof(amd_gpu_metrics_t));
     
-    if (!found) return GPU_ERROR_INVALID_PARAM;
+    ssize_t n = read_attr(card, AMD_ATTR_GPU_METRICS, (char*)blob, sizeof(blob));
+    if (n > 0) {
+        parse_gpu_metrics(blob, (size_t)n, metrics);
+    }
+}
+
+gpu_error_t amd_linux_get_gpu_count(int32_t* count) {
+    if (!count) return GPU_ERROR_INVALID_PARAM;
+    
+    gpu_mutex_lock(&amd_scan_lock);
+    gpu_error_t result = scan_amd_cards();
+    gpu_mutex_unlock(&amd_scan_lock);
+    *count = amd_card_count;
+    return result;
+}
+
+gpu_error_t amd_linux_get_gpu_path(int32_t index, char* path, size_t size) {
+    if (!path || size == 0) return GPU_ERROR_INVALID_PARAM;
+    
+    ensure_scanned();
+    
+    if (index < 0 || index >= amd_card_count) {
+        path[0] = '\0';
+        return GPU_ERROR_NO_GPU;
+    }
+    
+    snprintf(path, size, "%s", amd_cards[index].path);
+    return GPU_SUCCESS;
+}
+
+gpu_error_t amd_linux_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
+    if (!info) return GPU_ERROR_INVALID_PARAM;
+    
+    ensure_scanned();
+    
+    // A stale index means the card went away since the registry was built
+    if (index < 0 || index >= amd_card_count) return GPU_ERROR_NO_GPU;
+    
+    amd_card_t* card = &amd_cards[index];
+    if (card->gone) return GPU_ERROR_NO_GPU;
     
     // Initialize structure
     memset(info, 0, sizeof(gpu_info_t));
@@ -123,147 +488,130 @@ gpu_error_t amd_linux_get_gpu_info(int32_t index, gpu_info_t* info) {
     info->vendor = GPU_VENDOR_AMD;
     
     // Read GPU name from device
-    char name_path[512];
-    snprintf(name_path, sizeof(name_path), "%s/device/product_name", card_path);
-    if (!read_sysfs_string(name_path, info->name, sizeof(info->name))) {
-        // Fallback: try model or just use generic name
-        snprintf(name_path, sizeof(name_path), "%s/device/model", card_path);
-        if (!read_sysfs_string(name_path, info->name, sizeof(info->name))) {
-            snprintf(info->name, sizeof(info->name), "AMD GPU %d", index);
+    if (fields & GPU_FIELD_NAME) {
+        if (!read_attr_string(card, AMD_ATTR_PRODUCT_NAME, info->name, sizeof(info->name))) {
+            // Fallback: try model or just use generic name
+            if (!read_attr_string(card, AMD_ATTR_MODEL, info->name, sizeof(info->name))) {
+                snprintf(info->name, sizeof(info->name), "AMD GPU %d", index);
+            }
         }
     }
     
     // Read device ID for UUID
-    char device_path[512];
-    snprintf(device_path, sizeof(device_path), "%s/device/device", card_path);
-    unsigned int device_id = 0;
-    FILE* f = fopen(device_path, "r");
-    if (f) {
-        fscanf(f, "%x", &device_id);
-        fclose(f);
+    if (fields & GPU_FIELD_UUID) {
+        long device_id = read_attr_long(card, AMD_ATTR_DEVICE_ID);
+        if (device_id < 0) device_id = 0;
+        snprintf(info->uuid, sizeof(info->uuid), "AMD-Linux-0x%04lX-%d", device_id, index);
     }
-    snprintf(info->uuid, sizeof(info->uuid), "AMD-Linux-0x%04X-%d", device_id, index);
     
     // Read PCI bus ID
-    char pci_path[512];
-    snprintf(pci_path, sizeof(pci_path), "%s/device/uevent", card_path);
-    f = fopen(pci_path, "r");
-    if (f) {
-        char line[256];
-        while (fgets(line, sizeof(line), f)) {
-            if (strncmp(line, "PCI_SLOT_NAME=", 14) == 0) {
-                strncpy(info->pci_bus_id, line + 14, sizeof(info->pci_bus_id) - 1);
-                // Remove newline
-                size_t len = strlen(info->pci_bus_id);
-                if (len > 0 && info->pci_bus_id[len-1] == '\n') {
-                    info->pci_bus_id[len-1] = '\0';
-                }
-                break;
+    if (fields & GPU_FIELD_PCI_BUS_ID) {
+        char uevent[1024];
+        if (read_attr(card, AMD_ATTR_UEVENT, uevent, sizeof(uevent)) > 0) {
+            const char* slot = strstr(uevent, "PCI_SLOT_NAME=");
+            if (slot) {
+                slot += 14;
+                size_t len = strcspn(slot, "\n");
+                if (len >= sizeof(info->pci_bus_id)) len = sizeof(info->pci_bus_id) - 1;
+                memcpy(info->pci_bus_id, slot, len);
+                info->pci_bus_id[len] = '\0';
             }
         }
-        fclose(f);
-    }
-    if (info->pci_bus_id[0] == '\0') {
-        snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
+        if (info->pci_bus_id[0] == '\0') {
+            snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
+        }
     }
     
-    // Read memory information (in bytes, convert to MB)
-    char mem_path[512];
-    snprintf(mem_path, sizeof(mem_path), "%s/device/mem_info_vram_total", card_path);
-    long mem_total = read_sysfs_long(mem_path);
-    if (mem_total > 0) {
-        info->memory_total = (int32_t)(mem_total / (1024 * 1024));
+    // Read memory information (in bytes, convert to MB); free and
+    // utilization are derived from total and used
+    const gpu_field_mask_t derived = GPU_FIELD_MEMORY_FREE | GPU_FIELD_MEMORY_UTILIZATION;
+    if (fields & (GPU_FIELD_MEMORY_TOTAL | derived)) {
+        long mem_total = read_attr_long(card, AMD_ATTR_VRAM_TOTAL);
+        if (mem_total > 0) {
+            info->memory_total = (int32_t)(mem_total / (1024 * 1024));
+        }
     }
     
-    snprintf(mem_path, sizeof(mem_path), "%s/device/mem_info_vram_used", card_path);
-    long mem_used = read_sysfs_long(mem_path);
-    if (mem_used > 0) {
-        info->memory_used = (int32_t)(mem_used / (1024 * 1024));
-        if (info->memory_total > 0) {
-            info->memory_free = info->memory_total - info->memory_used;
-            info->memory_utilization = (float)info->memory_used / info->memory_total * 100.0f;
+    if (fields & (GPU_FIELD_MEMORY_USED | derived)) {
+        long mem_used = read_attr_long(card, AMD_ATTR_VRAM_USED);
+        if (mem_used > 0) {
+            info->memory_used = (int32_t)(mem_used / (1024 * 1024));
+            if (info->memory_total > 0) {
+                info->memory_free = info->memory_total - info->memory_used;
+                info->memory_utilization = (float)info->memory_used / info->memory_total * 100.0f;
+            }
         }
     }
     
+    // One read of gpu_metrics covers the dynamic sensors when the kernel and
+    // ASIC provide it; anything it lacks falls back to the individual files
+    amd_gpu_metrics_t metrics;
+    metrics.valid = 0;
+    if (fields & (GPU_FIELD_GPU_UTILIZATION | GPU_FIELD_TEMPERATURE | GPU_FIELD_POWER_USAGE |
+                  GPU_FIELD_CORE_CLOCK | GPU_FIELD_MEMORY_CLOCK)) {
+        read_gpu_metrics(card, &metrics);
+    }
+    
     // Read GPU utilization
-    char util_path[512];
-    snprintf(util_path, sizeof(util_path), "%s/device/gpu_busy_percent", card_path);
-    long gpu_util = read_sysfs_long(util_path);
-    if (gpu_util >= 0) {
-        info->gpu_utilization = (float)gpu_util;
+    if (metrics.valid & AMD_METRICS_GFX_ACTIVITY) {
+        info->gpu_utilization = metrics.gpu_utilization;
+    } else if (fields & GPU_FIELD_GPU_UTILIZATION) {
+        long gpu_util = read_attr_long(card, AMD_ATTR_GPU_BUSY);
+        if (gpu_util >= 0) {
+            info->gpu_utilization = (float)gpu_util;
+        }
     }
     
     // Read temperature (in millidegrees, convert to Celsius)
-    char temp_path[512];
-    snprintf(temp_path, sizeof(temp_path), "%s/device/hwmon/hwmon*/temp1_input", card_path);
-    // Note: This glob pattern won't work directly, we'd need to enumerate hwmon directories
-    // For now, try hwmon0 and hwmon1
-    for (int hwmon = 0; hwmon < 4; hwmon++) {
-        snprintf(temp_path, sizeof(temp_path), "%s/device/hwmon/hwmon%d/temp1_input", card_path, hwmon);
-        long temp = read_sysfs_long(temp_path);
+    if (metrics.valid & AMD_METRICS_TEMPERATURE) {
+        info->temperature = metrics.temperature;
+    } else if (fields & GPU_FIELD_TEMPERATURE) {
+        long temp = read_attr_long(card, AMD_ATTR_TEMP);
         if (temp > 0) {
             info->temperature = temp / 1000.0f;
-            break;
         }
     }
     
     // Read power usage (in microwatts, convert to watts)
-    char power_path[512];
-    for (int hwmon = 0; hwmon < 4; hwmon++) {
-        snprintf(power_path, sizeof(power_path), "%s/device/hwmon/hwmon%d/power1_average", card_path, hwmon);
-        long power = read_sysfs_long(power_path);
+    if (metrics.valid & AMD_METRICS_POWER) {
+        info->power_usage = metrics.power_usage;
+    } else if (fields & GPU_FIELD_POWER_USAGE) {
+        long power = read_attr_long(card, AMD_ATTR_POWER);
         if (power > 0) {
             info->power_usage = power / 1000000.0f;
-            break;
         }
     }
     
-    // Read clock speeds (in Hz, convert to MHz)
-    char clock_path[512];
-    snprintf(clock_path, sizeof(clock_path), "%s/device/pp_dpm_sclk", card_path);
-    f = fopen(clock_path, "r");
-    if (f) {
-        char line[256];
-        // Find the line with asterisk (current clock)
-        while (fgets(line, sizeof(line), f)) {
-            if (strchr(line, '*')) {
-                unsigned int clock_mhz;
-                if (sscanf(line, "%*d: %uMhz", &clock_mhz) == 1) {
-                    info->core_clock = clock_mhz;
-                    break;
-                }
-            }
-        }
-        fclose(f);
-    }
-    
-    snprintf(clock_path, sizeof(clock_path), "%s/device/pp_dpm_mclk", card_path);
-    f = fopen(clock_path, "r");
-    if (f) {
-        char line[256];
-        while (fgets(line, sizeof(line), f)) {
-            if (strchr(line, '*')) {
-                unsigned int clock_mhz;
-                if (sscanf(line, "%*d: %uMhz", &clock_mhz) == 1) {
-                    info->memory_clock = clock_mhz;
-                    break;
-                }
-            }
-        }
-        fclose(f);
+    // Read clock speeds (current DPM level, in MHz)
+    if (metrics.valid & AMD_METRICS_CORE_CLOCK) {
+        info->core_clock = metrics.core_clock;
+    } else if (fields & GPU_FIELD_CORE_CLOCK) {
+        info->core_clock = read_attr_dpm_clock(card, AMD_ATTR_SCLK);
+    }
+    if (metrics.valid & AMD_METRICS_MEMORY_CLOCK) {
+        info->memory_clock = metrics.memory_clock;
+    } else if (fields & GPU_FIELD_MEMORY_CLOCK) {
+        info->memory_clock = read_attr_dpm_clock(card, AMD_ATTR_MCLK);
     }
     
     // Read fan speed (percentage)
-    char fan_path[512];
-    for (int hwmon = 0; hwmon < 4; hwmon++) {
-        snprintf(fan_path, sizeof(fan_path), "%s/device/hwmon/hwmon%d/pwm1", card_path, hwmon);
-        long fan_pwm = read_sysfs_long(fan_path);
+    if (fields & GPU_FIELD_FAN_SPEED) {
+        long fan_pwm = read_attr_long(card, AMD_ATTR_PWM);
         if (fan_pwm >= 0) {
             // PWM is typically 0-255
             info->fan_speed = (fan_pwm / 255.0f) * 100.0f;
-            break;
         }
     }
     
+    // An attribute vanished mid-read: let the registry rescan
+    if (card->gone) return GPU_ERROR_NO_GPU;
+    
     return GPU_SUCCESS;
-}
\ No newline at end of file
+}
+
+// Cleanup function
+void amd_linux_cleanup(void) {
+    gpu_mutex_lock(&amd_scan_lock);
+    close_all_cards();
+    gpu_mutex_unlock(&amd_scan_lock);
+}
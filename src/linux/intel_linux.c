@@ -13,8 +13,10 @@ gpu_error_t intel_linux_get_gpu_count(int32_t* count) {
     return GPU_SUCCESS;
 }
 
-gpu_error_t intel_linux_get_gpu_info(int32_t index, gpu_info_t* info) {
+gpu_error_t intel_linux_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
     if (!info) return GPU_ERROR_INVALID_PARAM;
+    (void)index;
+    (void)fields;
     
     return GPU_ERROR_NOT_SUPPORTED;
 }
@@ -1,11 +1,20 @@
 #include "../gpu_info.h"
+#include "../gpu_thread.h"
 #include <dlfcn.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#define NVML_ERROR_GPU_IS_LOST 15
+
+// NVML is loaded once, by whichever thread gets there first: callers check
+// nvml_initialized with an acquire load and only take nvml_load_lock while it
+// is still unset. Unlike pthread_once, nvidia_linux_cleanup() can reset it.
+// The function pointers below are written before nvml_initialized is
+// published and are read-only afterwards.
+static gpu_mutex_t nvml_load_lock = GPU_MUTEX_INITIALIZER;
 static void* nvml_library = NULL;
-static int nvml_initialized = 0;
+static volatile uint32_t nvml_initialized = 0;
 
 // NVML structures (same as Windows)
 typedef struct {
@@ -29,6 +38,58 @@ typedef struct {
     unsigned int pciSubSystemId;
 } nvmlPciInfo_t;
 
+// Field value query (nvmlDeviceGetFieldValues, R384+)
+typedef union {
+    double dVal;
+    unsigned int uiVal;
+    unsigned long ulVal;
+    unsigned long long ullVal;
+    signed long long sllVal;
+    signed int siVal;
+    unsigned short usVal;
+} nvmlValue_t;
+
+typedef struct {
+    unsigned int fieldId;
+    unsigned int scopeId;
+    long long timestamp;
+    long long latencyUsec;
+    int valueType;              // nvmlValueType_t
+    int nvmlReturn;
+    nvmlValue_t value;
+} nvmlFieldValue_t;
+
+#define NVML_VALUE_TYPE_DOUBLE 0
+#define NVML_VALUE_TYPE_UNSIGNED_INT 1
+#define NVML_VALUE_TYPE_UNSIGNED_LONG 2
+#define NVML_VALUE_TYPE_UNSIGNED_LONG_LONG 3
+#define NVML_VALUE_TYPE_SIGNED_LONG_LONG 4
+#define NVML_VALUE_TYPE_SIGNED_INT 5
+#define NVML_VALUE_TYPE_UNSIGNED_SHORT 6
+
+#define NVML_FI_DEV_MEMORY_TEMP 82                  // C
+#define NVML_FI_DEV_TOTAL_ENERGY_CONSUMPTION 83     // mJ since driver load
+#define NVML_FI_DEV_PCIE_REPLAY_COUNTER 94
+#define NVML_FI_DEV_POWER_INSTANT 186               // mW, R530+
+
+// Fields served by one nvmlDeviceGetFieldValues call per query. NVML has no
+// field ids for utilization, core temperature, clocks or fan speed, so those
+// keep their dedicated calls. A field the driver rejects for a device is read
+// with its single-call function from then on.
+typedef struct {
+    gpu_field_mask_t field;     // GPU_FIELD_* bit it fills
+    unsigned int field_id;      // NVML_FI_*
+} nvml_batch_field_t;
+
+static const nvml_batch_field_t nvml_batch_fields[] = {
+    { GPU_FIELD_POWER_USAGE, NVML_FI_DEV_POWER_INSTANT },
+    { GPU_FIELD_MEMORY_TEMPERATURE, NVML_FI_DEV_MEMORY_TEMP },
+    { GPU_FIELD_ENERGY, NVML_FI_DEV_TOTAL_ENERGY_CONSUMPTION },
+    { GPU_FIELD_PCIE_REPLAY_COUNT, NVML_FI_DEV_PCIE_REPLAY_COUNTER },
+};
+
+#define NVML_BATCH_MAX (sizeof(nvml_batch_fields) / sizeof(nvml_batch_fields[0]))
+
 // Function pointers (same as Windows)
 static int (*nvmlInit_v2)(void) = NULL;
 static int (*nvmlShutdown)(void) = NULL;
@@ -43,10 +104,28 @@ static int (*nvmlDeviceGetPowerUsage)(void*, unsigned int*) = NULL;
 static int (*nvmlDeviceGetClockInfo)(void*, int, unsigned int*) = NULL;
 static int (*nvmlDeviceGetFanSpeed)(void*, unsigned int*) = NULL;
 static int (*nvmlDeviceGetPciInfo)(void*, nvmlPciInfo_t*) = NULL;
+static int (*nvmlDeviceGetTotalEnergyConsumption)(void*, unsigned long long*) = NULL;
+static int (*nvmlDeviceGetPcieReplayCounter)(void*, unsigned int*) = NULL;
+static int (*nvmlDeviceGetFieldValues)(void*, int, nvmlFieldValue_t*) = NULL;
 
-static gpu_error_t load_nvml_linux(void) {
-    if (nvml_initialized) return GPU_SUCCESS;
+// Per-device cache of the NVML handle and attributes that never change, filled
+// on first discovery so each poll only makes the dynamic calls
+typedef struct {
+    int cached;
+    void* handle;
+    char name[256];
+    char uuid[64];
+    char pci_bus_id[32];
+    uint64_t memory_total;      // MB, 0 if unknown
     
+    // GPU_FIELD_* bits still read through nvmlDeviceGetFieldValues; fields
+    // the GPU rejects are dropped after the first poll that asks for them
+    gpu_field_mask_t batch_fields;
+} nvml_device_t;
+
+static nvml_device_t nvml_devices[GPU_MAX_DEVICES];
+
+static gpu_error_t load_nvml_locked(void) {
     // Try to load NVML library from common locations
     nvml_library = dlopen("libnvidia-ml.so", RTLD_LAZY);
     if (!nvml_library) {
@@ -70,6 +149,10 @@ static gpu_error_t load_nvml_linux(void) {
     nvmlDeviceGetClockInfo = (int(*)(void*, int, unsigned int*))dlsym(nvml_library, "nvmlDeviceGetClockInfo");
     nvmlDeviceGetFanSpeed = (int(*)(void*, unsigned int*))dlsym(nvml_library, "nvmlDeviceGetFanSpeed");
     nvmlDeviceGetPciInfo = (int(*)(void*, nvmlPciInfo_t*))dlsym(nvml_library, "nvmlDeviceGetPciInfo");
+    nvmlDeviceGetTotalEnergyConsumption = (int(*)(void*, unsigned long long*))dlsym(nvml_library, "nvmlDeviceGetTotalEnergyConsumption");
+    nvmlDeviceGetPcieReplayCounter = (int(*)(void*, unsigned int*))dlsym(nvml_library, "nvmlDeviceGetPcieReplayCounter");
+    // Optional: older drivers lack it and every field uses its own call
+    nvmlDeviceGetFieldValues = (int(*)(void*, int, nvmlFieldValue_t*))dlsym(nvml_library, "nvmlDeviceGetFieldValues");
     
     // Check for essential functions
     if (!nvmlInit_v2 || !nvmlDeviceGetCount_v2 || !nvmlDeviceGetHandleByIndex) {
@@ -84,10 +167,160 @@ static gpu_error_t load_nvml_linux(void) {
         return GPU_ERROR_NOT_SUPPORTED;
     }
     
-    nvml_initialized = 1;
+    gpu_atomic_store_release(&nvml_initialized, 1);
+    return GPU_SUCCESS;
+}
+
+static gpu_error_t load_nvml_linux(void) {
+    if (gpu_atomic_load_acquire(&nvml_initialized)) return GPU_SUCCESS;
+    
+    gpu_mutex_lock(&nvml_load_lock);
+    gpu_error_t result = nvml_initialized ? GPU_SUCCESS : load_nvml_locked();
+    gpu_mutex_unlock(&nvml_load_lock);
+    return result;
+}
+
+// A GPU that fell off the bus or was reset is reported as lost by every call
+// on its handle. The cached handle is then dead: drop it, and the caller
+// returns GPU_ERROR_NO_GPU so the registry re-enumerates and the next query
+// resolves a fresh handle.
+static int device_lost(nvml_device_t* cache, int status) {
+    if (status != NVML_ERROR_GPU_IS_LOST) return 0;
+    
+    cache->cached = 0;
+    return 1;
+}
+
+// Resolve the NVML handle and immutable attributes for a device. Handles stay
+// valid until nvmlShutdown() or until the GPU is lost, so this normally runs
+// once per device.
+static gpu_error_t cache_device(int32_t index, nvml_device_t* cache) {
+    void* device;
+    int status = nvmlDeviceGetHandleByIndex((unsigned int)index, &device);
+    if (status != 0) {
+        return status == NVML_ERROR_GPU_IS_LOST ? GPU_ERROR_NO_GPU : GPU_ERROR_API_FAILED;
+    }
+    
+    memset(cache, 0, sizeof(nvml_device_t));
+    cache->handle = device;
+    
+    // Get GPU name
+    if (!nvmlDeviceGetName || nvmlDeviceGetName(device, cache->name, sizeof(cache->name)) != 0) {
+        snprintf(cache->name, sizeof(cache->name), "NVIDIA GPU");
+    }
+    
+    // Get UUID
+    if (!nvmlDeviceGetUUID || nvmlDeviceGetUUID(device, cache->uuid, sizeof(cache->uuid)) != 0) {
+        snprintf(cache->uuid, sizeof(cache->uuid), "NVIDIA-%d", index);
+    }
+    
+    // Get PCI bus information
+    nvmlPciInfo_t pciInfo;
+    if (nvmlDeviceGetPciInfo && nvmlDeviceGetPciInfo(device, &pciInfo) == 0) {
+        // Use the actual PCI bus ID from NVML
+        snprintf(cache->pci_bus_id, sizeof(cache->pci_bus_id), "%.*s",
+                 (int)sizeof(pciInfo.busId), pciInfo.busId);
+    } else {
+        // Fallback: generate from index
+        snprintf(cache->pci_bus_id, sizeof(cache->pci_bus_id), "PCI:%d", index);
+    }
+    
+    // Total framebuffer size is fixed for the lifetime of the device
+    nvmlMemory_t memory;
+    if (nvmlDeviceGetMemoryInfo && nvmlDeviceGetMemoryInfo(device, &memory) == 0) {
+        cache->memory_total = memory.total / (1024 * 1024);
+    }
+    
+    if (nvmlDeviceGetFieldValues) {
+        for (size_t i = 0; i < NVML_BATCH_MAX; i++) {
+            cache->batch_fields |= nvml_batch_fields[i].field;
+        }
+    }
+    
+    cache->cached = 1;
     return GPU_SUCCESS;
 }
 
+static double field_value_as_double(const nvmlFieldValue_t* field) {
+    switch (field->valueType) {
+        case NVML_VALUE_TYPE_DOUBLE: return field->value.dVal;
+        case NVML_VALUE_TYPE_UNSIGNED_INT: return (double)field->value.uiVal;
+        case NVML_VALUE_TYPE_UNSIGNED_LONG: return (double)field->value.ulVal;
+        case NVML_VALUE_TYPE_UNSIGNED_LONG_LONG: return (double)field->value.ullVal;
+        case NVML_VALUE_TYPE_SIGNED_LONG_LONG: return (double)field->value.sllVal;
+        case NVML_VALUE_TYPE_SIGNED_INT: return (double)field->value.siVal;
+        case NVML_VALUE_TYPE_UNSIGNED_SHORT: return (double)field->value.usVal;
+        default: return 0.0;
+    }
+}
+
+static uint64_t field_value_as_u64(const nvmlFieldValue_t* field) {
+    switch (field->valueType) {
+        case NVML_VALUE_TYPE_UNSIGNED_INT: return field->value.uiVal;
+        case NVML_VALUE_TYPE_UNSIGNED_LONG: return field->value.ulVal;
+        case NVML_VALUE_TYPE_UNSIGNED_LONG_LONG: return field->value.ullVal;
+        default: return (uint64_t)field_value_as_double(field);
+    }
+}
+
+// Fetch every requested batchable field for the device in a single driver
+// round-trip. Returns the GPU_FIELD_* bits that were filled in; anything else
+// is left to the single-call functions.
+static gpu_field_mask_t read_batched_fields(nvml_device_t* cache, gpu_field_mask_t fields,
+                                            gpu_info_t* info) {
+    if (!(cache->batch_fields & fields)) return 0;
+    
+    nvmlFieldValue_t values[NVML_BATCH_MAX];
+    gpu_field_mask_t requested[NVML_BATCH_MAX];
+    int count = 0;
+    
+    memset(values, 0, sizeof(values));
+    for (size_t i = 0; i < NVML_BATCH_MAX; i++) {
+        if (cache->batch_fields & fields & nvml_batch_fields[i].field) {
+            values[count].fieldId = nvml_batch_fields[i].field_id;
+            requested[count] = nvml_batch_fields[i].field;
+            count++;
+        }
+    }
+    
+    int status = nvmlDeviceGetFieldValues(cache->handle, count, values);
+    if (status != 0) {
+        // The call itself is unusable for this device, unless the device is
+        // gone altogether, which the caller sees from the dropped cache
+        if (!device_lost(cache, status)) {
+            cache->batch_fields = 0;
+        }
+        return 0;
+    }
+    
+    gpu_field_mask_t filled = 0;
+    for (int i = 0; i < count; i++) {
+        if (values[i].nvmlReturn != 0) {
+            // Not supported on this GPU or driver; fall back for good
+            cache->batch_fields &= ~requested[i];
+            continue;
+        }
+        
+        switch (requested[i]) {
+            case GPU_FIELD_POWER_USAGE:
+                info->power_usage = (float)(field_value_as_double(&values[i]) / 1000.0); // mW to watts
+                break;
+            case GPU_FIELD_MEMORY_TEMPERATURE:
+                info->memory_temperature = (float)field_value_as_double(&values[i]);
+                break;
+            case GPU_FIELD_ENERGY:
+                info->energy_consumption = field_value_as_u64(&values[i]);
+                break;
+            case GPU_FIELD_PCIE_REPLAY_COUNT:
+                info->pcie_replay_count = field_value_as_u64(&values[i]);
+                break;
+        }
+        filled |= requested[i];
+    }
+    
+    return filled;
+}
+
 gpu_error_t nvidia_linux_get_gpu_count(int32_t* count) {
     if (!count) return GPU_ERROR_INVALID_PARAM;
     
@@ -97,6 +330,9 @@ gpu_error_t nvidia_linux_get_gpu_count(int32_t* count) {
         return GPU_SUCCESS;
     }
     
+    // Re-enumeration may reorder devices; drop cached handles
+    memset(nvml_devices, 0, sizeof(nvml_devices));
+    
     unsigned int nv_count = 0;
     if (nvmlDeviceGetCount_v2(&nv_count) != 0) {
         *count = 0;
@@ -107,7 +343,7 @@ gpu_error_t nvidia_linux_get_gpu_count(int32_t* count) {
     return GPU_SUCCESS;
 }
 
-gpu_error_t nvidia_linux_get_gpu_info(int32_t index, gpu_info_t* info) {
+gpu_error_t nvidia_linux_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
     if (!info) return GPU_ERROR_INVALID_PARAM;
     
     gpu_error_t result = load_nvml_linux();
@@ -115,137 +351,169 @@ gpu_error_t nvidia_linux_get_gpu_info(int32_t index, gpu_info_t* info) {
         return result;
     }
     
-    void* device;
-    if (nvmlDeviceGetHandleByIndex((unsigned int)index, &device) != 0) {
-        return GPU_ERROR_API_FAILED;
+    if (index < 0 || index >= GPU_MAX_DEVICES) {
+        return GPU_ERROR_INVALID_PARAM;
+    }
+    
+    nvml_device_t* cache = &nvml_devices[index];
+    if (!cache->cached) {
+        gpu_error_t cache_result = cache_device(index, cache);
+        if (cache_result != GPU_SUCCESS) {
+            return cache_result;
+        }
     }
     
+    void* device = cache->handle;
+    
     memset(info, 0, sizeof(gpu_info_t));
     info->index = index;
     info->vendor = GPU_VENDOR_NVIDIA;
     
-    // Get GPU name
-    char name[256];
-    if (nvmlDeviceGetName && nvmlDeviceGetName(device, name, sizeof(name)) == 0) {
-        strncpy(info->name, name, sizeof(info->name) - 1);
-    } else {
-        strncpy(info->name, "NVIDIA GPU", sizeof(info->name) - 1);
+    // Static attributes come from the per-device cache
+    if (fields & GPU_FIELD_NAME) {
+        strncpy(info->name, cache->name, sizeof(info->name) - 1);
     }
-    
-    // Get UUID
-    char uuid[64];
-    if (nvmlDeviceGetUUID && nvmlDeviceGetUUID(device, uuid, sizeof(uuid)) == 0) {
-        strncpy(info->uuid, uuid, sizeof(info->uuid) - 1);
-    } else {
-        snprintf(info->uuid, sizeof(info->uuid), "NVIDIA-%d", index);
+    if (fields & GPU_FIELD_UUID) {
+        strncpy(info->uuid, cache->uuid, sizeof(info->uuid) - 1);
+    }
+    if (fields & GPU_FIELD_PCI_BUS_ID) {
+        strncpy(info->pci_bus_id, cache->pci_bus_id, sizeof(info->pci_bus_id) - 1);
     }
     
-    // Get PCI bus information
-    if (nvmlDeviceGetPciInfo) {
-        nvmlPciInfo_t pciInfo;
-        if (nvmlDeviceGetPciInfo(device, &pciInfo) == 0) {
-            // Use the actual PCI bus ID from NVML
-            strncpy(info->pci_bus_id, pciInfo.busId, sizeof(info->pci_bus_id) - 1);
-            
-            // Debug output to see all PCI information (optional)
-            /*printf("GPU %d PCI Info:\n", index);
-            printf("  Bus ID: %s\n", pciInfo.busId);
-            printf("  Domain: 0x%04X\n", pciInfo.domain);
-            printf("  Bus: 0x%02X\n", pciInfo.bus);
-            printf("  Device: 0x%02X\n", pciInfo.device);
-            printf("  Device ID: 0x%04X\n", pciInfo.pciDeviceId);
-            printf("  Subsystem ID: 0x%04X\n", pciInfo.pciSubSystemId);*/
-        } else {
-            // Fallback: generate from index
-            snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
-        }
-    } else {
-        // Fallback: generate from index
-        snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
+    gpu_field_mask_t batched = read_batched_fields(cache, fields, info);
+    if (!cache->cached) {
+        return GPU_ERROR_NO_GPU;
     }
     
-    // Get memory info
-    nvmlMemory_t memory;
-    if (nvmlDeviceGetMemoryInfo && nvmlDeviceGetMemoryInfo(device, &memory) == 0) {
-        info->memory_total = memory.total / (1024 * 1024); // Convert to MB
-        info->memory_used = memory.used / (1024 * 1024);
-        info->memory_free = memory.free / (1024 * 1024);
-        
-        // Calculate memory capacity utilization (for reference)
-        float capacity_utilization = 0.0f;
-        if (memory.total > 0) {
-            capacity_utilization = (float)memory.used / memory.total * 100.0f;
+    // Get memory info (total alone is served from the cache when possible)
+    if ((fields & (GPU_FIELD_MEMORY_USED | GPU_FIELD_MEMORY_FREE)) ||
+        ((fields & GPU_FIELD_MEMORY_TOTAL) && !cache->memory_total)) {
+        nvmlMemory_t memory;
+        int status = nvmlDeviceGetMemoryInfo ? nvmlDeviceGetMemoryInfo(device, &memory) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
         }
-        
-        // Debug output (optional)
-        /*printf("GPU %d Memory: %llu/%llu MB (%.1f%% capacity)\n", 
-               index, memory.used / (1024 * 1024), memory.total / (1024 * 1024),
-               capacity_utilization);*/
-    } else {
-        // Fallback values
-        info->memory_total = 8 * 1024;
-        info->memory_used = 0;
-        info->memory_free = 8 * 1024;
+        if (status == 0) {
+            info->memory_total = cache->memory_total ? cache->memory_total
+                                                     : memory.total / (1024 * 1024); // Convert to MB
+            info->memory_used = memory.used / (1024 * 1024);
+            info->memory_free = memory.free / (1024 * 1024);
+        } else {
+            // Fallback values
+            info->memory_total = 8 * 1024;
+            info->memory_used = 0;
+            info->memory_free = 8 * 1024;
+        }
+    } else if (fields & GPU_FIELD_MEMORY_TOTAL) {
+        info->memory_total = cache->memory_total;
     }
     
     // Get utilization rates
-    nvmlUtilization_t utilization;
-    if (nvmlDeviceGetUtilizationRates && nvmlDeviceGetUtilizationRates(device, &utilization) == 0) {
-        info->gpu_utilization = (float)utilization.gpu;
-        info->memory_utilization = (float)utilization.memory; // Memory bandwidth utilization
-        
-        // Debug output (optional)
-        /*printf("GPU %d Utilization: GPU=%u%%, Memory=%u%%\n", 
-               index, utilization.gpu, utilization.memory);*/
-    } else {
-        info->gpu_utilization = 0.0f;
-        info->memory_utilization = 0.0f;
+    if (fields & (GPU_FIELD_GPU_UTILIZATION | GPU_FIELD_MEMORY_UTILIZATION)) {
+        nvmlUtilization_t utilization;
+        int status = nvmlDeviceGetUtilizationRates ? nvmlDeviceGetUtilizationRates(device, &utilization) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->gpu_utilization = (float)utilization.gpu;
+            info->memory_utilization = (float)utilization.memory; // Memory bandwidth utilization
+        }
     }
     
     // Get temperature (GPU core)
-    unsigned int temperature;
-    if (nvmlDeviceGetTemperature && nvmlDeviceGetTemperature(device, 0, &temperature) == 0) {
-        info->temperature = (float)temperature;
-    } else {
-        info->temperature = 0.0f;
+    if (fields & GPU_FIELD_TEMPERATURE) {
+        unsigned int temperature;
+        int status = nvmlDeviceGetTemperature ? nvmlDeviceGetTemperature(device, 0, &temperature) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->temperature = (float)temperature;
+        }
     }
     
-    // Get power usage (in milliwatts)
-    unsigned int power;
-    if (nvmlDeviceGetPowerUsage && nvmlDeviceGetPowerUsage(device, &power) == 0) {
-        info->power_usage = (float)power / 1000.0f; // Convert to watts
-    } else {
-        info->power_usage = 0.0f;
+    // Get power usage (in milliwatts), the instantaneous reading either way
+    if ((fields & GPU_FIELD_POWER_USAGE) && !(batched & GPU_FIELD_POWER_USAGE)) {
+        unsigned int power;
+        int status = nvmlDeviceGetPowerUsage ? nvmlDeviceGetPowerUsage(device, &power) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->power_usage = (float)power / 1000.0f; // Convert to watts
+        }
     }
     
     // Get core clock (graphics clock)
-    unsigned int clock;
-    if (nvmlDeviceGetClockInfo && nvmlDeviceGetClockInfo(device, 0, &clock) == 0) {
-        info->core_clock = clock;
-    } else {
-        info->core_clock = 0;
+    if (fields & GPU_FIELD_CORE_CLOCK) {
+        unsigned int clock;
+        int status = nvmlDeviceGetClockInfo ? nvmlDeviceGetClockInfo(device, 0, &clock) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->core_clock = clock;
+        }
     }
     
     // Get memory clock
-    if (nvmlDeviceGetClockInfo && nvmlDeviceGetClockInfo(device, 1, &clock) == 0) {
-        info->memory_clock = clock;
-    } else {
-        info->memory_clock = 0;
+    if (fields & GPU_FIELD_MEMORY_CLOCK) {
+        unsigned int clock;
+        int status = nvmlDeviceGetClockInfo ? nvmlDeviceGetClockInfo(device, 1, &clock) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->memory_clock = clock;
+        }
     }
     
     // Get fan speed
-    unsigned int fan_speed;
-    if (nvmlDeviceGetFanSpeed && nvmlDeviceGetFanSpeed(device, &fan_speed) == 0) {
-        info->fan_speed = (float)fan_speed;
-    } else {
-        info->fan_speed = 0.0f;
+    if (fields & GPU_FIELD_FAN_SPEED) {
+        unsigned int fan_speed;
+        int status = nvmlDeviceGetFanSpeed ? nvmlDeviceGetFanSpeed(device, &fan_speed) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->fan_speed = (float)fan_speed;
+        }
+    }
+    
+    // Memory temperature is only exposed as a field value; without it the
+    // field stays 0
+    
+    // Get total energy consumption (in millijoules)
+    if ((fields & GPU_FIELD_ENERGY) && !(batched & GPU_FIELD_ENERGY)) {
+        unsigned long long energy;
+        int status = nvmlDeviceGetTotalEnergyConsumption ? nvmlDeviceGetTotalEnergyConsumption(device, &energy) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->energy_consumption = energy;
+        }
+    }
+    
+    // Get PCIe replay counter
+    if ((fields & GPU_FIELD_PCIE_REPLAY_COUNT) && !(batched & GPU_FIELD_PCIE_REPLAY_COUNT)) {
+        unsigned int replays;
+        int status = nvmlDeviceGetPcieReplayCounter ? nvmlDeviceGetPcieReplayCounter(device, &replays) : -1;
+        if (device_lost(cache, status)) {
+            return GPU_ERROR_NO_GPU;
+        }
+        if (status == 0) {
+            info->pcie_replay_count = replays;
+        }
     }
     
     return GPU_SUCCESS;
 }
 
-// Cleanup function
+// Cleanup function; callers guarantee no query is in flight
 void nvidia_linux_cleanup(void) {
+    gpu_mutex_lock(&nvml_load_lock);
     if (nvml_initialized && nvmlShutdown) {
         nvmlShutdown();
     }
@@ -253,5 +521,7 @@ void nvidia_linux_cleanup(void) {
         dlclose(nvml_library);
         nvml_library = NULL;
     }
-    nvml_initialized = 0;
+    memset(nvml_devices, 0, sizeof(nvml_devices));
+    gpu_atomic_store_release(&nvml_initialized, 0);
+    gpu_mutex_unlock(&nvml_load_lock);
 }
\ No newline at end of file
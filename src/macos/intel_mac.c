@@ -46,7 +46,7 @@ gpu_error_t intel_macos_get_gpu_count(int32_t* count) {
     return GPU_SUCCESS;
 }
 
-gpu_error_t intel_macos_get_gpu_info(int32_t index, gpu_info_t* info) {
+gpu_error_t intel_macos_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
     if (!info) return GPU_ERROR_INVALID_PARAM;
     
     int current_index = 0;
@@ -81,24 +81,28 @@ gpu_error_t intel_macos_get_gpu_info(int32_t index, gpu_info_t* info) {
                     info->vendor = GPU_VENDOR_INTEL;
                     
                     // Get model name
-                    CFTypeRef model = IORegistryEntryCreateCFProperty(service, CFSTR("model"),
-                                                                        kCFAllocatorDefault, 0);
-                    if (model && CFGetTypeID(model) == CFDataGetTypeID()) {
-                        const char* modelStr = (const char*)CFDataGetBytePtr(model);
-                        snprintf(info->name, sizeof(info->name), "%s", modelStr);
-                        CFRelease(model);
-                    } else {
-                        snprintf(info->name, sizeof(info->name), "Intel GPU %d", index);
+                    if (fields & GPU_FIELD_NAME) {
+                        CFTypeRef model = IORegistryEntryCreateCFProperty(service, CFSTR("model"),
+                                                                            kCFAllocatorDefault, 0);
+                        if (model && CFGetTypeID(model) == CFDataGetTypeID()) {
+                            const char* modelStr = (const char*)CFDataGetBytePtr(model);
+                            snprintf(info->name, sizeof(info->name), "%s", modelStr);
+                            CFRelease(model);
+                        } else {
+                            snprintf(info->name, sizeof(info->name), "Intel GPU %d", index);
+                        }
                     }
                     
                     // Get device ID for UUID
-                    CFTypeRef deviceID = IORegistryEntryCreateCFProperty(service, CFSTR("device-id"),
-                                                                           kCFAllocatorDefault, 0);
-                    if (deviceID) {
-                        UInt32 devID = 0;
-                        CFDataGetBytes(deviceID, CFRangeMake(0, sizeof(UInt32)), (UInt8*)&devID);
-                        snprintf(info->uuid, sizeof(info->uuid), "INTEL-macOS-0x%04X", devID);
-                        CFRelease(deviceID);
+                    if (fields & GPU_FIELD_UUID) {
+                        CFTypeRef deviceID = IORegistryEntryCreateCFProperty(service, CFSTR("device-id"),
+                                                                               kCFAllocatorDefault, 0);
+                        if (deviceID) {
+                            UInt32 devID = 0;
+                            CFDataGetBytes(deviceID, CFRangeMake(0, sizeof(UInt32)), (UInt8*)&devID);
+                            snprintf(info->uuid, sizeof(info->uuid), "INTEL-macOS-0x%04X", devID);
+                            CFRelease(deviceID);
+                        }
                     }
                     
                     snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
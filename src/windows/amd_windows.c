@@ -42,7 +42,7 @@ typedef struct {
 } dxgi_adapter_info_t;
 
 // Forward declarations
-static gpu_error_t detect_amd_gpus_adlx(int32_t* count, gpu_info_t* info, int32_t index);
+static gpu_error_t detect_amd_gpus_adlx(int32_t* count, gpu_info_t* info, int32_t index, gpu_field_mask_t fields);
 static gpu_error_t detect_amd_gpus_dxgi(int32_t* count, gpu_info_t* info, int32_t index);
 static gpu_error_t get_placeholder_info(int32_t index, gpu_info_t* info);
 static gpu_error_t load_adlx(void);
@@ -179,7 +179,7 @@ static detect_method_t select_detection_method(void) {
 }
 
 // ADLX implementation
-static gpu_error_t detect_amd_gpus_adlx(int32_t* count, gpu_info_t* info, int32_t index) {
+static gpu_error_t detect_amd_gpus_adlx(int32_t* count, gpu_info_t* info, int32_t index, gpu_field_mask_t fields) {
     gpu_error_t result = load_adlx();
     if (result != GPU_SUCCESS) {
         if (count) *count = 0;
@@ -209,44 +209,50 @@ static gpu_error_t detect_amd_gpus_adlx(int32_t* count, gpu_info_t* info, int32_
         info->vendor = GPU_VENDOR_AMD;
         
         // Get GPU name
-        const char* name = NULL;
-        res = gpu->pVtbl->Name(gpu, &name);
-        if (res == ADLX_OK && name != NULL) {
-            strncpy(info->name, name, sizeof(info->name) - 1);
-            info->name[sizeof(info->name) - 1] = '\0';
-        } else {
-            strncpy(info->name, "AMD GPU", sizeof(info->name) - 1);
+        if (fields & GPU_FIELD_NAME) {
+            const char* name = NULL;
+            res = gpu->pVtbl->Name(gpu, &name);
+            if (res == ADLX_OK && name != NULL) {
+                strncpy(info->name, name, sizeof(info->name) - 1);
+                info->name[sizeof(info->name) - 1] = '\0';
+            } else {
+                strncpy(info->name, "AMD GPU", sizeof(info->name) - 1);
+            }
         }
         
         // Get GPU vendor ID and device ID for UUID generation
-        const char* vendorId = NULL, *deviceId = NULL, *revisionId = NULL, *subSystemId = NULL;
-        res = gpu->pVtbl->VendorId(gpu, &vendorId);
-        if (res == ADLX_OK) {
-            gpu->pVtbl->DeviceId(gpu, &deviceId);
-            gpu->pVtbl->RevisionId(gpu, &revisionId);
-            gpu->pVtbl->SubSystemId(gpu, &subSystemId);
-            
-            // Generate UUID from device info
-            // Convert string IDs to integers for formatting
-            unsigned int vid = 0, did = 0, ssid = 0, rid = 0;
-            if (vendorId) sscanf(vendorId, "%x", &vid);
-            if (deviceId) sscanf(deviceId, "%x", &did);
-            if (subSystemId) sscanf(subSystemId, "%x", &ssid);
-            if (revisionId) sscanf(revisionId, "%x", &rid);
-            
-            snprintf(info->uuid, sizeof(info->uuid), "AMD-%04X-%04X-%04X-%04X", 
-                     vid, did, ssid, rid);
-            
-            // Generate PCI bus ID (simplified)
-            snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
-        } else {
-            strncpy(info->uuid, "AMD-ADLX-Unknown", sizeof(info->uuid) - 1);
-            snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
+        if (fields & (GPU_FIELD_UUID | GPU_FIELD_PCI_BUS_ID)) {
+            const char* vendorId = NULL, *deviceId = NULL, *revisionId = NULL, *subSystemId = NULL;
+            res = gpu->pVtbl->VendorId(gpu, &vendorId);
+            if (res == ADLX_OK) {
+                gpu->pVtbl->DeviceId(gpu, &deviceId);
+                gpu->pVtbl->RevisionId(gpu, &revisionId);
+                gpu->pVtbl->SubSystemId(gpu, &subSystemId);
+                
+                // Generate UUID from device info
+                // Convert string IDs to integers for formatting
+                unsigned int vid = 0, did = 0, ssid = 0, rid = 0;
+                if (vendorId) sscanf(vendorId, "%x", &vid);
+                if (deviceId) sscanf(deviceId, "%x", &did);
+                if (subSystemId) sscanf(subSystemId, "%x", &ssid);
+                if (revisionId) sscanf(revisionId, "%x", &rid);
+                
+                snprintf(info->uuid, sizeof(info->uuid), "AMD-%04X-%04X-%04X-%04X", 
+                         vid, did, ssid, rid);
+                
+                // Generate PCI bus ID (simplified)
+                snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
+            } else {
+                strncpy(info->uuid, "AMD-ADLX-Unknown", sizeof(info->uuid) - 1);
+                snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
+            }
         }
         
-        // Try to get performance monitoring services
+        // Try to get performance monitoring services (only needed for dynamic metrics)
         IADLXPerformanceMonitoringServices* perfServices = NULL;
-        res = adlx_system->pVtbl->GetPerformanceMonitoringServices(adlx_system, &perfServices);
+        res = (fields & GPU_FIELD_DYNAMIC)
+            ? adlx_system->pVtbl->GetPerformanceMonitoringServices(adlx_system, &perfServices)
+            : ADLX_FAIL;
         if (res == ADLX_OK && perfServices != NULL) {
             IADLXGPUMetricsSupport* metricsSupport = NULL;
             IADLXGPUMetrics* currentMetrics = NULL;
@@ -439,7 +445,7 @@ gpu_error_t amd_windows_get_gpu_count(int32_t* count) {
     
     switch (current_method) {
         case DETECT_METHOD_ADLX:
-            return detect_amd_gpus_adlx(count, NULL, -1);
+            return detect_amd_gpus_adlx(count, NULL, -1, 0);
         case DETECT_METHOD_DXGI:
             return detect_amd_gpus_dxgi(count, NULL, -1);
         case DETECT_METHOD_PLACEHOLDER:
@@ -449,7 +455,7 @@ gpu_error_t amd_windows_get_gpu_count(int32_t* count) {
     }
 }
 
-gpu_error_t amd_windows_get_gpu_info(int32_t index, gpu_info_t* info) {
+gpu_error_t amd_windows_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
     if (!info) return GPU_ERROR_INVALID_PARAM;
     
     if (current_method == DETECT_METHOD_NONE) {
@@ -458,7 +464,7 @@ gpu_error_t amd_windows_get_gpu_info(int32_t index, gpu_info_t* info) {
     
     switch (current_method) {
         case DETECT_METHOD_ADLX:
-            return detect_amd_gpus_adlx(NULL, info, index);
+            return detect_amd_gpus_adlx(NULL, info, index, fields);
         case DETECT_METHOD_DXGI:
             return detect_amd_gpus_dxgi(NULL, info, index);
         case DETECT_METHOD_PLACEHOLDER:
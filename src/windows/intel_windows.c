@@ -55,7 +55,7 @@ gpu_error_t intel_windows_get_gpu_count(int32_t* count) {
     return GPU_SUCCESS;
 }
 
-gpu_error_t intel_windows_get_gpu_info(int32_t index, gpu_info_t* info) {
+gpu_error_t intel_windows_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
     if (!info) return GPU_ERROR_INVALID_PARAM;
     
     HDEVINFO deviceInfoSet;
@@ -95,23 +95,27 @@ gpu_error_t intel_windows_get_gpu_info(int32_t index, gpu_info_t* info) {
                     // Found our Intel GPU
                     
                     // Get device name
-                    if (SetupDiGetDeviceRegistryPropertyA(deviceInfoSet, &deviceInfoData,
-                                                        SPDRP_DEVICEDESC, &dataType, 
-                                                        (PBYTE)deviceName, sizeof(deviceName), 
-                                                        &requiredSize)) {
-                        strncpy(info->name, deviceName, sizeof(info->name) - 1);
-                    } else {
-                        strncpy(info->name, "Intel Graphics", sizeof(info->name) - 1);
+                    if (fields & GPU_FIELD_NAME) {
+                        if (SetupDiGetDeviceRegistryPropertyA(deviceInfoSet, &deviceInfoData,
+                                                            SPDRP_DEVICEDESC, &dataType, 
+                                                            (PBYTE)deviceName, sizeof(deviceName), 
+                                                            &requiredSize)) {
+                            strncpy(info->name, deviceName, sizeof(info->name) - 1);
+                        } else {
+                            strncpy(info->name, "Intel Graphics", sizeof(info->name) - 1);
+                        }
                     }
                     
                     // Generate UUID from device instance ID
-                    CHAR instanceId[256] = {0};
-                    if (SetupDiGetDeviceInstanceIdA(deviceInfoSet, &deviceInfoData,
-                                                   instanceId, sizeof(instanceId), 
-                                                   &requiredSize) == TRUE) {
-                        snprintf(info->uuid, sizeof(info->uuid), "INTEL-%s", instanceId);
-                    } else {
-                        snprintf(info->uuid, sizeof(info->uuid), "INTEL-WIN-%d", index);
+                    if (fields & GPU_FIELD_UUID) {
+                        CHAR instanceId[256] = {0};
+                        if (SetupDiGetDeviceInstanceIdA(deviceInfoSet, &deviceInfoData,
+                                                       instanceId, sizeof(instanceId), 
+                                                       &requiredSize) == TRUE) {
+                            snprintf(info->uuid, sizeof(info->uuid), "INTEL-%s", instanceId);
+                        } else {
+                            snprintf(info->uuid, sizeof(info->uuid), "INTEL-WIN-%d", index);
+                        }
                     }
                     
                     // Generate PCI bus ID placeholder
@@ -102,7 +102,7 @@ gpu_error_t nvidia_windows_get_gpu_count(int32_t* count) {
     return GPU_SUCCESS;
 }
 
-gpu_error_t nvidia_windows_get_gpu_info(int32_t index, gpu_info_t* info) {
+gpu_error_t nvidia_windows_get_gpu_info(int32_t index, gpu_field_mask_t fields, gpu_info_t* info) {
     if (!info) return GPU_ERROR_INVALID_PARAM;
     
     gpu_error_t result = load_nvml_windows();
@@ -120,120 +120,141 @@ gpu_error_t nvidia_windows_get_gpu_info(int32_t index, gpu_info_t* info) {
     info->vendor = GPU_VENDOR_NVIDIA;
     
     // Get GPU name
-    char name[256];
-    if (nvmlDeviceGetName && nvmlDeviceGetName(device, name, sizeof(name)) == 0) {
-        strncpy(info->name, name, sizeof(info->name) - 1);
-    } else {
-        strncpy(info->name, "NVIDIA GPU", sizeof(info->name) - 1);
+    if (fields & GPU_FIELD_NAME) {
+        char name[256];
+        if (nvmlDeviceGetName && nvmlDeviceGetName(device, name, sizeof(name)) == 0) {
+            strncpy(info->name, name, sizeof(info->name) - 1);
+        } else {
+            strncpy(info->name, "NVIDIA GPU", sizeof(info->name) - 1);
+        }
     }
     
     // Get UUID
-    char uuid[64];
-    if (nvmlDeviceGetUUID && nvmlDeviceGetUUID(device, uuid, sizeof(uuid)) == 0) {
-        strncpy(info->uuid, uuid, sizeof(info->uuid) - 1);
-    } else {
-        snprintf(info->uuid, sizeof(info->uuid), "%d", index);
+    if (fields & GPU_FIELD_UUID) {
+        char uuid[64];
+        if (nvmlDeviceGetUUID && nvmlDeviceGetUUID(device, uuid, sizeof(uuid)) == 0) {
+            strncpy(info->uuid, uuid, sizeof(info->uuid) - 1);
+        } else {
+            snprintf(info->uuid, sizeof(info->uuid), "%d", index);
+        }
     }
     
     // Get PCI bus information
-    if (nvmlDeviceGetPciInfo) {
-        nvmlPciInfo_t pciInfo;
-        if (nvmlDeviceGetPciInfo(device, &pciInfo) == 0) {
-            // Use the actual PCI bus ID from NVML
-            strncpy(info->pci_bus_id, pciInfo.busId, sizeof(info->pci_bus_id) - 1);
-            
-            // Debug output to see all PCI information (optional)
-            /*printf("GPU %d PCI Info:\n", index);
-            printf("  Bus ID: %s\n", pciInfo.busId);
-            printf("  Domain: 0x%04X\n", pciInfo.domain);
-            printf("  Bus: 0x%02X\n", pciInfo.bus);
-            printf("  Device: 0x%02X\n", pciInfo.device);
-            printf("  Device ID: 0x%04X\n", pciInfo.pciDeviceId);
-            printf("  Subsystem ID: 0x%04X\n", pciInfo.pciSubSystemId);*/
+    if (fields & GPU_FIELD_PCI_BUS_ID) {
+        if (nvmlDeviceGetPciInfo) {
+            nvmlPciInfo_t pciInfo;
+            if (nvmlDeviceGetPciInfo(device, &pciInfo) == 0) {
+                // Use the actual PCI bus ID from NVML
+                strncpy(info->pci_bus_id, pciInfo.busId, sizeof(info->pci_bus_id) - 1);
+                
+                // Debug output to see all PCI information (optional)
+                /*printf("GPU %d PCI Info:\n", index);
+                printf("  Bus ID: %s\n", pciInfo.busId);
+                printf("  Domain: 0x%04X\n", pciInfo.domain);
+                printf("  Bus: 0x%02X\n", pciInfo.bus);
+                printf("  Device: 0x%02X\n", pciInfo.device);
+                printf("  Device ID: 0x%04X\n", pciInfo.pciDeviceId);
+                printf("  Subsystem ID: 0x%04X\n", pciInfo.pciSubSystemId);*/
+            } else {
+                // Fallback: generate from index
+                snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
+            }
         } else {
             // Fallback: generate from index
             snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
         }
-    } else {
-        // Fallback: generate from index
-        snprintf(info->pci_bus_id, sizeof(info->pci_bus_id), "PCI:%d", index);
     }
     
     // Get memory info
-    nvmlMemory_t memory;
-    if (nvmlDeviceGetMemoryInfo && nvmlDeviceGetMemoryInfo(device, &memory) == 0) {
-        info->memory_total = memory.total / (1024 * 1024); // Convert to MB
-        info->memory_used = memory.used / (1024 * 1024);
-        info->memory_free = memory.free / (1024 * 1024);
-        
-        // Calculate memory capacity utilization (for reference)
-        float capacity_utilization = 0.0f;
-        if (memory.total > 0) {
-            capacity_utilization = (float)memory.used / memory.total * 100.0f;
+    if (fields & (GPU_FIELD_MEMORY_TOTAL | GPU_FIELD_MEMORY_USED | GPU_FIELD_MEMORY_FREE)) {
+        nvmlMemory_t memory;
+        if (nvmlDeviceGetMemoryInfo && nvmlDeviceGetMemoryInfo(device, &memory) == 0) {
+            info->memory_total = memory.total / (1024 * 1024); // Convert to MB
+            info->memory_used = memory.used / (1024 * 1024);
+            info->memory_free = memory.free / (1024 * 1024);
+            
+            // Calculate memory capacity utilization (for reference)
+            float capacity_utilization = 0.0f;
+            if (memory.total > 0) {
+                capacity_utilization = (float)memory.used / memory.total * 100.0f;
+            }
+            
+            // Debug output (optional)
+            /*printf("GPU %d Memory: %llu/%llu MB (%.1f%% capacity)\n", 
+                   index, memory.used / (1024 * 1024), memory.total / (1024 * 1024),
+                   capacity_utilization);*/
+        } else {
+            // Fallback values
+            info->memory_total = 8 * 1024;
+            info->memory_used = 0;
+            info->memory_free = 8 * 1024;
         }
-        
-        // Debug output (optional)
-        /*printf("GPU %d Memory: %llu/%llu MB (%.1f%% capacity)\n", 
-               index, memory.used / (1024 * 1024), memory.total / (1024 * 1024),
-               capacity_utilization);*/
-    } else {
-        // Fallback values
-        info->memory_total = 8 * 1024;
-        info->memory_used = 0;
-        info->memory_free = 8 * 1024;
     }
     
     // Get utilization rates
-    nvmlUtilization_t utilization;
-    if (nvmlDeviceGetUtilizationRates && nvmlDeviceGetUtilizationRates(device, &utilization) == 0) {
-        info->gpu_utilization = (float)utilization.gpu;
-        info->memory_utilization = (float)utilization.memory; // Memory bandwidth utilization
-        
-        // Debug output (optional)
-        /*printf("GPU %d Utilization: GPU=%u%%, Memory=%u%%\n", 
-               index, utilization.gpu, utilization.memory);*/
-    } else {
-        info->gpu_utilization = 0.0f;
-        info->memory_utilization = 0.0f;
+    if (fields & (GPU_FIELD_GPU_UTILIZATION | GPU_FIELD_MEMORY_UTILIZATION)) {
+        nvmlUtilization_t utilization;
+        if (nvmlDeviceGetUtilizationRates && nvmlDeviceGetUtilizationRates(device, &utilization) == 0) {
+            info->gpu_utilization = (float)utilization.gpu;
+            info->memory_utilization = (float)utilization.memory; // Memory bandwidth utilization
+            
+            // Debug output (optional)
+            /*printf("GPU %d Utilization: GPU=%u%%, Memory=%u%%\n", 
+                   index, utilization.gpu, utilization.memory);*/
+        } else {
+            info->gpu_utilization = 0.0f;
+            info->memory_utilization = 0.0f;
+        }
     }
     
     // Get temperature (GPU core)
-    unsigned int temperature;
-    if (nvmlDeviceGetTemperature && nvmlDeviceGetTemperature(device, 0, &temperature) == 0) {
-        info->temperature = (float)temperature;
-    } else {
-        info->temperature = 0.0f;
+    if (fields & GPU_FIELD_TEMPERATURE) {
+        unsigned int temperature;
+        if (nvmlDeviceGetTemperature && nvmlDeviceGetTemperature(device, 0, &temperature) == 0) {
+            info->temperature = (float)temperature;
+        } else {
+            info->temperature = 0.0f;
+        }
     }
     
     // Get power usage (in milliwatts)
-    unsigned int power;
-    if (nvmlDeviceGetPowerUsage && nvmlDeviceGetPowerUsage(device, &power) == 0) {
-        info->power_usage = (float)power / 1000.0f; // Convert to watts
-    } else {
-        info->power_usage = 0.0f;
+    if (fields & GPU_FIELD_POWER_USAGE) {
+        unsigned int power;
+        if (nvmlDeviceGetPowerUsage && nvmlDeviceGetPowerUsage(device, &power) == 0) {
+            info->power_usage = (float)power / 1000.0f; // Convert to watts
+        } else {
+            info->power_usage = 0.0f;
+        }
     }
     
     // Get core clock (graphics clock)
-    unsigned int clock;
-    if (nvmlDeviceGetClockInfo && nvmlDeviceGetClockInfo(device, 0, &clock) == 0) {
-        info->core_clock = clock;
-    } else {
-        info->core_clock = 0;
+    if (fields & GPU_FIELD_CORE_CLOCK) {
+        unsigned int clock;
+        if (nvmlDeviceGetClockInfo && nvmlDeviceGetClockInfo(device, 0, &clock) == 0) {
+            info->core_clock = clock;
+        } else {
+            info->core_clock = 0;
+        }
     }
     
     // Get memory clock
-    if (nvmlDeviceGetClockInfo && nvmlDeviceGetClockInfo(device, 1, &clock) == 0) {
-        info->memory_clock = clock;
-    } else {
-        info->memory_clock = 0;
+    if (fields & GPU_FIELD_MEMORY_CLOCK) {
+        unsigned int clock;
+        if (nvmlDeviceGetClockInfo && nvmlDeviceGetClockInfo(device, 1, &clock) == 0) {
+            info->memory_clock = clock;
+        } else {
+            info->memory_clock = 0;
+        }
     }
     
     // Get fan speed
-    unsigned int fan_speed;
-    if (nvmlDeviceGetFanSpeed && nvmlDeviceGetFanSpeed(device, &fan_speed) == 0) {
-        info->fan_speed = (float)fan_speed;
-    } else {
-        info->fan_speed = 0.0f;
+    if (fields & GPU_FIELD_FAN_SPEED) {
+        unsigned int fan_speed;
+        if (nvmlDeviceGetFanSpeed && nvmlDeviceGetFanSpeed(device, &fan_speed) == 0) {
+            info->fan_speed = (float)fan_speed;
+        } else {
+            info->fan_speed = 0.0f;
+        }
     }
     
     return GPU_SUCCESS;
@@ -0,0 +1,80 @@
+/**
+ * Event-loop lag while scraping every GPU, getAllGpuInfo() versus
+ * getAllGpuInfoAsync(), against the stub NVML with injected latency on every
+ * driver call (STUB_NVML_LATENCY_US, 2000 by default).
+ *
+ * Run with: npm run bench:event-loop (after npm run build)
+ *
+ * The synchronous scrape blocks the loop for its whole duration; the
+ * asynchronous one must not. Fails if the worst lag seen during the
+ * asynchronous scrapes reaches half the mean synchronous scrape time.
+ */
+
+const { monitorEventLoopDelay, performance } = require('perf_hooks');
+
+// Read by the stub when the addon loads it
+process.env.STUB_NVML_LATENCY_US = process.env.STUB_NVML_LATENCY_US || '2000';
+
+let gpu;
+try {
+    gpu = require('../../index');
+} catch (err) {
+    console.log('skipped: the native addon is not built (npm run build)');
+    process.exit(0);
+}
+
+const ROUNDS = 20;
+
+function yieldToLoop() {
+    return new Promise((resolve) => setImmediate(resolve));
+}
+
+async function measure(label, scrape) {
+    const histogram = monitorEventLoopDelay({ resolution: 1 });
+    // Keeps a timer due at all times, so a blocked loop shows up as lag
+    const ticker = setInterval(() => {}, 1);
+    histogram.enable();
+
+    let total = 0;
+    for (let round = 0; round < ROUNDS; round++) {
+        const start = performance.now();
+        await scrape();
+        total += performance.now() - start;
+        await yieldToLoop();
+    }
+
+    histogram.disable();
+    clearInterval(ticker);
+    const result = {
+        scrapeMs: total / ROUNDS,
+        p50Ms: histogram.percentile(50) / 1e6,
+        maxMs: histogram.max / 1e6,
+    };
+    console.log(`${label.padEnd(20)} ${result.scrapeMs.toFixed(1).padStart(10)} ` +
+                `${result.p50Ms.toFixed(1).padStart(10)} ${result.maxMs.toFixed(1).padStart(10)}`);
+    return result;
+}
+
+async function main() {
+    const count = gpu.getGpuCount();
+    if (count === 0) {
+        console.log('skipped: no GPU found; is the stub NVML on LD_LIBRARY_PATH?');
+        return;
+    }
+    console.log(`${count} GPUs, ${process.env.STUB_NVML_LATENCY_US} us per NVML call`);
+    console.log(`${'ms'.padEnd(20)} ${'scrape'.padStart(10)} ${'lag p50'.padStart(10)} ${'lag max'.padStart(10)}`);
+
+    gpu.getAllGpuInfo();
+    const sync = await measure('getAllGpuInfo', () => gpu.getAllGpuInfo());
+    const async = await measure('getAllGpuInfoAsync', () => gpu.getAllGpuInfoAsync());
+
+    if (async.maxMs >= sync.scrapeMs / 2) {
+        console.log(`FAILED: async scrapes lagged the loop by ${async.maxMs.toFixed(1)} ms`);
+        process.exit(1);
+    }
+}
+
+main().catch((err) => {
+    console.error(err);
+    process.exit(1);
+});
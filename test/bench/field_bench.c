@@ -0,0 +1,78 @@
+// Per-call cost of gpu_get_info_fields() for common field subsets, on a stub
+// NVIDIA GPU and a fixture amdgpu card: latency, NVML calls and sysfs reads.
+// Fails unless every subset makes fewer driver calls than a full query.
+
+#include "fs_calls.h"
+#include "common.h"
+
+#define CALLS 20000
+
+long stub_nvml_total_calls(void);
+void stub_nvml_reset_calls(void);
+
+typedef struct {
+    const char* label;
+    gpu_field_mask_t fields;
+} subset_t;
+
+static const subset_t subsets[] = {
+    { "all", GPU_FIELD_ALL },
+    { "utilization+memory", GPU_FIELD_GPU_UTILIZATION | GPU_FIELD_MEMORY_USED },
+    { "temperature+power", GPU_FIELD_TEMPERATURE | GPU_FIELD_POWER_USAGE },
+    { "clocks", GPU_FIELD_CORE_CLOCK | GPU_FIELD_MEMORY_CLOCK },
+    { "name", GPU_FIELD_NAME },
+};
+
+#define SUBSET_COUNT ((int)(sizeof(subsets) / sizeof(subsets[0])))
+
+// Driver calls per query: NVML calls for NVIDIA, sysfs reads for amdgpu
+static double bench(int32_t index, gpu_vendor_t vendor, const subset_t* subset) {
+    gpu_info_t info;
+    CHECK(gpu_get_info_fields(index, subset->fields, &info) == GPU_SUCCESS);
+    
+    fs_calls_reset();
+    stub_nvml_reset_calls();
+    double start = test_now_ms();
+    for (int c = 0; c < CALLS; c++) {
+        CHECK(gpu_get_info_fields(index, subset->fields, &info) == GPU_SUCCESS);
+    }
+    double elapsed = test_now_ms() - start;
+    fs_calls_t calls = fs_calls();
+    double driver = vendor == GPU_VENDOR_NVIDIA ? (double)stub_nvml_total_calls() / CALLS
+                                                : (double)fs_calls_total(calls) / CALLS;
+    printf("%-8s %-20s %10.2f %10.1f\n", vendor == GPU_VENDOR_NVIDIA ? "nvidia" : "amdgpu",
+           subset->label, elapsed * 1000.0 / CALLS, driver);
+    return driver;
+}
+
+int main(void) {
+    fixture_reset();
+    fixture_add_amd_card(0, 0x03);
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    
+    int32_t count = 0;
+    CHECK(gpu_get_count(&count) == GPU_SUCCESS);
+    int32_t devices[2] = { -1, -1 };
+    for (int32_t i = 0; i < count; i++) {
+        gpu_device_desc_t desc;
+        CHECK(gpu_get_desc(i, &desc) == GPU_SUCCESS);
+        if (desc.vendor == GPU_VENDOR_NVIDIA && devices[0] < 0) {
+            devices[0] = i;
+        } else if (desc.vendor == GPU_VENDOR_AMD && devices[1] < 0) {
+            devices[1] = i;
+        }
+    }
+    CHECK(devices[0] >= 0 && devices[1] >= 0);
+    
+    printf("%-8s %-20s %10s %10s\n", "", "fields", "us/call", "driver");
+    const gpu_vendor_t vendors[2] = { GPU_VENDOR_NVIDIA, GPU_VENDOR_AMD };
+    for (int v = 0; v < 2; v++) {
+        double all = bench(devices[v], vendors[v], &subsets[0]);
+        for (int s = 1; s < SUBSET_COUNT; s++) {
+            CHECK(bench(devices[v], vendors[v], &subsets[s]) < all);
+        }
+    }
+    
+    gpu_info_cleanup();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#ifndef GPU_BENCH_FS_CALLS_H
+#define GPU_BENCH_FS_CALLS_H
+
+// Counts the file system calls the core makes. The core is linked statically
+// into the benchmark, so these definitions take the place of libc's for it;
+// each forwards to the real function. Every counted call is at least one
+// system call (buffered FILE reads are counted once per fopen, not per read).
+// Include from exactly one file, before any other header.
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+typedef struct {
+    long opens;                 // open, fopen, opendir, access
+    long reads;                 // read, pread
+    long closes;                // close, fclose, closedir
+} fs_calls_t;
+
+static fs_calls_t fs_calls_counted;
+
+static inline void fs_calls_reset(void) {
+    memset(&fs_calls_counted, 0, sizeof(fs_calls_counted));
+}
+
+static inline fs_calls_t fs_calls(void) {
+    fs_calls_t calls;
+    calls.opens = __atomic_load_n(&fs_calls_counted.opens, __ATOMIC_RELAXED);
+    calls.reads = __atomic_load_n(&fs_calls_counted.reads, __ATOMIC_RELAXED);
+    calls.closes = __atomic_load_n(&fs_calls_counted.closes, __ATOMIC_RELAXED);
+    return calls;
+}
+
+static inline long fs_calls_total(fs_calls_t calls) {
+    return calls.opens + calls.reads + calls.closes;
+}
+
+#define FS_COUNT(counter) __atomic_fetch_add(&fs_calls_counted.counter, 1, __ATOMIC_RELAXED)
+#define FS_REAL(name, type) \
+    static type real; \
+    if (!real) { \
+        real = (type)dlsym(RTLD_NEXT, name); \
+    }
+
+typedef int (*fs_open_t)(const char*, int, ...);
+typedef FILE* (*fs_fopen_t)(const char*, const char*);
+typedef DIR* (*fs_opendir_t)(const char*);
+typedef int (*fs_access_t)(const char*, int);
+typedef ssize_t (*fs_read_t)(int, void*, size_t);
+typedef ssize_t (*fs_pread_t)(int, void*, size_t, off_t);
+typedef int (*fs_close_t)(int);
+typedef int (*fs_fclose_t)(FILE*);
+typedef int (*fs_closedir_t)(DIR*);
+
+int open(const char* path, int flags, ...) {
+    FS_REAL("open", fs_open_t);
+    mode_t mode = 0;
+    if (flags & (O_CREAT | O_TMPFILE)) {
+        va_list args;
+        va_start(args, flags);
+        mode = (mode_t)va_arg(args, int);
+        va_end(args);
+    }
+    FS_COUNT(opens);
+    return real(path, flags, mode);
+}
+
+FILE* fopen(const char* path, const char* mode) {
+    FS_REAL("fopen", fs_fopen_t);
+    FS_COUNT(opens);
+    return real(path, mode);
+}
+
+DIR* opendir(const char* path) {
+    FS_REAL("opendir", fs_opendir_t);
+    FS_COUNT(opens);
+    return real(path);
+}
+
+int access(const char* path, int mode) {
+    FS_REAL("access", fs_access_t);
+    FS_COUNT(opens);
+    return real(path, mode);
+}
+
+ssize_t read(int fd, void* buffer, size_t size) {
+    FS_REAL("read", fs_read_t);
+    FS_COUNT(reads);
+    return real(fd, buffer, size);
+}
+
+ssize_t pread(int fd, void* buffer, size_t size, off_t offset) {
+    FS_REAL("pread", fs_pread_t);
+    FS_COUNT(reads);
+    return real(fd, buffer, size, offset);
+}
+
+int close(int fd) {
+    FS_REAL("close", fs_close_t);
+    FS_COUNT(closes);
+    return real(fd);
+}
+
+int fclose(FILE* file) {
+    FS_REAL("fclose", fs_fclose_t);
+    FS_COUNT(closes);
+    return real(file);
+}
+
+int closedir(DIR* dir) {
+    FS_REAL("closedir", fs_closedir_t);
+    FS_COUNT(closes);
+    return real(dir);
+}
+
+#undef FS_COUNT
+#undef FS_REAL
+
+#endif // GPU_BENCH_FS_CALLS_H
@@ -0,0 +1,78 @@
+// Wall time to collect every GPU against GPU count, serially (gpu_get_info
+// per index) and fanned out over the worker pool (gpu_collect_info), with
+// STUB_NVML_LATENCY_US of latency on every NVML call (1000 by default) and
+// STUB_NVML_COUNT stub GPUs (16 by default). Also reports the spread of the
+// per-device collection timestamps. Fails unless the pool collects all GPUs
+// at least three times faster than the serial loop.
+
+#include "common.h"
+#include "gpu_pool.h"
+#include <unistd.h>
+
+#define ROUNDS 5
+
+void stub_nvml_set_latency_us(unsigned int latency_us);
+
+int main(int argc, char** argv) {
+    (void)argc;
+    // The stub reads its device count when it is loaded
+    if (!getenv("STUB_NVML_COUNT")) {
+        setenv("STUB_NVML_COUNT", "16", 1);
+        execv("/proc/self/exe", argv);
+        return 1;
+    }
+    
+    fixture_reset();
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    int32_t count = 0;
+    CHECK(gpu_get_count(&count) == GPU_SUCCESS && count > 0);
+    
+    static gpu_info_t infos[GPU_MAX_DEVICES];
+    static gpu_error_t results[GPU_MAX_DEVICES];
+    static int64_t timestamps[GPU_MAX_DEVICES];
+    int32_t collected = 0;
+    CHECK(gpu_collect_info(GPU_FIELD_ALL, infos, results, timestamps, count, &collected) == GPU_SUCCESS);
+    
+    const char* latency = getenv("STUB_NVML_LATENCY_US");
+    stub_nvml_set_latency_us(latency ? (unsigned int)atoi(latency) : 1000);
+    printf("%d pool threads, %s us per NVML call\n", GPU_POOL_THREADS + 1, latency ? latency : "1000");
+    printf("%5s %12s %12s %8s %10s\n", "gpus", "serial ms", "parallel ms", "speedup", "skew ms");
+    
+    double serial = 0.0;
+    double parallel = 0.0;
+    // 1, 2, 4, ... GPUs, ending with all of them
+    for (int32_t gpus = 1; gpus > 0; gpus = gpus == count ? 0 : (gpus * 2 < count ? gpus * 2 : count)) {
+        double start = test_now_ms();
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int32_t i = 0; i < gpus; i++) {
+                CHECK(gpu_get_info(i, &infos[i]) == GPU_SUCCESS);
+            }
+        }
+        serial = (test_now_ms() - start) / ROUNDS;
+        
+        int64_t skew = 0;
+        start = test_now_ms();
+        for (int r = 0; r < ROUNDS; r++) {
+            CHECK(gpu_collect_info(GPU_FIELD_ALL, infos, results, timestamps, gpus, &collected) == GPU_SUCCESS);
+            CHECK(collected == gpus);
+            int64_t first = timestamps[0];
+            int64_t last = timestamps[0];
+            for (int32_t i = 0; i < gpus; i++) {
+                CHECK(results[i] == GPU_SUCCESS);
+                first = timestamps[i] < first ? timestamps[i] : first;
+                last = timestamps[i] > last ? timestamps[i] : last;
+            }
+            skew = last - first > skew ? last - first : skew;
+        }
+        parallel = (test_now_ms() - start) / ROUNDS;
+        printf("%5d %12.2f %12.2f %8.1f %10lld\n", gpus, serial, parallel, serial / parallel,
+               (long long)skew);
+    }
+    
+    if (count >= 4) {
+        CHECK(parallel * 3.0 < serial);
+    }
+    stub_nvml_set_latency_us(0);
+    gpu_info_cleanup();
+    return 0;
+}
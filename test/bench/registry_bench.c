@@ -0,0 +1,70 @@
+// Cost of a full scrape (gpu_get_count, then gpu_get_info for every index) as
+// the number of GPUs grows: the four stub NVIDIA GPUs plus 1 to 32 fixture
+// amdgpu cards. With the device registry a scrape neither enumerates devices
+// nor reopens sysfs files, so the file system calls per amdgpu card and the
+// NVML calls per scrape stay the same at every size. Fails if they do not.
+
+#include "fs_calls.h"
+#include "common.h"
+
+#define SCRAPES 20
+#define MAX_CARDS 32
+
+long stub_nvml_total_calls(void);
+void stub_nvml_reset_calls(void);
+
+static int32_t scrape(void) {
+    int32_t count = 0;
+    CHECK(gpu_get_count(&count) == GPU_SUCCESS);
+    for (int32_t i = 0; i < count; i++) {
+        gpu_info_t info;
+        CHECK(gpu_get_info(i, &info) == GPU_SUCCESS);
+    }
+    return count;
+}
+
+int main(void) {
+    fixture_reset();
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    
+    printf("%5s %10s %14s %12s %12s %12s\n", "gpus", "fs/scrape", "fs/amdgpu", "opens", "nvml/scrape",
+           "us/scrape");
+    long nvml_per_scrape = -1;
+    long fs_per_card = -1;
+    int cards = 0;
+    for (int size = 1; size <= MAX_CARDS; size *= 2) {
+        while (cards < size) {
+            fixture_add_amd_card(cards, 0x10 + cards);
+            cards++;
+        }
+        CHECK(gpu_refresh() == GPU_SUCCESS);
+        int32_t count = scrape();       // Opens the new cards' attributes
+        CHECK(count == 4 + cards);
+        
+        fs_calls_reset();
+        stub_nvml_reset_calls();
+        double start = test_now_ms();
+        for (int s = 0; s < SCRAPES; s++) {
+            scrape();
+        }
+        double elapsed = test_now_ms() - start;
+        fs_calls_t calls = fs_calls();
+        long nvml = stub_nvml_total_calls();
+        
+        long fs = fs_calls_total(calls) / SCRAPES;
+        printf("%5d %10ld %14.1f %12ld %12ld %12.1f\n", count, fs, (double)fs / cards,
+               calls.opens / SCRAPES, nvml / SCRAPES, elapsed * 1000.0 / SCRAPES);
+        
+        CHECK(calls.opens == 0);
+        CHECK(fs_calls_total(calls) % ((long)SCRAPES * cards) == 0);
+        if (fs_per_card < 0) {
+            fs_per_card = fs / cards;
+            nvml_per_scrape = nvml / SCRAPES;
+        }
+        CHECK(fs == fs_per_card * cards);
+        CHECK(nvml == nvml_per_scrape * SCRAPES);
+    }
+    
+    gpu_info_cleanup();
+    return 0;
+}
@@ -0,0 +1,124 @@
+// File system calls per amdgpu sample against the fixture sysfs tree, for a
+// card with only the individual sysfs attributes and for one that also
+// exposes device/gpu_metrics (test/fixtures/gpu_metrics/v1_3.bin). The first
+// sample after enumeration opens each attribute once; later ones only pread()
+// the open descriptors, where the backend used to fopen, read and fclose
+// every attribute on every call. On the gpu_metrics card one read of the
+// table replaces the utilization, temperature, power and clock files. Fails
+// if a steady-state sample or gpu_get_info() opens or closes anything, or if
+// the gpu_metrics card needs as many reads as the other.
+
+#include "fs_calls.h"
+#include "common.h"
+
+#define SAMPLES 10000
+
+typedef struct {
+    const char* label;
+    int card;                   // fixture card number
+    const char* table;          // NULL for a card without gpu_metrics
+    int32_t index;
+    fs_calls_t sample;          // SAMPLES calls of gpu_sample()
+    double sample_us;
+    fs_calls_t info;            // SAMPLES calls of gpu_get_info()
+    double info_us;
+} bench_card_t;
+
+static bench_card_t cards[] = {
+    { "sysfs", 0, NULL, -1, { 0, 0, 0 }, 0, { 0, 0, 0 }, 0 },
+    { "gpu_metrics", 1, "v1_3.bin", -1, { 0, 0, 0 }, 0, { 0, 0, 0 }, 0 },
+};
+
+#define CARD_COUNT ((int)(sizeof(cards) / sizeof(cards[0])))
+
+static void report(const char* card, const char* label, fs_calls_t calls, long samples,
+                   double elapsed_ms) {
+    printf("%-12s %-14s %8.1f %8.1f %8.1f %10.2f\n", card, label, (double)calls.opens / samples,
+           (double)calls.reads / samples, (double)calls.closes / samples,
+           elapsed_ms * 1000.0 / samples);
+}
+
+static void bench_card(bench_card_t* bench) {
+    gpu_sample_t sample;
+    fs_calls_reset();
+    double start = test_now_ms();
+    CHECK(gpu_sample(bench->index, &sample) == GPU_SUCCESS);
+    report(bench->label, "first sample", fs_calls(), 1, test_now_ms() - start);
+    
+    fs_calls_reset();
+    start = test_now_ms();
+    for (int s = 0; s < SAMPLES; s++) {
+        CHECK(gpu_sample(bench->index, &sample) == GPU_SUCCESS);
+    }
+    double elapsed = test_now_ms() - start;
+    bench->sample = fs_calls();
+    bench->sample_us = elapsed * 1000.0 / SAMPLES;
+    report(bench->label, "sample", bench->sample, SAMPLES, elapsed);
+    CHECK(sample.temperature > 0);
+    CHECK(bench->sample.opens == 0 && bench->sample.closes == 0);
+    CHECK(bench->sample.reads > 0 && bench->sample.reads % SAMPLES == 0);
+    
+    gpu_info_t info;
+    fs_calls_reset();
+    start = test_now_ms();
+    for (int s = 0; s < SAMPLES; s++) {
+        CHECK(gpu_get_info(bench->index, &info) == GPU_SUCCESS);
+    }
+    elapsed = test_now_ms() - start;
+    bench->info = fs_calls();
+    bench->info_us = elapsed * 1000.0 / SAMPLES;
+    report(bench->label, "gpu_get_info", bench->info, SAMPLES, elapsed);
+    CHECK(bench->info.opens == 0 && bench->info.closes == 0);
+}
+
+int main(void) {
+    fixture_reset();
+    for (int c = 0; c < CARD_COUNT; c++) {
+        const char* device = fixture_add_amd_card(cards[c].card, 0x03 + c);
+        if (cards[c].table) {
+            test_run("cp '%s/fixtures/gpu_metrics/%s' '%s/gpu_metrics'", TEST_SOURCE_DIR,
+                     cards[c].table, device);
+        }
+    }
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    
+    printf("%-12s %-14s %8s %8s %8s %10s\n", "card", "per call", "opens", "reads", "closes", "us");
+    
+    fs_calls_reset();
+    double start = test_now_ms();
+    int32_t count = 0;
+    CHECK(gpu_get_count(&count) == GPU_SUCCESS);
+    report("all", "enumeration", fs_calls(), 1, test_now_ms() - start);
+    
+    // Cards are named after their fixture card number
+    for (int32_t i = 0; i < count; i++) {
+        gpu_device_desc_t desc;
+        CHECK(gpu_get_desc(i, &desc) == GPU_SUCCESS);
+        const char* number = strchr(desc.name, '#');
+        if (desc.vendor == GPU_VENDOR_AMD && number) {
+            cards[atoi(number + 1)].index = i;
+        }
+    }
+    for (int c = 0; c < CARD_COUNT; c++) {
+        CHECK(cards[c].index >= 0);
+        bench_card(&cards[c]);
+    }
+    
+    // Reopening every attribute on each call would cost an open, a read and a
+    // close per attribute read
+    const bench_card_t* sysfs = &cards[0];
+    const bench_card_t* metrics = &cards[1];
+    double sysfs_reads = (double)sysfs->sample.reads / SAMPLES;
+    double metrics_reads = (double)metrics->sample.reads / SAMPLES;
+    printf("sample: %.0f calls instead of %.0f\n", sysfs_reads, 3 * sysfs_reads);
+    printf("sample: gpu_metrics %.0f reads in %.2f us, sysfs %.0f reads in %.2f us\n",
+           metrics_reads, metrics->sample_us, sysfs_reads, sysfs->sample_us);
+    printf("gpu_get_info: gpu_metrics %.0f reads in %.2f us, sysfs %.0f reads in %.2f us\n",
+           (double)metrics->info.reads / SAMPLES, metrics->info_us,
+           (double)sysfs->info.reads / SAMPLES, sysfs->info_us);
+    CHECK(metrics->sample.reads < sysfs->sample.reads);
+    CHECK(metrics->info.reads < sysfs->info.reads);
+    
+    gpu_info_cleanup();
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Collector server flow control: a client that pipelines requests without
+// reading the replies is stopped from sending (its requests stay in its
+// socket) instead of having replies queued for it without bound, and every
+// request is still answered, in order, once it reads.
+
+#include "common.h"
+#include "gpu_collector.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define FLOOD_LIMIT 200000
+
+static void send_frame(int fd, uint16_t type, const uint32_t* values, uint32_t count) {
+    uint8_t frame[8 + 16];
+    uint32_t length = count * 4;
+    uint16_t reserved = 0;
+    memcpy(frame, &length, 4);
+    memcpy(frame + 4, &type, 2);
+    memcpy(frame + 6, &reserved, 2);
+    memcpy(frame + 8, values, length);
+    CHECK(send(fd, frame, 8 + length, MSG_NOSIGNAL) == (ssize_t)(8 + length));
+}
+
+static void recv_exact(int fd, void* data, size_t length) {
+    size_t received = 0;
+    while (received < length) {
+        ssize_t n = recv(fd, (char*)data + received, length - received, 0);
+        CHECK(n > 0);
+        received += (size_t)n;
+    }
+}
+
+// Returns the frame type; the first payload word goes to *id
+static uint16_t recv_frame(int fd, uint32_t* id) {
+    static uint8_t payload[1 << 20];
+    uint8_t header[8];
+    uint32_t length;
+    uint16_t type;
+    recv_exact(fd, header, sizeof(header));
+    memcpy(&length, header, 4);
+    memcpy(&type, header + 4, 2);
+    CHECK(length >= 4 && length <= sizeof(payload));
+    recv_exact(fd, payload, length);
+    memcpy(id, payload, 4);
+    return type;
+}
+
+int main(void) {
+    fixture_reset();
+    
+    struct sockaddr_un address;
+    char path[sizeof(address.sun_path)];
+    snprintf(path, sizeof(path), "%s/collector.sock", TEST_FIXTURE_DIR);
+    gpu_collector_server_t* server = NULL;
+    CHECK(gpu_collector_server_start(path, &server) == GPU_SUCCESS);
+    
+    // Raw connection: HELLO, then GETs without reading anything back
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    CHECK(fd >= 0);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path, sizeof(path));
+    CHECK(connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0);
+    
+    uint32_t hello[2] = { GPU_COLLECTOR_MAGIC, GPU_COLLECTOR_VERSION };
+    send_frame(fd, 1, hello, 2);
+    uint32_t magic = 0;
+    CHECK(recv_frame(fd, &magic) == 0x81);
+    CHECK(magic == GPU_COLLECTOR_MAGIC);
+    
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    uint32_t sent = 0;
+    int stalls = 0;
+    while (sent < FLOOD_LIMIT && stalls < 20) {
+        uint8_t frame[16];
+        uint32_t length = 8;
+        uint16_t type = 2;
+        uint16_t reserved = 0;
+        uint32_t fields = GPU_FIELD_ALL;
+        memcpy(frame, &length, 4);
+        memcpy(frame + 4, &type, 2);
+        memcpy(frame + 6, &reserved, 2);
+        memcpy(frame + 8, &sent, 4);
+        memcpy(frame + 12, &fields, 4);
+        ssize_t n = send(fd, frame, sizeof(frame), MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            stalls++;
+            usleep(10000);
+            continue;
+        }
+        // Unix stream sockets take a whole small frame or nothing
+        CHECK(n == (ssize_t)sizeof(frame));
+        sent++;
+        stalls = 0;
+    }
+    fprintf(stderr, "server stopped reading after %u requests\n", sent);
+    CHECK(sent < FLOOD_LIMIT);
+    
+    // Every request is answered, in order, once the client reads
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    for (uint32_t expected = 0; expected < sent; expected++) {
+        uint32_t id = 0;
+        CHECK(recv_frame(fd, &id) == 0x82);
+        CHECK(id == expected);
+    }
+    close(fd);
+    
+    // The server still serves normal clients
+    gpu_collector_client_t* client = NULL;
+    CHECK(gpu_collector_connect(path, NULL, NULL, &client) == GPU_SUCCESS);
+    gpu_info_t infos[GPU_MAX_DEVICES];
+    gpu_error_t results[GPU_MAX_DEVICES];
+    int64_t timestamps[GPU_MAX_DEVICES];
+    int32_t count = 0;
+    CHECK(gpu_collector_get(client, GPU_FIELD_ALL, infos, results, timestamps, GPU_MAX_DEVICES,
+                            &count, 5000) == GPU_SUCCESS);
+    CHECK(count == 4);
+    CHECK(results[2] == GPU_SUCCESS && strcmp(infos[2].name, "Stub GPU 2") == 0);
+    gpu_collector_close(client);
+    gpu_collector_destroy(client);
+    
+    gpu_collector_server_stop(server);
+    printf("collector: %u pipelined requests answered under back-pressure\n", sent);
+    return 0;
+}
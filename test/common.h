@@ -0,0 +1,103 @@
+#ifndef GPU_TEST_COMMON_H
+#define GPU_TEST_COMMON_H
+
+// Shared helpers for the native tests and benchmarks (see run.sh): checks,
+// timing, and the fixture sysfs tree the amdgpu backend is compiled against.
+
+#include "gpu_info.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef TEST_FIXTURE_DIR
+#error "TEST_FIXTURE_DIR is set by test/run.sh"
+#endif
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance) do { \
+        double check_value_ = (double)(value); \
+        double check_expected_ = (double)(expected); \
+        if (check_value_ < check_expected_ - (tolerance) || check_value_ > check_expected_ + (tolerance)) { \
+            fprintf(stderr, "%s:%d: check failed: %s = %g, expected %g\n", __FILE__, __LINE__, \
+                    #value, check_value_, check_expected_); \
+            exit(1); \
+        } \
+    } while (0)
+
+static inline double test_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static inline void test_run(const char* format, ...) {
+    char command[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(command, sizeof(command), format, args);
+    va_end(args);
+    CHECK(system(command) == 0);
+}
+
+static inline void test_write(const char* path, const void* data, size_t size) {
+    FILE* f = fopen(path, "wb");
+    CHECK(f != NULL);
+    CHECK(fwrite(data, 1, size, f) == size);
+    fclose(f);
+}
+
+static inline void test_write_text(const char* path, const char* format, ...) {
+    char text[4096];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    test_write(path, text, (size_t)len);
+}
+
+// Empty TEST_FIXTURE_DIR/sys/class/drm
+static inline void fixture_reset(void) {
+    test_run("rm -rf '%s/sys' && mkdir -p '%s/sys/class/drm'", TEST_FIXTURE_DIR, TEST_FIXTURE_DIR);
+}
+
+// An amdgpu card with the usual sysfs and hwmon attributes at PCI address
+// 0000:<bus>:00.0; returns its device directory
+static inline const char* fixture_add_amd_card(int card, int bus) {
+    static char device[512];
+    char path[640];
+    snprintf(device, sizeof(device), "%s/sys/class/drm/card%d/device", TEST_FIXTURE_DIR, card);
+    test_run("mkdir -p '%s/hwmon/hwmon%d' '%s/sys/class/drm/card%d-DP-1'", device, card,
+             TEST_FIXTURE_DIR, card);
+
+#define FIXTURE_ATTR(name, ...) \
+    snprintf(path, sizeof(path), "%s/%s", device, name); \
+    test_write_text(path, __VA_ARGS__)
+    FIXTURE_ATTR("vendor", "0x1002\n");
+    FIXTURE_ATTR("device", "0x73bf\n");
+    FIXTURE_ATTR("product_name", "AMD Radeon RX 6800 #%d\n", card);
+    FIXTURE_ATTR("uevent", "DRIVER=amdgpu\nPCI_ID=1002:73BF\nPCI_SLOT_NAME=0000:%02x:00.0\n", bus);
+    FIXTURE_ATTR("mem_info_vram_total", "17163091968\n");
+    FIXTURE_ATTR("mem_info_vram_used", "1073741824\n");
+    FIXTURE_ATTR("gpu_busy_percent", "42\n");
+    FIXTURE_ATTR("pp_dpm_sclk", "0: 500Mhz\n1: 1800Mhz *\n2: 2100Mhz\n");
+    FIXTURE_ATTR("pp_dpm_mclk", "0: 96Mhz\n1: 1000Mhz *\n");
+#undef FIXTURE_ATTR
+
+    snprintf(path, sizeof(path), "%s/hwmon/hwmon%d/temp1_input", device, card);
+    test_write_text(path, "55000\n");
+    snprintf(path, sizeof(path), "%s/hwmon/hwmon%d/power1_average", device, card);
+    test_write_text(path, "120000000\n");
+    snprintf(path, sizeof(path), "%s/hwmon/hwmon%d/pwm1", device, card);
+    test_write_text(path, "128\n");
+    return device;
+}
+
+#endif // GPU_TEST_COMMON_H
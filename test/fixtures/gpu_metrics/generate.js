@@ -0,0 +1,48 @@
+// Regenerates the gpu_metrics fixture tables: node generate.js
+//
+// Each table has the 4-byte header (u16 structure_size, u8 format_revision,
+// u8 content_revision) and every other u16 slot filled with 1000 + its
+// offset, so a field read from a neighbouring slot yields a value the test
+// does not expect. The fields the backend decodes are then written at the
+// offsets of the kernel's struct gpu_metrics_vX_Y.
+const fs = require('fs');
+const path = require('path');
+
+function table(file, size, format, content, fields) {
+    const blob = Buffer.alloc(size);
+    for (let offset = 4; offset + 2 <= size; offset += 2) {
+        blob.writeUInt16LE(1000 + offset, offset);
+    }
+    blob.writeUInt16LE(size, 0);
+    blob.writeUInt8(format, 2);
+    blob.writeUInt8(content, 3);
+    for (const [offset, type, value] of fields) {
+        if (type === 'u32') {
+            blob.writeUInt32LE(value, offset);
+        } else {
+            blob.writeUInt16LE(value, offset);
+        }
+    }
+    fs.writeFileSync(path.join(__dirname, file), blob);
+}
+
+// dGPU, whole units: temperature_edge, average_gfx_activity,
+// average_socket_power, current_gfxclk, current_uclk
+table('v1_0.bin', 120, 1, 0, [[16, 'u16', 61], [28, 'u16', 77], [34, 'u16', 201],
+    [54, 'u16', 2450], [58, 'u16', 1250]]);
+// v1.1-v1.3 share the leading layout; current_uclk not populated (0xFFFF)
+table('v1_3.bin', 264, 1, 3, [[4, 'u16', 62], [16, 'u16', 78], [22, 'u16', 202],
+    [54, 'u16', 2451], [58, 'u16', 0xFFFF]]);
+// MI300 class: temperature_hotspot, curr_socket_power, average_gfx_activity
+table('v1_4.bin', 900, 1, 4, [[4, 'u16', 70], [10, 'u16', 550], [12, 'u16', 99]]);
+// APU, centi-degrees, centi-percent and mW
+table('v2_0.bin', 120, 2, 0, [[16, 'u16', 4000], [40, 'u16', 1000], [44, 'u16', 9000],
+    [80, 'u16', 1500], [84, 'u16', 700]]);
+table('v2_1.bin', 120, 2, 1, [[4, 'u16', 4550], [28, 'u16', 3300], [40, 'u16', 15000],
+    [76, 'u16', 1900], [80, 'u16', 800]]);
+// u32 average_socket_power; the u16 average_ipu_power at 116 pushes the
+// clocks to 174 (average_gfxclk_frequency) and 186 (average_uclk_frequency).
+// current_stapm_power_limit at 172 and average_vclk_frequency at 184 hold
+// values a misaligned read would return.
+table('v3_0.bin', 264, 3, 0, [[4, 'u16', 4800], [42, 'u16', 2500], [112, 'u32', 25000],
+    [172, 'u16', 3000], [174, 'u16', 2200], [184, 'u16', 1100], [186, 'u16', 900]]);
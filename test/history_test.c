@@ -0,0 +1,201 @@
+// History rollups: a resolution is only served from a tier whose bucket
+// divides it (15 s comes from the raw samples, not from 10 s buckets), tier
+// buckets come back at the right start times across gaps shorter than the
+// tier, and a gap longer than the tier restarts it without filling it.
+// An hour of steady 1 s telemetry on a second device stays under 2 bytes per
+// metric value and decodes back exactly.
+//
+// Built together with gpu_history.c to feed samples with chosen timestamps
+// through the sampler listener, without running the sampler.
+
+#include "common.h"
+#include "../src/gpu_history.c"
+
+#define MAX_SAMPLES 4096
+#define TEMPERATURE (GPU_COLUMN_TEMPERATURE - 1)
+
+static const int64_t start_ms = 1700000040000LL;   // On a 2 min boundary
+
+static int64_t fed_ms[MAX_SAMPLES];
+static double fed_value[MAX_SAMPLES];
+static int fed = 0;
+
+static void feed(int64_t timestamp_ms) {
+    gpu_sample_t sample;
+    bool valid = true;
+    memset(&sample, 0, sizeof(sample));
+    sample.timestamp_ms = timestamp_ms;
+    sample.temperature = (float)((fed * 7) % 90);
+    history_listener(&sample, &valid, 1, NULL);
+    
+    fed_ms[fed] = timestamp_ms;
+    fed_value[fed] = sample.temperature;
+    fed++;
+}
+
+static void feed_seconds(int64_t from_ms, int seconds) {
+    for (int s = 0; s < seconds; s++) {
+        feed(from_ms + (int64_t)s * 1000);
+    }
+}
+
+// Compare a rollup from from_ms (on a boundary of every tier) with buckets
+// merged from the fed samples
+static void check_rollup(int64_t from_ms, uint32_t resolution_ms, uint32_t expect_source) {
+    gpu_history_rollup_t* rollup = NULL;
+    CHECK(gpu_history_rollup_open(0, from_ms, INT64_MAX, resolution_ms, &rollup) == GPU_SUCCESS);
+    CHECK(gpu_history_rollup_source_ms(rollup) == expect_source);
+    
+    int i = 0;
+    while (i < fed && fed_ms[i] < from_ms) {
+        i++;
+    }
+    
+    gpu_history_bucket_t bucket;
+    while (gpu_history_rollup_next(rollup, &bucket)) {
+        CHECK(i < fed);
+        int64_t start = floor_to(fed_ms[i], resolution_ms);
+        uint64_t count = 0;
+        double min = 1e300, max = -1e300, sum = 0.0;
+        for (; i < fed && floor_to(fed_ms[i], resolution_ms) == start; i++) {
+            min = fed_value[i] < min ? fed_value[i] : min;
+            max = fed_value[i] > max ? fed_value[i] : max;
+            sum += fed_value[i];
+            count++;
+        }
+        CHECK(bucket.start_ms == start);
+        CHECK(bucket.count == count);
+        CHECK(bucket.min[TEMPERATURE] == min);
+        CHECK(bucket.max[TEMPERATURE] == max);
+        CHECK_NEAR(bucket.sum[TEMPERATURE], sum, 1e-6);
+    }
+    
+    // The bucket still open in the tiers is part of the rollup too
+    CHECK(i == fed);
+    gpu_history_rollup_close(rollup);
+}
+
+static void check_resolutions(int64_t from_ms) {
+    check_rollup(from_ms, 15000, 0);        // 10 s does not divide 15 s
+    check_rollup(from_ms, 30000, 10000);
+    check_rollup(from_ms, 90000, 10000);    // 1 min does not divide 90 s
+    check_rollup(from_ms, 120000, 60000);
+}
+
+#define STEADY_SECONDS 3600
+
+static gpu_sample_t steady[STEADY_SECONDS];
+
+// Slowly varying telemetry: whole numbers that step every few seconds to
+// minutes, as a busy GPU reports them
+static void make_steady_sample(int s, gpu_sample_t* sample) {
+    memset(sample, 0, sizeof(*sample));
+    sample->timestamp_ms = start_ms + (int64_t)s * 1000;
+    sample->index = 1;
+    sample->memory_used = 8192 + (uint64_t)(s / 600) * 256;
+    sample->memory_free = 24576 - sample->memory_used;
+    sample->gpu_utilization = (float)(90 + (s / 30) % 7);
+    sample->memory_utilization = (float)(40 + (s / 45) % 5);
+    sample->temperature = (float)(65 + (s / 120) % 6);
+    sample->power_usage = 250.0f + (float)((s / 5) % 8) * 0.5f;
+    sample->core_clock = (s / 300) % 2 ? 1905 : 1890;
+    sample->memory_clock = 9501;
+    sample->fan_speed = (float)(55 + (s / 180) % 4);
+}
+
+static void check_compression(void) {
+    gpu_sample_t samples[2];
+    bool valid[2] = { false, true };
+    for (int s = 0; s < STEADY_SECONDS; s++) {
+        make_steady_sample(s, &steady[s]);
+        samples[1] = steady[s];
+        history_listener(samples, valid, 2, NULL);
+    }
+    
+    gpu_history_stats_t stats;
+    CHECK(gpu_history_get_stats(1, &stats) == GPU_SUCCESS);
+    CHECK(stats.samples == STEADY_SECONDS);
+    double per_value = (double)stats.encoded_bytes / ((double)stats.samples * GPU_HISTORY_METRICS);
+    CHECK(per_value < 2.0);
+    CHECK(stats.blocks == 2);
+    
+    // A sub-range from inside the first block to inside the second
+    int from = 1000, to = 3500;
+    gpu_history_iter_t* iter = NULL;
+    CHECK(gpu_history_iter_open(1, steady[from].timestamp_ms, steady[to].timestamp_ms, &iter) ==
+          GPU_SUCCESS);
+    gpu_sample_t sample;
+    int s = from;
+    while (gpu_history_iter_next(iter, &sample)) {
+        CHECK(s <= to);
+        const gpu_sample_t* expect = &steady[s++];
+        CHECK(sample.timestamp_ms == expect->timestamp_ms);
+        CHECK(sample.memory_used == expect->memory_used);
+        CHECK(sample.memory_free == expect->memory_free);
+        CHECK(sample.gpu_utilization == expect->gpu_utilization);
+        CHECK(sample.memory_utilization == expect->memory_utilization);
+        CHECK(sample.temperature == expect->temperature);
+        CHECK(sample.power_usage == expect->power_usage);
+        CHECK(sample.core_clock == expect->core_clock);
+        CHECK(sample.memory_clock == expect->memory_clock);
+        CHECK(sample.fan_speed == expect->fan_speed);
+    }
+    CHECK(s == to + 1);
+    gpu_history_iter_close(iter);
+    
+    printf("history: %d steady samples in %llu bytes, %.2f bytes per value, %llu blocks\n",
+           STEADY_SECONDS, (unsigned long long)stats.encoded_bytes, per_value,
+           (unsigned long long)stats.blocks);
+}
+
+int main(void) {
+    const gpu_history_tier_t tiers[] = {
+        { 10000, 3600 * 1000 },             // 360 buckets
+        { 60000, 24 * 3600 * 1000 },        // 1440 buckets
+    };
+    CHECK(gpu_history_start(0, 0, tiers, 2) == GPU_SUCCESS);
+    
+    feed_seconds(start_ms, 600);
+    check_resolutions(start_ms);
+    
+    // 40 min without samples: both tiers keep their older buckets
+    feed_seconds(start_ms + 3000 * 1000, 300);
+    check_resolutions(start_ms);
+    const rollup_tier_t* fine = &g_devices[0].tiers[0];
+    CHECK(fine->first_start == start_ms);
+    CHECK(fine->count == (3000 + 290) / 10);
+    
+    // 20 min more: the empty buckets push the oldest ones out of the 10 s tier
+    feed_seconds(start_ms + 4500 * 1000, 60);
+    CHECK(fine->count == 360);
+    CHECK(fine->first_start == start_ms + (4550 - 3600) * 1000);
+    check_resolutions(start_ms + 1200 * 1000);
+    
+    // 2 h without samples: the 10 s tier starts over, the 1 min tier fills in
+    int64_t restart_ms = start_ms + 3 * 3600 * 1000;
+    feed_seconds(restart_ms, 300);
+    CHECK(fine->first_start == restart_ms);
+    CHECK(g_devices[0].tiers[1].first_start == start_ms);
+    check_rollup(start_ms, 15000, 0);
+    check_rollup(start_ms, 120000, 60000);
+    check_rollup(restart_ms, 30000, 10000);
+    check_rollup(restart_ms, 90000, 10000);
+    
+    // A year without samples restarts both tiers without touching their slots
+    uint32_t allocated[2] = { g_devices[0].tiers[0].allocated, g_devices[0].tiers[1].allocated };
+    int64_t year_ms = restart_ms + 365LL * 24 * 3600 * 1000;
+    double begin = test_now_ms();
+    feed(year_ms);
+    CHECK(test_now_ms() - begin < 50.0);
+    for (int t = 0; t < 2; t++) {
+        CHECK(g_devices[0].tiers[t].allocated == allocated[t]);
+        CHECK(g_devices[0].tiers[t].count == 0);
+        CHECK(g_devices[0].tiers[t].first_start == year_ms);
+    }
+    
+    check_compression();
+    
+    gpu_history_stop();
+    printf("history: %d samples, rollups match\n", fed);
+    return 0;
+}
@@ -0,0 +1,98 @@
+// NVIDIA field value batch against the stub NVML: power, memory temperature,
+// energy and PCIe replays come from one nvmlDeviceGetFieldValues call per
+// query. A field the driver rejects falls back to its single-call function
+// for that device, and a driver without the call falls back for every field,
+// which costs more calls per GPU for the same values.
+
+#include "common.h"
+
+long stub_nvml_calls(const char* function);
+long stub_nvml_total_calls(void);
+void stub_nvml_reset_calls(void);
+void stub_nvml_set_field_values(int supported);
+void stub_nvml_set_field_supported(unsigned int field_id, int supported);
+
+#define POLLS 10
+#define FI_POWER_INSTANT 186
+
+static int32_t gpus;
+
+// Poll every stub GPU for every field POLLS times and check what it reports;
+// returns the NVML calls made per GPU and query
+static long poll_all(bool memory_temperature) {
+    stub_nvml_reset_calls();
+    for (int poll = 0; poll < POLLS; poll++) {
+        for (int32_t i = 0; i < gpus; i++) {
+            gpu_info_t info;
+            CHECK(gpu_get_info(i, &info) == GPU_SUCCESS);
+            CHECK(info.power_usage == 100.0f + (float)i);
+            CHECK(info.energy_consumption == (uint64_t)(i + 1) * 1000000);
+            CHECK(info.pcie_replay_count == (uint64_t)i);
+            CHECK(info.memory_temperature == (memory_temperature ? 60.0f + (float)i : 0.0f));
+            CHECK(info.temperature == 40.0f + (float)i);
+        }
+    }
+    
+    long queries = (long)POLLS * gpus;
+    CHECK(stub_nvml_total_calls() % queries == 0);
+    return stub_nvml_total_calls() / queries;
+}
+
+// Drop the cached handles so each device starts over with the full batch
+static void reenumerate(void) {
+    CHECK(gpu_refresh() == GPU_SUCCESS);
+    gpu_info_t info;
+    for (int32_t i = 0; i < gpus; i++) {
+        CHECK(gpu_get_info(i, &info) == GPU_SUCCESS);
+    }
+}
+
+int main(void) {
+    fixture_reset();
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    CHECK(gpu_get_count(&gpus) == GPU_SUCCESS);
+    CHECK(gpus == 4);
+    reenumerate();
+    long queries = (long)POLLS * gpus;
+    
+    // Every batchable field in one call
+    long batched = poll_all(true);
+    CHECK(stub_nvml_calls("nvmlDeviceGetFieldValues") == queries);
+    CHECK(stub_nvml_calls("nvmlDeviceGetPowerUsage") == 0);
+    CHECK(stub_nvml_calls("nvmlDeviceGetTotalEnergyConsumption") == 0);
+    CHECK(stub_nvml_calls("nvmlDeviceGetPcieReplayCounter") == 0);
+    
+    // Fields that are not asked for stay out of the request
+    gpu_info_t info;
+    stub_nvml_reset_calls();
+    CHECK(gpu_get_info_fields(0, GPU_FIELD_TEMPERATURE, &info) == GPU_SUCCESS);
+    CHECK(stub_nvml_calls("nvmlDeviceGetFieldValues") == 0);
+    CHECK(stub_nvml_total_calls() == 1);
+    
+    // A rejected field is asked for once, then read on its own
+    stub_nvml_set_field_supported(FI_POWER_INSTANT, 0);
+    reenumerate();
+    long partial = poll_all(true);
+    CHECK(stub_nvml_calls("nvmlDeviceGetFieldValues") == queries);
+    CHECK(stub_nvml_calls("nvmlDeviceGetPowerUsage") == queries);
+    CHECK(stub_nvml_calls("nvmlDeviceGetTotalEnergyConsumption") == 0);
+    CHECK(partial == batched + 1);
+    stub_nvml_set_field_supported(FI_POWER_INSTANT, 1);
+    
+    // Without the call every field has its own, and memory temperature,
+    // which has no single-call function, is not reported
+    stub_nvml_set_field_values(0);
+    reenumerate();
+    long single = poll_all(false);
+    CHECK(stub_nvml_calls("nvmlDeviceGetFieldValues") == 0);
+    CHECK(stub_nvml_calls("nvmlDeviceGetPowerUsage") == queries);
+    CHECK(stub_nvml_calls("nvmlDeviceGetTotalEnergyConsumption") == queries);
+    CHECK(stub_nvml_calls("nvmlDeviceGetPcieReplayCounter") == queries);
+    CHECK(batched < single);
+    stub_nvml_set_field_values(1);
+    
+    gpu_info_cleanup();
+    printf("nvml_batch: %ld NVML calls per GPU batched, %ld with a rejected field, %ld without "
+           "the batch\n", batched, partial, single);
+    return 0;
+}
@@ -0,0 +1,102 @@
+// NVIDIA backend handle cache against the stub NVML: steady-state polls only
+// make the dynamic calls, and a GPU reported lost by any of them fails the
+// query with GPU_ERROR_NO_GPU and gets a freshly resolved handle afterwards.
+
+#include "common.h"
+
+long stub_nvml_calls(const char* function);
+void stub_nvml_reset_calls(void);
+void stub_nvml_set_lost(int index, int lost);
+
+#define POLLS 10
+
+typedef struct {
+    gpu_field_mask_t field;
+    const char* function;       // NVML call behind it
+} dynamic_field_t;
+
+static const dynamic_field_t dynamic_fields[] = {
+    { GPU_FIELD_MEMORY_USED, "nvmlDeviceGetMemoryInfo" },
+    { GPU_FIELD_GPU_UTILIZATION, "nvmlDeviceGetUtilizationRates" },
+    { GPU_FIELD_TEMPERATURE, "nvmlDeviceGetTemperature" },
+    { GPU_FIELD_POWER_USAGE, "nvmlDeviceGetFieldValues" },
+    { GPU_FIELD_CORE_CLOCK, "nvmlDeviceGetClockInfo" },
+    { GPU_FIELD_MEMORY_CLOCK, "nvmlDeviceGetClockInfo" },
+    { GPU_FIELD_FAN_SPEED, "nvmlDeviceGetFanSpeed" },
+    { GPU_FIELD_ENERGY | GPU_FIELD_PCIE_REPLAY_COUNT, "nvmlDeviceGetFieldValues" },
+};
+
+static void check_static_calls(long handle_calls) {
+    CHECK(stub_nvml_calls("nvmlDeviceGetHandleByIndex") == handle_calls);
+    CHECK(stub_nvml_calls("nvmlDeviceGetName") == handle_calls);
+    CHECK(stub_nvml_calls("nvmlDeviceGetUUID") == handle_calls);
+    CHECK(stub_nvml_calls("nvmlDeviceGetPciInfo") == handle_calls);
+}
+
+int main(void) {
+    fixture_reset();
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    
+    int32_t count = 0;
+    CHECK(gpu_get_count(&count) == GPU_SUCCESS);
+    CHECK(count == 4);
+    
+    // Warm every device's cache, then poll
+    gpu_info_t info;
+    for (int32_t i = 0; i < count; i++) {
+        CHECK(gpu_get_info(i, &info) == GPU_SUCCESS);
+    }
+    stub_nvml_reset_calls();
+    for (int poll = 0; poll < POLLS; poll++) {
+        for (int32_t i = 0; i < count; i++) {
+            char name[32];
+            snprintf(name, sizeof(name), "Stub GPU %d", (int)i);
+            CHECK(gpu_get_info(i, &info) == GPU_SUCCESS);
+            CHECK(strcmp(info.name, name) == 0);
+            CHECK(info.memory_used == (uint64_t)(i + 1) * 1024);
+        }
+    }
+    check_static_calls(0);
+    CHECK(stub_nvml_calls("nvmlDeviceGetMemoryInfo") == POLLS * count);
+    
+    // Power is the instantaneous reading, one call per query
+    stub_nvml_reset_calls();
+    CHECK(gpu_get_info_fields(0, GPU_FIELD_POWER_USAGE, &info) == GPU_SUCCESS);
+    CHECK(info.power_usage == 100.0f);
+    CHECK(stub_nvml_calls("nvmlDeviceGetFieldValues") == 1);
+    CHECK(stub_nvml_calls("nvmlDeviceGetPowerUsage") == 0);
+    
+    // A lost GPU surfaces from whichever call is the only one made
+    for (size_t f = 0; f < sizeof(dynamic_fields) / sizeof(dynamic_fields[0]); f++) {
+        const dynamic_field_t* dynamic = &dynamic_fields[f];
+        fprintf(stderr, "lost during %s\n", dynamic->function);
+        
+        CHECK(gpu_get_info_fields(1, dynamic->field, &info) == GPU_SUCCESS);
+        stub_nvml_set_lost(1, 1);
+        stub_nvml_reset_calls();
+        CHECK(gpu_get_info_fields(1, dynamic->field, &info) == GPU_ERROR_NO_GPU);
+        CHECK(stub_nvml_calls(dynamic->function) == 1);
+        
+        // Other devices keep answering while it is gone
+        CHECK(gpu_get_info_fields(0, dynamic->field, &info) == GPU_SUCCESS);
+        
+        // Once it is back the handle is resolved again, exactly once
+        stub_nvml_set_lost(1, 0);
+        stub_nvml_reset_calls();
+        CHECK(gpu_get_info_fields(1, dynamic->field, &info) == GPU_SUCCESS);
+        CHECK(gpu_get_info_fields(1, dynamic->field, &info) == GPU_SUCCESS);
+        CHECK(stub_nvml_calls("nvmlDeviceGetHandleByIndex") == 1);
+    }
+    
+    // A GPU lost before its handle is resolved is reported the same way
+    stub_nvml_set_lost(2, 1);
+    CHECK(gpu_refresh() == GPU_SUCCESS);
+    CHECK(gpu_get_info(2, &info) == GPU_ERROR_NO_GPU);
+    stub_nvml_set_lost(2, 0);
+    CHECK(gpu_get_info(2, &info) == GPU_SUCCESS);
+    CHECK(info.temperature == 42.0f);
+    
+    gpu_info_cleanup();
+    printf("nvml_cache: %d polls without static calls, lost GPU recovered\n", POLLS);
+    return 0;
+}
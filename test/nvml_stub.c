@@ -0,0 +1,274 @@
+// Stub libnvidia-ml.so for the native tests: STUB_NVML_COUNT devices
+// (default 4) with fixed telemetry, a call counter per entry point, optional
+// latency on every call (STUB_NVML_LATENCY_US), lost-GPU injection and
+// switches for drivers without nvmlDeviceGetFieldValues or without some of
+// its fields.
+// Tests link against it to reach the stub_nvml_* controls; the backend finds
+// the same library through dlopen("libnvidia-ml.so").
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NVML_SUCCESS 0
+#define NVML_ERROR_INVALID_ARGUMENT 2
+#define NVML_ERROR_NOT_SUPPORTED 3
+#define NVML_ERROR_GPU_IS_LOST 15
+#define STUB_MAX_DEVICES 128
+#define STUB_MAX_FIELD_ID 256
+
+typedef enum {
+    STUB_INIT, STUB_SHUTDOWN, STUB_GET_COUNT, STUB_GET_HANDLE, STUB_GET_NAME, STUB_GET_UUID,
+    STUB_GET_PCI_INFO, STUB_GET_MEMORY_INFO, STUB_GET_UTILIZATION, STUB_GET_TEMPERATURE,
+    STUB_GET_POWER, STUB_GET_CLOCK, STUB_GET_FAN, STUB_GET_ENERGY, STUB_GET_PCIE_REPLAY,
+    STUB_GET_FIELD_VALUES, STUB_FUNCTION_COUNT
+} stub_function_t;
+
+static const char* const stub_function_names[STUB_FUNCTION_COUNT] = {
+    "nvmlInit_v2", "nvmlShutdown", "nvmlDeviceGetCount_v2", "nvmlDeviceGetHandleByIndex",
+    "nvmlDeviceGetName", "nvmlDeviceGetUUID", "nvmlDeviceGetPciInfo", "nvmlDeviceGetMemoryInfo",
+    "nvmlDeviceGetUtilizationRates", "nvmlDeviceGetTemperature", "nvmlDeviceGetPowerUsage",
+    "nvmlDeviceGetClockInfo", "nvmlDeviceGetFanSpeed", "nvmlDeviceGetTotalEnergyConsumption",
+    "nvmlDeviceGetPcieReplayCounter", "nvmlDeviceGetFieldValues"
+};
+
+static long stub_calls[STUB_FUNCTION_COUNT];
+static int stub_lost[STUB_MAX_DEVICES];
+static unsigned int stub_count = 4;
+static unsigned int stub_latency_us = 0;
+static int stub_no_field_values = 0;
+static int stub_rejected_fields[STUB_MAX_FIELD_ID];
+
+__attribute__((constructor)) static void stub_load(void) {
+    const char* count = getenv("STUB_NVML_COUNT");
+    const char* latency = getenv("STUB_NVML_LATENCY_US");
+    if (count) stub_count = (unsigned int)atoi(count);
+    if (stub_count > STUB_MAX_DEVICES) stub_count = STUB_MAX_DEVICES;
+    if (latency) stub_latency_us = (unsigned int)atoi(latency);
+}
+
+static void stub_call(stub_function_t function) {
+    __atomic_fetch_add(&stub_calls[function], 1, __ATOMIC_RELAXED);
+    unsigned int latency_us = __atomic_load_n(&stub_latency_us, __ATOMIC_RELAXED);
+    if (latency_us) usleep(latency_us);
+}
+
+// Handles are 1-based device numbers
+static long stub_device(void* handle) {
+    return (long)handle - 1;
+}
+
+static int stub_dynamic_call(stub_function_t function, void* handle) {
+    stub_call(function);
+    long index = stub_device(handle);
+    if (index < 0 || index >= (long)stub_count) return NVML_ERROR_INVALID_ARGUMENT;
+    return __atomic_load_n(&stub_lost[index], __ATOMIC_RELAXED) ? NVML_ERROR_GPU_IS_LOST : NVML_SUCCESS;
+}
+
+// Test controls
+
+long stub_nvml_calls(const char* function) {
+    for (int i = 0; i < STUB_FUNCTION_COUNT; i++) {
+        if (strcmp(stub_function_names[i], function) == 0) {
+            return __atomic_load_n(&stub_calls[i], __ATOMIC_RELAXED);
+        }
+    }
+    return -1;
+}
+
+long stub_nvml_total_calls(void) {
+    long total = 0;
+    for (int i = 0; i < STUB_FUNCTION_COUNT; i++) {
+        total += __atomic_load_n(&stub_calls[i], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+void stub_nvml_reset_calls(void) {
+    for (int i = 0; i < STUB_FUNCTION_COUNT; i++) {
+        __atomic_store_n(&stub_calls[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+void stub_nvml_set_lost(int index, int lost) {
+    __atomic_store_n(&stub_lost[index], lost, __ATOMIC_RELAXED);
+}
+
+void stub_nvml_set_latency_us(unsigned int latency_us) {
+    __atomic_store_n(&stub_latency_us, latency_us, __ATOMIC_RELAXED);
+}
+
+// Make nvmlDeviceGetFieldValues fail as a whole, as on a driver that does not
+// support it
+void stub_nvml_set_field_values(int supported) {
+    __atomic_store_n(&stub_no_field_values, !supported, __ATOMIC_RELAXED);
+}
+
+// Make nvmlDeviceGetFieldValues reject one field id on every device
+void stub_nvml_set_field_supported(unsigned int field_id, int supported) {
+    if (field_id < STUB_MAX_FIELD_ID) {
+        __atomic_store_n(&stub_rejected_fields[field_id], !supported, __ATOMIC_RELAXED);
+    }
+}
+
+// NVML entry points used by the backend
+
+typedef struct { unsigned long long total, free, used; } nvmlMemory_t;
+typedef struct { unsigned int gpu, memory; } nvmlUtilization_t;
+typedef struct {
+    char busId[16];
+    unsigned int domain, bus, device, pciDeviceId, pciSubSystemId;
+} nvmlPciInfo_t;
+typedef struct {
+    unsigned int fieldId, scopeId;
+    long long timestamp, latencyUsec;
+    int valueType, nvmlReturn;
+    union { double dVal; unsigned int uiVal; unsigned long long ullVal; } value;
+} nvmlFieldValue_t;
+
+int nvmlInit_v2(void) {
+    stub_call(STUB_INIT);
+    return NVML_SUCCESS;
+}
+
+int nvmlShutdown(void) {
+    stub_call(STUB_SHUTDOWN);
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetCount_v2(unsigned int* count) {
+    stub_call(STUB_GET_COUNT);
+    *count = stub_count;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetHandleByIndex(unsigned int index, void** handle) {
+    stub_call(STUB_GET_HANDLE);
+    if (index >= stub_count) return NVML_ERROR_INVALID_ARGUMENT;
+    if (__atomic_load_n(&stub_lost[index], __ATOMIC_RELAXED)) return NVML_ERROR_GPU_IS_LOST;
+    *handle = (void*)(long)(index + 1);
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetName(void* handle, char* name, unsigned int size) {
+    stub_call(STUB_GET_NAME);
+    snprintf(name, size, "Stub GPU %ld", stub_device(handle));
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetUUID(void* handle, char* uuid, unsigned int size) {
+    stub_call(STUB_GET_UUID);
+    snprintf(uuid, size, "GPU-stub-%ld", stub_device(handle));
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetPciInfo(void* handle, nvmlPciInfo_t* pci) {
+    stub_call(STUB_GET_PCI_INFO);
+    memset(pci, 0, sizeof(*pci));
+    snprintf(pci->busId, sizeof(pci->busId), "0000:%02lx:00.0", 0x40 + stub_device(handle));
+    return NVML_SUCCESS;
+}
+
+// Device n: 24 GiB with n+1 GiB used, (n+1)*10 % busy, 40+n C, 100+n W,
+// 1905/9501 MHz, fan 33 %, memory at 60+n C, (n+1)*1000 J consumed and n
+// PCIe replays
+int nvmlDeviceGetMemoryInfo(void* handle, nvmlMemory_t* memory) {
+    int result = stub_dynamic_call(STUB_GET_MEMORY_INFO, handle);
+    if (result != NVML_SUCCESS) return result;
+    memory->total = 24ull << 30;
+    memory->used = (unsigned long long)(stub_device(handle) + 1) << 30;
+    memory->free = memory->total - memory->used;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetUtilizationRates(void* handle, nvmlUtilization_t* utilization) {
+    int result = stub_dynamic_call(STUB_GET_UTILIZATION, handle);
+    if (result != NVML_SUCCESS) return result;
+    utilization->gpu = (unsigned int)(stub_device(handle) + 1) * 10;
+    utilization->memory = 5;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetTemperature(void* handle, int sensor, unsigned int* temperature) {
+    (void)sensor;
+    int result = stub_dynamic_call(STUB_GET_TEMPERATURE, handle);
+    if (result != NVML_SUCCESS) return result;
+    *temperature = 40 + (unsigned int)stub_device(handle);
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetPowerUsage(void* handle, unsigned int* power) {
+    int result = stub_dynamic_call(STUB_GET_POWER, handle);
+    if (result != NVML_SUCCESS) return result;
+    *power = 100000 + (unsigned int)stub_device(handle) * 1000;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetClockInfo(void* handle, int type, unsigned int* clock) {
+    int result = stub_dynamic_call(STUB_GET_CLOCK, handle);
+    if (result != NVML_SUCCESS) return result;
+    *clock = type == 0 ? 1905 : 9501;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetFanSpeed(void* handle, unsigned int* speed) {
+    int result = stub_dynamic_call(STUB_GET_FAN, handle);
+    if (result != NVML_SUCCESS) return result;
+    *speed = 33;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetTotalEnergyConsumption(void* handle, unsigned long long* energy) {
+    int result = stub_dynamic_call(STUB_GET_ENERGY, handle);
+    if (result != NVML_SUCCESS) return result;
+    *energy = (unsigned long long)(stub_device(handle) + 1) * 1000000;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetPcieReplayCounter(void* handle, unsigned int* replays) {
+    int result = stub_dynamic_call(STUB_GET_PCIE_REPLAY, handle);
+    if (result != NVML_SUCCESS) return result;
+    *replays = (unsigned int)stub_device(handle);
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetFieldValues(void* handle, int count, nvmlFieldValue_t* values) {
+    int result = stub_dynamic_call(STUB_GET_FIELD_VALUES, handle);
+    if (result != NVML_SUCCESS) return result;
+    if (__atomic_load_n(&stub_no_field_values, __ATOMIC_RELAXED)) return NVML_ERROR_NOT_SUPPORTED;
+    
+    long device = stub_device(handle);
+    for (int i = 0; i < count; i++) {
+        nvmlFieldValue_t* field = &values[i];
+        unsigned int id = field->fieldId;
+        field->nvmlReturn = NVML_SUCCESS;
+        if (id < STUB_MAX_FIELD_ID && __atomic_load_n(&stub_rejected_fields[id], __ATOMIC_RELAXED)) {
+            field->nvmlReturn = NVML_ERROR_NOT_SUPPORTED;
+            continue;
+        }
+        
+        switch (id) {
+            case 82:            // NVML_FI_DEV_MEMORY_TEMP
+                field->valueType = 1;
+                field->value.uiVal = 60 + (unsigned int)device;
+                break;
+            case 83:            // NVML_FI_DEV_TOTAL_ENERGY_CONSUMPTION
+                field->valueType = 3;
+                field->value.ullVal = (unsigned long long)(device + 1) * 1000000;
+                break;
+            case 94:            // NVML_FI_DEV_PCIE_REPLAY_COUNTER
+                field->valueType = 1;
+                field->value.uiVal = (unsigned int)device;
+                break;
+            case 186:           // NVML_FI_DEV_POWER_INSTANT
+                field->valueType = 1;
+                field->value.uiVal = 100000 + (unsigned int)device * 1000;
+                break;
+            default:
+                field->nvmlReturn = NVML_ERROR_NOT_SUPPORTED;
+                break;
+        }
+    }
+    return NVML_SUCCESS;
+}
@@ -0,0 +1,191 @@
+// Per-process usage from DRM fdinfo, scanned through proc_root over the
+// fixture tree in test/fixtures/proc:
+//   100 game     amdgpu on the fixture card at 0000:03:00.0, ns engines;
+//                client 7 behind two fds, client 8, a non-DRM fd and a socket
+//   200 video    i915, ns engines with a video capacity of 2; client 12 and
+//                an fd without drm-client-id
+//   300 compute  xe, cycle counters with a ccs capacity of 4; client 41
+//                behind two fds
+//   400 idle     no DRM fd
+// A second scan over fdinfo with advanced counters checks the utilization
+// computed from the deltas.
+
+#include "common.h"
+#include "gpu_process.h"
+
+#define MS 1000000ULL
+
+static char proc_root[512];
+
+static void write_fdinfo(int pid, int fd, const char* format, ...) {
+    char path[640];
+    char text[2048];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    snprintf(path, sizeof(path), "%s/%d/fdinfo/%d", proc_root, pid, fd);
+    test_write(path, text, (size_t)len);
+}
+
+static const gpu_process_t* find_process(const gpu_process_t* processes, int32_t count, int32_t pid) {
+    for (int32_t i = 0; i < count; i++) {
+        if (processes[i].pid == pid) {
+            return &processes[i];
+        }
+    }
+    return NULL;
+}
+
+static const gpu_process_engine_t* find_engine(const gpu_process_t* process, const char* name) {
+    for (uint32_t i = 0; i < process->engine_count; i++) {
+        if (strcmp(process->engines[i].name, name) == 0) {
+            return &process->engines[i];
+        }
+    }
+    return NULL;
+}
+
+static const gpu_process_region_t* find_region(const gpu_process_t* process, const char* name) {
+    for (uint32_t i = 0; i < process->region_count; i++) {
+        if (strcmp(process->regions[i].name, name) == 0) {
+            return &process->regions[i];
+        }
+    }
+    return NULL;
+}
+
+static void check_engine(const gpu_process_t* process, const char* name, bool cycles,
+                         uint32_t capacity, uint64_t busy) {
+    const gpu_process_engine_t* engine = find_engine(process, name);
+    CHECK(engine != NULL);
+    CHECK(engine->cycles == cycles);
+    CHECK(engine->capacity == capacity);
+    CHECK(engine->busy == busy);
+}
+
+static void check_region(const gpu_process_t* process, const char* name, uint64_t total,
+                         uint64_t resident) {
+    const gpu_process_region_t* region = find_region(process, name);
+    CHECK(region != NULL);
+    CHECK(region->total_bytes == total);
+    CHECK(region->resident_bytes == resident);
+}
+
+// ns engines are measured against the scanner's clock, which read somewhere
+// between the bounds of the wall time taken around the two scans
+static void check_ns_utilization(const gpu_process_t* process, const char* name,
+                                 uint64_t busy_ms, double min_ms, double max_ms) {
+    const gpu_process_engine_t* engine = find_engine(process, name);
+    CHECK(engine != NULL);
+    double low = 100.0 * (double)busy_ms / max_ms / engine->capacity;
+    double high = 100.0 * (double)busy_ms / min_ms / engine->capacity;
+    CHECK(engine->utilization >= low - 1e-9 && engine->utilization <= high + 1e-9);
+}
+
+int main(void) {
+    fixture_reset();
+    fixture_add_amd_card(0, 0x03);
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    
+    snprintf(proc_root, sizeof(proc_root), "%s/proc", TEST_FIXTURE_DIR);
+    test_run("rm -rf '%s' && cp -a '%s/fixtures/proc' '%s'", proc_root, TEST_SOURCE_DIR, proc_root);
+    
+    gpu_process_scanner_t* scanner = NULL;
+    CHECK(gpu_process_scanner_open(proc_root, &scanner) == GPU_SUCCESS);
+    
+    const gpu_process_t* processes = NULL;
+    int32_t count = 0;
+    double before_first = test_now_ms();
+    CHECK(gpu_process_scan(scanner, &processes, &count) == GPU_SUCCESS);
+    double after_first = test_now_ms();
+    
+    CHECK(count == 3);
+    CHECK(processes[0].pid == 100 && processes[1].pid == 200 && processes[2].pid == 300);
+    
+    // Duplicate fds of one client count once; the fd without an id is its own client
+    const gpu_process_t* game = find_process(processes, count, 100);
+    CHECK(strcmp(game->name, "game") == 0 && strcmp(game->driver, "amdgpu") == 0);
+    CHECK(strcmp(game->pdev, "0000:03:00.0") == 0);
+    CHECK(game->clients == 2);
+    gpu_device_desc_t desc;
+    CHECK(game->device >= 0 && gpu_get_desc(game->device, &desc) == GPU_SUCCESS);
+    CHECK(desc.vendor == GPU_VENDOR_AMD && strstr(desc.pci_bus_id, "03:00.0") != NULL);
+    check_engine(game, "gfx", false, 1, 1500 * MS);
+    check_engine(game, "compute", false, 1, 0);
+    check_region(game, "vram", 192 * 1024 * 1024, 192 * 1024 * 1024);
+    check_region(game, "gtt", 2048 * 1024, 2048 * 1024);
+    
+    const gpu_process_t* video = find_process(processes, count, 200);
+    CHECK(strcmp(video->driver, "i915") == 0 && video->device == -1);
+    CHECK(video->clients == 2);
+    check_engine(video, "render", false, 1, 4000 * MS);
+    check_engine(video, "video", false, 2, 0);
+    check_engine(video, "video-enhance", false, 1, 0);
+    check_region(video, "system0", 16 * 1024 * 1024, 8 * 1024 * 1024);
+    
+    const gpu_process_t* compute = find_process(processes, count, 300);
+    CHECK(strcmp(compute->driver, "xe") == 0 && compute->device == -1);
+    CHECK(compute->clients == 1);
+    check_engine(compute, "rcs", true, 1, 1000);
+    check_engine(compute, "ccs", true, 4, 0);
+    check_region(compute, "vram0", 1024 * 1024 * 1024, 512 * 1024 * 1024);
+    check_region(compute, "system", 4 * 1024 * 1024, 3 * 1024 * 1024);
+    
+    // Nothing to compare against yet
+    for (int32_t i = 0; i < count; i++) {
+        for (uint32_t e = 0; e < processes[i].engine_count; e++) {
+            CHECK(processes[i].engines[e].utilization == -1);
+        }
+    }
+    
+    // Advance every counter, then scan again
+    const char* amd = "drm-driver:\tamdgpu\ndrm-pdev:\t0000:03:00.0\ndrm-client-id:\t%d\n"
+                      "drm-memory-vram:\t%d KiB\ndrm-engine-gfx:\t%llu ns\ndrm-engine-compute:\t%llu ns\n";
+    write_fdinfo(100, 5, amd, 7, 131072, 1050 * MS, 20 * MS);
+    write_fdinfo(100, 6, amd, 7, 131072, 1050 * MS, 20 * MS);
+    write_fdinfo(100, 7, amd, 8, 65536, 510 * MS, 0ULL);
+    const char* i915 = "drm-driver:\ti915\ndrm-pdev:\t0000:00:02.0\n%s"
+                       "drm-engine-render:\t%llu ns\ndrm-engine-video:\t%llu ns\n"
+                       "drm-engine-capacity-video:\t2\n";
+    write_fdinfo(200, 4, i915, "drm-client-id:\t12\n", 2030 * MS, 40 * MS);
+    write_fdinfo(200, 5, i915, "", 2000 * MS, 0ULL);
+    const char* xe = "drm-driver:\txe\ndrm-client-id:\t41\ndrm-pdev:\t0000:05:00.0\n"
+                     "drm-cycles-rcs:\t26000\ndrm-total-cycles-rcs:\t150000\n"
+                     "drm-cycles-ccs:\t40000\ndrm-total-cycles-ccs:\t150000\n"
+                     "drm-engine-capacity-ccs:\t4\n";
+    write_fdinfo(300, 3, xe);
+    write_fdinfo(300, 4, xe);
+    
+    struct timespec pause = { 0, 200 * 1000 * 1000 };
+    nanosleep(&pause, NULL);
+    double before_second = test_now_ms();
+    CHECK(gpu_process_scan(scanner, &processes, &count) == GPU_SUCCESS);
+    double after_second = test_now_ms();
+    double min_ms = before_second - after_first;
+    double max_ms = after_second - before_first;
+    
+    CHECK(count == 3);
+    game = find_process(processes, count, 100);
+    CHECK(game->clients == 2);
+    check_ns_utilization(game, "gfx", 60, min_ms, max_ms);
+    check_ns_utilization(game, "compute", 20, min_ms, max_ms);
+    check_region(game, "vram", 192 * 1024 * 1024, 192 * 1024 * 1024);
+    
+    // Both clients are matched to their previous counters, the one without an
+    // id by its fd
+    video = find_process(processes, count, 200);
+    CHECK(video->clients == 2);
+    check_ns_utilization(video, "render", 30, min_ms, max_ms);
+    check_ns_utilization(video, "video", 40, min_ms, max_ms);
+    
+    // Cycle counters need no clock: 25000 of 50000 cycles, 40000 of 50000 over 4 engines
+    compute = find_process(processes, count, 300);
+    CHECK_NEAR(find_engine(compute, "rcs")->utilization, 50.0, 1e-9);
+    CHECK_NEAR(find_engine(compute, "ccs")->utilization, 20.0, 1e-9);
+    
+    gpu_process_scanner_close(scanner);
+    gpu_info_cleanup();
+    printf("process: 3 processes over 2 scans, %.0f ms apart\n", min_ms);
+    return 0;
+}
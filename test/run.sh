@@ -0,0 +1,83 @@
+#!/bin/sh
+# Native tests and benchmarks for the C core. They run against fixture
+# backends, so no GPU is needed: a stub libnvidia-ml.so (nvml_stub.c) and a
+# fixture sysfs tree for amdgpu, which the core is compiled to read instead
+# of /sys/class/drm. Linux only.
+#
+#   sh test/run.sh            unit tests, under AddressSanitizer/UBSan
+#   sh test/run.sh stress     concurrency stress test under ThreadSanitizer
+#   sh test/run.sh bench      benchmarks, optimized build
+#   sh test/run.sh <name>...  only the named tests or benchmarks
+#
+# JavaScript benchmarks (test/bench/<name>.js) run the addon built by
+# `npm run build` against the same stub NVML.
+#
+# CC and CFLAGS are honoured; SANITIZE overrides the sanitizer flags.
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD="$ROOT/test/build"
+FIXTURE="$BUILD/fixture"
+CC=${CC:-cc}
+
+TESTS="gpu_metrics_test nvml_cache_test nvml_batch_test snapshot_test shm_test collector_test store_test history_test process_test"
+STRESS="stress_test"
+BENCHES="registry_bench sysfs_bench field_bench pool_bench event_loop_bench"
+
+case "${1:-test}" in
+    test) MODE=test; NAMES=$TESTS ;;
+    stress) MODE=stress; NAMES=$STRESS ;;
+    bench) MODE=bench; NAMES=$BENCHES ;;
+    *) MODE=named; NAMES="$*" ;;
+esac
+
+case "$MODE" in
+    stress) FLAVOR=tsan; SANITIZE=${SANITIZE-"-fsanitize=thread"}; OPT="-O1 -g" ;;
+    bench) FLAVOR=bench; SANITIZE=${SANITIZE-""}; OPT="-O2" ;;
+    *) FLAVOR=test; SANITIZE=${SANITIZE-"-fsanitize=address,undefined"}; OPT="-O1 -g" ;;
+esac
+
+# GCC warns that TSAN does not model the seqlock fences; that is expected
+if [ "$FLAVOR" = tsan ] && echo 'int x;' | $CC -Werror -Wno-tsan -x c -c -o /dev/null - 2>/dev/null; then
+    SANITIZE="$SANITIZE -Wno-tsan"
+fi
+
+OUT="$BUILD/$FLAVOR"
+mkdir -p "$OUT" "$FIXTURE"
+
+DEFINES="-DTEST_SOURCE_DIR=\"$ROOT/test\" -DTEST_FIXTURE_DIR=\"$FIXTURE\" -DDRM_CLASS_PATH=\"$FIXTURE/sys/class/drm\""
+FLAGS="$OPT -Wall -Wextra $SANITIZE $CFLAGS"
+
+# Stub NVML, found by the backend's dlopen() through LD_LIBRARY_PATH and
+# linked directly by tests that use its controls
+$CC $FLAGS -shared -fPIC -Wl,-soname,libnvidia-ml.so -o "$OUT/libnvidia-ml.so" "$ROOT/test/nvml_stub.c"
+
+# The C core as one archive
+rm -f "$OUT"/core-*.o "$OUT/libgpucore.a"
+for src in "$ROOT"/src/*.c "$ROOT"/src/vendor/*.c "$ROOT"/src/linux/*.c; do
+    obj="$OUT/core-$(basename "$(dirname "$src")")-$(basename "$src" .c).o"
+    $CC $FLAGS $DEFINES -I"$ROOT/src" -c "$src" -o "$obj"
+done
+ar rcs "$OUT/libgpucore.a" "$OUT"/core-*.o
+
+status=0
+for name in $NAMES; do
+    if [ -f "$ROOT/test/bench/$name.js" ]; then
+        # Runs the built addon, which dlopen()s the same stub NVML
+        run="node $ROOT/test/bench/$name.js"
+    else
+        src="$ROOT/test/$name.c"
+        [ -f "$src" ] || src="$ROOT/test/bench/$name.c"
+        $CC $FLAGS $DEFINES -I"$ROOT/src" -I"$ROOT/test" -o "$OUT/$name" "$src" \
+            "$OUT/libgpucore.a" -L"$OUT" -lnvidia-ml -Wl,-rpath,"$OUT" -ldl -lpthread -lm
+        run="$OUT/$name"
+    fi
+    echo "== $name"
+    if LD_LIBRARY_PATH="$OUT${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}" $run; then
+        :
+    else
+        echo "FAILED: $name"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,74 @@
+// Shared-memory segment publisher and reader: a publish round-trips through
+// an attached reader, publishing again under the same name closes the old
+// segment, and a name held by an object that is not a segment is refused
+// and left in place.
+
+#include "common.h"
+#include "gpu_shm.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static void publish(gpu_shm_t* shm) {
+    gpu_sample_t samples[4];
+    bool valid[4];
+    int32_t count = 0;
+    CHECK(gpu_collect_samples(samples, valid, 4, &count) == GPU_SUCCESS);
+    CHECK(count == 4);
+    gpu_shm_write(samples, valid, count, shm);
+}
+
+int main(void) {
+    fixture_reset();
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    
+    char name[64];
+    snprintf(name, sizeof(name), "/gpu-shm-test-%d", (int)getpid());
+    
+    gpu_shm_t* shm = NULL;
+    CHECK(gpu_shm_create(name, 4, &shm) == GPU_SUCCESS);
+    publish(shm);
+    
+    gpu_shm_reader_t* reader = NULL;
+    CHECK(gpu_shm_attach(name, &reader) == GPU_SUCCESS);
+    CHECK(gpu_shm_reader_capacity(reader) == 4);
+    
+    double data[4 * GPU_COLUMN_COUNT];
+    gpu_device_desc_t descs[4];
+    int32_t count = 0;
+    CHECK(gpu_shm_read(reader, data, descs, &count, 16) == GPU_SUCCESS);
+    CHECK(count == 4);
+    CHECK(strcmp(descs[3].name, "Stub GPU 3") == 0);
+    CHECK(strcmp(descs[3].pci_bus_id, "0000:43:00.0") == 0);
+    CHECK(data[GPU_COLUMN_TEMPERATURE * 4 + 3] == 43.0);
+    
+    // A second publisher retires the first segment
+    gpu_shm_t* replacement = NULL;
+    CHECK(gpu_shm_create(name, 4, &replacement) == GPU_SUCCESS);
+    CHECK(gpu_shm_reader_closed(reader));
+    gpu_shm_detach(reader);
+    gpu_shm_destroy(replacement);
+    gpu_shm_destroy(shm);
+    
+    // Objects that are not segments are never unlinked
+    const size_t sizes[] = { 0, 16, 4096 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        CHECK(fd >= 0);
+        CHECK(ftruncate(fd, (off_t)sizes[i]) == 0);
+        if (sizes[i] >= 16) {
+            CHECK(pwrite(fd, "not a gpu segment", 16, 0) == 16);
+        }
+        close(fd);
+        
+        CHECK(gpu_shm_create(name, 4, &shm) == GPU_ERROR_INVALID_PARAM);
+        fd = shm_open(name, O_RDONLY, 0);
+        CHECK(fd >= 0);
+        close(fd);
+        CHECK(shm_unlink(name) == 0);
+    }
+    
+    gpu_info_cleanup();
+    printf("shm: round-trip, replacement and foreign objects\n");
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Snapshot writer against a buffer whose header a reader overwrites (as
+// JavaScript can through a SharedArrayBuffer): writes stay within the size
+// given at init, under AddressSanitizer, and readers still get consistent
+// copies.
+
+#include "common.h"
+#include "gpu_snapshot.h"
+
+#define CAPACITY 2
+
+static void fill(gpu_sample_t* samples, bool* valid, int32_t count, int64_t tick) {
+    memset(samples, 0, sizeof(gpu_sample_t) * (size_t)count);
+    for (int32_t i = 0; i < count; i++) {
+        samples[i].timestamp_ms = tick;
+        samples[i].index = i;
+        samples[i].temperature = 40.0f + (float)i;
+        valid[i] = true;
+    }
+}
+
+int main(void) {
+    size_t size = gpu_snapshot_size(CAPACITY);
+    void* buffer = malloc(size);
+    CHECK(buffer != NULL);
+    
+    gpu_snapshot_writer_t writer;
+    CHECK(gpu_snapshot_init(&writer, buffer, size) == GPU_SUCCESS);
+    CHECK(writer.capacity == CAPACITY);
+    
+    volatile uint32_t* header = (volatile uint32_t*)buffer;
+    CHECK(header[GPU_SNAPSHOT_WORD_CAPACITY] == CAPACITY);
+    CHECK((header[GPU_SNAPSHOT_WORD_SEQUENCE] & 1) == 0);
+    
+    gpu_sample_t samples[8];
+    bool valid[8];
+    double data[CAPACITY * GPU_COLUMN_COUNT];
+    for (int64_t tick = 1; tick <= 100; tick++) {
+        // The header is output only: a capacity or sequence written by a
+        // reader neither sizes the write nor breaks the seqlock
+        header[GPU_SNAPSHOT_WORD_CAPACITY] = 1000;
+        header[GPU_SNAPSHOT_WORD_SEQUENCE] = (uint32_t)tick * 7 + 1;
+        
+        fill(samples, valid, 8, tick);
+        gpu_snapshot_write(&writer, samples, valid, 8);
+        
+        CHECK((header[GPU_SNAPSHOT_WORD_SEQUENCE] & 1) == 0);
+        CHECK(gpu_snapshot_read(buffer, CAPACITY, data, 1) == CAPACITY);
+        CHECK(data[GPU_COLUMN_TIMESTAMP * CAPACITY + 1] == (double)tick);
+        CHECK(data[GPU_COLUMN_TEMPERATURE * CAPACITY + 1] == 41.0);
+    }
+    
+    // Unsampled GPUs read as NaN
+    fill(samples, valid, 1, 101);
+    gpu_snapshot_write(&writer, samples, valid, 1);
+    CHECK(gpu_snapshot_read(buffer, CAPACITY, data, 1) == 1);
+    CHECK(data[GPU_COLUMN_TEMPERATURE * CAPACITY] == 40.0);
+    CHECK(data[GPU_COLUMN_TEMPERATURE * CAPACITY + 1] != data[GPU_COLUMN_TEMPERATURE * CAPACITY + 1]);
+    
+    free(buffer);
+    printf("snapshot: writes bounded by the writer's capacity\n");
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Persistent store ordering and sealing: device timestamps that go backwards
+// within a tick do not start new segments, every record comes back sorted,
+// a real clock step does start one, and every full segment is sealed by the
+// time the store is closed.
+
+#include "common.h"
+#include "gpu_store.h"
+
+#define DEVICES 4
+#define TICKS 300
+#define SEGMENT_BYTES (64 * 1024)
+
+static const int64_t start_ms = 1700000000000LL;
+
+// Devices finish in reverse order: device 0 is stamped last
+static void write_tick(gpu_store_t* store, int64_t tick_ms) {
+    gpu_sample_t samples[DEVICES];
+    bool valid[DEVICES];
+    memset(samples, 0, sizeof(samples));
+    for (int i = 0; i < DEVICES; i++) {
+        samples[i].index = i;
+        samples[i].timestamp_ms = tick_ms + (DEVICES - 1 - i);
+        samples[i].temperature = 40.0f + (float)i;
+        valid[i] = true;
+    }
+    gpu_store_write(samples, valid, DEVICES, store);
+}
+
+static uint64_t check_sorted(gpu_store_t* store) {
+    gpu_store_range_t ranges[16];
+    int32_t count = 0;
+    CHECK(gpu_store_query(store, INT64_MIN, INT64_MAX, ranges, 16, &count) == GPU_SUCCESS);
+    
+    uint64_t records = 0;
+    for (int32_t r = 0; r < count; r++) {
+        double previous = -1.0;
+        for (uint64_t i = 0; i < ranges[r].count; i++) {
+            const double* record = ranges[r].records + i * GPU_STORE_RECORD_DOUBLES;
+            CHECK(record[GPU_COLUMN_TIMESTAMP] >= previous);
+            CHECK(record[GPU_COLUMN_TEMPERATURE] == 40.0 + record[GPU_STORE_DEVICE]);
+            previous = record[GPU_COLUMN_TIMESTAMP];
+            records++;
+        }
+        gpu_store_segment_release(ranges[r].segment);
+    }
+    return records;
+}
+
+static uint32_t sealed_segments(const char* dir) {
+    uint32_t sealed = 0;
+    for (uint64_t sequence = 0; sequence < 16; sequence++) {
+        char path[600];
+        snprintf(path, sizeof(path), "%s/segment-%016llx.gpus", dir, (unsigned long long)sequence);
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            continue;
+        }
+        gpu_store_header_t header;
+        CHECK(fread(&header, sizeof(header), 1, f) == 1);
+        fclose(f);
+        sealed += header.sealed ? 1 : 0;
+    }
+    return sealed;
+}
+
+int main(void) {
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s/store", TEST_FIXTURE_DIR);
+    test_run("rm -rf '%s'", dir);
+    
+    gpu_store_t* store = NULL;
+    CHECK(gpu_store_open(dir, SEGMENT_BYTES, 16 * SEGMENT_BYTES, &store) == GPU_SUCCESS);
+    for (int t = 0; t < TICKS; t++) {
+        write_tick(store, start_ms + t * 1000);
+    }
+    
+    // 1200 records at 640 per segment
+    gpu_store_stats_t stats;
+    CHECK(gpu_store_get_stats(store, &stats) == GPU_SUCCESS);
+    CHECK(stats.records == TICKS * DEVICES);
+    CHECK(stats.segments == 2);
+    CHECK(stats.dropped_samples == 0);
+    CHECK(stats.first_ms == start_ms);
+    CHECK(check_sorted(store) == TICKS * DEVICES);
+    
+    // A wall-clock step backwards is a new segment
+    write_tick(store, start_ms);
+    CHECK(gpu_store_get_stats(store, &stats) == GPU_SUCCESS);
+    CHECK(stats.segments == 3);
+    gpu_store_close(store);
+    CHECK(sealed_segments(dir) == 3);
+    
+    CHECK(gpu_store_open(dir, SEGMENT_BYTES, 16 * SEGMENT_BYTES, &store) == GPU_SUCCESS);
+    CHECK(gpu_store_get_stats(store, &stats) == GPU_SUCCESS);
+    CHECK(stats.records == (TICKS + 1) * DEVICES);
+    CHECK(stats.recovered_records == 0);
+    CHECK(stats.truncated_records == 0);
+    CHECK(check_sorted(store) == (TICKS + 1) * DEVICES);
+    gpu_store_close(store);
+    
+    printf("store: %d ticks with skewed device timestamps in 2 segments\n", TICKS);
+    return 0;
+}
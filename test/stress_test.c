@@ -0,0 +1,138 @@
+// Concurrency stress test for the thread-safety contract in gpu_info.h: many
+// threads call every query entry point while others rebuild the registry,
+// re-initialize the library and make a GPU disappear and come back, so
+// queries keep running into invalidated registries. Backends are the stub
+// NVML (4 GPUs) and 2 fixture amdgpu cards. Meant for ThreadSanitizer:
+// `sh test/run.sh stress`. Usage: stress_test [seconds]
+
+#include "common.h"
+#include "gpu_thread.h"
+
+void stub_nvml_set_lost(int index, int lost);
+
+#define QUERY_THREADS 16
+
+static uint32_t g_stop = 0;
+static long g_ok[QUERY_THREADS];
+static long g_lost[QUERY_THREADS];
+
+static bool stopping(void) {
+    return __atomic_load_n(&g_stop, __ATOMIC_ACQUIRE) != 0;
+}
+
+static void check_info(int32_t index, const gpu_info_t* info) {
+    CHECK(info->index == index);
+    if (info->vendor == GPU_VENDOR_NVIDIA) {
+        CHECK(strncmp(info->name, "Stub GPU", 8) == 0);
+        CHECK(info->memory_total == 24 * 1024);
+    } else {
+        CHECK(info->vendor == GPU_VENDOR_AMD);
+        CHECK(strncmp(info->name, "AMD Radeon RX 6800", 18) == 0);
+        CHECK(info->temperature == 55.0f);
+    }
+}
+
+static void query_thread(void* arg) {
+    long id = (long)arg;
+    gpu_info_t infos[GPU_MAX_DEVICES];
+    gpu_error_t results[GPU_MAX_DEVICES];
+    int64_t timestamps[GPU_MAX_DEVICES];
+    
+    while (!stopping()) {
+        int32_t count = 0;
+        gpu_get_count(&count);
+        for (int32_t i = 0; i < count; i++) {
+            gpu_info_t info;
+            gpu_device_desc_t desc;
+            gpu_sample_t sample;
+            gpu_error_t result = gpu_get_info(i, &info);
+            if (result == GPU_SUCCESS) {
+                check_info(i, &info);
+                g_ok[id]++;
+            } else if (result == GPU_ERROR_NO_GPU) {
+                g_lost[id]++;
+            }
+            if (gpu_get_desc(i, &desc) == GPU_SUCCESS) {
+                CHECK(desc.index == i);
+            }
+            gpu_sample(i, &sample);
+        }
+        
+        int32_t collected = 0;
+        gpu_collect_info(GPU_FIELD_ALL, infos, results, timestamps, GPU_MAX_DEVICES, &collected);
+        for (int32_t i = 0; i < collected; i++) {
+            if (results[i] == GPU_SUCCESS) {
+                check_info(i, &infos[i]);
+            }
+        }
+    }
+}
+
+// Registry rebuilds and library reference churn; the main thread's own
+// reference keeps the backends loaded throughout
+static void refresh_thread(void* arg) {
+    (void)arg;
+    while (!stopping()) {
+        gpu_refresh();
+        gpu_info_init();
+        gpu_info_cleanup();
+    }
+}
+
+// GPU 1 falls off the bus and comes back
+static void hotplug_thread(void* arg) {
+    (void)arg;
+    struct timespec pause = { 0, 2 * 1000 * 1000 };
+    for (int lost = 1; !stopping(); lost = !lost) {
+        stub_nvml_set_lost(1, lost);
+        nanosleep(&pause, NULL);
+    }
+    stub_nvml_set_lost(1, 0);
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    
+    fixture_reset();
+    fixture_add_amd_card(0, 0x03);
+    fixture_add_amd_card(1, 0x04);
+    
+    CHECK(gpu_info_init() == GPU_SUCCESS);
+    int32_t count = 0;
+    CHECK(gpu_get_count(&count) == GPU_SUCCESS && count == 6);
+    
+    gpu_thread_t threads[QUERY_THREADS + 2];
+    for (long i = 0; i < QUERY_THREADS; i++) {
+        CHECK(gpu_thread_create(&threads[i], query_thread, (void*)i) == 0);
+    }
+    CHECK(gpu_thread_create(&threads[QUERY_THREADS], refresh_thread, NULL) == 0);
+    CHECK(gpu_thread_create(&threads[QUERY_THREADS + 1], hotplug_thread, NULL) == 0);
+    
+    struct timespec run = { (time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9) };
+    nanosleep(&run, NULL);
+    __atomic_store_n(&g_stop, 1, __ATOMIC_RELEASE);
+    
+    long ok = 0;
+    long lost = 0;
+    for (int i = 0; i < QUERY_THREADS + 2; i++) {
+        gpu_thread_join(threads[i]);
+    }
+    for (int i = 0; i < QUERY_THREADS; i++) {
+        ok += g_ok[i];
+        lost += g_lost[i];
+    }
+    
+    // Once GPU 1 is back, the registry recovers and every device answers
+    gpu_refresh();
+    CHECK(gpu_get_count(&count) == GPU_SUCCESS && count == 6);
+    for (int32_t i = 0; i < count; i++) {
+        gpu_info_t info;
+        CHECK(gpu_get_info(i, &info) == GPU_SUCCESS);
+        check_info(i, &info);
+    }
+    CHECK(ok > 0);
+    
+    printf("stress: %ld queries answered, %ld saw a lost GPU, in %.1f s\n", ok, lost, seconds);
+    gpu_info_cleanup();
+    return 0;
+}